@@ -20,6 +20,10 @@
 
 #include <string.h>  // memset
 
+#ifdef UA_ENABLE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #ifndef MSG_NOSIGNAL
 #define MSG_NOSIGNAL 0
 #endif
@@ -28,6 +32,86 @@
 /* Generic Socket Functions */
 /****************************/
 
+/* The send and receive buffers of the server connections are kept in pools
+ * for reuse, so that sending a chunk or receiving from the socket requires no
+ * heap allocation. Every pool holds buffers of a single size class, the
+ * negotiated send- or receive buffer size of the connection. Long messages are
+ * sent in many chunks. Enough buffers are kept for the chunks that the
+ * SecureChannel collects for a single sendv call plus the chunk that is being
+ * encoded. The buffers are allocated lazily, so the receive pool holds only a
+ * single buffer in practice. */
+#define BUFFERPOOL_SIZE (UA_MESSAGECONTEXT_MAXPENDING + 1)
+
+typedef struct {
+    size_t bufferSize; /* All pooled buffers have the same size */
+    UA_Byte *buffers[BUFFERPOOL_SIZE];
+    UA_Boolean inUse[BUFFERPOOL_SIZE];
+} BufferPool;
+
+static void
+BufferPool_clear(BufferPool *pool) {
+    for(size_t i = 0; i < BUFFERPOOL_SIZE; i++)
+        UA_free(pool->buffers[i]);
+    memset(pool, 0, sizeof(BufferPool));
+}
+
+/* Reusing a pooled buffer counts as a hit. Every heap allocation counts as a
+ * miss. The statistics are optional. */
+static UA_StatusCode
+BufferPool_get(BufferPool *pool, size_t length, UA_ByteString *buf,
+               UA_NetworkStatistics *stats) {
+    /* Adjust the pool to a new buffer size (e.g. after the Hello handshake)
+     * when no pooled buffer is in use. Otherwise allocate from the heap. */
+    if(length != pool->bufferSize) {
+        for(size_t i = 0; i < BUFFERPOOL_SIZE; i++) {
+            if(pool->inUse[i])
+                goto heap;
+        }
+        BufferPool_clear(pool);
+        pool->bufferSize = length;
+    }
+
+    for(size_t i = 0; i < BUFFERPOOL_SIZE; i++) {
+        if(pool->inUse[i])
+            continue;
+        if(pool->buffers[i]) {
+            if(stats)
+                UA_atomic_addSize(&stats->bufferPoolHits, 1);
+        } else {
+            pool->buffers[i] = (UA_Byte*)UA_malloc(length);
+            if(!pool->buffers[i])
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            if(stats)
+                UA_atomic_addSize(&stats->bufferPoolMisses, 1);
+        }
+        pool->inUse[i] = true;
+        buf->data = pool->buffers[i];
+        buf->length = length;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* All pooled buffers are in use */
+ heap:
+    if(stats)
+        UA_atomic_addSize(&stats->bufferPoolMisses, 1);
+    return UA_ByteString_allocBuffer(buf, length);
+}
+
+/* Buffers that do not come from the pool are freed. The pool is optional. */
+static void
+BufferPool_release(BufferPool *pool, UA_ByteString *buf) {
+    if(pool && buf->data) {
+        for(size_t i = 0; i < BUFFERPOOL_SIZE; i++) {
+            if(pool->buffers[i] != buf->data)
+                continue;
+            pool->inUse[i] = false;
+            UA_ByteString_init(buf);
+            return;
+        }
+    }
+    UA_ByteString_deleteMembers(buf);
+}
+
 static UA_StatusCode
 connection_getsendbuffer(UA_Connection *connection,
                          size_t length, UA_ByteString *buf) {
@@ -49,78 +133,151 @@ connection_releaserecvbuffer(UA_Connection *connection,
     UA_ByteString_deleteMembers(buf);
 }
 
+/* Maximum number of buffers that are handed to a single sendmsg call */
+#define SENDV_MAXBUFFERS 16
+
+/* Timeout in ms to wait for space in the socket send buffer. The connection is
+ * closed if the remote side does not read within that time. */
+#define SEND_WAIT_TIMEOUT 10000
+
+/* Wait until the socket is writable. Returns false on timeout or error. */
+static UA_Boolean
+connection_waitWritable(UA_Connection *connection) {
+#ifdef UA_poll
+    /* No upper limit for the socket number (as with select and FD_SETSIZE) */
+    struct pollfd pfd;
+    pfd.fd = (int)connection->sockfd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    int res;
+    do {
+        res = UA_poll(&pfd, 1, SEND_WAIT_TIMEOUT);
+    } while(res < 0 && UA_ERRNO == UA_INTERRUPTED);
+    return (res > 0 && (pfd.revents & POLLOUT));
+#else
+# ifndef _WIN32
+    if(connection->sockfd >= FD_SETSIZE)
+        return false;
+# endif
+    fd_set fdset;
+    FD_ZERO(&fdset);
+    UA_fd_set(connection->sockfd, &fdset);
+    struct timeval tmptv = {SEND_WAIT_TIMEOUT / 1000,
+                            (SEND_WAIT_TIMEOUT % 1000) * 1000};
+    return (UA_select(connection->sockfd+1, NULL, &fdset, NULL, &tmptv) > 0);
+#endif
+}
+
+/* Send all buffers in order. The buffers are released (to the pool) in every
+ * case. */
 static UA_StatusCode
-connection_write(UA_Connection *connection, UA_ByteString *buf) {
+connection_sendBuffers(UA_Connection *connection, BufferPool *pool,
+                       UA_ByteString *bufs, size_t bufsSize) {
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
     if(connection->state == UA_CONNECTION_CLOSED) {
-        UA_ByteString_deleteMembers(buf);
-        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+        res = UA_STATUSCODE_BADCONNECTIONCLOSED;
+        goto cleanup;
     }
 
     /* Prevent OS signals when sending to a closed socket */
     int flags = 0;
     flags |= MSG_NOSIGNAL;
 
-    /* Send the full buffer. This may require several calls to send */
-    size_t nWritten = 0;
-    do {
-        ssize_t n = 0;
-        do {
-            size_t bytes_to_send = buf->length - nWritten;
-            n = UA_send(connection->sockfd,
-                     (const char*)buf->data + nWritten,
-                     bytes_to_send, flags);
-            if(n < 0 && UA_ERRNO != UA_INTERRUPTED && UA_ERRNO != UA_AGAIN) {
-                connection->close(connection);
-                UA_ByteString_deleteMembers(buf);
-                return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    /* Send the full buffers. This may require several calls. The position is
+     * the current buffer and the offset inside that buffer. */
+    size_t pos = 0, offset = 0;
+    while(pos < bufsSize) {
+        if(bufs[pos].length <= offset) {
+            pos++;
+            offset = 0;
+            continue;
+        }
+        ssize_t n;
+#ifdef UA_sendmsg
+        /* Gather the remaining buffers into one system call */
+        struct iovec iov[SENDV_MAXBUFFERS];
+        size_t iovSize = 0;
+        for(size_t i = pos; i < bufsSize && iovSize < SENDV_MAXBUFFERS; i++) {
+            size_t skip = (i == pos) ? offset : 0;
+            if(bufs[i].length <= skip)
+                continue;
+            iov[iovSize].iov_base = (void*)(bufs[i].data + skip);
+            iov[iovSize].iov_len = bufs[i].length - skip;
+            iovSize++;
+        }
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(struct msghdr));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovSize;
+        n = UA_sendmsg(connection->sockfd, &msg, flags);
+#else
+        n = UA_send(connection->sockfd,
+                    (const char*)bufs[pos].data + offset,
+                    bufs[pos].length - offset, flags);
+#endif
+        if(n < 0) {
+            if(UA_ERRNO == UA_INTERRUPTED)
+                continue;
+            /* The socket buffer is full. Wait until the remote side has read
+             * from the socket instead of spinning. */
+            if((UA_ERRNO == UA_AGAIN || UA_ERRNO == UA_WOULDBLOCK) &&
+               connection_waitWritable(connection))
+                continue;
+            connection->close(connection);
+            res = UA_STATUSCODE_BADCONNECTIONCLOSED;
+            goto cleanup;
+        }
+
+        /* Advance over the written bytes */
+        size_t written = (size_t)n;
+        while(written > 0 && pos < bufsSize) {
+            size_t remaining = bufs[pos].length - offset;
+            if(written < remaining) {
+                offset += written;
+                break;
             }
-        } while(n < 0);
-        nWritten += (size_t)n;
-    } while(nWritten < buf->length);
+            written -= remaining;
+            pos++;
+            offset = 0;
+        }
+    }
 
-    /* Free the buffer */
-    UA_ByteString_deleteMembers(buf);
-    return UA_STATUSCODE_GOOD;
+ cleanup:
+    for(size_t i = 0; i < bufsSize; i++)
+        BufferPool_release(pool, &bufs[i]);
+    return res;
 }
 
 static UA_StatusCode
-connection_recv(UA_Connection *connection, UA_ByteString *response,
-                UA_UInt32 timeout) {
-    if(connection->state == UA_CONNECTION_CLOSED)
-        return UA_STATUSCODE_BADCONNECTIONCLOSED;
-
-    /* Listen on the socket for the given timeout until a message arrives */
-    fd_set fdset;
-    FD_ZERO(&fdset);
-    UA_fd_set(connection->sockfd, &fdset);
-    UA_UInt32 timeout_usec = timeout * 1000;
-    struct timeval tmptv = {(long int)(timeout_usec / 1000000),
-                            (int)(timeout_usec % 1000000)};
-    int resultsize = UA_select(connection->sockfd+1, &fdset, NULL, NULL, &tmptv);
-
-    /* No result */
-    if(resultsize == 0)
-        return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+connection_write(UA_Connection *connection, UA_ByteString *buf) {
+    return connection_sendBuffers(connection, NULL, buf, 1);
+}
 
-    if(resultsize == -1) {
-        /* The call to select was interrupted. Act as if it timed out. */
-        if(UA_ERRNO == EINTR)
-            return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+static UA_StatusCode
+connection_writev(UA_Connection *connection, UA_ByteString *bufs,
+                  size_t bufsSize) {
+    return connection_sendBuffers(connection, NULL, bufs, bufsSize);
+}
 
-        /* The error cannot be recovered. Close the connection. */
-        connection->close(connection);
-        return UA_STATUSCODE_BADCONNECTIONCLOSED;
-    }
+static size_t
+connection_recvBufferSize(const UA_Connection *connection) {
+    UA_SecureChannel *channel = connection->channel;
+    if(channel && channel->config.recvBufferSize > 0)
+        return channel->config.recvBufferSize;
+    return 16384; /* Use as default for a new SecureChannel */
+}
 
+/* Receive from a socket that is known to be readable (or nonblocking). If no
+ * data is pending on a nonblocking socket, an empty buffer is returned. */
+static UA_StatusCode
+connection_recvReady(UA_Connection *connection, UA_ByteString *response,
+                     UA_UInt32 timeout) {
     UA_Boolean internallyAllocated = !response->length;
 
     /* Allocate the buffer  */
     if(internallyAllocated) {
-        size_t bufferSize = 16384; /* Use as default for a new SecureChannel */
-        UA_SecureChannel *channel = connection->channel;
-        if(channel && channel->config.recvBufferSize > 0)
-            bufferSize = channel->config.recvBufferSize;
-        UA_StatusCode res = UA_ByteString_allocBuffer(response, bufferSize);
+        UA_StatusCode res =
+            UA_ByteString_allocBuffer(response, connection_recvBufferSize(connection));
         if(res != UA_STATUSCODE_GOOD)
             return res;
     }
@@ -140,6 +297,8 @@ connection_recv(UA_Connection *connection, UA_ByteString *response,
     if(ret < 0) {
         if(internallyAllocated)
             UA_ByteString_deleteMembers(response);
+        else
+            response->length = 0;
         if(UA_ERRNO == UA_INTERRUPTED || (timeout > 0) ?
            false : (UA_ERRNO == UA_EAGAIN || UA_ERRNO == UA_WOULDBLOCK))
             return UA_STATUSCODE_GOOD; /* statuscode_good but no data -> retry */
@@ -152,6 +311,38 @@ connection_recv(UA_Connection *connection, UA_ByteString *response,
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_StatusCode
+connection_recv(UA_Connection *connection, UA_ByteString *response,
+                UA_UInt32 timeout) {
+    if(connection->state == UA_CONNECTION_CLOSED)
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+
+    /* Listen on the socket for the given timeout until a message arrives */
+    fd_set fdset;
+    FD_ZERO(&fdset);
+    UA_fd_set(connection->sockfd, &fdset);
+    UA_UInt32 timeout_usec = timeout * 1000;
+    struct timeval tmptv = {(long int)(timeout_usec / 1000000),
+                            (int)(timeout_usec % 1000000)};
+    int resultsize = UA_select(connection->sockfd+1, &fdset, NULL, NULL, &tmptv);
+
+    /* No result */
+    if(resultsize == 0)
+        return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+
+    if(resultsize == -1) {
+        /* The call to select was interrupted. Act as if it timed out. */
+        if(UA_ERRNO == EINTR)
+            return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+
+        /* The error cannot be recovered. Close the connection. */
+        connection->close(connection);
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+    }
+
+    return connection_recvReady(connection, response, timeout);
+}
+
 
 /***************************/
 /* Server NetworkLayer TCP */
@@ -164,8 +355,21 @@ connection_recv(UA_Connection *connection, UA_ByteString *response,
 typedef struct ConnectionEntry {
     UA_Connection connection;
     LIST_ENTRY(ConnectionEntry) pointers;
+#ifdef UA_ENABLE_EPOLL
+    /* Connections that have not yet received a Hello. Ordered by the opening
+     * date, so that the Hello timeout does not require a full scan. */
+    TAILQ_ENTRY(ConnectionEntry) openingPointers;
+    UA_Boolean opening;
+    UA_Boolean purged; /* Freed after the current batch of epoll events */
+#endif
+    BufferPool sendBuffers;
+    BufferPool recvBuffers;
 } ConnectionEntry;
 
+#ifdef UA_ENABLE_EPOLL
+#define EPOLL_MAXEVENTS 64
+#endif
+
 typedef struct {
     const UA_Logger *logger;
     UA_UInt16 port;
@@ -173,14 +377,84 @@ typedef struct {
     UA_SOCKET serverSockets[FD_SETSIZE];
     UA_UInt16 serverSocketsSize;
     LIST_HEAD(, ConnectionEntry) connections;
-    UA_UInt16 connectionsSize;
+    UA_UInt32 connectionsSize;
+    UA_NetworkStatistics *statistics; /* Taken from the nl when started */
+#ifdef UA_ENABLE_EPOLL
+    int epollfd; /* -1 for the select-based layer */
+    TAILQ_HEAD(, ConnectionEntry) openingConnections;
+    LIST_HEAD(, ConnectionEntry) purgedConnections;
+    struct epoll_event events[EPOLL_MAXEVENTS];
+#endif
 } ServerNetworkLayerTCP;
 
 static void
 ServerNetworkLayerTCP_freeConnection(UA_Connection *connection) {
+    BufferPool_clear(&((ConnectionEntry*)connection)->sendBuffers);
+    BufferPool_clear(&((ConnectionEntry*)connection)->recvBuffers);
     UA_free(connection);
 }
 
+/* The server connections take the send and receive buffers from the
+ * per-connection pools */
+
+static UA_StatusCode
+ServerNetworkLayerTCP_getSendBuffer(UA_Connection *connection,
+                                    size_t length, UA_ByteString *buf) {
+    UA_SecureChannel *channel = connection->channel;
+    if(channel && channel->config.sendBufferSize < length)
+        return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)connection->handle;
+    return BufferPool_get(&((ConnectionEntry*)connection)->sendBuffers,
+                          length, buf, layer->statistics);
+}
+
+static void
+ServerNetworkLayerTCP_releaseSendBuffer(UA_Connection *connection,
+                                        UA_ByteString *buf) {
+    BufferPool_release(&((ConnectionEntry*)connection)->sendBuffers, buf);
+}
+
+/* Receive into a pooled buffer. The buffer is already released if no status
+ * good is returned. */
+static UA_StatusCode
+ServerNetworkLayerTCP_recv(ConnectionEntry *e, UA_ByteString *buf,
+                           UA_Boolean ready) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP*)e->connection.handle;
+    UA_StatusCode retval =
+        BufferPool_get(&e->recvBuffers, connection_recvBufferSize(&e->connection),
+                       buf, layer->statistics);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if(ready)
+        retval = connection_recvReady(&e->connection, buf, 0);
+    else
+        retval = connection_recv(&e->connection, buf, 0);
+    if(retval != UA_STATUSCODE_GOOD)
+        BufferPool_release(&e->recvBuffers, buf);
+    return retval;
+}
+
+static void
+ServerNetworkLayerTCP_releaseRecvBuffer(UA_Connection *connection,
+                                        UA_ByteString *buf) {
+    BufferPool_release(&((ConnectionEntry*)connection)->recvBuffers, buf);
+}
+
+static UA_StatusCode
+ServerNetworkLayerTCP_send(UA_Connection *connection, UA_ByteString *buf) {
+    return connection_sendBuffers(connection,
+                                  &((ConnectionEntry*)connection)->sendBuffers,
+                                  buf, 1);
+}
+
+static UA_StatusCode
+ServerNetworkLayerTCP_sendv(UA_Connection *connection, UA_ByteString *bufs,
+                            size_t bufsSize) {
+    return connection_sendBuffers(connection,
+                                  &((ConnectionEntry*)connection)->sendBuffers,
+                                  bufs, bufsSize);
+}
+
 /* This performs only 'shutdown'. 'close' is called when the shutdown
  * socket is returned from select. */
 static void
@@ -192,16 +466,38 @@ ServerNetworkLayerTCP_close(UA_Connection *connection) {
 }
 
 static UA_Boolean
-purgeFirstConnectionWithoutChannel(ServerNetworkLayerTCP *layer) {
+purgeFirstConnectionWithoutChannel(UA_ServerNetworkLayer *nl,
+                                   ServerNetworkLayerTCP *layer) {
     ConnectionEntry *e;
     LIST_FOREACH(e, &layer->connections, pointers) {
-        if(e->connection.channel == NULL) {
-            LIST_REMOVE(e, pointers);
-            layer->connectionsSize--;
-            UA_close(e->connection.sockfd);
-            e->connection.free(&e->connection);
+        if(e->connection.channel != NULL)
+            continue;
+        LIST_REMOVE(e, pointers);
+#ifdef UA_ENABLE_EPOLL
+        if(layer->epollfd >= 0) {
+            epoll_ctl(layer->epollfd, EPOLL_CTL_DEL, e->connection.sockfd, NULL);
+            if(e->opening) {
+                TAILQ_REMOVE(&layer->openingConnections, e, openingPointers);
+                e->opening = false;
+            }
+        }
+#endif
+        layer->connectionsSize--;
+        UA_close(e->connection.sockfd);
+        if(nl->statistics)
+            nl->statistics->currentConnectionCount--;
+#ifdef UA_ENABLE_EPOLL
+        /* The purge runs while the events are processed. Later events of the
+         * same batch can still point to the entry. */
+        if(layer->epollfd >= 0) {
+            e->connection.state = UA_CONNECTION_CLOSED;
+            e->purged = true;
+            LIST_INSERT_HEAD(&layer->purgedConnections, e, pointers);
             return true;
         }
+#endif
+        e->connection.free(&e->connection);
+        return true;
     }
     return false;
 }
@@ -210,7 +506,7 @@ static UA_StatusCode
 ServerNetworkLayerTCP_add(UA_ServerNetworkLayer *nl, ServerNetworkLayerTCP *layer,
                           UA_Int32 newsockfd, struct sockaddr_storage *remote) {
    if(layer->maxConnections && layer->connectionsSize >= layer->maxConnections &&
-      !purgeFirstConnectionWithoutChannel(layer)) {
+      !purgeFirstConnectionWithoutChannel(nl, layer)) {
        return UA_STATUSCODE_BADTCPNOTENOUGHRESOURCES;
    }
 
@@ -256,21 +552,49 @@ ServerNetworkLayerTCP_add(UA_ServerNetworkLayer *nl, ServerNetworkLayerTCP *laye
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
+    memset(&e->sendBuffers, 0, sizeof(BufferPool));
+    memset(&e->recvBuffers, 0, sizeof(BufferPool));
     UA_Connection *c = &e->connection;
     memset(c, 0, sizeof(UA_Connection));
     c->sockfd = newsockfd;
     c->handle = layer;
-    c->send = connection_write;
+    c->send = ServerNetworkLayerTCP_send;
+    c->sendv = ServerNetworkLayerTCP_sendv;
     c->close = ServerNetworkLayerTCP_close;
     c->free = ServerNetworkLayerTCP_freeConnection;
-    c->getSendBuffer = connection_getsendbuffer;
-    c->releaseSendBuffer = connection_releasesendbuffer;
-    c->releaseRecvBuffer = connection_releaserecvbuffer;
+    c->getSendBuffer = ServerNetworkLayerTCP_getSendBuffer;
+    c->releaseSendBuffer = ServerNetworkLayerTCP_releaseSendBuffer;
+    c->releaseRecvBuffer = ServerNetworkLayerTCP_releaseRecvBuffer;
     c->state = UA_CONNECTION_OPENING;
     c->openingDate = UA_DateTime_nowMonotonic();
 
+#ifdef UA_ENABLE_EPOLL
+    e->opening = false;
+    e->purged = false;
+
+    /* Register the socket once. Edge-triggered, so the socket has to be
+     * drained until it would block whenever an event is signaled. */
+    if(layer->epollfd >= 0) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(struct epoll_event));
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = e;
+        if(epoll_ctl(layer->epollfd, EPOLL_CTL_ADD, newsockfd, &ev) != 0) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+                UA_LOG_ERROR(layer->logger, UA_LOGCATEGORY_NETWORK,
+                             "Connection %i | Cannot add the socket to epoll. "
+                             "Error: %s", (int)newsockfd, errno_str));
+            UA_free(e);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+        e->opening = true;
+        TAILQ_INSERT_TAIL(&layer->openingConnections, e, openingPointers);
+    }
+#endif
+
     /* Add to the linked list */
     LIST_INSERT_HEAD(&layer->connections, e, pointers);
+    layer->connectionsSize++;
     if(nl->statistics) {
         nl->statistics->currentConnectionCount++;
         nl->statistics->cumulatedConnectionCount++;
@@ -358,6 +682,7 @@ ServerNetworkLayerTCP_start(UA_ServerNetworkLayer *nl, const UA_String *customHo
   UA_initialize_architecture_network();
 
     ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+    layer->statistics = nl->statistics;
 
     /* Get addrinfo of the server and create server sockets */
     char portno[6];
@@ -506,12 +831,12 @@ ServerNetworkLayerTCP_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
                     (int)(e->connection.sockfd));
 
         UA_ByteString buf = UA_BYTESTRING_NULL;
-        UA_StatusCode retval = connection_recv(&e->connection, &buf, 0);
+        UA_StatusCode retval = ServerNetworkLayerTCP_recv(e, &buf, false);
 
         if(retval == UA_STATUSCODE_GOOD) {
             /* Process packets */
             UA_Server_processBinaryMessage(server, &e->connection, &buf);
-            connection_releaserecvbuffer(&e->connection, &buf);
+            ServerNetworkLayerTCP_releaseRecvBuffer(&e->connection, &buf);
         } else if(retval == UA_STATUSCODE_BADCONNECTIONCLOSED) {
             /* The socket is shutdown but not closed */
             UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
@@ -567,12 +892,17 @@ ServerNetworkLayerTCP_deleteMembers(UA_ServerNetworkLayer *nl) {
         LIST_REMOVE(e, pointers);
         layer->connectionsSize--;
         UA_close(e->connection.sockfd);
-        UA_free(e);
+        e->connection.free(&e->connection);
         if(nl->statistics) {
             nl->statistics->currentConnectionCount--;
         }
     }
 
+#ifdef UA_ENABLE_EPOLL
+    if(layer->epollfd >= 0)
+        UA_close(layer->epollfd);
+#endif
+
     /* Free the layer */
     UA_free(layer);
 }
@@ -598,10 +928,229 @@ UA_ServerNetworkLayerTCP(UA_ConnectionConfig config, UA_UInt16 port,
     layer->logger = logger;
     layer->port = port;
     layer->maxConnections = maxConnections;
+#ifdef UA_ENABLE_EPOLL
+    layer->epollfd = -1;
+    TAILQ_INIT(&layer->openingConnections);
+    LIST_INIT(&layer->purgedConnections);
+#endif
+
+    return nl;
+}
+
+#ifdef UA_ENABLE_EPOLL
+
+/*********************************/
+/* Server NetworkLayer TCP Epoll */
+/*********************************/
+
+/* The epoll layer shares the connection handling with the select-based layer
+ * above. But the sockets are registered only once with an edge-triggered epoll
+ * instance. So the cost of an iteration depends on the number of sockets with
+ * activity and not on the number of open connections. */
+
+static UA_StatusCode
+ServerNetworkLayerTCPEpoll_start(UA_ServerNetworkLayer *nl,
+                                 const UA_String *customHostname) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+    layer->epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if(layer->epollfd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_ERROR(layer->logger, UA_LOGCATEGORY_NETWORK,
+                         "Could not create the epoll instance: %s", errno_str));
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_StatusCode retval = ServerNetworkLayerTCP_start(nl, customHostname);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Register the server sockets. They are identified by a pointer into the
+     * serverSockets array of the layer. */
+    for(UA_UInt16 i = 0; i < layer->serverSocketsSize; i++) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(struct epoll_event));
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.ptr = &layer->serverSockets[i];
+        if(epoll_ctl(layer->epollfd, EPOLL_CTL_ADD,
+                     layer->serverSockets[i], &ev) != 0) {
+            UA_LOG_SOCKET_ERRNO_WRAP(
+                UA_LOG_ERROR(layer->logger, UA_LOGCATEGORY_NETWORK,
+                             "Could not add the server socket to epoll: %s",
+                             errno_str));
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+ServerNetworkLayerTCPEpoll_remove(UA_ServerNetworkLayer *nl, UA_Server *server,
+                                  ConnectionEntry *e) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+    epoll_ctl(layer->epollfd, EPOLL_CTL_DEL, e->connection.sockfd, NULL);
+    LIST_REMOVE(e, pointers);
+    if(e->opening) {
+        TAILQ_REMOVE(&layer->openingConnections, e, openingPointers);
+        e->opening = false;
+    }
+    layer->connectionsSize--;
+    UA_close(e->connection.sockfd);
+    UA_Server_removeConnection(server, &e->connection);
+    if(nl->statistics)
+        nl->statistics->currentConnectionCount--;
+}
+
+/* Close connections without a Hello message. Only the head of the list needs
+ * to be inspected as the list is ordered by the opening date. */
+static void
+ServerNetworkLayerTCPEpoll_checkHelloTimeout(UA_ServerNetworkLayer *nl,
+                                             UA_Server *server) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    ConnectionEntry *e;
+    while((e = TAILQ_FIRST(&layer->openingConnections))) {
+        if(e->connection.state != UA_CONNECTION_OPENING) {
+            TAILQ_REMOVE(&layer->openingConnections, e, openingPointers);
+            e->opening = false;
+            continue;
+        }
+        if(now <= e->connection.openingDate + (NOHELLOTIMEOUT * UA_DATETIME_MSEC))
+            break;
+        UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
+                    "Connection %i | Closed by the server (no Hello Message)",
+                    (int)(e->connection.sockfd));
+        if(nl->statistics)
+            nl->statistics->connectionTimeoutCount++;
+        ServerNetworkLayerTCPEpoll_remove(nl, server, e);
+    }
+}
+
+static void
+ServerNetworkLayerTCPEpoll_accept(UA_ServerNetworkLayer *nl, UA_SOCKET serverSocket) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+    /* Edge-triggered. Accept until no connection is pending. */
+    while(true) {
+        struct sockaddr_storage remote;
+        socklen_t remote_size = sizeof(remote);
+        UA_SOCKET newsockfd = UA_accept(serverSocket, (struct sockaddr*)&remote,
+                                        &remote_size);
+        if(newsockfd == UA_INVALID_SOCKET) {
+            if(UA_ERRNO == UA_INTERRUPTED)
+                continue;
+            return;
+        }
 
+        UA_LOG_TRACE(layer->logger, UA_LOGCATEGORY_NETWORK,
+                     "Connection %i | New TCP connection on server socket %i",
+                     (int)newsockfd, (int)serverSocket);
+
+        if(ServerNetworkLayerTCP_add(nl, layer, (UA_Int32)newsockfd,
+                                     &remote) != UA_STATUSCODE_GOOD)
+            UA_close(newsockfd);
+    }
+}
+
+static void
+ServerNetworkLayerTCPEpoll_read(UA_ServerNetworkLayer *nl, UA_Server *server,
+                                ConnectionEntry *e) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+    UA_LOG_TRACE(layer->logger, UA_LOGCATEGORY_NETWORK,
+                 "Connection %i | Activity on the socket",
+                 (int)(e->connection.sockfd));
+
+    /* Edge-triggered. Drain the socket until it would block. */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    while(true) {
+        if(e->connection.state == UA_CONNECTION_CLOSED) {
+            retval = UA_STATUSCODE_BADCONNECTIONCLOSED;
+            break;
+        }
+        UA_ByteString buf = UA_BYTESTRING_NULL;
+        retval = ServerNetworkLayerTCP_recv(e, &buf, true);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+        if(buf.length == 0) {
+            ServerNetworkLayerTCP_releaseRecvBuffer(&e->connection, &buf);
+            break;
+        }
+        UA_Server_processBinaryMessage(server, &e->connection, &buf);
+        ServerNetworkLayerTCP_releaseRecvBuffer(&e->connection, &buf);
+    }
+
+    if(retval != UA_STATUSCODE_BADCONNECTIONCLOSED)
+        return;
+
+    /* The socket is shutdown but not closed */
+    UA_LOG_INFO(layer->logger, UA_LOGCATEGORY_NETWORK,
+                "Connection %i | Closed", (int)(e->connection.sockfd));
+    ServerNetworkLayerTCPEpoll_remove(nl, server, e);
+}
+
+static UA_StatusCode
+ServerNetworkLayerTCPEpoll_listen(UA_ServerNetworkLayer *nl, UA_Server *server,
+                                  UA_UInt16 timeout) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+    if(layer->serverSocketsSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    ServerNetworkLayerTCPEpoll_checkHelloTimeout(nl, server);
+
+    /* Wait only for the sockets with activity. If more than EPOLL_MAXEVENTS
+     * sockets are ready, the remaining ones are returned in the next
+     * iteration. */
+    int n = epoll_wait(layer->epollfd, layer->events, EPOLL_MAXEVENTS, timeout);
+    if(n < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+            UA_LOG_DEBUG(layer->logger, UA_LOGCATEGORY_NETWORK,
+                         "Socket epoll_wait failed with %s", errno_str));
+        // we will retry, so do not return bad
+        return UA_STATUSCODE_GOOD;
+    }
+
+    for(int i = 0; i < n; i++) {
+        void *ptr = layer->events[i].data.ptr;
+        if(ptr >= (void*)&layer->serverSockets[0] &&
+           ptr < (void*)&layer->serverSockets[layer->serverSocketsSize]) {
+            ServerNetworkLayerTCPEpoll_accept(nl, *(UA_SOCKET*)ptr);
+            continue;
+        }
+        ConnectionEntry *e = (ConnectionEntry*)ptr;
+        if(!e->purged)
+            ServerNetworkLayerTCPEpoll_read(nl, server, e);
+    }
+
+    /* Free the connections purged while processing the events */
+    ConnectionEntry *e;
+    while((e = LIST_FIRST(&layer->purgedConnections))) {
+        LIST_REMOVE(e, pointers);
+        e->connection.free(&e->connection);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+ServerNetworkLayerTCPEpoll_stop(UA_ServerNetworkLayer *nl, UA_Server *server) {
+    ServerNetworkLayerTCP *layer = (ServerNetworkLayerTCP *)nl->handle;
+    ServerNetworkLayerTCP_stop(nl, server);
+    if(layer->epollfd >= 0) {
+        UA_close(layer->epollfd);
+        layer->epollfd = -1;
+    }
+}
+
+UA_ServerNetworkLayer
+UA_ServerNetworkLayerTCPEpoll(UA_ConnectionConfig config, UA_UInt16 port,
+                              UA_UInt16 maxConnections, UA_Logger *logger) {
+    UA_ServerNetworkLayer nl =
+        UA_ServerNetworkLayerTCP(config, port, maxConnections, logger);
+    nl.start = ServerNetworkLayerTCPEpoll_start;
+    nl.listen = ServerNetworkLayerTCPEpoll_listen;
+    nl.stop = ServerNetworkLayerTCPEpoll_stop;
     return nl;
 }
 
+#endif /* UA_ENABLE_EPOLL */
+
 typedef struct TCPClientConnection {
     struct addrinfo hints, *server;
     UA_DateTime connStart;
@@ -797,6 +1346,7 @@ UA_ClientConnectionTCP_init(UA_ConnectionConfig config, const UA_String endpoint
 
     connection.state = UA_CONNECTION_OPENING;
     connection.send = connection_write;
+    connection.sendv = connection_writev;
     connection.recv = connection_recv;
     connection.close = ClientNetworkLayerTCP_close;
     connection.free = ClientNetworkLayerTCP_free;
@@ -858,6 +1408,7 @@ UA_ClientConnectionTCP(UA_ConnectionConfig config, const UA_String endpointUrl,
     memset(&connection, 0, sizeof(UA_Connection));
     connection.state = UA_CONNECTION_CLOSED;
     connection.send = connection_write;
+    connection.sendv = connection_writev;
     connection.recv = connection_recv;
     connection.close = ClientNetworkLayerTCP_close;
     connection.free = ClientNetworkLayerTCP_free;
@@ -12,6 +12,12 @@
 
 #include <open62541/architecture_base.h>
 
+/* Enable the GNU extensions on Linux (e.g. recvmmsg). This header is the
+ * first to include system headers, also in the amalgamation. */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE
+#endif
+
 /* Enable POSIX features */
 #if !defined(_XOPEN_SOURCE)
 # define _XOPEN_SOURCE 600
@@ -42,6 +48,8 @@
 
 #include <fcntl.h>
 #include <unistd.h> // read, write, close
+#include <sys/uio.h> // struct iovec
+#include <poll.h>
 
 #ifdef __QNX__
 # include <sys/socket.h>
@@ -86,6 +94,7 @@
 
 #define UA_getnameinfo getnameinfo
 #define UA_send send
+#define UA_sendmsg sendmsg
 #define UA_recv recv
 #define UA_sendto sendto
 #define UA_recvfrom recvfrom
@@ -93,6 +102,7 @@
 #define UA_ntohl ntohl
 #define UA_close close
 #define UA_select select
+#define UA_poll poll
 #define UA_shutdown shutdown
 #define UA_socket socket
 #define UA_bind bind
@@ -163,6 +163,8 @@ typedef struct {
     size_t rejectedConnectionCount;
     size_t connectionTimeoutCount;
     size_t connectionAbortCount;
+    size_t bufferPoolHits;   /* Send/receive buffers reused from a pool */
+    size_t bufferPoolMisses; /* Send/receive buffers allocated on the heap */
 } UA_NetworkStatistics;
 
 typedef struct {
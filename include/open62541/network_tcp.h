@@ -27,6 +27,17 @@ UA_ServerNetworkLayer UA_EXPORT
 UA_ServerNetworkLayerTCP(UA_ConnectionConfig config, UA_UInt16 port,
                          UA_UInt16 maxConnections, UA_Logger *logger);
 
+#ifdef UA_ENABLE_EPOLL
+/* Initializes a TCP network layer that uses an edge-triggered epoll instance
+ * (Linux only) instead of select. The sockets are registered once and every
+ * iteration only processes the sockets with activity. The number of connections
+ * is not limited by FD_SETSIZE. The parameters are the same as for
+ * UA_ServerNetworkLayerTCP. */
+UA_ServerNetworkLayer UA_EXPORT
+UA_ServerNetworkLayerTCPEpoll(UA_ConnectionConfig config, UA_UInt16 port,
+                              UA_UInt16 maxConnections, UA_Logger *logger);
+#endif
+
 UA_Connection UA_EXPORT
 UA_ClientConnectionTCP(UA_ConnectionConfig config, const UA_String endpointUrl,
                        UA_UInt32 timeout, UA_Logger *logger);
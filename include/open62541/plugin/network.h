@@ -84,6 +84,13 @@ struct UA_Connection {
      * @return Returns an error code or UA_STATUSCODE_GOOD. */
     UA_StatusCode (*send)(UA_Connection *connection, UA_ByteString *buf);
 
+    /* Sends several message buffers in order with as few system calls as
+     * possible (optional, can be NULL). All buffers are freed, even if sending
+     * fails. The SecureChannel collects the chunks of long messages and hands
+     * them over in one call if this is implemented. */
+    UA_StatusCode (*sendv)(UA_Connection *connection, UA_ByteString *bufs,
+                           size_t bufsSize);
+
     /* Receive a message from the remote connection
      *
      * @param connection The connection
@@ -178,10 +178,11 @@ typedef struct {
  * :ref:`variabletypenode` is ensured. */
 
 /* Indicates whether a variable contains data inline or whether it points to an
- * external data source */
+ * external data source or value ring */
 typedef enum {
     UA_VALUESOURCE_DATA,
-    UA_VALUESOURCE_DATASOURCE
+    UA_VALUESOURCE_DATASOURCE,
+    UA_VALUESOURCE_VALUERING
 } UA_ValueSource;
 
 #define UA_NODE_VARIABLEATTRIBUTES                                      \
@@ -199,6 +200,7 @@ typedef enum {
             UA_ValueCallback callback;                                  \
         } data;                                                         \
         UA_DataSource dataSource;                                       \
+        UA_ValueRing *valueRing;                                        \
     } value;
 
 typedef struct {
@@ -41,6 +41,12 @@ typedef enum {
 struct UA_PubSubChannel;
 typedef struct UA_PubSubChannel UA_PubSubChannel;
 
+/* Called for every message received in a batch. The buffer is owned by the
+ * channel and only valid during the callback. */
+typedef UA_StatusCode
+(*UA_PubSubReceiveCallback)(UA_PubSubChannel *channel, void *callbackContext,
+                            const UA_ByteString *buffer);
+
 /* Interface structure between network plugin and internal implementation */
 struct UA_PubSubChannel {
     UA_UInt32 publisherId; /* unique identifier */
@@ -67,6 +73,15 @@ struct UA_PubSubChannel {
     UA_StatusCode (*receive)(UA_PubSubChannel * channel, UA_ByteString *,
                              UA_ExtensionObject *transportSettings, UA_UInt32 timeout);
 
+    /* Optional. Wait up to the timeout (in microseconds) for a message and
+     * then receive all pending messages into buffers owned by the channel. The
+     * callback is called for every message. If not set, the messages are
+     * received one by one with receive. */
+    UA_StatusCode (*receiveBatch)(UA_PubSubChannel *channel,
+                                  UA_ExtensionObject *transportSettings,
+                                  UA_PubSubReceiveCallback callback,
+                                  void *callbackContext, UA_UInt32 timeout);
+
     /* Closing the connection and implicit free of the channel structures. */
     UA_StatusCode (*close)(UA_PubSubChannel *channel);
 
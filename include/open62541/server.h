@@ -18,6 +18,7 @@
 #include <open62541/types.h>
 #include <open62541/types_generated.h>
 #include <open62541/types_generated_handling.h>
+#include <open62541/util.h>
 
 _UA_BEGIN_DECLS
 
@@ -867,6 +868,67 @@ UA_StatusCode UA_EXPORT UA_THREADSAFE
 UA_Server_setVariableNode_dataSource(UA_Server *server, const UA_NodeId nodeId,
                                      const UA_DataSource dataSource);
 
+/**
+ * .. _value-ring:
+ *
+ * Value Ring
+ * ^^^^^^^^^^
+ *
+ * Values that are produced at a high rate by an acquisition thread can be
+ * handed to the server through a value ring. The ring stores the last
+ * ``capacity`` scalar values of a fixed data type together with their source
+ * timestamp. Pushing a value does not take the server lock and does not call
+ * into the server. Reading the value attribute of a variable that points to
+ * the ring (also for the sampling of MonitoredItems and for PubSub) returns the
+ * most recent value. Consumers that need every value (e.g. for historizing)
+ * take the values in order with ``UA_ValueRing_getValues``.
+ *
+ * Only scalars of data types without pointers (numbers, DateTime, Guid, ...)
+ * are supported. Any number of threads may push concurrently, as long as fewer
+ * than ``capacity`` pushes are in progress at the same time. Pushing from
+ * threads other than the server thread requires ``UA_MULTITHREADING >= 100``.
+ *
+ * The ring is owned by the user. It must not be deleted while a variable node
+ * still points to it. */
+
+struct UA_ValueRing;
+typedef struct UA_ValueRing UA_ValueRing;
+
+/* The capacity is rounded up to the next power of two */
+UA_StatusCode UA_EXPORT
+UA_ValueRing_new(const UA_DataType *type, size_t capacity, UA_ValueRing **ring);
+
+void UA_EXPORT
+UA_ValueRing_delete(UA_ValueRing *ring);
+
+/* Push a scalar of the ring's data type. If the source timestamp is zero, then
+ * the current time is used. When the ring is full, the oldest value is
+ * overwritten. */
+UA_StatusCode UA_EXPORT
+UA_ValueRing_push(UA_ValueRing *ring, const UA_Variant *value,
+                  UA_DateTime sourceTimestamp);
+
+/* Copy the most recent value into the DataValue. Returns
+ * UA_STATUSCODE_BADWAITINGFORINITIALDATA if no value was pushed yet. */
+UA_StatusCode UA_EXPORT
+UA_ValueRing_getLatest(UA_ValueRing *ring, UA_DataValue *value);
+
+/* Take up to valuesSize values in the order in which they were pushed. The
+ * position (initially zero) is the number of values pushed before the first
+ * value to be taken and is advanced by the method. Values that were overwritten
+ * before they were taken are skipped. Returns the number of values written
+ * into the values array. */
+size_t UA_EXPORT
+UA_ValueRing_getValues(UA_ValueRing *ring, size_t *position,
+                       UA_DataValue *values, size_t valuesSize);
+
+/* Let the value attribute of the variable point to the ring. The data type of
+ * the ring and the variable must be the same. Writing the value attribute
+ * pushes into the ring. */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_setVariableNode_valueRing(UA_Server *server, const UA_NodeId nodeId,
+                                    UA_ValueRing *ring);
+
 /**
  * .. _value-callback:
  *
@@ -1618,6 +1680,51 @@ typedef struct {
 
 UA_ServerStatistics UA_Server_getStatistics(UA_Server *server);
 
+/**
+ * With the build option ``UA_ENABLE_SERVICE_STATISTICS``, the server also
+ * records counters and latency histograms for every service. A request is
+ * measured from the decoded request until the response was sent. Publish
+ * requests are only queued when they are processed. The time until the
+ * response is sent out shows up in the publish latency.
+ *
+ * The statistics are also exposed in the information model. The
+ * ServerDiagnosticsSummary node contains the session counters and the number
+ * of rejected requests. The ``ServiceStatistics`` object below the
+ * ServerDiagnostics node (in namespace 1) contains one array per counter with
+ * an entry for each service in the order of ``ServiceNames``. */
+
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+
+#define UA_SERVICESTATISTICS_MAX 32
+
+typedef struct {
+    const UA_DataType *requestType;
+    size_t requestCount;
+    size_t errorCount; /* ServiceResult not good or sending failed */
+    UA_UInt64 bytesReceived; /* Request body */
+    UA_UInt64 bytesSent;     /* Response body (all chunks) */
+    UA_LatencyHistogram latency;
+} UA_ServiceCounters;
+
+typedef struct {
+    size_t servicesSize; /* Services in the order of the first request */
+    UA_ServiceCounters services[UA_SERVICESTATISTICS_MAX];
+    UA_LatencyHistogram publishLatency; /* Creating and sending a PublishResponse */
+    UA_LatencyHistogram samplingLag;    /* Delay of the sampling beyond the
+                                         * sampling interval */
+    UA_LatencyHistogram timerLateness;  /* Delay of the (repeated) callbacks
+                                         * beyond their scheduled time */
+} UA_ServiceStatistics;
+
+/* Copy the current statistics */
+void UA_EXPORT
+UA_Server_getServiceStatistics(UA_Server *server, UA_ServiceStatistics *stats);
+
+void UA_EXPORT
+UA_Server_resetServiceStatistics(UA_Server *server);
+
+#endif
+
 _UA_END_DECLS
 
 #endif /* UA_SERVER_H_ */
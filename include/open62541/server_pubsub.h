@@ -78,6 +78,9 @@ _UA_BEGIN_DECLS
  * **UA_ENABLE_PUBSUB_DELTAFRAMES**
  *  The PubSub messages differentiate between keyframe (all published values contained) and deltaframe (only changed values contained) messages.
  *  Deltaframe messages creation consumes some additional ressources and can be disabled with this flag. Disabled by default.
+ *  Writes to the value of a published variable are tracked. A deltaframe samples only the variables that were written since
+ *  the last message. Variables with a data source, static value sources and variables that did not exist when the DataSetField
+ *  was added are sampled for every deltaframe.
  *  Compile the human-readable name of the StatusCodes into the binary. Disabled by default.
  * **UA_ENABLE_PUBSUB_INFORMATIONMODEL**
  *  Enable the information model representation of the PubSub configuration. For more details take a look at the following section `PubSub Information Model Representation`. Disabled by default.
@@ -339,7 +342,21 @@ typedef enum {
  *
  * WARNING! For hard real time requirements the underlying system must be rt-capable.
  *
- */
+ * Dedicated Threads
+ * ~~~~~~~~~~~~~~~~~
+ * With ``UA_ENABLE_PUBSUB_THREADS``, a WriterGroup or ReaderGroup can run in a
+ * dedicated thread instead of the server main loop. The thread sleeps on its
+ * own clock between the cycles. So the cycles of the group are not delayed by
+ * other groups or by the processing of client requests.
+ *
+ * The thread runs without the service mutex of the server. So only a group
+ * that is frozen with ``UA_PUBSUB_RT_FIXED_SIZE`` moves into its thread. Until
+ * then it is run by the server main loop. A frozen WriterGroup sends its
+ * buffered message without touching the information model. A frozen
+ * ReaderGroup only processes the messages for its own DataSetReaders. The
+ * first message of a reader, that becomes the template, is written with the
+ * thread-safe server API (``UA_MULTITHREADING >= 100``). A WriterGroup has to
+ * be disabled to freeze or unfreeze it. */
 typedef enum {
     UA_PUBSUB_RT_NONE = 0,
     UA_PUBSUB_RT_DIRECT_VALUE_ACCESS = 1,
@@ -368,6 +385,10 @@ typedef struct {
     UA_Boolean configurationFrozen;
     /* non std. field */
     UA_PubSubRTLevel rtLevel;
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    /* non std. field. Publish in a dedicated thread. */
+    UA_Boolean dedicatedThread;
+#endif
 } UA_WriterGroupConfig;
 
 void UA_EXPORT
@@ -481,6 +502,13 @@ typedef struct {
     UA_UadpDataSetReaderMessageDataType messageSettings;
     UA_ExtensionObject transportSettings;
     UA_TargetVariablesDataType subscribedDataSetTarget;
+    /* non std. field. Used in ReaderGroups with UA_PUBSUB_RT_FIXED_SIZE. One
+     * DataValue for each field of the dataSetMetaData, with a scalar of the
+     * field type already allocated. The received values are copied into the
+     * scalars. The array is not copied and must outlive the DataSetReader. */
+    UA_DataValue *staticValueTargets;
+    /* This flag is 'read only' and is set internally based on the PubSub state. */
+    UA_Boolean configurationFrozen;
 } UA_DataSetReaderConfig;
 
 /* Update configuration to the dataSetReader */
@@ -509,12 +537,29 @@ UA_Server_DataSetReader_createTargetVariables(UA_Server *server, UA_NodeId dataS
  * ReaderGroup
  * -----------
  * All ReaderGroups are created within a PubSubConnection and automatically
- * deleted if the connection is removed. */
+ * deleted if the connection is removed.
+ *
+ * The configuration of a ReaderGroup can be frozen. With the
+ * ``UA_PUBSUB_RT_FIXED_SIZE`` level, all DataSetReaders of the frozen group
+ * must have scalar fields of a numeric type and ``staticValueTargets``. The
+ * first NetworkMessage for a DataSetReader is decoded as usual and taken as
+ * template. Later messages with the same layout are not decoded. The field
+ * values are copied from their fixed offsets into the ``staticValueTargets``
+ * instead of being written into the information model. Messages that do not
+ * match the template take the normal path. */
 
 /* ReaderGroup configuration */
 typedef struct {
     UA_String name;
     UA_PubSubSecurityParameters securityParameters;
+    /* This flag is 'read only' and is set internally based on the PubSub state. */
+    UA_Boolean configurationFrozen;
+    /* non std. field */
+    UA_PubSubRTLevel rtLevel;
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    /* non std. field. Receive in a dedicated thread. */
+    UA_Boolean dedicatedThread;
+#endif
 } UA_ReaderGroupConfig;
 
 /* Add DataSetReader to the ReaderGroup */
@@ -548,6 +593,12 @@ UA_Server_addReaderGroup(UA_Server *server, UA_NodeId connectionIdentifier,
 UA_StatusCode UA_EXPORT
 UA_Server_removeReaderGroup(UA_Server *server, UA_NodeId groupIdentifier);
 
+UA_StatusCode UA_EXPORT
+UA_Server_freezeReaderGroupConfiguration(UA_Server *server, const UA_NodeId readerGroup);
+
+UA_StatusCode UA_EXPORT
+UA_Server_unfreezeReaderGroupConfiguration(UA_Server *server, const UA_NodeId readerGroup);
+
 #endif /* UA_ENABLE_PUBSUB */
 
 _UA_END_DECLS
@@ -162,6 +162,32 @@ UA_constantTimeEqual(const void *ptr1, const void *ptr2, size_t length) {
     return !c;
 }
 
+/**
+ * Latency Histogram
+ * ----------------- */
+
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+
+/* Histogram of durations in microseconds. The bucket boundaries grow
+ * exponentially with four linear sub-buckets between two powers of two. So the
+ * relative error of the reported percentiles is below 25% over the entire
+ * range. The last bucket also collects all durations beyond ~71 minutes. */
+#define UA_LATENCYHISTOGRAM_BUCKETS 124
+
+typedef struct {
+    UA_UInt64 count;
+    UA_UInt64 sum; /* [us] */
+    UA_UInt64 max; /* [us] */
+    UA_UInt64 buckets[UA_LATENCYHISTOGRAM_BUCKETS];
+} UA_LatencyHistogram;
+
+/* Returns the upper bound [us] of the bucket that contains the percentile
+ * (between 0.0 and 1.0). Returns zero for an empty histogram. */
+UA_UInt64 UA_EXPORT
+UA_LatencyHistogram_percentile(const UA_LatencyHistogram *h, UA_Double percentile);
+
+#endif
+
 _UA_END_DECLS
 
 #endif /* UA_HELPER_H_ */
@@ -0,0 +1,1494 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define HDB_FILE_MAGIC 0x44484155 /* "UAHD" */
+#define HDB_FILE_VERSION 1
+#define HDB_FILE_INITIAL_BUCKETS 16
+
+/* Every sparse index entry covers one page of records */
+#define HDB_FILE_SPARSE_BYTES 4096
+
+/* The mappings are larger than the files. So the records appended to a
+ * segment can be read without mapping the segment again. */
+#define HDB_FILE_MAP_CHUNK (1024 * 1024)
+
+/* At most this many segments are mapped at the same time. The least recently
+ * used mapping is released first. */
+#define HDB_FILE_MAX_MAPPINGS 64
+
+/* Longer directory names of the nodes are replaced by a hash */
+#define HDB_FILE_MAX_NAME 128
+#define HDB_FILE_MAX_COLLISIONS 64
+#define HDB_FILE_NAME_FILE "node"
+
+#define HDB_FILE_HASVALUE           0x01
+#define HDB_FILE_HASSTATUS          0x02
+#define HDB_FILE_HASSOURCETIMESTAMP 0x04
+#define HDB_FILE_HASSERVERTIMESTAMP 0x08
+
+/* Round up to a multiple of eight bytes to keep the records aligned */
+#define HDB_FILE_ALIGN(size) (((size) + 7) & ~(size_t)7)
+
+/* Every segment file starts with the header */
+typedef struct {
+    UA_UInt32 magic;
+    UA_UInt32 version;
+    UA_UInt32 recordSize;
+    UA_UInt32 typeIdentifier;
+    UA_UInt16 typeNamespace;
+    UA_UInt16 reserved;
+    UA_UInt32 reserved2;
+    UA_DateTime segmentStart;
+    UA_DateTime segmentDuration;
+} UA_FileSegmentHeader;
+
+/* The records have a fixed size. The value follows the record header. */
+typedef struct {
+    UA_DateTime timestamp; /* Source timestamp or the fallback */
+    UA_DateTime serverTimestamp;
+    UA_StatusCode status;
+    UA_Byte flags;
+    UA_Byte reserved[3];
+} UA_FileRecord;
+
+typedef struct {
+    UA_DateTime start; /* Start of the time partition */
+    size_t first;      /* Index of the first record among all segments */
+    size_t count;
+    UA_DateTime last;  /* Timestamp of the last record */
+
+    /* Mapped on demand */
+    UA_Byte *map;
+    size_t mapLength;
+    size_t mapping;    /* Position in the mapping table plus one */
+
+    /* Timestamp of every sparseStride-th record. Built on demand. */
+    UA_DateTime *sparse;
+    size_t sparseSize;
+} UA_FileSegment;
+
+typedef struct UA_FileStoreContext UA_FileStoreContext;
+
+typedef struct UA_FileNode {
+    struct UA_FileNode *next; /* Next node in the same hash bucket */
+    UA_FileStoreContext *ctx;
+    UA_NodeId nodeId;
+    char *path;               /* Directory of the segment files */
+
+    const UA_DataType *type;  /* Fixed by the first sample */
+    size_t recordSize;
+    size_t sparseStride;
+    UA_Byte *record;          /* Buffer for writing a record */
+
+    UA_FileSegment *segments; /* Ordered by the start time */
+    size_t segmentsSize;
+    size_t count;             /* Records in all segments */
+
+    /* The segment file that was written last is kept open */
+    int fd;
+    UA_DateTime fdStart;
+
+    /* Returned from getDataValue. Points into the mapped segment. */
+    UA_DataValue current;
+} UA_FileNode;
+
+/* Entry of the table of mapped segments */
+typedef struct {
+    UA_FileNode *node; /* NULL if the entry is free */
+    UA_DateTime start;
+    UA_UInt64 lastUse;
+} UA_FileMapping;
+
+struct UA_FileStoreContext {
+    char *directory;
+    UA_DateTime segmentDuration;
+    UA_FileNode **buckets;
+    size_t bucketsSize; /* Power of two */
+    size_t nodesSize;
+
+    UA_FileMapping mappings[HDB_FILE_MAX_MAPPINGS];
+    UA_UInt64 mappingsClock;
+};
+
+/* Unknown nodes have an empty history */
+static UA_FileNode emptyNode_backend_file;
+
+/*****************/
+/* File Handling */
+/*****************/
+
+static const char *hexDigits_backend_file = "0123456789abcdef";
+
+static int
+hexValue_backend_file(char c) {
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+static void
+printHex_backend_file(char *pos, const UA_Byte *data, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        pos[2 * i] = hexDigits_backend_file[data[i] >> 4];
+        pos[(2 * i) + 1] = hexDigits_backend_file[data[i] & 0x0f];
+    }
+    pos[2 * length] = 0;
+}
+
+static UA_StatusCode
+parseHex_backend_file(const char *pos, UA_Byte *data, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        int high = hexValue_backend_file(pos[2 * i]);
+        int low = hexValue_backend_file(pos[(2 * i) + 1]);
+        if(high < 0 || low < 0)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        data[i] = (UA_Byte)((high << 4) | low);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The directory of a node is named <ns>-<type>-<identifier>. Strings,
+ * ByteStrings and Guids are written in hex. */
+static char *
+nodeName_backend_file(const UA_NodeId *nodeId) {
+    size_t identifierLength;
+    char type;
+    switch(nodeId->identifierType) {
+    case UA_NODEIDTYPE_NUMERIC:
+        identifierLength = 10;
+        type = 'i';
+        break;
+    case UA_NODEIDTYPE_STRING:
+        identifierLength = 2 * nodeId->identifier.string.length;
+        type = 's';
+        break;
+    case UA_NODEIDTYPE_BYTESTRING:
+        identifierLength = 2 * nodeId->identifier.byteString.length;
+        type = 'b';
+        break;
+    case UA_NODEIDTYPE_GUID:
+        identifierLength = 32;
+        type = 'g';
+        break;
+    default:
+        return NULL;
+    }
+
+    char *name = (char*)UA_malloc(identifierLength + 9);
+    if(!name)
+        return NULL;
+    int pos = sprintf(name, "%u-%c-", (unsigned)nodeId->namespaceIndex, type);
+    const UA_Guid *guid = &nodeId->identifier.guid;
+    switch(nodeId->identifierType) {
+    case UA_NODEIDTYPE_NUMERIC:
+        sprintf(&name[pos], "%u", (unsigned)nodeId->identifier.numeric);
+        break;
+    case UA_NODEIDTYPE_GUID:
+        pos += sprintf(&name[pos], "%08x%04x%04x", (unsigned)guid->data1,
+                       (unsigned)guid->data2, (unsigned)guid->data3);
+        printHex_backend_file(&name[pos], guid->data4, 8);
+        break;
+    default: /* String and ByteString */
+        printHex_backend_file(&name[pos], nodeId->identifier.string.data,
+                              nodeId->identifier.string.length);
+        break;
+    }
+    return name;
+}
+
+static char *
+joinPath_backend_file(const char *directory, const char *name) {
+    char *path = (char*)UA_malloc(strlen(directory) + strlen(name) + 2);
+    if(path)
+        sprintf(path, "%s/%s", directory, name);
+    return path;
+}
+
+/* Returns the content of the name file in the directory of a hashed node */
+static char *
+readNodeName_backend_file(const char *path) {
+    char *namePath = joinPath_backend_file(path, HDB_FILE_NAME_FILE);
+    if(!namePath)
+        return NULL;
+    int fd = open(namePath, O_RDONLY);
+    UA_free(namePath);
+    if(fd < 0)
+        return NULL;
+    char *name = NULL;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size <= 0)
+        goto cleanup;
+    name = (char*)UA_malloc((size_t)st.st_size + 1);
+    if(!name)
+        goto cleanup;
+    if(pread(fd, name, (size_t)st.st_size, 0) != (ssize_t)st.st_size) {
+        UA_free(name);
+        name = NULL;
+        goto cleanup;
+    }
+    name[st.st_size] = 0;
+
+ cleanup:
+    close(fd);
+    return name;
+}
+
+/* Long names exceed the limit of the file system. Such nodes are stored in the
+ * directory h-<hash>-<n> that contains the full name in a file. The directory
+ * is created right away to reserve it. Collisions of the hash are resolved
+ * with the counter. */
+static char *
+hashedNodePath_backend_file(const char *directory, const char *name,
+                            UA_UInt32 hash) {
+    size_t nameLength = strlen(name);
+    for(unsigned n = 0; n < HDB_FILE_MAX_COLLISIONS; n++) {
+        char *path = (char*)UA_malloc(strlen(directory) + 22);
+        if(!path)
+            return NULL;
+        sprintf(path, "%s/h-%08x-%u", directory, (unsigned)hash, n);
+        if(mkdir(path, 0755) == 0) {
+            char *namePath = joinPath_backend_file(path, HDB_FILE_NAME_FILE);
+            int fd = (namePath) ? open(namePath, O_WRONLY | O_CREAT | O_EXCL, 0644) : -1;
+            UA_free(namePath);
+            if(fd >= 0 && write(fd, name, nameLength) == (ssize_t)nameLength) {
+                close(fd);
+                return path;
+            }
+            if(fd >= 0)
+                close(fd);
+            UA_free(path);
+            return NULL;
+        }
+        if(errno != EEXIST) {
+            UA_free(path);
+            return NULL;
+        }
+
+        /* Reuse the directory if it belongs to the same node */
+        char *existing = readNodeName_backend_file(path);
+        UA_Boolean match = (existing && strcmp(existing, name) == 0);
+        UA_free(existing);
+        if(match)
+            return path;
+        UA_free(path);
+    }
+    return NULL;
+}
+
+static char *
+nodePath_backend_file(const char *directory, const UA_NodeId *nodeId) {
+    char *name = nodeName_backend_file(nodeId);
+    if(!name)
+        return NULL;
+    char *path;
+    if(strlen(name) <= HDB_FILE_MAX_NAME)
+        path = joinPath_backend_file(directory, name);
+    else
+        path = hashedNodePath_backend_file(directory, name, UA_NodeId_hash(nodeId));
+    UA_free(name);
+    return path;
+}
+
+static UA_StatusCode
+parseNodeId_backend_file(const char *name, UA_NodeId *nodeId) {
+    UA_NodeId_init(nodeId);
+    char *end = NULL;
+    unsigned long ns = strtoul(name, &end, 10);
+    if(end == name || ns > UA_UINT16_MAX || end[0] != '-' ||
+       end[1] == 0 || end[2] != '-')
+        return UA_STATUSCODE_BADDECODINGERROR;
+    char type = end[1];
+    const char *identifier = &end[3];
+    size_t length = strlen(identifier);
+    nodeId->namespaceIndex = (UA_UInt16)ns;
+
+    switch(type) {
+    case 'i': {
+        unsigned long numeric = strtoul(identifier, &end, 10);
+        if(length == 0 || *end != 0 || numeric > UA_UINT32_MAX)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        nodeId->identifierType = UA_NODEIDTYPE_NUMERIC;
+        nodeId->identifier.numeric = (UA_UInt32)numeric;
+        return UA_STATUSCODE_GOOD;
+    }
+    case 'g': {
+        UA_Byte data[16];
+        if(length != 32 || parseHex_backend_file(identifier, data, 16) != UA_STATUSCODE_GOOD)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        UA_Guid *guid = &nodeId->identifier.guid;
+        guid->data1 = ((UA_UInt32)data[0] << 24) | ((UA_UInt32)data[1] << 16) |
+            ((UA_UInt32)data[2] << 8) | data[3];
+        guid->data2 = (UA_UInt16)((data[4] << 8) | data[5]);
+        guid->data3 = (UA_UInt16)((data[6] << 8) | data[7]);
+        memcpy(guid->data4, &data[8], 8);
+        nodeId->identifierType = UA_NODEIDTYPE_GUID;
+        return UA_STATUSCODE_GOOD;
+    }
+    case 's':
+    case 'b': {
+        if(length % 2 != 0)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        UA_ByteString *s = &nodeId->identifier.byteString;
+        if(length > 0) {
+            UA_StatusCode retval = UA_ByteString_allocBuffer(s, length / 2);
+            if(retval != UA_STATUSCODE_GOOD)
+                return retval;
+            retval = parseHex_backend_file(identifier, s->data, s->length);
+            if(retval != UA_STATUSCODE_GOOD) {
+                UA_ByteString_clear(s);
+                return retval;
+            }
+        }
+        nodeId->identifierType = (type == 's') ?
+            UA_NODEIDTYPE_STRING : UA_NODEIDTYPE_BYTESTRING;
+        return UA_STATUSCODE_GOOD;
+    }
+    default:
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+}
+
+/* The segment files are named after the start of the time partition */
+static char *
+segmentPath_backend_file(const UA_FileNode *node, UA_DateTime start) {
+    char *path = (char*)UA_malloc(strlen(node->path) + 23);
+    if(path)
+        sprintf(path, "%s/%016llx.seg", node->path, (unsigned long long)start);
+    return path;
+}
+
+static UA_DateTime
+partitionStart_backend_file(const UA_FileStoreContext *ctx, UA_DateTime timestamp) {
+    UA_DateTime offset = timestamp % ctx->segmentDuration;
+    if(offset < 0)
+        offset += ctx->segmentDuration;
+    return timestamp - offset;
+}
+
+/* Returns the file descriptor of the segment for writing */
+static int
+segmentFd_backend_file(UA_FileNode *node, const UA_FileSegment *seg) {
+    if(node->fd >= 0 && node->fdStart == seg->start)
+        return node->fd;
+    if(node->fd >= 0)
+        close(node->fd);
+    char *path = segmentPath_backend_file(node, seg->start);
+    node->fd = (path) ? open(path, O_RDWR) : -1;
+    node->fdStart = seg->start;
+    UA_free(path);
+    return node->fd;
+}
+
+static void
+unmapSegment_backend_file(const UA_FileNode *node, UA_FileSegment *seg) {
+    if(!seg->map)
+        return;
+    munmap(seg->map, seg->mapLength);
+    node->ctx->mappings[seg->mapping - 1].node = NULL;
+    seg->map = NULL;
+    seg->mapLength = 0;
+    seg->mapping = 0;
+}
+
+static UA_FileSegment *
+segmentOfStart_backend_file(const UA_FileNode *node, UA_DateTime start) {
+    size_t min = 0;
+    size_t max = node->segmentsSize;
+    while(min < max) {
+        size_t mid = min + ((max - min) / 2);
+        if(node->segments[mid].start < start)
+            min = mid + 1;
+        else
+            max = mid;
+    }
+    if(min == node->segmentsSize || node->segments[min].start != start)
+        return NULL;
+    return &node->segments[min];
+}
+
+/* Returns a free entry of the mapping table. Unmaps the least recently used
+ * segment if the table is full. */
+static UA_FileMapping *
+freeMapping_backend_file(UA_FileStoreContext *ctx) {
+    UA_FileMapping *lru = &ctx->mappings[0];
+    for(size_t i = 0; i < HDB_FILE_MAX_MAPPINGS; i++) {
+        UA_FileMapping *m = &ctx->mappings[i];
+        if(!m->node)
+            return m;
+        if(m->lastUse < lru->lastUse)
+            lru = m;
+    }
+    UA_FileSegment *seg = segmentOfStart_backend_file(lru->node, lru->start);
+    if(seg)
+        unmapSegment_backend_file(lru->node, seg);
+    lru->node = NULL;
+    return lru;
+}
+
+/* The mapping stays valid until the next segment is mapped */
+static UA_StatusCode
+mapSegment_backend_file(const UA_FileNode *node, UA_FileSegment *seg) {
+    UA_FileStoreContext *ctx = node->ctx;
+    size_t length = sizeof(UA_FileSegmentHeader) + (seg->count * node->recordSize);
+    if(seg->map && seg->mapLength >= length) {
+        ctx->mappings[seg->mapping - 1].lastUse = ++ctx->mappingsClock;
+        return UA_STATUSCODE_GOOD;
+    }
+    unmapSegment_backend_file(node, seg);
+
+    char *path = segmentPath_backend_file(node, seg->start);
+    if(!path)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    int fd = open(path, O_RDONLY);
+    UA_free(path);
+    if(fd < 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    length = ((length / HDB_FILE_MAP_CHUNK) + 1) * HDB_FILE_MAP_CHUNK;
+    void *map = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_FileMapping *m = freeMapping_backend_file(ctx);
+    m->node = (UA_FileNode*)(uintptr_t)node;
+    m->start = seg->start;
+    m->lastUse = ++ctx->mappingsClock;
+    seg->map = (UA_Byte*)map;
+    seg->mapLength = length;
+    seg->mapping = (size_t)(m - ctx->mappings) + 1;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+UA_FileSegment_clear(const UA_FileNode *node, UA_FileSegment *seg) {
+    unmapSegment_backend_file(node, seg);
+    UA_free(seg->sparse);
+    memset(seg, 0, sizeof(UA_FileSegment));
+}
+
+/* The segment must be mapped */
+static const UA_FileRecord *
+recordAt_backend_file(const UA_FileNode *node, const UA_FileSegment *seg, size_t index) {
+    return (const UA_FileRecord*)
+        &seg->map[sizeof(UA_FileSegmentHeader) + (index * node->recordSize)];
+}
+
+/*********/
+/* Nodes */
+/*********/
+
+static void
+UA_FileNode_delete(UA_FileNode *node) {
+    if(node->fd >= 0)
+        close(node->fd);
+    for(size_t i = 0; i < node->segmentsSize; i++)
+        UA_FileSegment_clear(node, &node->segments[i]);
+    UA_free(node->segments);
+    UA_free(node->record);
+    UA_free(node->path);
+    UA_NodeId_clear(&node->nodeId);
+    UA_free(node);
+}
+
+static void
+UA_FileStoreContext_deleteMembers(UA_FileStoreContext *ctx) {
+    for(size_t i = 0; i < ctx->bucketsSize; i++) {
+        UA_FileNode *node = ctx->buckets[i];
+        while(node) {
+            UA_FileNode *next = node->next;
+            UA_FileNode_delete(node);
+            node = next;
+        }
+    }
+    UA_free(ctx->buckets);
+    UA_free(ctx->directory);
+    memset(ctx, 0, sizeof(UA_FileStoreContext));
+}
+
+static UA_FileNode *
+findNode_backend_file(const UA_FileStoreContext *ctx, const UA_NodeId *nodeId) {
+    if(ctx->bucketsSize == 0)
+        return NULL;
+    UA_FileNode *node = ctx->buckets[UA_NodeId_hash(nodeId) & (ctx->bucketsSize - 1)];
+    for(; node; node = node->next) {
+        if(UA_NodeId_equal(&node->nodeId, nodeId))
+            return node;
+    }
+    return NULL;
+}
+
+static UA_FileNode *
+getNode_backend_file(void *context, const UA_NodeId *nodeId) {
+    UA_FileNode *node = findNode_backend_file((UA_FileStoreContext*)context, nodeId);
+    return (node) ? node : &emptyNode_backend_file;
+}
+
+static void
+growBuckets_backend_file(UA_FileStoreContext *ctx) {
+    size_t newSize = ctx->bucketsSize * 2;
+    UA_FileNode **buckets = (UA_FileNode**)UA_calloc(newSize, sizeof(UA_FileNode*));
+    if(!buckets)
+        return; /* Continue with a higher load */
+    for(size_t i = 0; i < ctx->bucketsSize; i++) {
+        UA_FileNode *node = ctx->buckets[i];
+        while(node) {
+            UA_FileNode *next = node->next;
+            UA_FileNode **bucket = &buckets[UA_NodeId_hash(&node->nodeId) & (newSize - 1)];
+            node->next = *bucket;
+            *bucket = node;
+            node = next;
+        }
+    }
+    UA_free(ctx->buckets);
+    ctx->buckets = buckets;
+    ctx->bucketsSize = newSize;
+}
+
+/* The directory name is given for nodes loaded from the disk */
+static UA_StatusCode
+addNode_backend_file(UA_FileStoreContext *ctx, const UA_NodeId *nodeId,
+                     const char *name, UA_FileNode **outNode) {
+    UA_FileNode *node = (UA_FileNode*)UA_calloc(1, sizeof(UA_FileNode));
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    node->ctx = ctx;
+    node->fd = -1;
+    node->path = (name) ? joinPath_backend_file(ctx->directory, name) :
+        nodePath_backend_file(ctx->directory, nodeId);
+    UA_StatusCode retval = UA_NodeId_copy(nodeId, &node->nodeId);
+    if(!node->path || retval != UA_STATUSCODE_GOOD) {
+        UA_FileNode_delete(node);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    if(ctx->nodesSize >= ctx->bucketsSize)
+        growBuckets_backend_file(ctx);
+    UA_FileNode **bucket = &ctx->buckets[UA_NodeId_hash(nodeId) & (ctx->bucketsSize - 1)];
+    node->next = *bucket;
+    *bucket = node;
+    ctx->nodesSize++;
+    *outNode = node;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+setType_backend_file(UA_FileNode *node, const UA_DataType *type) {
+    size_t recordSize = sizeof(UA_FileRecord) + HDB_FILE_ALIGN(type->memSize);
+    UA_Byte *record = (UA_Byte*)UA_calloc(1, recordSize);
+    if(!record)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    node->type = type;
+    node->recordSize = recordSize;
+    node->record = record;
+    node->sparseStride = HDB_FILE_SPARSE_BYTES / recordSize;
+    if(node->sparseStride == 0)
+        node->sparseStride = 1;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Only scalars of the standard types without pointers can be stored. The type
+ * is found again when the segment files are loaded. */
+static UA_StatusCode
+checkValue_backend_file(const UA_FileNode *node, const UA_DataValue *value) {
+    if(!value->hasValue)
+        return UA_STATUSCODE_GOOD;
+    const UA_DataType *type = value->value.type;
+    if(!type || !UA_Variant_isScalar(&value->value) || !type->pointerFree ||
+       UA_findDataType(&type->typeId) != type)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    if(node && node->type && node->type != type)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Get the node for storing the value. Creates the node if required. */
+static UA_StatusCode
+getNodeForValue_backend_file(UA_FileStoreContext *ctx, const UA_NodeId *nodeId,
+                             const UA_DataValue *value, UA_FileNode **outNode) {
+    UA_FileNode *node = findNode_backend_file(ctx, nodeId);
+    UA_StatusCode retval = checkValue_backend_file(node, value);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* The first sample of a node needs a value to set the type */
+    if((!node || !node->type) && !value->hasValue)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    if(!node) {
+        retval = addNode_backend_file(ctx, nodeId, NULL, &node);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+    if(!node->type) {
+        retval = setType_backend_file(node, value->value.type);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+    *outNode = node;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Recompute the index of the first record for the segments from the given
+ * position on */
+static void
+updateFirst_backend_file(UA_FileNode *node, size_t from) {
+    size_t first = 0;
+    if(from > 0)
+        first = node->segments[from - 1].first + node->segments[from - 1].count;
+    for(size_t i = from; i < node->segmentsSize; i++) {
+        node->segments[i].first = first;
+        first += node->segments[i].count;
+    }
+    node->count = first;
+}
+
+/***********/
+/* Loading */
+/***********/
+
+static int
+compareSegments_backend_file(const void *a, const void *b) {
+    UA_DateTime startA = ((const UA_FileSegment*)a)->start;
+    UA_DateTime startB = ((const UA_FileSegment*)b)->start;
+    if(startA == startB)
+        return 0;
+    return (startA < startB) ? -1 : 1;
+}
+
+/* Returns UA_STATUSCODE_GOOD if the segment file is valid for the node. A
+ * partially written record at the end is ignored and overwritten later. */
+static UA_StatusCode
+loadSegment_backend_file(const UA_FileStoreContext *ctx, UA_FileNode *node,
+                         UA_DateTime start, UA_FileSegment *seg) {
+    char *path = segmentPath_backend_file(node, start);
+    if(!path)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    int fd = open(path, O_RDONLY);
+    UA_free(path);
+    if(fd < 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_StatusCode retval = UA_STATUSCODE_BADDECODINGERROR;
+    UA_FileSegmentHeader header;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(UA_FileSegmentHeader) ||
+       pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+        goto cleanup;
+    if(header.magic != HDB_FILE_MAGIC || header.version != HDB_FILE_VERSION ||
+       header.segmentStart != start || header.segmentDuration != ctx->segmentDuration)
+        goto cleanup;
+
+    UA_NodeId typeId = UA_NODEID_NUMERIC(header.typeNamespace, header.typeIdentifier);
+    const UA_DataType *type = UA_findDataType(&typeId);
+    if(!type || !type->pointerFree || (node->type && node->type != type))
+        goto cleanup;
+    if(!node->type) {
+        retval = setType_backend_file(node, type);
+        if(retval != UA_STATUSCODE_GOOD)
+            goto cleanup;
+        retval = UA_STATUSCODE_BADDECODINGERROR;
+    }
+    if(header.recordSize != node->recordSize)
+        goto cleanup;
+
+    memset(seg, 0, sizeof(UA_FileSegment));
+    seg->start = start;
+    seg->count = ((size_t)st.st_size - sizeof(UA_FileSegmentHeader)) / node->recordSize;
+    if(seg->count > 0) {
+        off_t offset = (off_t)(sizeof(UA_FileSegmentHeader) +
+                               ((seg->count - 1) * node->recordSize));
+        if(pread(fd, &seg->last, sizeof(UA_DateTime), offset) != (ssize_t)sizeof(UA_DateTime))
+            goto cleanup;
+    }
+    retval = UA_STATUSCODE_GOOD;
+
+ cleanup:
+    close(fd);
+    return retval;
+}
+
+/* Invalid files are skipped */
+static UA_StatusCode
+loadSegments_backend_file(const UA_FileStoreContext *ctx, UA_FileNode *node) {
+    DIR *dir = opendir(node->path);
+    if(!dir)
+        return UA_STATUSCODE_GOOD;
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    struct dirent *entry;
+    while((entry = readdir(dir))) {
+        char *end = NULL;
+        unsigned long long start = strtoull(entry->d_name, &end, 16);
+        if(end != &entry->d_name[16] || strcmp(end, ".seg") != 0)
+            continue;
+
+        UA_FileSegment seg;
+        if(loadSegment_backend_file(ctx, node, (UA_DateTime)start, &seg) != UA_STATUSCODE_GOOD)
+            continue;
+        UA_FileSegment *segments = (UA_FileSegment*)
+            UA_realloc(node->segments, (node->segmentsSize + 1) * sizeof(UA_FileSegment));
+        if(!segments) {
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        node->segments = segments;
+        node->segments[node->segmentsSize] = seg;
+        node->segmentsSize++;
+    }
+    closedir(dir);
+
+    if(node->segmentsSize > 0)
+        qsort(node->segments, node->segmentsSize, sizeof(UA_FileSegment),
+              compareSegments_backend_file);
+    updateFirst_backend_file(node, 0);
+    return retval;
+}
+
+static UA_StatusCode
+loadNodes_backend_file(UA_FileStoreContext *ctx) {
+    DIR *dir = opendir(ctx->directory);
+    if(!dir)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    struct dirent *entry;
+    while((entry = readdir(dir))) {
+        /* The NodeId of a hashed directory name is read from the name file */
+        UA_NodeId nodeId;
+        UA_StatusCode res;
+        if(strncmp(entry->d_name, "h-", 2) == 0) {
+            char *path = joinPath_backend_file(ctx->directory, entry->d_name);
+            char *name = (path) ? readNodeName_backend_file(path) : NULL;
+            res = (name) ? parseNodeId_backend_file(name, &nodeId) :
+                UA_STATUSCODE_BADDECODINGERROR;
+            UA_free(name);
+            UA_free(path);
+        } else {
+            res = parseNodeId_backend_file(entry->d_name, &nodeId);
+        }
+        if(res != UA_STATUSCODE_GOOD)
+            continue;
+        UA_FileNode *node = NULL;
+        retval = addNode_backend_file(ctx, &nodeId, entry->d_name, &node);
+        UA_NodeId_clear(&nodeId);
+        if(retval == UA_STATUSCODE_GOOD)
+            retval = loadSegments_backend_file(ctx, node);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+    }
+    closedir(dir);
+    return retval;
+}
+
+/*************/
+/* Searching */
+/*************/
+
+static UA_StatusCode
+updateSparseIndex_backend_file(const UA_FileNode *node, UA_FileSegment *seg) {
+    size_t stride = node->sparseStride;
+    size_t needed = (seg->count + stride - 1) / stride;
+    if(seg->sparseSize >= needed)
+        return UA_STATUSCODE_GOOD;
+    UA_StatusCode retval = mapSegment_backend_file(node, seg);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_DateTime *sparse = (UA_DateTime*)
+        UA_realloc(seg->sparse, needed * sizeof(UA_DateTime));
+    if(!sparse)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = seg->sparseSize; i < needed; i++)
+        sparse[i] = recordAt_backend_file(node, seg, i * stride)->timestamp;
+    seg->sparse = sparse;
+    seg->sparseSize = needed;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The index of the first record in the segment that is not earlier than the
+ * timestamp. The sparse index selects the page to search. */
+static size_t
+segmentLowerBound_backend_file(const UA_FileNode *node, UA_FileSegment *seg,
+                               UA_DateTime timestamp) {
+    if(updateSparseIndex_backend_file(node, seg) != UA_STATUSCODE_GOOD)
+        return seg->count;
+    size_t min = 0;
+    size_t max = seg->sparseSize;
+    while(min < max) {
+        size_t mid = min + ((max - min) / 2);
+        if(seg->sparse[mid] < timestamp)
+            min = mid + 1;
+        else
+            max = mid;
+    }
+
+    /* The result is in (begin, end] */
+    size_t begin = (min > 0) ? (min - 1) * node->sparseStride : 0;
+    size_t end = min * node->sparseStride;
+    if(end > seg->count)
+        end = seg->count;
+    while(begin < end) {
+        size_t mid = begin + ((end - begin) / 2);
+        if(recordAt_backend_file(node, seg, mid)->timestamp < timestamp)
+            begin = mid + 1;
+        else
+            end = mid;
+    }
+    return begin;
+}
+
+/* The index of the first record that is not earlier than the timestamp. The
+ * records of a segment are earlier than the start of the next segment. */
+static size_t
+lowerBound_backend_file(const UA_FileNode *node, UA_DateTime timestamp) {
+    size_t min = 0;
+    size_t max = node->segmentsSize;
+    while(min < max) {
+        size_t mid = min + ((max - min) / 2);
+        if(node->segments[mid].start <= timestamp)
+            min = mid + 1;
+        else
+            max = mid;
+    }
+    if(min == 0)
+        return 0;
+    UA_FileSegment *seg = &node->segments[min - 1];
+    return seg->first + segmentLowerBound_backend_file(node, seg, timestamp);
+}
+
+static UA_FileSegment *
+segmentOfIndex_backend_file(const UA_FileNode *node, size_t index) {
+    size_t min = 0;
+    size_t max = node->segmentsSize;
+    while(min < max) {
+        size_t mid = min + ((max - min) / 2);
+        if(node->segments[mid].first + node->segments[mid].count <= index)
+            min = mid + 1;
+        else
+            max = mid;
+    }
+    return (min < node->segmentsSize) ? &node->segments[min] : NULL;
+}
+
+static const UA_FileRecord *
+getRecord_backend_file(const UA_FileNode *node, size_t index) {
+    UA_FileSegment *seg = segmentOfIndex_backend_file(node, index);
+    if(!seg || mapSegment_backend_file(node, seg) != UA_STATUSCODE_GOOD)
+        return NULL;
+    return recordAt_backend_file(node, seg, index - seg->first);
+}
+
+/* Returns true if the timestamp was found. The index points to the first
+ * record that is not earlier than the timestamp (or to the end). */
+static UA_Boolean
+binarySearch_backend_file(const UA_FileNode *node, const UA_DateTime timestamp,
+                          size_t *index) {
+    *index = lowerBound_backend_file(node, timestamp);
+    if(*index >= node->count)
+        return false;
+    const UA_FileRecord *record = getRecord_backend_file(node, *index);
+    return (record && record->timestamp == timestamp);
+}
+
+/* The DataValue points into the mapped segment and must not be cleared */
+static void
+readRecord_backend_file(const UA_FileNode *node, const UA_FileRecord *record,
+                        UA_DataValue *dv) {
+    UA_DataValue_init(dv);
+    if(record->flags & HDB_FILE_HASVALUE) {
+        UA_Variant_setScalar(&dv->value, (void*)(uintptr_t)&record[1], node->type);
+        dv->value.storageType = UA_VARIANT_DATA_NODELETE;
+        dv->hasValue = true;
+    }
+    if(record->flags & HDB_FILE_HASSTATUS) {
+        dv->status = record->status;
+        dv->hasStatus = true;
+    }
+    if(record->flags & HDB_FILE_HASSOURCETIMESTAMP) {
+        dv->sourceTimestamp = record->timestamp;
+        dv->hasSourceTimestamp = true;
+    }
+    if(record->flags & HDB_FILE_HASSERVERTIMESTAMP) {
+        dv->serverTimestamp = record->serverTimestamp;
+        dv->hasServerTimestamp = true;
+    }
+}
+
+/***********/
+/* Writing */
+/***********/
+
+static UA_StatusCode
+writeRecord_backend_file(UA_FileNode *node, const UA_FileSegment *seg, size_t index,
+                         UA_DateTime timestamp, const UA_DataValue *value) {
+    memset(node->record, 0, node->recordSize);
+    UA_FileRecord *record = (UA_FileRecord*)node->record;
+    record->timestamp = timestamp;
+    record->serverTimestamp = value->serverTimestamp;
+    record->status = value->status;
+    if(value->hasValue) {
+        memcpy(&record[1], value->value.data, node->type->memSize);
+        record->flags |= HDB_FILE_HASVALUE;
+    }
+    if(value->hasStatus)
+        record->flags |= HDB_FILE_HASSTATUS;
+    if(value->hasSourceTimestamp)
+        record->flags |= HDB_FILE_HASSOURCETIMESTAMP;
+    if(value->hasServerTimestamp)
+        record->flags |= HDB_FILE_HASSERVERTIMESTAMP;
+
+    int fd = segmentFd_backend_file(node, seg);
+    if(fd < 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    off_t offset = (off_t)(sizeof(UA_FileSegmentHeader) + (index * node->recordSize));
+    if(pwrite(fd, node->record, node->recordSize, offset) != (ssize_t)node->recordSize)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+createSegment_backend_file(const UA_FileStoreContext *ctx, UA_FileNode *node,
+                           size_t pos, UA_DateTime start) {
+    UA_FileSegment *segments = (UA_FileSegment*)
+        UA_realloc(node->segments, (node->segmentsSize + 1) * sizeof(UA_FileSegment));
+    if(!segments)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    node->segments = segments;
+
+    char *path = segmentPath_backend_file(node, start);
+    if(!path)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    if(node->segmentsSize == 0)
+        mkdir(node->path, 0755); /* Fails if the directory exists */
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    UA_free(path);
+    if(fd < 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_FileSegmentHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = HDB_FILE_MAGIC;
+    header.version = HDB_FILE_VERSION;
+    header.recordSize = (UA_UInt32)node->recordSize;
+    header.typeIdentifier = node->type->typeId.identifier.numeric;
+    header.typeNamespace = node->type->typeId.namespaceIndex;
+    header.segmentStart = start;
+    header.segmentDuration = ctx->segmentDuration;
+    if(pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        close(fd);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Keep the new segment open for the following appends */
+    if(node->fd >= 0)
+        close(node->fd);
+    node->fd = fd;
+    node->fdStart = start;
+
+    memmove(&node->segments[pos + 1], &node->segments[pos],
+            (node->segmentsSize - pos) * sizeof(UA_FileSegment));
+    memset(&node->segments[pos], 0, sizeof(UA_FileSegment));
+    node->segments[pos].start = start;
+    node->segmentsSize++;
+    updateFirst_backend_file(node, pos);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Append the sample to the segment of its time partition. Appending to the
+ * latest segment is O(1). */
+static UA_StatusCode
+appendSample_backend_file(const UA_FileStoreContext *ctx, UA_FileNode *node,
+                          UA_DateTime timestamp, const UA_DataValue *value) {
+    UA_DateTime start = partitionStart_backend_file(ctx, timestamp);
+    size_t pos = node->segmentsSize;
+    if(pos == 0 || node->segments[pos - 1].start != start) {
+        size_t min = 0;
+        size_t max = node->segmentsSize;
+        while(min < max) {
+            size_t mid = min + ((max - min) / 2);
+            if(node->segments[mid].start < start)
+                min = mid + 1;
+            else
+                max = mid;
+        }
+        pos = min;
+        if(pos == node->segmentsSize || node->segments[pos].start != start) {
+            UA_StatusCode retval = createSegment_backend_file(ctx, node, pos, start);
+            if(retval != UA_STATUSCODE_GOOD)
+                return retval;
+        }
+    } else {
+        pos--;
+    }
+
+    /* The segment files are append-only */
+    UA_FileSegment *seg = &node->segments[pos];
+    if(seg->count > 0 && timestamp < seg->last)
+        return UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED;
+    UA_StatusCode retval = writeRecord_backend_file(node, seg, seg->count, timestamp, value);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    seg->count++;
+    seg->last = timestamp;
+    if(pos + 1 < node->segmentsSize)
+        updateFirst_backend_file(node, pos + 1);
+    else
+        node->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_DateTime
+sampleTimestamp_backend_file(const UA_DataValue *value) {
+    if(value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    if(value->hasServerTimestamp)
+        return value->serverTimestamp;
+    return UA_DateTime_now();
+}
+
+/*******************/
+/* Backend Methods */
+/*******************/
+
+static size_t
+resultSize_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId,
+                        size_t startIndex,
+                        size_t endIndex) {
+    const UA_FileNode *node = getNode_backend_file(context, nodeId);
+    if(node->count == 0 || startIndex == node->count || endIndex == node->count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getDateTimeMatch_backend_file(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              const UA_DateTime timestamp,
+                              const MatchStrategy strategy) {
+    const UA_FileNode *node = getNode_backend_file(context, nodeId);
+    size_t current;
+    UA_Boolean found = binarySearch_backend_file(node, timestamp, &current);
+
+    if((strategy == MATCH_EQUAL ||
+        strategy == MATCH_EQUAL_OR_AFTER ||
+        strategy == MATCH_EQUAL_OR_BEFORE) && found)
+        return current;
+    switch(strategy) {
+    case MATCH_AFTER:
+        if(found)
+            return current + 1;
+        return current;
+    case MATCH_EQUAL_OR_AFTER:
+        return current;
+    case MATCH_EQUAL_OR_BEFORE:
+        /* found == true is handled before. Fall through otherwise. */
+    case MATCH_BEFORE:
+        if(current > 0)
+            return current - 1;
+        return node->count;
+    default:
+        break;
+    }
+    return node->count;
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_file(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  UA_Boolean historizing,
+                                  const UA_DataValue *value) {
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)context;
+    UA_FileNode *node = NULL;
+    UA_StatusCode retval = getNodeForValue_backend_file(ctx, nodeId, value, &node);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    return appendSample_backend_file(ctx, node, sampleTimestamp_backend_file(value), value);
+}
+
+static size_t
+getEnd_backend_file(UA_Server *server,
+                    void *context,
+                    const UA_NodeId *sessionId,
+                    void *sessionContext,
+                    const UA_NodeId *nodeId) {
+    return getNode_backend_file(context, nodeId)->count;
+}
+
+static size_t
+lastIndex_backend_file(UA_Server *server,
+                       void *context,
+                       const UA_NodeId *sessionId,
+                       void *sessionContext,
+                       const UA_NodeId *nodeId) {
+    const UA_FileNode *node = getNode_backend_file(context, nodeId);
+    if(node->count == 0)
+        return 0;
+    return node->count - 1;
+}
+
+static size_t
+firstIndex_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static UA_Boolean
+boundSupported_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_file(UA_Server *server,
+                                         void *context,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         const UA_TimestampsToReturn timestampsToReturn) {
+    const UA_FileNode *node = getNode_backend_file(context, nodeId);
+    if(node->count == 0)
+        return true;
+    const UA_FileRecord *record = getRecord_backend_file(node, 0);
+    if(!record)
+        return false;
+    UA_Boolean hasSource = (record->flags & HDB_FILE_HASSOURCETIMESTAMP) != 0;
+    UA_Boolean hasServer = (record->flags & HDB_FILE_HASSERVERTIMESTAMP) != 0;
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_INVALID ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER && !hasServer) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE && !hasSource) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH && !(hasSource && hasServer)))
+        return false;
+    return true;
+}
+
+static const UA_DataValue*
+getDataValue_backend_file(UA_Server *server,
+                          void *context,
+                          const UA_NodeId *sessionId,
+                          void *sessionContext,
+                          const UA_NodeId *nodeId,
+                          size_t index) {
+    UA_FileNode *node = findNode_backend_file((UA_FileStoreContext*)context, nodeId);
+    if(!node)
+        return NULL;
+    const UA_FileRecord *record = getRecord_backend_file(node, index);
+    if(!record)
+        return NULL;
+    readRecord_backend_file(node, record, &node->current);
+    return &node->current;
+}
+
+static UA_StatusCode
+copyRecord_backend_file(const UA_FileNode *node, size_t index,
+                        const UA_NumericRange range, UA_DataValue *dst) {
+    const UA_FileRecord *record = getRecord_backend_file(node, index);
+    if(!record)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_DataValue sample;
+    readRecord_backend_file(node, record, &sample);
+    if(range.dimensionsSize == 0)
+        return UA_DataValue_copy(&sample, dst);
+    memcpy(dst, &sample, sizeof(UA_DataValue));
+    UA_Variant_init(&dst->value);
+    dst->hasValue = false;
+    if(sample.hasValue &&
+       UA_Variant_copyRange(&sample.value, &dst->value, range) == UA_STATUSCODE_GOOD)
+        dst->hasValue = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+copyDataValues_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId,
+                            size_t startIndex,
+                            size_t endIndex,
+                            UA_Boolean reverse,
+                            size_t maxValues,
+                            UA_NumericRange range,
+                            UA_Boolean releaseContinuationPoints,
+                            const UA_ByteString *continuationPoint,
+                            UA_ByteString *outContinuationPoint,
+                            size_t *providedValues,
+                            UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        skip = *((size_t*)(continuationPoint->data));
+    }
+    const UA_FileNode *node = getNode_backend_file(context, nodeId);
+    size_t index = startIndex;
+    size_t counter = 0;
+    size_t skippedValues = 0;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(reverse) {
+        while(index >= endIndex && index < node->count && counter < maxValues) {
+            if(skippedValues++ >= skip) {
+                retval = copyRecord_backend_file(node, index, range, &values[counter]);
+                if(retval != UA_STATUSCODE_GOOD)
+                    return retval;
+                ++counter;
+            }
+            --index;
+        }
+    } else {
+        while(index <= endIndex && index < node->count && counter < maxValues) {
+            if(skippedValues++ >= skip) {
+                retval = copyRecord_backend_file(node, index, range, &values[counter]);
+                if(retval != UA_STATUSCODE_GOOD)
+                    return retval;
+                ++counter;
+            }
+            ++index;
+        }
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if((!reverse && (endIndex - startIndex - skip + 1) > counter) ||
+       (reverse && (startIndex - endIndex - skip + 1) > counter)) {
+        outContinuationPoint->data = (UA_Byte*)UA_malloc(sizeof(size_t));
+        if(!outContinuationPoint->data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        outContinuationPoint->length = sizeof(size_t);
+        *((size_t*)(outContinuationPoint->data)) = skip + counter;
+    }
+
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+insertDataValue_backend_file(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)hdbContext;
+    UA_FileNode *node = NULL;
+    UA_StatusCode retval = getNodeForValue_backend_file(ctx, nodeId, value, &node);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    UA_DateTime timestamp = sampleTimestamp_backend_file(value);
+    size_t index;
+    if(binarySearch_backend_file(node, timestamp, &index))
+        return UA_STATUSCODE_BADENTRYEXISTS;
+    return appendSample_backend_file(ctx, node, timestamp, value);
+}
+
+static UA_StatusCode
+replaceDataValue_backend_file(UA_Server *server,
+                              void *hdbContext,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    UA_FileNode *node = findNode_backend_file((UA_FileStoreContext*)hdbContext, nodeId);
+    UA_DateTime timestamp = sampleTimestamp_backend_file(value);
+    size_t index;
+    if(!node || !binarySearch_backend_file(node, timestamp, &index))
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+    UA_StatusCode retval = checkValue_backend_file(node, value);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Overwrite the record in place */
+    UA_FileSegment *seg = segmentOfIndex_backend_file(node, index);
+    return writeRecord_backend_file(node, seg, index - seg->first, timestamp, value);
+}
+
+static UA_StatusCode
+updateDataValue_backend_file(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             const UA_DataValue *value) {
+    UA_StatusCode ret = replaceDataValue_backend_file(server, hdbContext, sessionId,
+                                                      sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYREPLACED;
+    if(ret != UA_STATUSCODE_BADNOENTRYEXISTS)
+        return ret;
+
+    ret = insertDataValue_backend_file(server, hdbContext, sessionId,
+                                       sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYINSERTED;
+    return ret;
+}
+
+static UA_StatusCode
+removeDataValue_backend_file(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             UA_DateTime startTimestamp,
+                             UA_DateTime endTimestamp) {
+    if(startTimestamp > endTimestamp)
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+    UA_FileNode *node = findNode_backend_file((UA_FileStoreContext*)hdbContext, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADNODATA;
+
+    /* Remove the records in [index1, index2). The end timestamp is excluded
+     * unless it equals the start timestamp. */
+    size_t index1;
+    size_t index2;
+    if(startTimestamp == endTimestamp) {
+        if(!binarySearch_backend_file(node, startTimestamp, &index1))
+            return UA_STATUSCODE_BADNODATA;
+        index2 = index1 + 1;
+    } else {
+        index1 = lowerBound_backend_file(node, startTimestamp);
+        index2 = lowerBound_backend_file(node, endTimestamp);
+        if(index1 >= index2)
+            return UA_STATUSCODE_BADNODATA;
+    }
+
+    /* The segment files are append-only. Only entire segments are removed. */
+    size_t from = node->segmentsSize;
+    size_t to = 0;
+    for(size_t i = 0; i < node->segmentsSize; i++) {
+        const UA_FileSegment *seg = &node->segments[i];
+        if(seg->count == 0 || seg->first + seg->count <= index1 || seg->first >= index2)
+            continue;
+        if(seg->first < index1 || seg->first + seg->count > index2)
+            return UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED;
+        if(from > i)
+            from = i;
+        to = i + 1;
+    }
+    if(from >= to)
+        return UA_STATUSCODE_BADNODATA;
+
+    for(size_t i = from; i < to; i++) {
+        UA_FileSegment *seg = &node->segments[i];
+        if(node->fd >= 0 && node->fdStart == seg->start) {
+            close(node->fd);
+            node->fd = -1;
+        }
+        char *path = segmentPath_backend_file(node, seg->start);
+        if(path)
+            unlink(path);
+        UA_free(path);
+        UA_FileSegment_clear(node, seg);
+    }
+    memmove(&node->segments[from], &node->segments[to],
+            (node->segmentsSize - to) * sizeof(UA_FileSegment));
+    node->segmentsSize -= to - from;
+    updateFirst_backend_file(node, from);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deleteMembers_backend_file(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    UA_FileStoreContext_deleteMembers((UA_FileStoreContext*)backend->context);
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_File(const char *directory, UA_DateTime segmentDuration) {
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    if(!directory || segmentDuration <= 0)
+        return result;
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)
+        UA_calloc(1, sizeof(UA_FileStoreContext));
+    if(!ctx)
+        return result;
+    size_t directoryLength = strlen(directory);
+    ctx->directory = (char*)UA_malloc(directoryLength + 1);
+    ctx->buckets = (UA_FileNode**)UA_calloc(HDB_FILE_INITIAL_BUCKETS, sizeof(UA_FileNode*));
+    if(!ctx->directory || !ctx->buckets) {
+        UA_free(ctx->directory);
+        UA_free(ctx->buckets);
+        UA_free(ctx);
+        return result;
+    }
+    memcpy(ctx->directory, directory, directoryLength + 1);
+    ctx->bucketsSize = HDB_FILE_INITIAL_BUCKETS;
+    ctx->segmentDuration = segmentDuration;
+
+    /* Load the history from previous runs */
+    if(mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        UA_FileStoreContext_deleteMembers(ctx);
+        UA_free(ctx);
+        return result;
+    }
+    if(loadNodes_backend_file(ctx) != UA_STATUSCODE_GOOD) {
+        UA_FileStoreContext_deleteMembers(ctx);
+        UA_free(ctx);
+        return result;
+    }
+
+    result.serverSetHistoryData = &serverSetHistoryData_backend_file;
+    result.resultSize = &resultSize_backend_file;
+    result.getEnd = &getEnd_backend_file;
+    result.lastIndex = &lastIndex_backend_file;
+    result.firstIndex = &firstIndex_backend_file;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_file;
+    result.copyDataValues = &copyDataValues_backend_file;
+    result.getDataValue = &getDataValue_backend_file;
+    result.boundSupported = &boundSupported_backend_file;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_file;
+    result.insertDataValue = &insertDataValue_backend_file;
+    result.updateDataValue = &updateDataValue_backend_file;
+    result.replaceDataValue = &replaceDataValue_backend_file;
+    result.removeDataValue = &removeDataValue_backend_file;
+    result.deleteMembers = &deleteMembers_backend_file;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+}
+
+void
+UA_HistoryDataBackend_File_deleteMembers(UA_HistoryDataBackend *backend) {
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)backend->context;
+    if(ctx) {
+        UA_FileStoreContext_deleteMembers(ctx);
+        UA_free(ctx);
+    }
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
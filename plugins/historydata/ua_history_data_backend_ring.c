@@ -0,0 +1,656 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_ring.h>
+
+#include <string.h>
+
+#define RING_HASVALUE           0x01
+#define RING_HASSTATUS          0x02
+#define RING_HASSOURCETIMESTAMP 0x04
+#define RING_HASSERVERTIMESTAMP 0x08
+
+/* Round up to a multiple of eight bytes to keep the columns aligned */
+#define RING_ALIGN(size) (((size) + 7) & ~(size_t)7)
+
+typedef struct UA_RingNode {
+    struct UA_RingNode *next; /* Next node in the same hash bucket */
+    UA_NodeId nodeId;
+    const UA_DataType *type;  /* Fixed by the first sample */
+
+    /* The samples are ordered by timestamp. The logical index i is stored in
+     * the slot (head + i) % capacity. */
+    size_t capacity;
+    size_t head;
+    size_t count;
+
+    /* The columns share one allocation that starts with the timestamps */
+    UA_DateTime *timestamps; /* Source timestamp or the fallback */
+    UA_DateTime *serverTimestamps;
+    UA_Byte *values;         /* capacity * type->memSize */
+    UA_StatusCode *statusCodes;
+    UA_Byte *flags;
+
+    /* Returned from getDataValue. Points into the value column. */
+    UA_DataValue current;
+} UA_RingNode;
+
+typedef struct {
+    UA_RingNode *nodes;    /* Preallocated for maxNodes */
+    size_t nodesSize;
+    size_t maxNodes;
+    size_t nodeBytes;      /* Memory budget of the columns of one node */
+    UA_RingNode **buckets; /* Hash index of the nodes */
+    size_t bucketsSize;    /* Power of two */
+} UA_RingStoreContext;
+
+/* Unknown nodes have an empty history */
+static const UA_RingNode emptyNode_backend_ring = {0};
+
+static void
+UA_RingStoreContext_deleteMembers(UA_RingStoreContext *ctx) {
+    for(size_t i = 0; i < ctx->nodesSize; i++) {
+        UA_NodeId_deleteMembers(&ctx->nodes[i].nodeId);
+        UA_free(ctx->nodes[i].timestamps);
+    }
+    UA_free(ctx->nodes);
+    UA_free(ctx->buckets);
+    memset(ctx, 0, sizeof(UA_RingStoreContext));
+}
+
+static size_t
+slot_backend_ring(const UA_RingNode *node, size_t index) {
+    size_t slot = node->head + index;
+    if(slot >= node->capacity)
+        slot -= node->capacity;
+    return slot;
+}
+
+static UA_RingNode *
+findNode_backend_ring(const UA_RingStoreContext *ctx, const UA_NodeId *nodeId) {
+    if(ctx->bucketsSize == 0)
+        return NULL;
+    UA_RingNode *node = ctx->buckets[UA_NodeId_hash(nodeId) & (ctx->bucketsSize - 1)];
+    for(; node; node = node->next) {
+        if(UA_NodeId_equal(&node->nodeId, nodeId))
+            return node;
+    }
+    return NULL;
+}
+
+static const UA_RingNode *
+getNode_backend_ring(void *context, const UA_NodeId *nodeId) {
+    const UA_RingNode *node = findNode_backend_ring((UA_RingStoreContext*)context, nodeId);
+    return (node) ? node : &emptyNode_backend_ring;
+}
+
+/* Only scalars without pointers fit into the value column */
+static UA_StatusCode
+checkValue_backend_ring(const UA_RingNode *node, const UA_DataValue *value) {
+    if(!value->hasValue)
+        return UA_STATUSCODE_GOOD;
+    if(!value->value.type || !UA_Variant_isScalar(&value->value) ||
+       !value->value.type->pointerFree)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    if(node && node->type != value->value.type)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+addNode_backend_ring(UA_RingStoreContext *ctx, const UA_NodeId *nodeId,
+                     const UA_DataType *type, UA_RingNode **outNode) {
+    if(ctx->nodesSize >= ctx->maxNodes)
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+
+    /* Fit as many samples into the memory budget as possible */
+    size_t sampleSize = 2 * sizeof(UA_DateTime) + type->memSize +
+        sizeof(UA_StatusCode) + sizeof(UA_Byte);
+    size_t capacity = ctx->nodeBytes / sampleSize;
+    if(capacity == 0)
+        capacity = 1;
+    size_t timestampsSize = RING_ALIGN(capacity * sizeof(UA_DateTime));
+    size_t valuesSize = RING_ALIGN(capacity * type->memSize);
+    size_t statusCodesSize = RING_ALIGN(capacity * sizeof(UA_StatusCode));
+    UA_Byte *block = (UA_Byte*)
+        UA_malloc((2 * timestampsSize) + valuesSize + statusCodesSize + capacity);
+    if(!block)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_RingNode *node = &ctx->nodes[ctx->nodesSize];
+    UA_StatusCode retval = UA_NodeId_copy(nodeId, &node->nodeId);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_free(block);
+        return retval;
+    }
+    node->type = type;
+    node->capacity = capacity;
+    node->head = 0;
+    node->count = 0;
+    node->timestamps = (UA_DateTime*)block;
+    node->serverTimestamps = (UA_DateTime*)(block + timestampsSize);
+    node->values = block + (2 * timestampsSize);
+    node->statusCodes = (UA_StatusCode*)(block + (2 * timestampsSize) + valuesSize);
+    node->flags = block + (2 * timestampsSize) + valuesSize + statusCodesSize;
+
+    UA_RingNode **bucket = &ctx->buckets[UA_NodeId_hash(nodeId) & (ctx->bucketsSize - 1)];
+    node->next = *bucket;
+    *bucket = node;
+    ctx->nodesSize++;
+    *outNode = node;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Get the node for storing the value. Creates the node if required. */
+static UA_StatusCode
+getNodeForValue_backend_ring(UA_RingStoreContext *ctx, const UA_NodeId *nodeId,
+                             const UA_DataValue *value, UA_RingNode **outNode) {
+    UA_RingNode *node = findNode_backend_ring(ctx, nodeId);
+    UA_StatusCode retval = checkValue_backend_ring(node, value);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if(node) {
+        *outNode = node;
+        return UA_STATUSCODE_GOOD;
+    }
+    /* The first sample of a node needs a value to set the type */
+    if(!value->hasValue)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    return addNode_backend_ring(ctx, nodeId, value->value.type, outNode);
+}
+
+/* Returns true if the timestamp was found. The index points to the first
+ * sample that is not earlier than the timestamp (or to the end). */
+static UA_Boolean
+binarySearch_backend_ring(const UA_RingNode *node, const UA_DateTime timestamp,
+                          size_t *index) {
+    size_t min = 0;
+    size_t max = node->count;
+    while(min < max) {
+        size_t mid = min + ((max - min) / 2);
+        if(node->timestamps[slot_backend_ring(node, mid)] < timestamp)
+            min = mid + 1;
+        else
+            max = mid;
+    }
+    *index = min;
+    return (min < node->count &&
+            node->timestamps[slot_backend_ring(node, min)] == timestamp);
+}
+
+static void
+writeSample_backend_ring(UA_RingNode *node, size_t slot, UA_DateTime timestamp,
+                         const UA_DataValue *value) {
+    UA_Byte flags = 0;
+    if(value->hasValue) {
+        memcpy(&node->values[slot * node->type->memSize],
+               value->value.data, node->type->memSize);
+        flags |= RING_HASVALUE;
+    }
+    if(value->hasStatus)
+        flags |= RING_HASSTATUS;
+    if(value->hasSourceTimestamp)
+        flags |= RING_HASSOURCETIMESTAMP;
+    if(value->hasServerTimestamp)
+        flags |= RING_HASSERVERTIMESTAMP;
+    node->timestamps[slot] = timestamp;
+    node->serverTimestamps[slot] = value->serverTimestamp;
+    node->statusCodes[slot] = value->status;
+    node->flags[slot] = flags;
+}
+
+static void
+moveSample_backend_ring(UA_RingNode *node, size_t dst, size_t src) {
+    size_t memSize = node->type->memSize;
+    memcpy(&node->values[dst * memSize], &node->values[src * memSize], memSize);
+    node->timestamps[dst] = node->timestamps[src];
+    node->serverTimestamps[dst] = node->serverTimestamps[src];
+    node->statusCodes[dst] = node->statusCodes[src];
+    node->flags[dst] = node->flags[src];
+}
+
+/* The DataValue points into the value column and must not be cleared */
+static void
+readSample_backend_ring(const UA_RingNode *node, size_t slot, UA_DataValue *dv) {
+    UA_DataValue_init(dv);
+    UA_Byte flags = node->flags[slot];
+    if(flags & RING_HASVALUE) {
+        UA_Variant_setScalar(&dv->value, &node->values[slot * node->type->memSize],
+                             node->type);
+        dv->value.storageType = UA_VARIANT_DATA_NODELETE;
+        dv->hasValue = true;
+    }
+    if(flags & RING_HASSTATUS) {
+        dv->status = node->statusCodes[slot];
+        dv->hasStatus = true;
+    }
+    if(flags & RING_HASSOURCETIMESTAMP) {
+        dv->sourceTimestamp = node->timestamps[slot];
+        dv->hasSourceTimestamp = true;
+    }
+    if(flags & RING_HASSERVERTIMESTAMP) {
+        dv->serverTimestamp = node->serverTimestamps[slot];
+        dv->hasServerTimestamp = true;
+    }
+}
+
+/* Insert at the logical index. Appending in time order is O(1). A full ring
+ * drops the oldest sample. A sample that is older than all samples in a full
+ * ring is not stored. */
+static UA_StatusCode
+insertSample_backend_ring(UA_RingNode *node, size_t index, UA_DateTime timestamp,
+                          const UA_DataValue *value) {
+    if(node->count == node->capacity) {
+        if(index == 0)
+            return UA_STATUSCODE_BADDATALOST;
+        node->head = slot_backend_ring(node, 1);
+        node->count--;
+        index--;
+    }
+    for(size_t i = node->count; i > index; i--)
+        moveSample_backend_ring(node, slot_backend_ring(node, i),
+                                slot_backend_ring(node, i - 1));
+    writeSample_backend_ring(node, slot_backend_ring(node, index), timestamp, value);
+    node->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static size_t
+resultSize_backend_ring(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId,
+                        size_t startIndex,
+                        size_t endIndex) {
+    const UA_RingNode *node = getNode_backend_ring(context, nodeId);
+    if(node->count == 0 || startIndex == node->count || endIndex == node->count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getDateTimeMatch_backend_ring(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              const UA_DateTime timestamp,
+                              const MatchStrategy strategy) {
+    const UA_RingNode *node = getNode_backend_ring(context, nodeId);
+    size_t current;
+    UA_Boolean found = binarySearch_backend_ring(node, timestamp, &current);
+
+    if((strategy == MATCH_EQUAL ||
+        strategy == MATCH_EQUAL_OR_AFTER ||
+        strategy == MATCH_EQUAL_OR_BEFORE) && found)
+        return current;
+    switch(strategy) {
+    case MATCH_AFTER:
+        if(found)
+            return current + 1;
+        return current;
+    case MATCH_EQUAL_OR_AFTER:
+        return current;
+    case MATCH_EQUAL_OR_BEFORE:
+        /* found == true is handled before. Fall through otherwise. */
+    case MATCH_BEFORE:
+        if(current > 0)
+            return current - 1;
+        return node->count;
+    default:
+        break;
+    }
+    return node->count;
+}
+
+static UA_DateTime
+sampleTimestamp_backend_ring(const UA_DataValue *value) {
+    if(value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    if(value->hasServerTimestamp)
+        return value->serverTimestamp;
+    return UA_DateTime_now();
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_ring(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  UA_Boolean historizing,
+                                  const UA_DataValue *value) {
+    UA_RingNode *node = NULL;
+    UA_StatusCode retval =
+        getNodeForValue_backend_ring((UA_RingStoreContext*)context, nodeId, value, &node);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Samples usually arrive in time order and are appended at the end */
+    UA_DateTime timestamp = sampleTimestamp_backend_ring(value);
+    size_t index = node->count;
+    if(index > 0 && node->timestamps[slot_backend_ring(node, index - 1)] > timestamp)
+        binarySearch_backend_ring(node, timestamp, &index);
+    return insertSample_backend_ring(node, index, timestamp, value);
+}
+
+static size_t
+getEnd_backend_ring(UA_Server *server,
+                    void *context,
+                    const UA_NodeId *sessionId,
+                    void *sessionContext,
+                    const UA_NodeId *nodeId) {
+    return getNode_backend_ring(context, nodeId)->count;
+}
+
+static size_t
+lastIndex_backend_ring(UA_Server *server,
+                       void *context,
+                       const UA_NodeId *sessionId,
+                       void *sessionContext,
+                       const UA_NodeId *nodeId) {
+    const UA_RingNode *node = getNode_backend_ring(context, nodeId);
+    if(node->count == 0)
+        return 0;
+    return node->count - 1;
+}
+
+static size_t
+firstIndex_backend_ring(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static UA_Boolean
+boundSupported_backend_ring(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_ring(UA_Server *server,
+                                         void *context,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         const UA_TimestampsToReturn timestampsToReturn) {
+    const UA_RingNode *node = getNode_backend_ring(context, nodeId);
+    if(node->count == 0)
+        return true;
+    UA_Byte flags = node->flags[node->head];
+    UA_Boolean hasSource = (flags & RING_HASSOURCETIMESTAMP) != 0;
+    UA_Boolean hasServer = (flags & RING_HASSERVERTIMESTAMP) != 0;
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_INVALID ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER && !hasServer) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE && !hasSource) ||
+       (timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH && !(hasSource && hasServer)))
+        return false;
+    return true;
+}
+
+static const UA_DataValue*
+getDataValue_backend_ring(UA_Server *server,
+                          void *context,
+                          const UA_NodeId *sessionId,
+                          void *sessionContext,
+                          const UA_NodeId *nodeId,
+                          size_t index) {
+    UA_RingNode *node = findNode_backend_ring((UA_RingStoreContext*)context, nodeId);
+    if(!node || index >= node->count)
+        return NULL;
+    readSample_backend_ring(node, slot_backend_ring(node, index), &node->current);
+    return &node->current;
+}
+
+static void
+copySample_backend_ring(const UA_RingNode *node, size_t index,
+                        const UA_NumericRange range, UA_DataValue *dst) {
+    UA_DataValue sample;
+    readSample_backend_ring(node, slot_backend_ring(node, index), &sample);
+    if(range.dimensionsSize == 0) {
+        UA_DataValue_copy(&sample, dst);
+        return;
+    }
+    memcpy(dst, &sample, sizeof(UA_DataValue));
+    UA_Variant_init(&dst->value);
+    dst->hasValue = false;
+    if(sample.hasValue &&
+       UA_Variant_copyRange(&sample.value, &dst->value, range) == UA_STATUSCODE_GOOD)
+        dst->hasValue = true;
+}
+
+static UA_StatusCode
+copyDataValues_backend_ring(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId,
+                            size_t startIndex,
+                            size_t endIndex,
+                            UA_Boolean reverse,
+                            size_t maxValues,
+                            UA_NumericRange range,
+                            UA_Boolean releaseContinuationPoints,
+                            const UA_ByteString *continuationPoint,
+                            UA_ByteString *outContinuationPoint,
+                            size_t *providedValues,
+                            UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        skip = *((size_t*)(continuationPoint->data));
+    }
+    const UA_RingNode *node = getNode_backend_ring(context, nodeId);
+    size_t index = startIndex;
+    size_t counter = 0;
+    size_t skippedValues = 0;
+    if(reverse) {
+        while(index >= endIndex && index < node->count && counter < maxValues) {
+            if(skippedValues++ >= skip) {
+                copySample_backend_ring(node, index, range, &values[counter]);
+                ++counter;
+            }
+            --index;
+        }
+    } else {
+        while(index <= endIndex && index < node->count && counter < maxValues) {
+            if(skippedValues++ >= skip) {
+                copySample_backend_ring(node, index, range, &values[counter]);
+                ++counter;
+            }
+            ++index;
+        }
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if((!reverse && (endIndex - startIndex - skip + 1) > counter) ||
+       (reverse && (startIndex - endIndex - skip + 1) > counter)) {
+        outContinuationPoint->data = (UA_Byte*)UA_malloc(sizeof(size_t));
+        if(!outContinuationPoint->data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        outContinuationPoint->length = sizeof(size_t);
+        *((size_t*)(outContinuationPoint->data)) = skip + counter;
+    }
+
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+insertDataValue_backend_ring(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    UA_RingNode *node = NULL;
+    UA_StatusCode retval =
+        getNodeForValue_backend_ring((UA_RingStoreContext*)hdbContext, nodeId, value, &node);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    UA_DateTime timestamp = sampleTimestamp_backend_ring(value);
+    size_t index;
+    if(binarySearch_backend_ring(node, timestamp, &index))
+        return UA_STATUSCODE_BADENTRYEXISTS;
+    return insertSample_backend_ring(node, index, timestamp, value);
+}
+
+static UA_StatusCode
+replaceDataValue_backend_ring(UA_Server *server,
+                              void *hdbContext,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    UA_RingNode *node = findNode_backend_ring((UA_RingStoreContext*)hdbContext, nodeId);
+    UA_DateTime timestamp = sampleTimestamp_backend_ring(value);
+    size_t index;
+    if(!node || !binarySearch_backend_ring(node, timestamp, &index))
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+    UA_StatusCode retval = checkValue_backend_ring(node, value);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    writeSample_backend_ring(node, slot_backend_ring(node, index), timestamp, value);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+updateDataValue_backend_ring(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             const UA_DataValue *value) {
+    UA_StatusCode ret = replaceDataValue_backend_ring(server, hdbContext, sessionId,
+                                                      sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYREPLACED;
+    if(ret != UA_STATUSCODE_BADNOENTRYEXISTS)
+        return ret;
+
+    ret = insertDataValue_backend_ring(server, hdbContext, sessionId,
+                                       sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYINSERTED;
+    return ret;
+}
+
+static UA_StatusCode
+removeDataValue_backend_ring(UA_Server *server,
+                             void *hdbContext,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_NodeId *nodeId,
+                             UA_DateTime startTimestamp,
+                             UA_DateTime endTimestamp) {
+    if(startTimestamp > endTimestamp)
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+    UA_RingNode *node = findNode_backend_ring((UA_RingStoreContext*)hdbContext, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADNODATA;
+
+    /* Remove the samples in [index1, index2). The end timestamp is excluded
+     * unless it equals the start timestamp. */
+    size_t index1;
+    size_t index2;
+    if(startTimestamp == endTimestamp) {
+        if(!binarySearch_backend_ring(node, startTimestamp, &index1))
+            return UA_STATUSCODE_BADNODATA;
+        index2 = index1 + 1;
+    } else {
+        binarySearch_backend_ring(node, startTimestamp, &index1);
+        binarySearch_backend_ring(node, endTimestamp, &index2);
+        if(index1 >= index2)
+            return UA_STATUSCODE_BADNODATA;
+    }
+
+    /* Removing from the front only moves the head */
+    size_t removed = index2 - index1;
+    if(index1 == 0) {
+        node->head = slot_backend_ring(node, index2);
+    } else {
+        for(size_t i = index2; i < node->count; i++)
+            moveSample_backend_ring(node, slot_backend_ring(node, i - removed),
+                                    slot_backend_ring(node, i));
+    }
+    node->count -= removed;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deleteMembers_backend_ring(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    UA_RingStoreContext_deleteMembers((UA_RingStoreContext*)backend->context);
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_Ring(size_t maxNodes, size_t maxBytes) {
+    if(maxNodes == 0)
+        maxNodes = 1;
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    UA_RingStoreContext *ctx = (UA_RingStoreContext*)
+        UA_calloc(1, sizeof(UA_RingStoreContext));
+    if(!ctx)
+        return result;
+    size_t bucketsSize = 1;
+    while(bucketsSize < maxNodes)
+        bucketsSize <<= 1;
+    ctx->nodes = (UA_RingNode*)UA_calloc(maxNodes, sizeof(UA_RingNode));
+    ctx->buckets = (UA_RingNode**)UA_calloc(bucketsSize, sizeof(UA_RingNode*));
+    if(!ctx->nodes || !ctx->buckets) {
+        UA_free(ctx->nodes);
+        UA_free(ctx->buckets);
+        UA_free(ctx);
+        return result;
+    }
+    ctx->maxNodes = maxNodes;
+    ctx->nodeBytes = maxBytes / maxNodes;
+    ctx->bucketsSize = bucketsSize;
+    result.serverSetHistoryData = &serverSetHistoryData_backend_ring;
+    result.resultSize = &resultSize_backend_ring;
+    result.getEnd = &getEnd_backend_ring;
+    result.lastIndex = &lastIndex_backend_ring;
+    result.firstIndex = &firstIndex_backend_ring;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_ring;
+    result.copyDataValues = &copyDataValues_backend_ring;
+    result.getDataValue = &getDataValue_backend_ring;
+    result.boundSupported = &boundSupported_backend_ring;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_ring;
+    result.insertDataValue = &insertDataValue_backend_ring;
+    result.updateDataValue = &updateDataValue_backend_ring;
+    result.replaceDataValue = &replaceDataValue_backend_ring;
+    result.removeDataValue = &removeDataValue_backend_ring;
+    result.deleteMembers = &deleteMembers_backend_ring;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+}
+
+void
+UA_HistoryDataBackend_Ring_deleteMembers(UA_HistoryDataBackend *backend) {
+    UA_RingStoreContext *ctx = (UA_RingStoreContext*)backend->context;
+    if(ctx) {
+        UA_RingStoreContext_deleteMembers(ctx);
+        UA_free(ctx);
+    }
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
@@ -0,0 +1,41 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_FILE_H_
+#define UA_HISTORYDATABACKEND_FILE_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+/* The file backend stores the history in a directory that persists across
+ * restarts of the server. Every node gets a subdirectory. The samples of a
+ * node are appended to segment files that each cover segmentDuration of
+ * source time. The segments are read via mmap and searched with a sparse
+ * timestamp index. So only the pages that are actually read are loaded. The
+ * existing segments are loaded when the backend is created.
+ *
+ * Only scalar values of the standard types without pointers (numbers,
+ * DateTime, Guid, ...) can be stored. The first sample of a node fixes the
+ * value type. The picoseconds of the timestamps are not stored. The files use
+ * the byte order of the host.
+ *
+ * The segment files are append-only. A sample can only be added at the end of
+ * its segment. Entries can be replaced. Deletions must cover entire segments.
+ * The segment duration must not change for an existing directory. Segments
+ * with a different duration are ignored.
+ *
+ * The data is written to the files without fsync. It survives a restart of
+ * the process, but not necessarily a crash of the operating system. */
+
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_File(const char *directory, UA_DateTime segmentDuration);
+
+void UA_EXPORT
+UA_HistoryDataBackend_File_deleteMembers(UA_HistoryDataBackend *backend);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_FILE_H_ */
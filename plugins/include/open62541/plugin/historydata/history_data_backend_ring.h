@@ -0,0 +1,30 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_RING_H_
+#define UA_HISTORYDATABACKEND_RING_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+/* The ring backend stores the history of up to maxNodes nodes in fixed-size
+ * ring buffers. Every node gets an equal share of maxBytes. When a ring is
+ * full, the oldest sample is overwritten. The samples are kept in columns
+ * (timestamps, status codes, values) ordered by the source timestamp.
+ *
+ * Only scalar values of types without pointers (numbers, DateTime, Guid, ...)
+ * can be stored. The first sample of a node fixes the value type. The
+ * picoseconds of the timestamps are not stored. */
+
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_Ring(size_t maxNodes, size_t maxBytes);
+
+void UA_EXPORT
+UA_HistoryDataBackend_Ring_deleteMembers(UA_HistoryDataBackend *backend);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_RING_H_ */
@@ -27,6 +27,17 @@ UA_Nodestore_HashMap(UA_Nodestore *ns);
 UA_EXPORT UA_StatusCode
 UA_Nodestore_ZipTree(UA_Nodestore *ns);
 
+/* The Sharded Nodestore splits the nodes into a fixed number of hash-maps
+ * (shards) according to the NodeId hash. Lookup via getNode/releaseNode takes
+ * no lock and scales with the number of reading threads. Writers lock only the
+ * shard of the edited node. Removed and replaced nodes are freed once no reader
+ * can hold a pointer to them anymore.
+ *
+ * Use this Nodestore for large information models that are accessed from
+ * several threads at once. */
+UA_EXPORT UA_StatusCode
+UA_Nodestore_Sharded(UA_Nodestore *ns);
+
 _UA_END_DECLS
 
 #endif /* UA_NODESTORE_DEFAULT_H_ */
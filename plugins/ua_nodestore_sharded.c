@@ -0,0 +1,652 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+#include <open62541/plugin/nodestore_default.h>
+
+#ifndef container_of
+#define container_of(ptr, type, member) \
+    (type *)((uintptr_t)ptr - offsetof(type,member))
+#endif
+
+/* The sharded Nodestore splits the NodeId space into a fixed number of shards
+ * according to the NodeId hash. Every shard is a hash-map with open addressing
+ * (as in the HashMap Nodestore).
+ *
+ * Writers (insert, replace, remove) lock only the shard of the NodeId. Readers
+ * take no lock. They announce themselves in the shard's reader counter, look up
+ * the entry and increase its refcount. Entries and tables that are removed from
+ * a shard are retired. They are freed only once the reader counter was
+ * observed to be zero after the retirement (so no reader can still hold a
+ * pointer it has not yet refcounted) and the entry refcount is zero. */
+
+#define UA_NODESTORE_SHARDS 64 /* Must be a power of two */
+#define UA_NODESHARD_MINSIZE 16
+#define UA_NODESHARD_TOMBSTONE ((UA_NodeShardEntry*)0x01)
+#define UA_NODESHARD_FIRSTID 50000 /* First identifier for random NodeIds */
+
+typedef struct UA_NodeShardEntry {
+    struct UA_NodeShardEntry *orig; /* the version this is a copy from (or NULL).
+                                     * The copy holds a reference to orig. */
+    struct UA_NodeShardEntry *nextRetired;
+    volatile UA_UInt32 refCount; /* How many consumers have a reference to the node? */
+    UA_UInt32 shard; /* Index of the shard. Set when the entry is inserted. */
+    volatile UA_Boolean deleted; /* Node was removed from the shard and can be
+                                  * deleted when refCount == 0 */
+    UA_Node node;
+} UA_NodeShardEntry;
+
+typedef struct {
+    UA_NodeShardEntry * volatile entry;
+    UA_UInt32 nodeIdHash;
+} UA_NodeShardSlot;
+
+/* The table is replaced as a whole when the shard is resized. Slots in the
+ * current table are edited in-place. */
+typedef struct UA_NodeShardTable {
+    struct UA_NodeShardTable *nextRetired;
+    UA_NodeShardSlot *slots;
+    UA_UInt32 size;
+    UA_UInt32 sizePrimeIndex;
+} UA_NodeShardTable;
+
+typedef struct {
+    /* Accessed by the readers */
+    UA_NodeShardTable * volatile table;
+    volatile size_t readers; /* Readers currently in the lookup */
+
+    /* Accessed by the writers (with the lock taken) */
+    UA_LOCK_TYPE(lock)
+    UA_UInt32 count;
+    UA_NodeShardEntry * volatile retiredEntries;
+    UA_NodeShardTable *retiredTables;
+
+    /* Readers of different shards do not share a cache line */
+    UA_Byte padding[64];
+} UA_NodeShard;
+
+typedef struct {
+    UA_NodeShard shards[UA_NODESTORE_SHARDS];
+    volatile UA_UInt32 nextIdentifier; /* For random NodeIds */
+} UA_NodeShards;
+
+/*********************/
+/* HashMap Utilities */
+/*********************/
+
+/* The size of the hash-map is always a prime number. They are chosen to be
+ * close to the next power of 2. So the size ca. doubles with each prime. */
+static UA_UInt32 const shardPrimes[] = {
+    7,         13,         31,         61,         127,         251,
+    509,       1021,       2039,       4093,       8191,        16381,
+    32749,     65521,      131071,     262139,     524287,      1048573,
+    2097143,   4194301,    8388593,    16777213,   33554393,    67108859,
+    134217689, 268435399,  536870909,  1073741789, 2147483647,  4294967291
+};
+
+static UA_UInt32 shardMod(UA_UInt32 h, UA_UInt32 size) { return h % size; }
+static UA_UInt32 shardMod2(UA_UInt32 h, UA_UInt32 size) { return 1 + (h % (size - 2)); }
+
+static UA_UInt16
+higherShardPrimeIndex(UA_UInt32 n) {
+    UA_UInt16 low  = 0;
+    UA_UInt16 high = (UA_UInt16)(sizeof(shardPrimes) / sizeof(UA_UInt32));
+    while(low != high) {
+        UA_UInt16 mid = (UA_UInt16)(low + ((high - low) / 2));
+        if(n > shardPrimes[mid])
+            low = (UA_UInt16)(mid + 1);
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static UA_NodeShardTable *
+createTable(UA_UInt32 sizePrimeIndex) {
+    UA_UInt32 size = shardPrimes[sizePrimeIndex];
+    UA_NodeShardTable *table = (UA_NodeShardTable*)
+        UA_calloc(1, sizeof(UA_NodeShardTable) + (size * sizeof(UA_NodeShardSlot)));
+    if(!table)
+        return NULL;
+    table->slots = (UA_NodeShardSlot*)&table[1];
+    table->size = size;
+    table->sizePrimeIndex = sizePrimeIndex;
+    return table;
+}
+
+/* Returns an empty slot or null if the nodeid exists or if no empty slot is
+ * found. Only called by writers. */
+static UA_NodeShardSlot *
+findFreeShardSlot(const UA_NodeShardTable *table, const UA_NodeId *nodeid, UA_UInt32 h) {
+    UA_UInt32 size = table->size;
+    UA_UInt64 idx = shardMod(h, size); /* Use 64bit container to avoid overflow  */
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+    UA_UInt32 hash2 = shardMod2(h, size);
+
+    UA_NodeShardSlot *candidate = NULL;
+    do {
+        UA_NodeShardSlot *slot = &table->slots[(UA_UInt32)idx];
+        UA_NodeShardEntry *entry = slot->entry;
+        if(entry > UA_NODESHARD_TOMBSTONE) {
+            /* A Node with the NodeId does already exist */
+            if(slot->nodeIdHash == h &&
+               UA_NodeId_equal(&entry->node.nodeId, nodeid))
+                return NULL;
+        } else {
+            /* Found a candidate node */
+            if(!candidate)
+                candidate = slot;
+            /* No matching node can come afterwards */
+            if(entry == NULL)
+                return candidate;
+        }
+
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx);
+
+    return candidate;
+}
+
+/* Also used by the readers. The slots can be edited concurrently. So the entry
+ * pointer is read only once and returned together with the slot. */
+static UA_NodeShardSlot *
+findOccupiedShardSlot(const UA_NodeShardTable *table, const UA_NodeId *nodeid,
+                      UA_UInt32 h, UA_NodeShardEntry **outEntry) {
+    UA_UInt32 size = table->size;
+    UA_UInt64 idx = shardMod(h, size); /* Use 64bit container to avoid overflow */
+    UA_UInt32 hash2 = shardMod2(h, size);
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+
+    do {
+        UA_NodeShardSlot *slot = &table->slots[(UA_UInt32)idx];
+        UA_NodeShardEntry *entry = slot->entry;
+        if(entry > UA_NODESHARD_TOMBSTONE) {
+            if(slot->nodeIdHash == h &&
+               UA_NodeId_equal(&entry->node.nodeId, nodeid)) {
+                *outEntry = entry;
+                return slot;
+            }
+        } else {
+            if(entry == NULL)
+                return NULL; /* No further entry possible */
+        }
+
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx);
+
+    return NULL;
+}
+
+static UA_NodeShardEntry *
+createShardEntry(UA_NodeClass nodeClass) {
+    size_t size = sizeof(UA_NodeShardEntry) - sizeof(UA_Node);
+    switch(nodeClass) {
+    case UA_NODECLASS_OBJECT:
+        size += sizeof(UA_ObjectNode);
+        break;
+    case UA_NODECLASS_VARIABLE:
+        size += sizeof(UA_VariableNode);
+        break;
+    case UA_NODECLASS_METHOD:
+        size += sizeof(UA_MethodNode);
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        size += sizeof(UA_ObjectTypeNode);
+        break;
+    case UA_NODECLASS_VARIABLETYPE:
+        size += sizeof(UA_VariableTypeNode);
+        break;
+    case UA_NODECLASS_REFERENCETYPE:
+        size += sizeof(UA_ReferenceTypeNode);
+        break;
+    case UA_NODECLASS_DATATYPE:
+        size += sizeof(UA_DataTypeNode);
+        break;
+    case UA_NODECLASS_VIEW:
+        size += sizeof(UA_ViewNode);
+        break;
+    default:
+        return NULL;
+    }
+    UA_NodeShardEntry *entry = (UA_NodeShardEntry*)UA_calloc(1, size);
+    if(!entry)
+        return NULL;
+    entry->node.nodeClass = nodeClass;
+    return entry;
+}
+
+static void
+deleteNodeShardEntry(UA_NodeShardEntry *entry) {
+    UA_Node_clear(&entry->node);
+    UA_free(entry);
+}
+
+/*******************/
+/* Shard Utilities */
+/*******************/
+
+/* Free the retired entries and tables that can no longer be seen by a reader.
+ * Called with the shard lock taken. */
+static void
+reclaim(UA_NodeShard *shard) {
+    UA_atomic_sync(); /* The retirement is visible before the readers are
+                       * checked */
+    if(shard->readers > 0)
+        return;
+
+    UA_NodeShardTable *table = shard->retiredTables;
+    while(table) {
+        UA_NodeShardTable *next = table->nextRetired;
+        UA_free(table);
+        table = next;
+    }
+    shard->retiredTables = NULL;
+
+    UA_NodeShardEntry *entry = shard->retiredEntries;
+    UA_NodeShardEntry *keep = NULL;
+    while(entry) {
+        UA_NodeShardEntry *next = entry->nextRetired;
+        if(entry->refCount == 0) {
+            deleteNodeShardEntry(entry);
+        } else {
+            entry->nextRetired = keep;
+            keep = entry;
+        }
+        entry = next;
+    }
+    shard->retiredEntries = keep;
+}
+
+static void
+retireEntry(UA_NodeShard *shard, UA_NodeShardEntry *entry) {
+    entry->deleted = true;
+    entry->nextRetired = shard->retiredEntries;
+    shard->retiredEntries = entry;
+}
+
+/* Drop a reference. The entry is freed by reclaim if it was removed from the
+ * shard in the meantime. */
+static void
+releaseEntry(UA_NodeShards *ns, UA_NodeShardEntry *entry) {
+    UA_NodeShard *shard = &ns->shards[entry->shard];
+    /* Read before the refCount is decreased. Afterwards the entry can be freed
+     * by a writer at any point. If the entry is removed concurrently, then the
+     * writer reclaims it. */
+    UA_Boolean deleted = entry->deleted;
+    if(UA_atomic_subUInt32(&entry->refCount, 1) > 0 || !deleted)
+        return;
+    UA_LOCK(shard->lock);
+    reclaim(shard);
+    UA_UNLOCK(shard->lock);
+}
+
+/* The occupancy of the table after the call will be about 50%. The new table
+ * is published and the old table is retired. */
+static UA_StatusCode
+expandShard(UA_NodeShard *shard) {
+    UA_NodeShardTable *otable = shard->table;
+    UA_UInt32 osize = otable->size;
+    UA_UInt32 count = shard->count;
+    /* Resize only when table after removal of unused elements is either too
+       full or too empty */
+    if(count * 2 < osize && (count * 8 > osize || osize <= UA_NODESHARD_MINSIZE))
+        return UA_STATUSCODE_GOOD;
+
+    UA_UInt32 nindex = higherShardPrimeIndex(count * 2);
+    if(shardPrimes[nindex] < UA_NODESHARD_MINSIZE)
+        nindex = higherShardPrimeIndex(UA_NODESHARD_MINSIZE);
+    UA_NodeShardTable *ntable = createTable(nindex);
+    if(!ntable)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Recompute the position of every entry and insert the pointer */
+    for(size_t i = 0, j = 0; i < osize && j < count; ++i) {
+        UA_NodeShardEntry *entry = otable->slots[i].entry;
+        if(entry <= UA_NODESHARD_TOMBSTONE)
+            continue;
+        UA_NodeShardSlot *s =
+            findFreeShardSlot(ntable, &entry->node.nodeId, otable->slots[i].nodeIdHash);
+        UA_assert(s);
+        *s = otable->slots[i];
+        ++j;
+    }
+
+    UA_atomic_sync(); /* Fill the table before it is published */
+    shard->table = ntable;
+    otable->nextRetired = shard->retiredTables;
+    shard->retiredTables = otable;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Insert into the shard. Returns UA_STATUSCODE_BADNODEIDEXISTS without deleting
+ * the node if the NodeId is taken. */
+static UA_StatusCode
+insertIntoShard(UA_NodeShards *ns, UA_NodeShardEntry *entry) {
+    UA_UInt32 h = UA_NodeId_hash(&entry->node.nodeId);
+    entry->shard = h & (UA_NODESTORE_SHARDS - 1);
+    UA_NodeShard *shard = &ns->shards[entry->shard];
+
+    UA_LOCK(shard->lock);
+    if(shard->table->size * 3 <= shard->count * 4) {
+        if(expandShard(shard) != UA_STATUSCODE_GOOD) {
+            UA_UNLOCK(shard->lock);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+    }
+
+    UA_NodeShardSlot *slot = findFreeShardSlot(shard->table, &entry->node.nodeId, h);
+    if(!slot) {
+        UA_UNLOCK(shard->lock);
+        return UA_STATUSCODE_BADNODEIDEXISTS;
+    }
+
+    slot->nodeIdHash = h;
+    UA_atomic_sync(); /* Set the hash first */
+    slot->entry = entry;
+    ++shard->count;
+    reclaim(shard);
+    UA_UNLOCK(shard->lock);
+    return UA_STATUSCODE_GOOD;
+}
+
+/***********************/
+/* Interface functions */
+/***********************/
+
+static UA_Node *
+UA_NodeShards_newNode(void *context, UA_NodeClass nodeClass) {
+    UA_NodeShardEntry *entry = createShardEntry(nodeClass);
+    if(!entry)
+        return NULL;
+    return &entry->node;
+}
+
+static void
+UA_NodeShards_deleteNode(void *context, UA_Node *node) {
+    UA_NodeShardEntry *entry = container_of(node, UA_NodeShardEntry, node);
+    UA_assert(&entry->node == node);
+    if(entry->orig)
+        releaseEntry((UA_NodeShards*)context, entry->orig);
+    deleteNodeShardEntry(entry);
+}
+
+static const UA_Node *
+UA_NodeShards_getNode(void *context, const UA_NodeId *nodeid) {
+    UA_NodeShards *ns = (UA_NodeShards*)context;
+    UA_UInt32 h = UA_NodeId_hash(nodeid);
+    UA_NodeShard *shard = &ns->shards[h & (UA_NODESTORE_SHARDS - 1)];
+
+    /* Lock-free lookup. The entry and table cannot be freed while the reader is
+     * counted. */
+    UA_atomic_addSize(&shard->readers, 1);
+    UA_NodeShardEntry *entry = NULL;
+    if(findOccupiedShardSlot(shard->table, nodeid, h, &entry))
+        UA_atomic_addUInt32(&entry->refCount, 1);
+    UA_atomic_subSize(&shard->readers, 1);
+
+    if(!entry)
+        return NULL;
+    return &entry->node;
+}
+
+static void
+UA_NodeShards_releaseNode(void *context, const UA_Node *node) {
+    if(!node)
+        return;
+    UA_NodeShardEntry *entry = container_of(node, UA_NodeShardEntry, node);
+    UA_assert(&entry->node == node);
+    UA_assert(entry->refCount > 0);
+    releaseEntry((UA_NodeShards*)context, entry);
+}
+
+static UA_StatusCode
+UA_NodeShards_getNodeCopy(void *context, const UA_NodeId *nodeid,
+                          UA_Node **outNode) {
+    const UA_Node *node = UA_NodeShards_getNode(context, nodeid);
+    if(!node)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    UA_NodeShardEntry *entry = container_of(node, UA_NodeShardEntry, node);
+    UA_NodeShardEntry *newItem = createShardEntry(entry->node.nodeClass);
+    if(!newItem) {
+        releaseEntry((UA_NodeShards*)context, entry);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    UA_StatusCode retval = UA_Node_copy(&entry->node, &newItem->node);
+    if(retval != UA_STATUSCODE_GOOD) {
+        deleteNodeShardEntry(newItem);
+        releaseEntry((UA_NodeShards*)context, entry);
+        return retval;
+    }
+
+    /* Keep the reference to the original. So it cannot be freed and its memory
+     * reused before the copy is replaced. */
+    newItem->orig = entry;
+    *outNode = &newItem->node;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+UA_NodeShards_removeNode(void *context, const UA_NodeId *nodeid) {
+    UA_NodeShards *ns = (UA_NodeShards*)context;
+    UA_UInt32 h = UA_NodeId_hash(nodeid);
+    UA_NodeShard *shard = &ns->shards[h & (UA_NODESTORE_SHARDS - 1)];
+
+    UA_LOCK(shard->lock);
+    UA_NodeShardEntry *entry = NULL;
+    UA_NodeShardSlot *slot = findOccupiedShardSlot(shard->table, nodeid, h, &entry);
+    if(!slot) {
+        UA_UNLOCK(shard->lock);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    slot->entry = UA_NODESHARD_TOMBSTONE;
+    retireEntry(shard, entry);
+    --shard->count;
+    /* Downsize the shard if it is very empty */
+    if(shard->count * 8 < shard->table->size &&
+       shard->table->size > UA_NODESHARD_MINSIZE)
+        expandShard(shard); /* Can fail. Just continue with the bigger table. */
+    reclaim(shard);
+    UA_UNLOCK(shard->lock);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+UA_NodeShards_insertNode(void *context, UA_Node *node,
+                         UA_NodeId *addedNodeId) {
+    UA_NodeShards *ns = (UA_NodeShards*)context;
+    UA_NodeShardEntry *entry = container_of(node, UA_NodeShardEntry, node);
+
+    /* Copy the NodeId. The node cannot be used after the insertion. It might be
+     * removed by another thread in the meantime. */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(addedNodeId) {
+        retval = UA_NodeId_copy(&node->nodeId, addedNodeId);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_NodeShards_deleteNode(ns, node);
+            return retval;
+        }
+    }
+
+    /* The inserted node is not a replacement. Drop the reference to the
+     * original after the insertion. */
+    UA_NodeShardEntry *orig = entry->orig;
+    entry->orig = NULL;
+
+    if(node->nodeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+       node->nodeId.identifier.numeric == 0) {
+        /* Create a random nodeid: Start at least with 50,000 to make sure we
+         * don not conflict with nodes from the spec. The identifiers are taken
+         * from a shared counter. If the identifier is already taken, then just
+         * try the next one until all identifiers have been tried. */
+        UA_UInt32 tries = 0;
+        retval = UA_STATUSCODE_BADNODEIDEXISTS;
+        do {
+            UA_UInt32 identifier = UA_atomic_addUInt32(&ns->nextIdentifier, 1);
+            if(identifier < UA_NODESHARD_FIRSTID)
+                continue; /* Wrapped around */
+            node->nodeId.identifier.numeric = identifier;
+            if(addedNodeId)
+                addedNodeId->identifier.numeric = identifier;
+            retval = insertIntoShard(ns, entry);
+        } while(retval == UA_STATUSCODE_BADNODEIDEXISTS &&
+                ++tries < UA_UINT32_MAX - UA_NODESHARD_FIRSTID);
+    } else {
+        retval = insertIntoShard(ns, entry);
+    }
+
+    if(retval != UA_STATUSCODE_GOOD) {
+        if(addedNodeId)
+            UA_NodeId_clear(addedNodeId);
+        deleteNodeShardEntry(entry);
+    }
+    if(orig)
+        releaseEntry(ns, orig);
+    return retval;
+}
+
+static UA_StatusCode
+UA_NodeShards_replaceNode(void *context, UA_Node *node) {
+    UA_NodeShards *ns = (UA_NodeShards*)context;
+    UA_NodeShardEntry *newEntry = container_of(node, UA_NodeShardEntry, node);
+    UA_UInt32 h = UA_NodeId_hash(&node->nodeId);
+    newEntry->shard = h & (UA_NODESTORE_SHARDS - 1);
+    UA_NodeShard *shard = &ns->shards[newEntry->shard];
+
+    /* Find the node */
+    UA_LOCK(shard->lock);
+    UA_NodeShardEntry *oldEntry = NULL;
+    UA_NodeShardSlot *slot =
+        findOccupiedShardSlot(shard->table, &node->nodeId, h, &oldEntry);
+    if(!slot) {
+        UA_UNLOCK(shard->lock);
+        UA_NodeShards_deleteNode(ns, node);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    /* The node was already updated since the copy was made? */
+    if(oldEntry != newEntry->orig) {
+        UA_UNLOCK(shard->lock);
+        UA_NodeShards_deleteNode(ns, node);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Replace the entry and drop the reference of the copy */
+    newEntry->orig = NULL;
+    UA_atomic_sync(); /* The node is complete before it is published */
+    slot->entry = newEntry;
+    retireEntry(shard, oldEntry);
+    UA_atomic_subUInt32(&oldEntry->refCount, 1);
+    reclaim(shard);
+    UA_UNLOCK(shard->lock);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+UA_NodeShards_iterate(void *context, UA_NodestoreVisitor visitor,
+                      void *visitorContext) {
+    UA_NodeShards *ns = (UA_NodeShards*)context;
+    for(size_t i = 0; i < UA_NODESTORE_SHARDS; i++) {
+        /* The visitor can edit the nodestore. So collect the entries first
+         * and visit them without holding the lock. */
+        UA_NodeShard *shard = &ns->shards[i];
+        UA_LOCK(shard->lock);
+        UA_NodeShardEntry **entries = (UA_NodeShardEntry**)
+            UA_malloc(sizeof(UA_NodeShardEntry*) * (shard->count + 1));
+        if(!entries) {
+            UA_UNLOCK(shard->lock);
+            return;
+        }
+        size_t entriesSize = 0;
+        UA_NodeShardTable *table = shard->table;
+        for(UA_UInt32 j = 0; j < table->size; j++) {
+            UA_NodeShardEntry *entry = table->slots[j].entry;
+            if(entry <= UA_NODESHARD_TOMBSTONE)
+                continue;
+            UA_atomic_addUInt32(&entry->refCount, 1);
+            entries[entriesSize++] = entry;
+        }
+        UA_UNLOCK(shard->lock);
+
+        for(size_t j = 0; j < entriesSize; j++) {
+            visitor(visitorContext, &entries[j]->node);
+            releaseEntry(ns, entries[j]);
+        }
+        UA_free(entries);
+    }
+}
+
+static void
+UA_NodeShards_delete(void *context) {
+    UA_NodeShards *ns = (UA_NodeShards*)context;
+    for(size_t i = 0; i < UA_NODESTORE_SHARDS; i++) {
+        UA_NodeShard *shard = &ns->shards[i];
+        UA_NodeShardTable *table = shard->table;
+        for(UA_UInt32 j = 0; j < table->size; j++) {
+            UA_NodeShardEntry *entry = table->slots[j].entry;
+            if(entry <= UA_NODESHARD_TOMBSTONE)
+                continue;
+            /* On debugging builds, check that all nodes were release */
+            UA_assert(entry->refCount == 0);
+            deleteNodeShardEntry(entry);
+        }
+        UA_free(table);
+
+        /* All readers are gone */
+        shard->table = NULL;
+        UA_NodeShardEntry *entry = shard->retiredEntries;
+        while(entry) {
+            UA_NodeShardEntry *next = entry->nextRetired;
+            deleteNodeShardEntry(entry);
+            entry = next;
+        }
+        UA_NodeShardTable *retired = shard->retiredTables;
+        while(retired) {
+            UA_NodeShardTable *next = retired->nextRetired;
+            UA_free(retired);
+            retired = next;
+        }
+        UA_LOCK_DESTROY(shard->lock);
+    }
+    UA_free(ns);
+}
+
+UA_StatusCode
+UA_Nodestore_Sharded(UA_Nodestore *ns) {
+    /* Allocate and initialize the shards */
+    UA_NodeShards *shards = (UA_NodeShards*)UA_calloc(1, sizeof(UA_NodeShards));
+    if(!shards)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    shards->nextIdentifier = UA_NODESHARD_FIRSTID;
+    UA_UInt16 sizePrimeIndex = higherShardPrimeIndex(UA_NODESHARD_MINSIZE);
+    for(size_t i = 0; i < UA_NODESTORE_SHARDS; i++) {
+        UA_NodeShard *shard = &shards->shards[i];
+        shard->table = createTable(sizePrimeIndex);
+        if(!shard->table) {
+            for(size_t j = 0; j < i; j++) {
+                UA_free(shards->shards[j].table);
+                UA_LOCK_DESTROY(shards->shards[j].lock);
+            }
+            UA_free(shards);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        UA_LOCK_INIT(shard->lock);
+    }
+
+    /* Populate the nodestore */
+    ns->context = shards;
+    ns->clear = UA_NodeShards_delete;
+    ns->newNode = UA_NodeShards_newNode;
+    ns->deleteNode = UA_NodeShards_deleteNode;
+    ns->getNode = UA_NodeShards_getNode;
+    ns->releaseNode = UA_NodeShards_releaseNode;
+    ns->getNodeCopy = UA_NodeShards_getNodeCopy;
+    ns->insertNode = UA_NodeShards_insertNode;
+    ns->replaceNode = UA_NodeShards_replaceNode;
+    ns->removeNode = UA_NodeShards_removeNode;
+    ns->iterate = UA_NodeShards_iterate;
+    return UA_STATUSCODE_GOOD;
+}
@@ -11,6 +11,18 @@
 #include <open62541/plugin/pubsub_udp.h>
 #include <open62541/util.h>
 
+/* _GNU_SOURCE is defined in the POSIX architecture header */
+#if defined(__linux__) && defined(_GNU_SOURCE)
+# define UA_PUBSUB_UDP_RECVMMSG
+#endif
+
+/* Batched receive. The datagrams are received into a set of buffers that is
+ * reused for every batch. The number of batches per receive call is limited so
+ * that a flooded socket cannot starve the server. */
+#define UA_PUBSUB_UDP_BATCHSIZE 32
+#define UA_PUBSUB_UDP_MAXBATCHES 8
+#define UA_PUBSUB_UDP_MAXDATAGRAM 2048
+
 /* UDP multicast network layer specific internal data */
 typedef struct {
     int ai_family;                    /* Protocol family for socket. IPv4/IPv6 */
@@ -18,6 +30,7 @@ typedef struct {
     UA_UInt32 messageTTL;
     UA_Boolean enableLoopback;
     UA_Boolean enableReuse;
+    UA_Byte *receiveBuffers; /* Allocated with the first batch */
 } UA_PubSubChannelDataUDPMC;
 
 /**
@@ -51,7 +64,7 @@ UA_PubSubChannelUDPMC_open(const UA_PubSubConnectionConfig *connectionConfig) {
     }
 
     /* Set default values */
-    UA_PubSubChannelDataUDPMC defaultValues = {0, NULL, 255, UA_TRUE, UA_TRUE};
+    UA_PubSubChannelDataUDPMC defaultValues = {0, NULL, 255, UA_TRUE, UA_TRUE, NULL};
     memcpy(channelDataUDPMC, &defaultValues, sizeof(UA_PubSubChannelDataUDPMC));
     /* Iterate over the given KeyValuePair parameters */
     UA_String ttlParam = UA_STRING("ttl");
@@ -444,6 +457,23 @@ UA_PubSubChannelUDPMC_send(UA_PubSubChannel *channel, UA_ExtensionObject *transp
     return UA_STATUSCODE_GOOD;
 }
 
+/* Wait until the socket is readable. The timeout is in microseconds. */
+static UA_StatusCode
+waitForMessage(UA_PubSubChannel *channel, UA_UInt32 timeout) {
+    fd_set fdset;
+    FD_ZERO(&fdset);
+    UA_fd_set(channel->sockfd, &fdset);
+    struct timeval tmptv = {(long int)(timeout / 1000000),
+                            (long int)(timeout % 1000000)};
+    int resultsize = UA_select(channel->sockfd+1, &fdset, NULL,
+                               NULL, &tmptv);
+    if(resultsize == 0)
+        return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+    if(resultsize == -1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
 /**
  * Receive messages. The regist function should be called before.
  *
@@ -461,20 +491,10 @@ UA_PubSubChannelUDPMC_receive(UA_PubSubChannel *channel, UA_ByteString *message,
     UA_PubSubChannelDataUDPMC *channelConfigUDPMC = (UA_PubSubChannelDataUDPMC *) channel->handle;
 
     if(timeout > 0) {
-        fd_set fdset;
-        FD_ZERO(&fdset);
-        UA_fd_set(channel->sockfd, &fdset);
-        struct timeval tmptv = {(long int)(timeout / 1000000),
-                                (long int)(timeout % 1000000)};
-        int resultsize = UA_select(channel->sockfd+1, &fdset, NULL,
-                                NULL, &tmptv);
-        if(resultsize == 0) {
+        UA_StatusCode retval = waitForMessage(channel, timeout);
+        if(retval != UA_STATUSCODE_GOOD) {
             message->length = 0;
-            return UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
-        }
-        if (resultsize == -1) {
-            message->length = 0;
-            return UA_STATUSCODE_BADINTERNALERROR;
+            return retval;
         }
     }
 
@@ -494,6 +514,92 @@ UA_PubSubChannelUDPMC_receive(UA_PubSubChannel *channel, UA_ByteString *message,
     return UA_STATUSCODE_GOOD;
 }
 
+/**
+ * Receive all pending datagrams in batches into the reused receive buffers and
+ * call the callback for each of them. Uses recvmmsg where available.
+ *
+ * @return UA_STATUSCODE_GOODNONCRITICALTIMEOUT if no message arrived within the
+ *         timeout (in microseconds)
+ */
+static UA_StatusCode
+UA_PubSubChannelUDPMC_receiveBatch(UA_PubSubChannel *channel,
+                                   UA_ExtensionObject *transportSettings,
+                                   UA_PubSubReceiveCallback callback,
+                                   void *callbackContext, UA_UInt32 timeout) {
+    if(!(channel->state == UA_PUBSUB_CHANNEL_PUB || channel->state == UA_PUBSUB_CHANNEL_PUB_SUB)) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                     "PubSub Connection receive failed. Invalid state.");
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_StatusCode retval = waitForMessage(channel, timeout);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    UA_PubSubChannelDataUDPMC *channelConfigUDPMC = (UA_PubSubChannelDataUDPMC *) channel->handle;
+    if(!channelConfigUDPMC->receiveBuffers) {
+        channelConfigUDPMC->receiveBuffers = (UA_Byte*)
+            UA_malloc(UA_PUBSUB_UDP_BATCHSIZE * UA_PUBSUB_UDP_MAXDATAGRAM);
+        if(!channelConfigUDPMC->receiveBuffers)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    UA_ByteString message;
+#ifdef UA_PUBSUB_UDP_RECVMMSG
+    struct iovec iovecs[UA_PUBSUB_UDP_BATCHSIZE];
+    struct mmsghdr msgs[UA_PUBSUB_UDP_BATCHSIZE];
+    memset(msgs, 0, sizeof(msgs));
+    for(size_t i = 0; i < UA_PUBSUB_UDP_BATCHSIZE; i++) {
+        iovecs[i].iov_base = &channelConfigUDPMC->receiveBuffers[i * UA_PUBSUB_UDP_MAXDATAGRAM];
+        iovecs[i].iov_len = UA_PUBSUB_UDP_MAXDATAGRAM;
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for(size_t batch = 0; batch < UA_PUBSUB_UDP_MAXBATCHES; batch++) {
+        int received = recvmmsg(channel->sockfd, msgs, UA_PUBSUB_UDP_BATCHSIZE,
+                                MSG_DONTWAIT, NULL);
+        /* The kernel does not implement recvmmsg. Receive one datagram per
+         * call instead. */
+        if(received < 0 && UA_ERRNO == ENOSYS && batch == 0)
+            goto single;
+        if(received <= 0)
+            break; /* Drained (EAGAIN) or error */
+        for(int i = 0; i < received; i++) {
+            if(msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_SERVER,
+                               "PubSub Connection receive. Dropped a datagram "
+                               "larger than %u bytes.", UA_PUBSUB_UDP_MAXDATAGRAM);
+                continue;
+            }
+            message.data = (UA_Byte*)iovecs[i].iov_base;
+            message.length = msgs[i].msg_len;
+            callback(channel, callbackContext, &message);
+        }
+        if(received < UA_PUBSUB_UDP_BATCHSIZE)
+            break;
+    }
+    return UA_STATUSCODE_GOOD;
+
+ single:
+#endif
+    /* One datagram per call to recvfrom. Continue as long as the socket is
+     * readable. */
+    for(size_t i = 0; i < UA_PUBSUB_UDP_BATCHSIZE * UA_PUBSUB_UDP_MAXBATCHES; i++) {
+        if(i > 0 && waitForMessage(channel, 0) != UA_STATUSCODE_GOOD)
+            break;
+        ssize_t messageLength =
+            UA_recvfrom(channel->sockfd, channelConfigUDPMC->receiveBuffers,
+                        UA_PUBSUB_UDP_MAXDATAGRAM, 0, NULL, NULL);
+        if(messageLength <= 0)
+            break;
+        message.data = channelConfigUDPMC->receiveBuffers;
+        message.length = (size_t)messageLength;
+        callback(channel, callbackContext, &message);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 /**
  * Close channel and free the channel data.
  *
@@ -509,6 +615,7 @@ UA_PubSubChannelUDPMC_close(UA_PubSubChannel *channel) {
     //cleanup the internal NetworkLayer data
     UA_PubSubChannelDataUDPMC *networkLayerData = (UA_PubSubChannelDataUDPMC *) channel->handle;
     UA_free(networkLayerData->ai_addr);
+    UA_free(networkLayerData->receiveBuffers);
     UA_free(networkLayerData);
     UA_free(channel);
     return UA_STATUSCODE_GOOD;
@@ -529,6 +636,7 @@ TransportLayerUDPMC_addChannel(UA_PubSubConnectionConfig *connectionConfig) {
         pubSubChannel->unregist = UA_PubSubChannelUDPMC_unregist;
         pubSubChannel->send = UA_PubSubChannelUDPMC_send;
         pubSubChannel->receive = UA_PubSubChannelUDPMC_receive;
+        pubSubChannel->receiveBatch = UA_PubSubChannelUDPMC_receiveBatch;
         pubSubChannel->close = UA_PubSubChannelUDPMC_close;
         pubSubChannel->connectionConfig = connectionConfig;
     }
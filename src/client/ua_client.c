@@ -204,24 +204,102 @@ sendSymmetricServiceRequest(UA_Client *client, const void *request,
     return UA_STATUSCODE_GOOD;
 }
 
+/* The async service calls are indexed by their requestId in a hash map. The
+ * calls with a timeout are additionally ordered by their expiry. */
+
+#define UA_ASYNCSERVICECALLBUCKETS_INITIAL 16
+
+/* Calls with the same expiry are ordered by their memory address */
+static enum ZIP_CMP
+cmpAsyncServiceCallExpiry(const UA_DateTime *a, const UA_DateTime *b) {
+    if(*a < *b)
+        return ZIP_CMP_LESS;
+    if(*a > *b)
+        return ZIP_CMP_MORE;
+    if(a == b)
+        return ZIP_CMP_EQ;
+    if(a < b)
+        return ZIP_CMP_LESS;
+    return ZIP_CMP_MORE;
+}
+
+ZIP_IMPL(UA_AsyncServiceCallExpiryZip, AsyncServiceCall, expiryZipfields,
+         UA_DateTime, expiry, cmpAsyncServiceCallExpiry)
+
+/* The requestIds are consecutive. So the lower bits are a good hash. */
+static AsyncServiceCall_bucket *
+getAsyncServiceCallBucket(UA_Client *client, UA_UInt32 requestId) {
+    return &client->asyncServiceCallBuckets[requestId &
+                                            (client->asyncServiceCallBucketsSize - 1)];
+}
+
+/* Double the number of buckets and rehash the calls */
+static UA_StatusCode
+growAsyncServiceCallBuckets(UA_Client *client) {
+    size_t newSize = (client->asyncServiceCallBucketsSize == 0) ?
+        UA_ASYNCSERVICECALLBUCKETS_INITIAL : client->asyncServiceCallBucketsSize * 2;
+    AsyncServiceCall_bucket *buckets = (AsyncServiceCall_bucket*)
+        UA_calloc(newSize, sizeof(AsyncServiceCall_bucket));
+    if(!buckets)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_free(client->asyncServiceCallBuckets);
+    client->asyncServiceCallBuckets = buckets;
+    client->asyncServiceCallBucketsSize = newSize;
+    AsyncServiceCall *ac;
+    LIST_FOREACH(ac, &client->asyncServiceCalls, pointers)
+        LIST_INSERT_HEAD(&getAsyncServiceCallBucket(client, ac->requestId)->byId,
+                         ac, idPointers);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+addAsyncServiceCall(UA_Client *client, AsyncServiceCall *ac) {
+    LIST_INSERT_HEAD(&client->asyncServiceCalls, ac, pointers);
+    LIST_INSERT_HEAD(&getAsyncServiceCallBucket(client, ac->requestId)->byId,
+                     ac, idPointers);
+    if(ac->timeout) {
+        ac->expiry = ac->start + (UA_DateTime)(ac->timeout * UA_DATETIME_MSEC);
+        ZIP_INSERT(UA_AsyncServiceCallExpiryZip, &client->asyncServiceCallsByExpiry,
+                   ac, ZIP_FFS32(UA_UInt32_random()));
+    }
+    client->asyncServiceCallsSize++;
+}
+
+static void
+removeAsyncServiceCall(UA_Client *client, AsyncServiceCall *ac) {
+    LIST_REMOVE(ac, pointers);
+    LIST_REMOVE(ac, idPointers);
+    if(ac->timeout)
+        ZIP_REMOVE(UA_AsyncServiceCallExpiryZip, &client->asyncServiceCallsByExpiry, ac);
+    client->asyncServiceCallsSize--;
+}
+
+static AsyncServiceCall *
+findAsyncServiceCall(UA_Client *client, UA_UInt32 requestId) {
+    if(client->asyncServiceCallBucketsSize == 0)
+        return NULL;
+    AsyncServiceCall *ac;
+    LIST_FOREACH(ac, &getAsyncServiceCallBucket(client, requestId)->byId, idPointers) {
+        if(ac->requestId == requestId)
+            return ac;
+    }
+    return NULL;
+}
+
 static const UA_NodeId
 serviceFaultId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_SERVICEFAULT_ENCODING_DEFAULTBINARY}};
 
-/* Look for the async callback in the linked list, execute and delete it */
+/* Look for the async callback, execute and delete it */
 static UA_StatusCode
 processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *responseTypeId,
-                     const UA_ByteString *responseMessage, size_t *offset) {
+                     const UA_ByteString *segments, size_t segmentsSize, size_t *offset) {
     /* Find the callback */
-    AsyncServiceCall *ac;
-    LIST_FOREACH(ac, &client->asyncServiceCalls, pointers) {
-        if(ac->requestId == requestId)
-            break;
-    }
+    AsyncServiceCall *ac = findAsyncServiceCall(client, requestId);
     if(!ac)
         return UA_STATUSCODE_BADREQUESTHEADERINVALID;
 
     /* Dequeue ac. We might disconnect (remove all ac) in the callback. */
-    LIST_REMOVE(ac, pointers);
+    removeAsyncServiceCall(client, ac);
 
     /* Allocate the response */
     UA_STACKARRAY(UA_Byte, responseBuf, ac->responseType->memSize);
@@ -248,7 +326,8 @@ processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *re
     }
 
     /* Decode the response */
-    retval = UA_decodeBinary(responseMessage, offset, response, responseType, client->config.customDataTypes);
+    retval = UA_decodeBinarySegments(segments, segmentsSize, offset, response, responseType,
+                                     client->config.customDataTypes, NULL, false);
 
  process:
     if(retval != UA_STATUSCODE_GOOD) {
@@ -279,8 +358,9 @@ processAsyncResponse(UA_Client *client, UA_UInt32 requestId, const UA_NodeId *re
 static void
 processServiceResponse(void *application, UA_SecureChannel *channel,
                        UA_MessageType messageType, UA_UInt32 requestId,
-                       UA_ByteString *message) {
+                       UA_ByteString *segments, size_t segmentsSize) {
     SyncResponseDescription *rd = (SyncResponseDescription*)application;
+    UA_ByteString *message = &segments[0]; /* Single segment except for MSG */
 
     /* Process ACK response */
     if(messageType == UA_MESSAGETYPE_ACK) {
@@ -319,14 +399,17 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
     /* Decode the data type identifier of the response */
     size_t offset = 0;
     UA_NodeId responseId;
-    UA_StatusCode retval = UA_NodeId_decodeBinary(message, &offset, &responseId);
+    UA_StatusCode retval =
+        UA_decodeBinarySegments(segments, segmentsSize, &offset, &responseId,
+                                &UA_TYPES[UA_TYPES_NODEID], NULL, NULL, false);
     if(retval != UA_STATUSCODE_GOOD)
         goto finish;
 
     /* Got an asynchronous response. Don't expected a synchronous response
      * (responseType NULL) or the id does not match. */
     if(!rd->responseType || requestId != rd->requestId) {
-        retval = processAsyncResponse(rd->client, requestId, &responseId, message, &offset);
+        retval = processAsyncResponse(rd->client, requestId, &responseId,
+                                      segments, segmentsSize, &offset);
         goto finish;
     }
 
@@ -338,9 +421,10 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
     if(!UA_NodeId_equal(&responseId, &expectedNodeId)) {
         if(UA_NodeId_equal(&responseId, &serviceFaultId)) {
             UA_init(rd->response, rd->responseType);
-            retval = UA_decodeBinary(message, &offset, rd->response,
-                                     &UA_TYPES[UA_TYPES_SERVICEFAULT],
-                                     rd->client->config.customDataTypes);
+            retval = UA_decodeBinarySegments(segments, segmentsSize, &offset, rd->response,
+                                             &UA_TYPES[UA_TYPES_SERVICEFAULT],
+                                             rd->client->config.customDataTypes,
+                                             NULL, false);
             if(retval != UA_STATUSCODE_GOOD)
                 ((UA_ResponseHeader*)rd->response)->serviceResult = retval;
             UA_LOG_INFO(&rd->client->config.logger, UA_LOGCATEGORY_CLIENT,
@@ -364,8 +448,9 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
 #endif
 
     /* Decode the response */
-    retval = UA_decodeBinary(message, &offset, rd->response, rd->responseType,
-                             rd->client->config.customDataTypes);
+    retval = UA_decodeBinarySegments(segments, segmentsSize, &offset, rd->response,
+                                     rd->responseType, rd->client->config.customDataTypes,
+                                     NULL, false);
 
 finish:
     UA_NodeId_deleteMembers(&responseId);
@@ -482,10 +567,17 @@ UA_Client_AsyncService_cancel(UA_Client *client, AsyncServiceCall *ac,
 void UA_Client_AsyncService_removeAll(UA_Client *client, UA_StatusCode statusCode) {
     AsyncServiceCall *ac, *ac_tmp;
     LIST_FOREACH_SAFE(ac, &client->asyncServiceCalls, pointers, ac_tmp) {
-        LIST_REMOVE(ac, pointers);
+        removeAsyncServiceCall(client, ac);
         UA_Client_AsyncService_cancel(client, ac, statusCode);
         UA_free(ac);
     }
+
+    /* The callbacks might have added new calls */
+    if(client->asyncServiceCallsSize > 0)
+        return;
+    UA_free(client->asyncServiceCallBuckets);
+    client->asyncServiceCallBuckets = NULL;
+    client->asyncServiceCallBucketsSize = 0;
 }
 
 UA_StatusCode
@@ -495,7 +587,14 @@ __UA_Client_AsyncServiceEx(UA_Client *client, const void *request,
                            const UA_DataType *responseType,
                            void *userdata, UA_UInt32 *requestId,
                            UA_UInt32 timeout) {
-    /* Prepare the entry for the linked list */
+    /* Grow the hash index. Continue with a higher load if this fails. */
+    if(client->asyncServiceCallsSize >= client->asyncServiceCallBucketsSize) {
+        UA_StatusCode res = growAsyncServiceCallBuckets(client);
+        if(res != UA_STATUSCODE_GOOD && client->asyncServiceCallBucketsSize == 0)
+            return res;
+    }
+
+    /* Prepare the entry for the index */
     AsyncServiceCall *ac = (AsyncServiceCall*)UA_malloc(sizeof(AsyncServiceCall));
     if(!ac)
         return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -514,7 +613,7 @@ __UA_Client_AsyncServiceEx(UA_Client *client, const void *request,
     ac->start = UA_DateTime_nowMonotonic();
 
     /* Store the entry for async processing */
-    LIST_INSERT_HEAD(&client->asyncServiceCalls, ac, pointers);
+    addAsyncServiceCall(client, ac);
     if(requestId)
         *requestId = ac->requestId;
     return UA_STATUSCODE_GOOD;
@@ -581,17 +680,14 @@ static void
 asyncServiceTimeoutCheck(UA_Client *client) {
     UA_DateTime now = UA_DateTime_nowMonotonic();
 
-    /* Timeout occurs, remove the callback */
-    AsyncServiceCall *ac, *ac_tmp;
-    LIST_FOREACH_SAFE(ac, &client->asyncServiceCalls, pointers, ac_tmp) {
-        if(!ac->timeout)
-           continue;
-
-        if(ac->start + (UA_DateTime)(ac->timeout * UA_DATETIME_MSEC) <= now) {
-            LIST_REMOVE(ac, pointers);
-            UA_Client_AsyncService_cancel(client, ac, UA_STATUSCODE_BADTIMEOUT);
-            UA_free(ac);
-        }
+    /* Timeout occurs, remove the callback. Only the calls whose expiry has
+     * been reached are visited. */
+    AsyncServiceCall *ac;
+    while((ac = ZIP_MIN(UA_AsyncServiceCallExpiryZip, &client->asyncServiceCallsByExpiry)) &&
+          ac->expiry <= now) {
+        removeAsyncServiceCall(client, ac);
+        UA_Client_AsyncService_cancel(client, ac, UA_STATUSCODE_BADTIMEOUT);
+        UA_free(ac);
     }
 }
 
@@ -38,6 +38,8 @@ typedef struct UA_Client_NotificationsAckNumber {
 
 typedef struct UA_Client_MonitoredItem {
     LIST_ENTRY(UA_Client_MonitoredItem) listEntry;
+    LIST_ENTRY(UA_Client_MonitoredItem) handlePointers; /* Index by clientHandle */
+    LIST_ENTRY(UA_Client_MonitoredItem) idPointers;     /* Index by monitoredItemId */
     UA_UInt32 monitoredItemId;
     UA_UInt32 clientHandle;
     void *context;
@@ -49,6 +51,12 @@ typedef struct UA_Client_MonitoredItem {
     UA_Boolean isEventMonitoredItem; /* Otherwise a DataChange MoniitoredItem */
 } UA_Client_MonitoredItem;
 
+/* Hash bucket for the MonitoredItem lookup */
+typedef struct {
+    LIST_HEAD(, UA_Client_MonitoredItem) byHandle;
+    LIST_HEAD(, UA_Client_MonitoredItem) byId;
+} UA_Client_MonitoredItem_bucket;
+
 typedef struct UA_Client_Subscription {
     LIST_ENTRY(UA_Client_Subscription) listEntry;
     UA_UInt32 subscriptionId;
@@ -60,6 +68,9 @@ typedef struct UA_Client_Subscription {
     UA_UInt32 sequenceNumber;
     UA_DateTime lastActivity;
     LIST_HEAD(UA_ListOfClientMonitoredItems, UA_Client_MonitoredItem) monitoredItems;
+    size_t monitoredItemsSize;
+    UA_Client_MonitoredItem_bucket *monitoredItemBuckets;
+    size_t monitoredItemBucketsSize; /* Power of two */
 } UA_Client_Subscription;
 
 void
@@ -91,15 +102,26 @@ UA_Client_Subscriptions_backgroundPublishInactivityCheck(UA_Client *client);
 
 typedef struct AsyncServiceCall {
     LIST_ENTRY(AsyncServiceCall) pointers;
+    LIST_ENTRY(AsyncServiceCall) idPointers; /* Index by requestId */
+    ZIP_ENTRY(AsyncServiceCall) expiryZipfields; /* Only with a timeout */
     UA_UInt32 requestId;
     UA_ClientAsyncServiceCallback callback;
     const UA_DataType *responseType;
     void *userdata;
     UA_DateTime start;
     UA_UInt32 timeout;
+    UA_DateTime expiry; /* start + timeout */
     void *responsedata;
 } AsyncServiceCall;
 
+ZIP_HEAD(UA_AsyncServiceCallExpiryZip, AsyncServiceCall);
+ZIP_PROTTYPE(UA_AsyncServiceCallExpiryZip, AsyncServiceCall, UA_DateTime)
+
+/* Hash bucket for the lookup of async service calls by their requestId */
+typedef struct {
+    LIST_HEAD(, AsyncServiceCall) byId;
+} AsyncServiceCall_bucket;
+
 void UA_Client_AsyncService_cancel(UA_Client *client, AsyncServiceCall *ac,
                                    UA_StatusCode statusCode);
 
@@ -148,6 +170,10 @@ struct UA_Client {
     /* Async Service */
     AsyncServiceCall asyncConnectCall;
     LIST_HEAD(ListOfAsyncServiceCall, AsyncServiceCall) asyncServiceCalls;
+    size_t asyncServiceCallsSize;
+    AsyncServiceCall_bucket *asyncServiceCallBuckets;
+    size_t asyncServiceCallBucketsSize; /* Power of two */
+    struct UA_AsyncServiceCallExpiryZip asyncServiceCallsByExpiry;
     /*When using highlevel functions these are the callbacks that can be accessed by the user*/
     LIST_HEAD(ListOfCustomCallback, CustomCallback) customCallbacks;
 
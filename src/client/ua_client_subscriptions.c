@@ -40,6 +40,9 @@ __Subscriptions_create_handler(UA_Client *client, void *data, UA_UInt32 requestI
     newSub->publishingInterval = response->revisedPublishingInterval;
     newSub->maxKeepAliveCount = response->revisedMaxKeepAliveCount;
     LIST_INIT(&newSub->monitoredItems);
+    newSub->monitoredItemsSize = 0;
+    newSub->monitoredItemBuckets = NULL;
+    newSub->monitoredItemBucketsSize = 0;
     LIST_INSERT_HEAD(&client->subscriptions, newSub, listEntry);
 
 cleanup:
@@ -207,6 +210,7 @@ UA_Client_Subscription_deleteInternal(UA_Client *client, UA_Client_Subscription
 
     /* Remove */
     LIST_REMOVE(sub, listEntry);
+    UA_free(sub->monitoredItemBuckets);
     UA_free(sub);
 }
 
@@ -388,11 +392,76 @@ UA_Client_Subscriptions_deleteSingle(UA_Client *client, UA_UInt32 subscriptionId
 /* MonitoredItems */
 /******************/
 
+/* The MonitoredItems of a subscription are indexed by their clientHandle (for
+ * the notifications) and by their monitoredItemId (for the services) in a hash
+ * map. Both are usually assigned consecutively. So the lower bits are a good
+ * hash. */
+
+#define UA_MONITOREDITEMBUCKETS_INITIAL 16
+
+static UA_Client_MonitoredItem_bucket *
+getMonitoredItemBucket(UA_Client_Subscription *sub, UA_UInt32 key) {
+    return &sub->monitoredItemBuckets[key & (sub->monitoredItemBucketsSize - 1)];
+}
+
+static void
+indexMonitoredItem(UA_Client_Subscription *sub, UA_Client_MonitoredItem *mon) {
+    LIST_INSERT_HEAD(&getMonitoredItemBucket(sub, mon->clientHandle)->byHandle,
+                     mon, handlePointers);
+    LIST_INSERT_HEAD(&getMonitoredItemBucket(sub, mon->monitoredItemId)->byId,
+                     mon, idPointers);
+}
+
+/* Double the number of buckets and rehash the MonitoredItems */
+static UA_StatusCode
+growMonitoredItemBuckets(UA_Client_Subscription *sub) {
+    size_t newSize = (sub->monitoredItemBucketsSize == 0) ?
+        UA_MONITOREDITEMBUCKETS_INITIAL : sub->monitoredItemBucketsSize * 2;
+    UA_Client_MonitoredItem_bucket *buckets = (UA_Client_MonitoredItem_bucket*)
+        UA_calloc(newSize, sizeof(UA_Client_MonitoredItem_bucket));
+    if(!buckets)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_free(sub->monitoredItemBuckets);
+    sub->monitoredItemBuckets = buckets;
+    sub->monitoredItemBucketsSize = newSize;
+    UA_Client_MonitoredItem *mon;
+    LIST_FOREACH(mon, &sub->monitoredItems, listEntry)
+        indexMonitoredItem(sub, mon);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_Client_MonitoredItem *
+findMonitoredItemByHandle(UA_Client_Subscription *sub, UA_UInt32 clientHandle) {
+    if(sub->monitoredItemBucketsSize == 0)
+        return NULL;
+    UA_Client_MonitoredItem *mon;
+    LIST_FOREACH(mon, &getMonitoredItemBucket(sub, clientHandle)->byHandle, handlePointers) {
+        if(mon->clientHandle == clientHandle)
+            return mon;
+    }
+    return NULL;
+}
+
+static UA_Client_MonitoredItem *
+findMonitoredItemById(UA_Client_Subscription *sub, UA_UInt32 monitoredItemId) {
+    if(sub->monitoredItemBucketsSize == 0)
+        return NULL;
+    UA_Client_MonitoredItem *mon;
+    LIST_FOREACH(mon, &getMonitoredItemBucket(sub, monitoredItemId)->byId, idPointers) {
+        if(mon->monitoredItemId == monitoredItemId)
+            return mon;
+    }
+    return NULL;
+}
+
 void
 UA_Client_MonitoredItem_remove(UA_Client *client, UA_Client_Subscription *sub,
                                UA_Client_MonitoredItem *mon) {
     // NOLINTNEXTLINE
     LIST_REMOVE(mon, listEntry);
+    LIST_REMOVE(mon, handlePointers);
+    LIST_REMOVE(mon, idPointers);
+    sub->monitoredItemsSize--;
     if(mon->deleteCallback)
         mon->deleteCallback(client, sub->subscriptionId, sub->context,
                             mon->monitoredItemId, mon->context);
@@ -461,6 +530,22 @@ __MonitoredItems_create_handler(UA_Client *client, CustomCallback *cc, UA_UInt32
             continue;
         }
 
+        /* Grow the hash index. Continue with a higher load if this fails. */
+        if(sub->monitoredItemsSize >= sub->monitoredItemBucketsSize &&
+           growMonitoredItemBuckets(sub) != UA_STATUSCODE_GOOD &&
+           sub->monitoredItemBucketsSize == 0) {
+            UA_LOG_ERROR(&client->config.logger, UA_LOGCATEGORY_CLIENT,
+                         "Subscription %" PRIu32 " | Could not add the MonitoredItem "
+                         "with id %" PRIu32, sub->subscriptionId,
+                         response->results[i].monitoredItemId);
+            if(deleteCallbacks[i])
+                deleteCallbacks[i](client, sub->subscriptionId, sub->context,
+                                   response->results[i].monitoredItemId, contexts[i]);
+            UA_free(mis[i]);
+            mis[i] = NULL;
+            continue;
+        }
+
         UA_assert(mis[i] != NULL);
         UA_Client_MonitoredItem *newMon = mis[i];
         newMon->clientHandle = request->itemsToCreate[i].requestedParameters.clientHandle;
@@ -472,6 +557,8 @@ __MonitoredItems_create_handler(UA_Client *client, CustomCallback *cc, UA_UInt32
         newMon->isEventMonitoredItem =
             (request->itemsToCreate[i].itemToMonitor.attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER);
         LIST_INSERT_HEAD(&sub->monitoredItems, newMon, listEntry);
+        indexMonitoredItem(sub, newMon);
+        sub->monitoredItemsSize++;
 
         UA_LOG_DEBUG(&client->config.logger, UA_LOGCATEGORY_CLIENT,
                     "Subscription %" PRIu32 " | Added a MonitoredItem with handle %" PRIu32,
@@ -786,14 +873,10 @@ __MonitoredItems_delete_handler(UA_Client *client, void *d, UA_UInt32 requestId,
 
 #ifndef __clang_analyzer__
         /* Delete the internal representation */
-        UA_Client_MonitoredItem *mon;
-        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-            // NOLINTNEXTLINE
-            if(mon->monitoredItemId == request->monitoredItemIds[i]) {
-                UA_Client_MonitoredItem_remove(client, sub, mon);
-                break;
-            }
-        }
+        UA_Client_MonitoredItem *mon =
+            findMonitoredItemById(sub, request->monitoredItemIds[i]);
+        if(mon)
+            UA_Client_MonitoredItem_remove(client, sub, mon);
 #endif
     }
 cleanup:
@@ -900,13 +983,10 @@ UA_Client_MonitoredItems_modify(UA_Client *client,
     UA_ModifyMonitoredItemsRequest_copy(&request, &modifiedRequest);
 
     for (size_t i = 0; i < modifiedRequest.itemsToModifySize; ++i) {
-        UA_Client_MonitoredItem *mon = 0;
-        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-            if(mon->monitoredItemId == modifiedRequest.itemsToModify[i].monitoredItemId) {
-                modifiedRequest.itemsToModify[i].requestedParameters.clientHandle = mon->clientHandle;
-                break;
-            }
-        }
+        UA_Client_MonitoredItem *mon =
+            findMonitoredItemById(sub, modifiedRequest.itemsToModify[i].monitoredItemId);
+        if(mon)
+            modifiedRequest.itemsToModify[i].requestedParameters.clientHandle = mon->clientHandle;
     }
 
     __UA_Client_Service(client,
@@ -967,11 +1047,7 @@ processDataChangeNotification(UA_Client *client, UA_Client_Subscription *sub,
         UA_MonitoredItemNotification *min = &dataChangeNotification->monitoredItems[j];
 
         /* Find the MonitoredItem */
-        UA_Client_MonitoredItem *mon;
-        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-            if(mon->clientHandle == min->clientHandle)
-                break;
-        }
+        UA_Client_MonitoredItem *mon = findMonitoredItemByHandle(sub, min->clientHandle);
 
         if(!mon) {
             UA_LOG_DEBUG(&client->config.logger, UA_LOGCATEGORY_CLIENT,
@@ -1000,11 +1076,8 @@ processEventNotification(UA_Client *client, UA_Client_Subscription *sub,
         UA_EventFieldList *eventFieldList = &eventNotificationList->events[j];
 
         /* Find the MonitoredItem */
-        UA_Client_MonitoredItem *mon;
-        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-            if(mon->clientHandle == eventFieldList->clientHandle)
-                break;
-        }
+        UA_Client_MonitoredItem *mon =
+            findMonitoredItemByHandle(sub, eventFieldList->clientHandle);
 
         if(!mon) {
             UA_LOG_DEBUG(&client->config.logger, UA_LOGCATEGORY_CLIENT,
@@ -28,6 +28,15 @@ typedef struct UA_WriterGroup UA_WriterGroup;
 struct UA_ReaderGroup;
 typedef struct UA_ReaderGroup UA_ReaderGroup;
 
+/* Declaration for DataSetReader */
+struct UA_DataSetReader;
+
+/* Hash bucket for the lookup of DataSetReaders by PublisherId, WriterGroupId
+ * and DataSetWriterId */
+typedef struct {
+    LIST_HEAD(, UA_DataSetReader) readers;
+} UA_DataSetReaderBucket;
+
 /* The configuration structs (public part of PubSub entities) are defined in include/ua_plugin_pubsub.h */
 
 /**********************************************/
@@ -63,6 +72,10 @@ typedef struct UA_PubSubConnection{
     LIST_HEAD(UA_ListOfWriterGroup, UA_WriterGroup) writerGroups;
     LIST_HEAD(UA_ListOfPubSubReaderGroup, UA_ReaderGroup) readerGroups;
     size_t readerGroupsSize;
+    /* The DataSetReaders of all ReaderGroups. The size is a power of two. */
+    UA_DataSetReaderBucket *readerBuckets;
+    size_t readerBucketsSize;
+    size_t readersCount;
     TAILQ_ENTRY(UA_PubSubConnection) listEntry;
     UA_UInt16 configurationFreezeCounter;
 } UA_PubSubConnection;
@@ -86,6 +99,7 @@ UA_PubSubConnection_regist(UA_Server *server, UA_NodeId *connectionIdentifier);
 #ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
 typedef struct UA_DataSetWriterSample{
     UA_Boolean valueChanged;
+    UA_UInt32 valueVersion; /* valueVersion of the field when sampled */
     UA_DataValue value;
 } UA_DataSetWriterSample;
 #endif
@@ -97,6 +111,9 @@ typedef struct UA_DataSetWriter{
     UA_NodeId identifier;
     UA_NodeId linkedWriterGroup;
     UA_NodeId connectedDataSet;
+    /* Resolved connectedDataSet. Removing the PublishedDataSet removes its
+     * DataSetWriters first. */
+    UA_PublishedDataSet *publishedDataSet;
     UA_ConfigurationVersionDataType connectedDataSetVersion;
     UA_PubSubState state;
 #ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
@@ -153,9 +170,35 @@ typedef struct UA_DataSetField{
     UA_FieldMetaData fieldMetaData;
     UA_UInt64 sampleCallbackId;
     UA_Boolean sampleCallbackIsRegistered;
-
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+    /* Fields that publish the value attribute of a variable without a data
+     * source are indexed by the NodeId. Every write of the value increases
+     * the valueVersion. Delta frames sample only the fields whose version
+     * differs from the last sample. */
+    UA_Boolean valueTracked;
+    UA_UInt32 valueVersion;
+    UA_UInt32 nodeIdHash;
+    LIST_ENTRY(UA_DataSetField) hashEntry;
+#endif
 } UA_DataSetField;
 
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+typedef struct {
+    LIST_HEAD(, UA_DataSetField) fields;
+} UA_DataSetFieldBucket;
+
+/* Called after the value attribute of a variable was written */
+void
+UA_DataSetField_valueWritten(UA_Server *server, const UA_NodeId *nodeId);
+
+/* Called when the value of a variable can change without a write. That is,
+ * the variable gets a data source, a value ring or an onRead callback, or it
+ * is deleted. The fields of the variable are sampled in every cycle from then
+ * on. */
+void
+UA_DataSetField_valueSourceChanged(UA_Server *server, const UA_NodeId *nodeId);
+#endif
+
 UA_StatusCode
 UA_DataSetFieldConfig_copy(const UA_DataSetFieldConfig *src, UA_DataSetFieldConfig *dst);
 UA_DataSetField *
@@ -171,6 +214,25 @@ typedef enum {
     UA_PUBSUB_SDS_MIRROR
 }UA_SubscribedDataSetEnumType;
 
+/* Layout of the NetworkMessages for a DataSetReader in a frozen ReaderGroup
+ * with UA_PUBSUB_RT_FIXED_SIZE. The field types are taken from the
+ * DataSetMetaData when the configuration is frozen. The template is the first
+ * message that is decoded for the reader. A message matches if it has the same
+ * length and equals the template in the static segments, i.e. everywhere
+ * except for the sequence numbers, timestamps and field values. */
+typedef struct {
+    size_t offset;
+    size_t length;
+} UA_DataSetReaderSegment;
+
+typedef struct {
+    const UA_DataType **fieldTypes; /* Set when the configuration is frozen */
+    size_t *fieldOffsets;
+    UA_ByteString messageTemplate;  /* Empty until the first message arrives */
+    size_t staticSegmentsSize;
+    UA_DataSetReaderSegment *staticSegments;
+} UA_DataSetReaderLayout;
+
 /* DataSetReader Type definition */
 typedef struct UA_DataSetReader {
     UA_DataSetReaderConfig config;
@@ -178,9 +240,13 @@ typedef struct UA_DataSetReader {
     UA_NodeId identifier;
     UA_NodeId linkedReaderGroup;
     LIST_ENTRY(UA_DataSetReader) listEntry;
+    LIST_ENTRY(UA_DataSetReader) hashEntry; /* In the readerBuckets of the
+                                             * PubSubConnection */
+    UA_UInt32 identifierHash;
     UA_SubscribedDataSetEnumType subscribedDataSetType;
     UA_TargetVariablesDataType subscribedDataSetTarget;
     /* To Do UA_SubscribedDataSetMirrorDataType subscribedDataSetMirror */
+    UA_DataSetReaderLayout layout;
 }UA_DataSetReader;
 
 /* Delete DataSetReader */
@@ -211,6 +277,10 @@ struct UA_ReaderGroup {
     UA_UInt32 readersCount;
     UA_UInt64 subscribeCallbackId;
     UA_Boolean subscribeCallbackIsRegistered;
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    /* Resolved when the dedicated thread is started */
+    UA_PubSubConnection *threadConnection;
+#endif
 };
 
 /* Delete ReaderGroup */
@@ -224,6 +294,12 @@ UA_ReaderGroupConfig_copy(const UA_ReaderGroupConfig *src, UA_ReaderGroupConfig
 UA_StatusCode
 UA_Server_processNetworkMessage(UA_Server *server, UA_NetworkMessage* pMsg, UA_PubSubConnection *pConnection);
 
+/* Process an encoded Network Message. Messages matching the layout of a
+ * DataSetReader in a frozen RT ReaderGroup are not decoded. */
+UA_StatusCode
+UA_Server_processNetworkMessageBinary(UA_Server *server, const UA_ByteString *buffer,
+                                      UA_PubSubConnection *pConnection);
+
 /* Prototypes for internal util functions - some functions maybe removed later
  *(currently moved from public to internal)*/
 UA_ReaderGroup *UA_ReaderGroup_findRGbyId(UA_Server *server, UA_NodeId identifier);
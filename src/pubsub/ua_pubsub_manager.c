@@ -9,6 +9,11 @@
 #include "server/ua_server_internal.h"
 #include "ua_pubsub_ns0.h"
 
+#ifdef UA_ENABLE_PUBSUB_THREADS
+#include <pthread.h>
+#include <time.h>
+#endif
+
 #ifdef UA_ENABLE_PUBSUB /* conditional compilation */
 
 #define UA_DATETIMESTAMP_2000 125911584000000000
@@ -100,6 +105,23 @@ UA_Server_removePubSubConnection(UA_Server *server, const UA_NodeId connection)
     if(!currentConnection)
         return UA_STATUSCODE_BADNOTFOUND;
 
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    /* Frozen groups are not removed together with the connection. Stop their
+     * dedicated threads before the connection is freed. */
+    UA_WriterGroup *wg;
+    LIST_FOREACH(wg, &currentConnection->writerGroups, listEntry) {
+        if(wg->config.dedicatedThread)
+            UA_WriterGroup_setPubSubState(server, UA_PUBSUBSTATE_DISABLED, wg);
+    }
+    UA_ReaderGroup *rg;
+    LIST_FOREACH(rg, &currentConnection->readerGroups, listEntry) {
+        if(rg->config.dedicatedThread && rg->subscribeCallbackIsRegistered) {
+            UA_PubSubManager_removeRepeatedPubSubCallback(server, rg->subscribeCallbackId);
+            rg->subscribeCallbackIsRegistered = false;
+        }
+    }
+#endif
+
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
     removePubSubConnectionRepresentation(server, currentConnection);
 #endif
@@ -275,7 +297,7 @@ void
 UA_PubSubManager_delete(UA_Server *server, UA_PubSubManager *pubSubManager) {
     UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER, "PubSub cleanup was called.");
 
-    /* Stop and unfreeze all WriterGroups */
+    /* Stop and unfreeze all WriterGroups and ReaderGroups */
     UA_PubSubConnection *tmpConnection;
     TAILQ_FOREACH(tmpConnection, &server->pubSubManager.connections, listEntry){
         for(size_t i = 0; i < pubSubManager->connectionsSize; i++) {
@@ -284,6 +306,12 @@ UA_PubSubManager_delete(UA_Server *server, UA_PubSubManager *pubSubManager) {
                 UA_WriterGroup_setPubSubState(server, UA_PUBSUBSTATE_DISABLED, writerGroup);
                 UA_Server_unfreezeWriterGroupConfiguration(server, writerGroup->identifier);
             }
+            UA_ReaderGroup *readerGroup;
+            LIST_FOREACH(readerGroup, &tmpConnection->readerGroups, listEntry) {
+                UA_PubSubManager_removeRepeatedPubSubCallback(server, readerGroup->subscribeCallbackId);
+                readerGroup->subscribeCallbackIsRegistered = false;
+                UA_Server_unfreezeReaderGroupConfiguration(server, readerGroup->identifier);
+            }
         }
     }
 
@@ -302,6 +330,12 @@ UA_PubSubManager_delete(UA_Server *server, UA_PubSubManager *pubSubManager) {
     TAILQ_FOREACH_SAFE(tmpPDS1, &server->pubSubManager.publishedDataSets, listEntry, tmpPDS2){
         UA_Server_removePublishedDataSet(server, tmpPDS1->identifier);
     }
+
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+    UA_free(pubSubManager->fieldBuckets);
+    pubSubManager->fieldBuckets = NULL;
+    pubSubManager->fieldBucketsSize = 0;
+#endif
 }
 
 /***********************************/
@@ -313,6 +347,139 @@ UA_PubSubManager_delete(UA_Server *server, UA_PubSubManager *pubSubManager) {
 /* If UA_ENABLE_PUBSUB_CUSTOM_PUBLISH_HANDLING is enabled, a custom callback
  * management must be linked to the application */
 
+#ifdef UA_ENABLE_PUBSUB_THREADS
+
+/* CLOCK_TAI can be used instead if the system clock is synchronized to the
+ * network time (e.g. with TSN) */
+#ifndef UA_PUBSUB_THREAD_CLOCKID
+# define UA_PUBSUB_THREAD_CLOCKID CLOCK_MONOTONIC
+#endif
+
+/* Distinguishes the ids of the thread callbacks from the timer ids */
+#define UA_PUBSUB_THREAD_ID_FLAG ((UA_UInt64)1 << 63)
+
+/* Wake up at least every 100ms to see whether the thread shall stop */
+#define UA_PUBSUB_THREAD_MAXSLEEP 100000000 /* nsec */
+
+#define UA_NSEC_PER_SEC 1000000000
+
+struct UA_PubSubThread {
+    LIST_ENTRY(UA_PubSubThread) listEntry;
+    UA_UInt64 id;
+    UA_Server *server;
+    UA_ServerCallback callback;
+    void *data;
+    pthread_t thread;
+    pthread_mutex_t mutex; /* Protects the interval and the running flag */
+    UA_Int64 interval; /* nsec */
+    UA_Boolean running;
+};
+
+static UA_Int64
+threadClockNow(void) {
+    struct timespec ts;
+    clock_gettime(UA_PUBSUB_THREAD_CLOCKID, &ts);
+    return ((UA_Int64)ts.tv_sec * UA_NSEC_PER_SEC) + ts.tv_nsec;
+}
+
+static void
+threadClockSleepUntil(UA_Int64 time) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(time / UA_NSEC_PER_SEC);
+    ts.tv_nsec = (long)(time % UA_NSEC_PER_SEC);
+    clock_nanosleep(UA_PUBSUB_THREAD_CLOCKID, TIMER_ABSTIME, &ts, NULL);
+}
+
+/* The cycles are aligned to the start time of the thread. Cycles that are
+ * missed because the callback took too long are skipped. */
+static void *
+pubSubThreadLoop(void *arg) {
+    UA_PubSubThread *pt = (UA_PubSubThread*)arg;
+    UA_Int64 next = threadClockNow();
+    while(true) {
+        pthread_mutex_lock(&pt->mutex);
+        UA_Boolean running = pt->running;
+        UA_Int64 interval = pt->interval;
+        pthread_mutex_unlock(&pt->mutex);
+        if(!running)
+            break;
+
+        UA_Int64 now = threadClockNow();
+        if(now < next) {
+            if(next - now > UA_PUBSUB_THREAD_MAXSLEEP)
+                threadClockSleepUntil(now + UA_PUBSUB_THREAD_MAXSLEEP);
+            else
+                threadClockSleepUntil(next);
+            continue;
+        }
+
+        pt->callback(pt->server, pt->data);
+
+        next += interval;
+        now = threadClockNow();
+        if(next <= now)
+            next += (((now - next) / interval) + 1) * interval;
+    }
+    return NULL;
+}
+
+static UA_PubSubThread *
+findThread(UA_Server *server, UA_UInt64 callbackId) {
+    if(!(callbackId & UA_PUBSUB_THREAD_ID_FLAG))
+        return NULL;
+    UA_PubSubThread *pt;
+    LIST_FOREACH(pt, &server->pubSubManager.threads, listEntry) {
+        if(pt->id == callbackId)
+            return pt;
+    }
+    return NULL;
+}
+
+static void
+stopThread(UA_PubSubThread *pt) {
+    pthread_mutex_lock(&pt->mutex);
+    pt->running = false;
+    pthread_mutex_unlock(&pt->mutex);
+    pthread_join(pt->thread, NULL);
+    LIST_REMOVE(pt, listEntry);
+    pthread_mutex_destroy(&pt->mutex);
+    UA_free(pt);
+}
+
+UA_StatusCode
+UA_PubSubManager_addThreadCallback(UA_Server *server, UA_ServerCallback callback,
+                                   void *data, UA_Double interval_ms, UA_UInt64 *callbackId) {
+    /* The interval needs to be positive */
+    UA_Int64 interval = (UA_Int64)(interval_ms * 1000000.0);
+    if(interval <= 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_PubSubThread *pt = (UA_PubSubThread*)UA_calloc(1, sizeof(UA_PubSubThread));
+    if(!pt)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    pt->id = (++server->pubSubManager.threadIdCounter) | UA_PUBSUB_THREAD_ID_FLAG;
+    pt->server = server;
+    pt->callback = callback;
+    pt->data = data;
+    pt->interval = interval;
+    pt->running = true;
+    pthread_mutex_init(&pt->mutex, NULL);
+    if(pthread_create(&pt->thread, NULL, pubSubThreadLoop, pt) != 0) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                     "PubSub thread could not be started");
+        pthread_mutex_destroy(&pt->mutex);
+        UA_free(pt);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    LIST_INSERT_HEAD(&server->pubSubManager.threads, pt, listEntry);
+    if(callbackId)
+        *callbackId = pt->id;
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif /* UA_ENABLE_PUBSUB_THREADS */
+
 UA_StatusCode
 UA_PubSubManager_addRepeatedCallback(UA_Server *server, UA_ServerCallback callback,
                                      void *data, UA_Double interval_ms, UA_UInt64 *callbackId) {
@@ -323,11 +490,30 @@ UA_PubSubManager_addRepeatedCallback(UA_Server *server, UA_ServerCallback callba
 UA_StatusCode
 UA_PubSubManager_changeRepeatedCallbackInterval(UA_Server *server, UA_UInt64 callbackId,
                                                 UA_Double interval_ms) {
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    UA_PubSubThread *pt = findThread(server, callbackId);
+    if(pt) {
+        UA_Int64 interval = (UA_Int64)(interval_ms * 1000000.0);
+        if(interval <= 0)
+            return UA_STATUSCODE_BADINTERNALERROR;
+        pthread_mutex_lock(&pt->mutex);
+        pt->interval = interval;
+        pthread_mutex_unlock(&pt->mutex);
+        return UA_STATUSCODE_GOOD;
+    }
+#endif
     return UA_Timer_changeRepeatedCallbackInterval(&server->timer, callbackId, interval_ms);
 }
 
 void
 UA_PubSubManager_removeRepeatedPubSubCallback(UA_Server *server, UA_UInt64 callbackId) {
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    UA_PubSubThread *pt = findThread(server, callbackId);
+    if(pt) {
+        stopThread(pt);
+        return;
+    }
+#endif
     UA_Timer_removeCallback(&server->timer, callbackId);
 }
 
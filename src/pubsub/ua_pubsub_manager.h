@@ -16,12 +16,28 @@ _UA_BEGIN_DECLS
 
 #ifdef UA_ENABLE_PUBSUB /* conditional compilation */
 
+#ifdef UA_ENABLE_PUBSUB_THREADS
+typedef struct UA_PubSubThread UA_PubSubThread;
+#endif
+
 typedef struct UA_PubSubManager{
     //Connections and PublishedDataSets can exist alone (own lifecycle) -> top level components
     size_t connectionsSize;
     TAILQ_HEAD(UA_ListOfPubSubConnection, UA_PubSubConnection) connections;
     size_t publishedDataSetsSize;
     TAILQ_HEAD(UA_ListOfPublishedDataSet, UA_PublishedDataSet) publishedDataSets;
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+    /* The tracked DataSetFields of all PublishedDataSets by the NodeId of the
+     * published variable. The size is a power of two. */
+    UA_DataSetFieldBucket *fieldBuckets;
+    size_t fieldBucketsSize;
+    size_t trackedFieldsCount;
+#endif
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    /* Groups that run in a dedicated thread */
+    LIST_HEAD(UA_ListOfPubSubThread, UA_PubSubThread) threads;
+    UA_UInt64 threadIdCounter;
+#endif
 } UA_PubSubManager;
 
 void
@@ -45,6 +61,16 @@ UA_PubSubManager_changeRepeatedCallbackInterval(UA_Server *server, UA_UInt64 cal
 void
 UA_PubSubManager_removeRepeatedPubSubCallback(UA_Server *server, UA_UInt64 callbackId);
 
+#ifdef UA_ENABLE_PUBSUB_THREADS
+/* Execute the callback in a dedicated thread that sleeps on its own clock
+ * between the cycles. The first execution is immediate. The returned
+ * callbackId is used with the functions above. Removing the callback waits
+ * until the thread has finished. */
+UA_StatusCode
+UA_PubSubManager_addThreadCallback(UA_Server *server, UA_ServerCallback callback,
+                                   void *data, UA_Double interval_ms, UA_UInt64 *callbackId);
+#endif
+
 #endif /* UA_ENABLE_PUBSUB */
 
 _UA_END_DECLS
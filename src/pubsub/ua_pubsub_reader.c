@@ -18,9 +18,7 @@
 #include "ua_pubsub_ns0.h"
 #endif
 
-#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
 #include "ua_types_encoding_binary.h"
-#endif
 
 #define UA_MAX_SIZENAME 64  /* Max size of Qualified Name of Subscribed Variable */
 
@@ -61,6 +59,7 @@ UA_Server_addReaderGroup(UA_Server *server, UA_NodeId connectionIdentifier,
 
     /* Deep copy of the config */
     retval |= UA_ReaderGroupConfig_copy(readerGroupConfig, &newGroup->config);
+    newGroup->config.configurationFrozen = false;
     retval |= UA_ReaderGroup_addSubscribeCallback(server, newGroup);
     LIST_INSERT_HEAD(&currentConnectionContext->readerGroups, newGroup, listEntry);
     currentConnectionContext->readerGroupsSize++;
@@ -79,6 +78,12 @@ UA_Server_removeReaderGroup(UA_Server *server, UA_NodeId groupIdentifier) {
         return UA_STATUSCODE_BADNOTFOUND;
     }
 
+    if(readerGroup->config.configurationFrozen) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Delete ReaderGroup failed. ReaderGroup is frozen.");
+        return UA_STATUSCODE_BADCONFIGURATIONERROR;
+    }
+
     /* Search the connection to which the given readergroup is connected to */
     UA_PubSubConnection *connection =
         UA_PubSubConnection_findConnectionbyId(server, readerGroup->linkedConnection);
@@ -152,87 +157,466 @@ UA_ReaderGroupConfig_copy(const UA_ReaderGroupConfig *src,
                           UA_ReaderGroupConfig *dst) {
     /* Currently simple memcpy only */
     memcpy(&dst->securityParameters, &src->securityParameters, sizeof(UA_PubSubSecurityParameters));
+    dst->configurationFrozen = src->configurationFrozen;
+    dst->rtLevel = src->rtLevel;
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    dst->dedicatedThread = src->dedicatedThread;
+#endif
     UA_String_copy(&src->name, &dst->name);
     return UA_STATUSCODE_GOOD;
 }
 
+/*******************************/
+/* Fixed-Size RealTime Reading */
+/*******************************/
+
+static void
+DataSetReaderLayout_clear(UA_DataSetReaderLayout *layout) {
+    UA_free(layout->fieldTypes);
+    UA_free(layout->fieldOffsets);
+    UA_ByteString_clear(&layout->messageTemplate);
+    UA_free(layout->staticSegments);
+    memset(layout, 0, sizeof(UA_DataSetReaderLayout));
+}
+
+/* Builtin types with a fixed encoded size */
+static UA_Boolean
+isFixedSizeType(const UA_DataType *type) {
+    return (type->pointerFree && type->typeKind <= UA_DATATYPEKIND_STATUSCODE);
+}
+
+/* Take the field types from the DataSetMetaData. The offsets are set when the
+ * first message arrives. */
 static UA_StatusCode
-checkReaderIdentifier(UA_Server *server, UA_NetworkMessage *pMsg, UA_DataSetReader *reader) {
-    if(!pMsg->groupHeaderEnabled &&
-       !pMsg->groupHeader.writerGroupIdEnabled &&
-       !pMsg->payloadHeaderEnabled) {
-        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                    "Cannot process DataSetReader without WriterGroup"
-                    "and DataSetWriter identifiers");
-        return UA_STATUSCODE_BADNOTIMPLEMENTED;
+DataSetReaderLayout_prepare(UA_Server *server, UA_DataSetReader *dsr) {
+    const UA_DataSetMetaDataType *metaData = &dsr->config.dataSetMetaData;
+    if(metaData->fieldsSize == 0 || !dsr->config.staticValueTargets) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "PubSub-RT configuration fail: DataSetReader without "
+                       "static value targets.");
+        return UA_STATUSCODE_BADNOTSUPPORTED;
     }
 
-    if((reader->config.writerGroupId == pMsg->groupHeader.writerGroupId) &&
-       (reader->config.dataSetWriterId == *pMsg->payloadHeader.dataSetPayloadHeader.dataSetWriterIds)) {
-        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                     "DataSetReader found. Process NetworkMessage");
+    UA_DataSetReaderLayout *layout = &dsr->layout;
+    layout->fieldTypes = (const UA_DataType**)
+        UA_calloc(metaData->fieldsSize, sizeof(UA_DataType*));
+    layout->fieldOffsets = (size_t*)UA_calloc(metaData->fieldsSize, sizeof(size_t));
+    if(!layout->fieldTypes || !layout->fieldOffsets) {
+        DataSetReaderLayout_clear(layout);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    for(size_t i = 0; i < metaData->fieldsSize; i++) {
+        const UA_FieldMetaData *field = &metaData->fields[i];
+        const UA_DataType *type = UA_findDataType(&field->dataType);
+        if(!type || !isFixedSizeType(type) || field->valueRank != UA_VALUERANK_SCALAR) {
+            UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                           "PubSub-RT configuration fail: DataSetMetaData contains "
+                           "fields with dynamic length types.");
+            DataSetReaderLayout_clear(layout);
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        }
+        if(!UA_Variant_hasScalarType(&dsr->config.staticValueTargets[i].value, type)) {
+            UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                           "PubSub-RT configuration fail: Static value target %lu "
+                           "does not match the DataSetMetaData.", (unsigned long)i);
+            DataSetReaderLayout_clear(layout);
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        }
+        layout->fieldTypes[i] = type;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Copy the field values into the static value targets if the message matches
+ * the template */
+static UA_StatusCode
+DataSetReaderLayout_process(UA_DataSetReader *dsr, const UA_ByteString *buffer) {
+    const UA_DataSetReaderLayout *layout = &dsr->layout;
+    if(layout->messageTemplate.length == 0 ||
+       buffer->length != layout->messageTemplate.length)
+        return UA_STATUSCODE_BADNOMATCH;
+
+    for(size_t i = 0; i < layout->staticSegmentsSize; i++) {
+        const UA_DataSetReaderSegment *seg = &layout->staticSegments[i];
+        if(memcmp(&buffer->data[seg->offset],
+                  &layout->messageTemplate.data[seg->offset], seg->length) != 0)
+            return UA_STATUSCODE_BADNOMATCH;
+    }
+
+    for(size_t i = 0; i < dsr->config.dataSetMetaData.fieldsSize; i++) {
+        const UA_DataType *type = layout->fieldTypes[i];
+        UA_DataValue *target = &dsr->config.staticValueTargets[i];
+        if(type->overlayable) {
+            memcpy(target->value.data, &buffer->data[layout->fieldOffsets[i]],
+                   type->memSize);
+        } else {
+            size_t offset = layout->fieldOffsets[i];
+            UA_StatusCode res =
+                UA_decodeBinary(buffer, &offset, target->value.data, type, NULL);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+        }
+        target->hasValue = true;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Use the first decoded message as the template. Only unsecured messages with
+ * a single keyframe and the fields encoded as Variant have a fixed layout. The
+ * DataSetMessage header must not contain a timestamp or status. */
+static UA_StatusCode
+DataSetReaderLayout_learn(UA_DataSetReader *dsr, UA_NetworkMessage *msg,
+                          const UA_ByteString *buffer) {
+    UA_DataSetReaderLayout *layout = &dsr->layout;
+    size_t fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+    if(msg->securityEnabled || msg->promotedFieldsEnabled ||
+       msg->networkMessageType != UA_NETWORKMESSAGE_DATASET ||
+       (msg->payloadHeaderEnabled && msg->payloadHeader.dataSetPayloadHeader.count != 1))
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    UA_DataSetMessage *dsm = &msg->payload.dataSetPayload.dataSetMessages[0];
+    if(dsm->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME ||
+       dsm->header.fieldEncoding != UA_FIELDENCODING_VARIANT ||
+       dsm->header.timestampEnabled || dsm->header.picoSecondsIncluded ||
+       dsm->header.statusEnabled || dsm->data.keyFrameData.fieldCount != fieldsSize)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    for(size_t i = 0; i < fieldsSize; i++) {
+        const UA_Variant *v = &dsm->data.keyFrameData.dataSetFields[i].value;
+        if(!UA_Variant_isScalar(v) || v->type->typeKind != layout->fieldTypes[i]->typeKind)
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+
+    /* Get the offsets of the parts that change between messages. They are
+     * ordered by their position in the message. */
+    UA_NetworkMessageOffsetBuffer ob;
+    memset(&ob, 0, sizeof(UA_NetworkMessageOffsetBuffer));
+    size_t size = UA_NetworkMessage_calcSizeBinary(msg, &ob);
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    layout->staticSegments = (UA_DataSetReaderSegment*)
+        UA_calloc(ob.offsetsSize + 1, sizeof(UA_DataSetReaderSegment));
+    if(size != buffer->length || !layout->staticSegments) {
+        res = UA_STATUSCODE_BADNOTSUPPORTED;
+        goto cleanup;
+    }
+
+    size_t pos = 0, field = 0;
+    for(size_t i = 0; i < ob.offsetsSize; i++) {
+        const UA_NetworkMessageOffset *o = &ob.offsets[i];
+        size_t length = 0;
+        switch(o->contentType) {
+        case UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
+        case UA_PUBSUB_OFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
+        case UA_PUBSUB_OFFSETTYPE_TIMESTAMP_PICOSECONDS:
+            length = sizeof(UA_UInt16);
+            break;
+        case UA_PUBSUB_OFFSETTYPE_TIMESTAMP:
+            length = sizeof(UA_DateTime);
+            break;
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT: {
+            /* The encoding byte of the Variant is static */
+            const UA_Variant *v = &o->offsetData.value.value->value;
+            layout->fieldOffsets[field] = o->offset + 1;
+            length = 1 + UA_calcSizeBinary(v->data, v->type);
+            field++;
+            break;
+        }
+        default:
+            res = UA_STATUSCODE_BADNOTSUPPORTED;
+            goto cleanup;
+        }
+        if(o->offset > pos) {
+            UA_DataSetReaderSegment *seg = &layout->staticSegments[layout->staticSegmentsSize];
+            seg->offset = pos;
+            seg->length = o->offset - pos;
+            layout->staticSegmentsSize++;
+        }
+        pos = o->offset + length;
+    }
+    if(pos < size) {
+        UA_DataSetReaderSegment *seg = &layout->staticSegments[layout->staticSegmentsSize];
+        seg->offset = pos;
+        seg->length = size - pos;
+        layout->staticSegmentsSize++;
+    }
+
+    if(field != fieldsSize || pos > size) {
+        res = UA_STATUSCODE_BADNOTSUPPORTED;
+        goto cleanup;
+    }
+    res = UA_ByteString_copy(buffer, &layout->messageTemplate);
+
+ cleanup:
+    for(size_t i = 0; i < ob.offsetsSize; i++) {
+        switch(ob.offsets[i].contentType) {
+        case UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
+        case UA_PUBSUB_OFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT:
+            /* Points into the message */
+            UA_free(ob.offsets[i].offsetData.value.value);
+            break;
+        default:
+            break;
+        }
+    }
+    UA_free(ob.offsets);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_free(layout->staticSegments);
+        layout->staticSegments = NULL;
+        layout->staticSegmentsSize = 0;
+    }
+    return res;
+}
+
+/* A group with a dedicated thread moves into the thread when it is frozen and
+ * back to the main loop when it is unfrozen. Also the layouts must not change
+ * while the thread decodes messages with them. So the callback is stopped
+ * and added again afterwards. */
+static UA_Boolean
+ReaderGroup_stopThread(UA_Server *server, UA_ReaderGroup *rg) {
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    if(rg->config.dedicatedThread && rg->subscribeCallbackIsRegistered) {
+        UA_PubSubManager_removeRepeatedPubSubCallback(server, rg->subscribeCallbackId);
+        rg->subscribeCallbackIsRegistered = false;
+        return true;
+    }
+#endif
+    return false;
+}
+
+UA_StatusCode
+UA_Server_freezeReaderGroupConfiguration(UA_Server *server, const UA_NodeId readerGroup) {
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroup);
+    if(!rg)
+        return UA_STATUSCODE_BADNOTFOUND;
+    if(rg->config.configurationFrozen)
         return UA_STATUSCODE_GOOD;
+
+    UA_Boolean restart = ReaderGroup_stopThread(server, rg);
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_DataSetReader *dsr;
+    if(rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+        LIST_FOREACH(dsr, &rg->readers, listEntry) {
+            res = DataSetReaderLayout_prepare(server, dsr);
+            if(res != UA_STATUSCODE_GOOD)
+                break;
+        }
     }
 
-    return UA_STATUSCODE_BADNOTFOUND;
+    if(res == UA_STATUSCODE_GOOD) {
+        rg->config.configurationFrozen = true;
+        LIST_FOREACH(dsr, &rg->readers, listEntry)
+            dsr->config.configurationFrozen = true;
+    } else {
+        LIST_FOREACH(dsr, &rg->readers, listEntry)
+            DataSetReaderLayout_clear(&dsr->layout);
+    }
+
+    if(restart)
+        UA_ReaderGroup_addSubscribeCallback(server, rg);
+    return res;
+}
+
+UA_StatusCode
+UA_Server_unfreezeReaderGroupConfiguration(UA_Server *server, const UA_NodeId readerGroup) {
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroup);
+    if(!rg)
+        return UA_STATUSCODE_BADNOTFOUND;
+    UA_Boolean restart = ReaderGroup_stopThread(server, rg);
+    rg->config.configurationFrozen = false;
+    UA_DataSetReader *dsr;
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        dsr->config.configurationFrozen = false;
+        DataSetReaderLayout_clear(&dsr->layout);
+    }
+    if(restart)
+        UA_ReaderGroup_addSubscribeCallback(server, rg);
+    return UA_STATUSCODE_GOOD;
+}
+
+/*********************************/
+/* Lookup of DataSetReaders      */
+/*********************************/
+
+#define UA_READERBUCKETS_INITIAL 16
+
+/* The type of the PublisherId is part of the hash */
+static UA_UInt32
+readerIdentifierHash(UA_PublisherIdDatatype publisherIdType, const UA_Byte *publisherId,
+                     size_t publisherIdSize, UA_UInt16 writerGroupId,
+                     UA_UInt16 dataSetWriterId) {
+    UA_Byte type = (UA_Byte)publisherIdType;
+    UA_UInt32 h = UA_ByteString_hash(0, &type, 1);
+    h = UA_ByteString_hash(h, publisherId, publisherIdSize);
+    h = UA_ByteString_hash(h, (const UA_Byte*)&writerGroupId, sizeof(UA_UInt16));
+    return UA_ByteString_hash(h, (const UA_Byte*)&dataSetWriterId, sizeof(UA_UInt16));
 }
 
+static UA_UInt32
+DataSetReader_identifierHash(const UA_DataSetReader *dsr) {
+    const UA_Variant *publisherId = &dsr->config.publisherId;
+    UA_PublisherIdDatatype publisherIdType = UA_PUBLISHERDATATYPE_BYTE;
+    const UA_Byte *data = (const UA_Byte*)publisherId->data;
+    size_t size = 0;
+    if(publisherId->type == &UA_TYPES[UA_TYPES_STRING]) {
+        const UA_String *str = (const UA_String*)publisherId->data;
+        publisherIdType = UA_PUBLISHERDATATYPE_STRING;
+        data = str->data;
+        size = str->length;
+    } else if(publisherId->type == &UA_TYPES[UA_TYPES_BYTE]) {
+        size = sizeof(UA_Byte);
+    } else if(publisherId->type == &UA_TYPES[UA_TYPES_UINT16]) {
+        publisherIdType = UA_PUBLISHERDATATYPE_UINT16;
+        size = sizeof(UA_UInt16);
+    } else if(publisherId->type == &UA_TYPES[UA_TYPES_UINT32]) {
+        publisherIdType = UA_PUBLISHERDATATYPE_UINT32;
+        size = sizeof(UA_UInt32);
+    } else if(publisherId->type == &UA_TYPES[UA_TYPES_UINT64]) {
+        publisherIdType = UA_PUBLISHERDATATYPE_UINT64;
+        size = sizeof(UA_UInt64);
+    }
+    return readerIdentifierHash(publisherIdType, data, size,
+                                dsr->config.writerGroupId, dsr->config.dataSetWriterId);
+}
+
+static UA_UInt32
+NetworkMessage_readerHash(const UA_NetworkMessage *pMsg) {
+    const UA_Byte *data = NULL;
+    size_t size = 0;
+    switch(pMsg->publisherIdType) {
+    case UA_PUBLISHERDATATYPE_BYTE:
+        data = &pMsg->publisherId.publisherIdByte;
+        size = sizeof(UA_Byte);
+        break;
+    case UA_PUBLISHERDATATYPE_UINT16:
+        data = (const UA_Byte*)&pMsg->publisherId.publisherIdUInt16;
+        size = sizeof(UA_UInt16);
+        break;
+    case UA_PUBLISHERDATATYPE_UINT32:
+        data = (const UA_Byte*)&pMsg->publisherId.publisherIdUInt32;
+        size = sizeof(UA_UInt32);
+        break;
+    case UA_PUBLISHERDATATYPE_UINT64:
+        data = (const UA_Byte*)&pMsg->publisherId.publisherIdUInt64;
+        size = sizeof(UA_UInt64);
+        break;
+    case UA_PUBLISHERDATATYPE_STRING:
+        data = pMsg->publisherId.publisherIdString.data;
+        size = pMsg->publisherId.publisherIdString.length;
+        break;
+    default:
+        break;
+    }
+    return readerIdentifierHash(pMsg->publisherIdType, data, size,
+                                pMsg->groupHeader.writerGroupId,
+                                *pMsg->payloadHeader.dataSetPayloadHeader.dataSetWriterIds);
+}
+
+static UA_DataSetReaderBucket *
+getReaderBucket(UA_PubSubConnection *connection, UA_UInt32 hash) {
+    return &connection->readerBuckets[hash & (connection->readerBucketsSize - 1)];
+}
+
+/* Double the number of buckets and rehash the DataSetReaders */
 static UA_StatusCode
-getReaderFromIdentifier(UA_Server *server, UA_NetworkMessage *pMsg,
-                        UA_DataSetReader **dataSetReader, UA_PubSubConnection *pConnection) {
-    UA_StatusCode retval = UA_STATUSCODE_BADNOTFOUND;
+growReaderBuckets(UA_PubSubConnection *connection) {
+    size_t newSize = (connection->readerBucketsSize == 0) ?
+        UA_READERBUCKETS_INITIAL : connection->readerBucketsSize * 2;
+    UA_DataSetReaderBucket *buckets = (UA_DataSetReaderBucket*)
+        UA_calloc(newSize, sizeof(UA_DataSetReaderBucket));
+    if(!buckets)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_free(connection->readerBuckets);
+    connection->readerBuckets = buckets;
+    connection->readerBucketsSize = newSize;
+    UA_ReaderGroup *readerGroup;
+    LIST_FOREACH(readerGroup, &connection->readerGroups, listEntry) {
+        UA_DataSetReader *dsr;
+        LIST_FOREACH(dsr, &readerGroup->readers, listEntry)
+            LIST_INSERT_HEAD(&getReaderBucket(connection, dsr->identifierHash)->readers,
+                             dsr, hashEntry);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The hash is computed from the current config */
+static void
+indexDataSetReader(UA_PubSubConnection *connection, UA_DataSetReader *dsr) {
+    dsr->identifierHash = DataSetReader_identifierHash(dsr);
+    LIST_INSERT_HEAD(&getReaderBucket(connection, dsr->identifierHash)->readers,
+                     dsr, hashEntry);
+}
+
+static UA_Boolean
+matchesPublisherId(const UA_NetworkMessage *pMsg, const UA_DataSetReader *dsr) {
+    const UA_Variant *publisherId = &dsr->config.publisherId;
+    switch (pMsg->publisherIdType) {
+    case UA_PUBLISHERDATATYPE_BYTE:
+        return (publisherId->type == &UA_TYPES[UA_TYPES_BYTE] &&
+                pMsg->publisherId.publisherIdByte == *(UA_Byte*)publisherId->data);
+    case UA_PUBLISHERDATATYPE_UINT16:
+        return (publisherId->type == &UA_TYPES[UA_TYPES_UINT16] &&
+                pMsg->publisherId.publisherIdUInt16 == *(UA_UInt16*)publisherId->data);
+    case UA_PUBLISHERDATATYPE_UINT32:
+        return (publisherId->type == &UA_TYPES[UA_TYPES_UINT32] &&
+                pMsg->publisherId.publisherIdUInt32 == *(UA_UInt32*)publisherId->data);
+    case UA_PUBLISHERDATATYPE_UINT64:
+        return (publisherId->type == &UA_TYPES[UA_TYPES_UINT64] &&
+                pMsg->publisherId.publisherIdUInt64 == *(UA_UInt64*)publisherId->data);
+    case UA_PUBLISHERDATATYPE_STRING:
+        return (publisherId->type == &UA_TYPES[UA_TYPES_STRING] &&
+                UA_String_equal(&pMsg->publisherId.publisherIdString,
+                                (UA_String*)publisherId->data));
+    default:
+        return false;
+    }
+}
+
+static UA_Boolean
+matchesReader(const UA_NetworkMessage *pMsg, const UA_DataSetReader *dsr) {
+    return (dsr->config.writerGroupId == pMsg->groupHeader.writerGroupId &&
+            dsr->config.dataSetWriterId ==
+            *pMsg->payloadHeader.dataSetPayloadHeader.dataSetWriterIds &&
+            matchesPublisherId(pMsg, dsr));
+}
+
+static UA_StatusCode
+checkReaderIdentifier(UA_Server *server, const UA_NetworkMessage *pMsg) {
     if(!pMsg->publisherIdEnabled) {
         UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
                     "Cannot process DataSetReader without PublisherId");
         return UA_STATUSCODE_BADNOTIMPLEMENTED; /* TODO: Handle DSR without PublisherId */
     }
 
-    UA_ReaderGroup* readerGroup;
-    LIST_FOREACH(readerGroup, &pConnection->readerGroups, listEntry) {
-        UA_DataSetReader *tmpReader;
-        LIST_FOREACH(tmpReader, &readerGroup->readers, listEntry) {
-            switch (pMsg->publisherIdType) {
-            case UA_PUBLISHERDATATYPE_BYTE:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_BYTE] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_BYTE &&
-                   pMsg->publisherId.publisherIdByte == *(UA_Byte*)tmpReader->config.publisherId.data) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            case UA_PUBLISHERDATATYPE_UINT16:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_UINT16] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_UINT16 &&
-                   pMsg->publisherId.publisherIdUInt16 == *(UA_UInt16*) tmpReader->config.publisherId.data) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            case UA_PUBLISHERDATATYPE_UINT32:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_UINT32] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_UINT32 &&
-                   pMsg->publisherId.publisherIdUInt32 == *(UA_UInt32*)tmpReader->config.publisherId.data) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            case UA_PUBLISHERDATATYPE_UINT64:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_UINT64] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_UINT64 &&
-                   pMsg->publisherId.publisherIdUInt64 == *(UA_UInt64*)tmpReader->config.publisherId.data) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            case UA_PUBLISHERDATATYPE_STRING:
-                if(tmpReader->config.publisherId.type == &UA_TYPES[UA_TYPES_STRING] &&
-                   pMsg->publisherIdType == UA_PUBLISHERDATATYPE_STRING &&
-                   UA_String_equal(&pMsg->publisherId.publisherIdString,
-                                   (UA_String*)tmpReader->config.publisherId.data)) {
-                    retval = checkReaderIdentifier(server, pMsg, tmpReader);
-                }
-                break;
-            default:
-                return UA_STATUSCODE_BADINTERNALERROR;
-            }
+    if((!pMsg->groupHeaderEnabled && !pMsg->groupHeader.writerGroupIdEnabled &&
+        !pMsg->payloadHeaderEnabled) ||
+       !pMsg->payloadHeader.dataSetPayloadHeader.dataSetWriterIds) {
+        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                    "Cannot process DataSetReader without WriterGroup"
+                    "and DataSetWriter identifiers");
+        return UA_STATUSCODE_BADNOTIMPLEMENTED;
+    }
 
-            if(retval == UA_STATUSCODE_GOOD) {
+    if(pMsg->publisherIdType > UA_PUBLISHERDATATYPE_STRING)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+getReaderFromIdentifier(UA_Server *server, UA_NetworkMessage *pMsg,
+                        UA_DataSetReader **dataSetReader, UA_PubSubConnection *pConnection) {
+    UA_StatusCode retval = checkReaderIdentifier(server, pMsg);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    if(pConnection->readerBucketsSize > 0) {
+        UA_UInt32 hash = NetworkMessage_readerHash(pMsg);
+        UA_DataSetReader *tmpReader;
+        LIST_FOREACH(tmpReader, &getReaderBucket(pConnection, hash)->readers, hashEntry) {
+            if(tmpReader->identifierHash == hash && matchesReader(pMsg, tmpReader)) {
+                UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                             "DataSetReader found. Process NetworkMessage");
                 *dataSetReader = tmpReader;
                 return UA_STATUSCODE_GOOD;
             }
@@ -275,11 +659,33 @@ UA_DataSetReader *UA_ReaderGroup_findDSRbyId(UA_Server *server, UA_NodeId identi
     return NULL;
 }
 
+typedef struct {
+    UA_Server *server;
+    UA_PubSubConnection *connection;
+    UA_ReaderGroup *readerGroup; /* Only set in the dedicated thread */
+} UA_ReceiveContext;
+
+static UA_StatusCode
+decodeAndProcessNetworkMessage(UA_PubSubChannel *channel, void *callbackContext,
+                               const UA_ByteString *buffer) {
+    UA_ReceiveContext *ctx = (UA_ReceiveContext*)callbackContext;
+    UA_LOG_DEBUG(&ctx->server->config.logger, UA_LOGCATEGORY_USERLAND, "Message received:");
+    return UA_Server_processNetworkMessageBinary(ctx->server, buffer, ctx->connection);
+}
+
 /* This callback triggers the collection and reception of NetworkMessages and the
- * contained DataSetMessages. */
+ * contained DataSetMessages. If the channel supports it, all messages that
+ * arrived since the last call are received and processed as a batch. */
 void UA_ReaderGroup_subscribeCallback(UA_Server *server, UA_ReaderGroup *readerGroup) {
     UA_PubSubConnection *connection =
         UA_PubSubConnection_findConnectionbyId(server, readerGroup->linkedConnection);
+    UA_ReceiveContext ctx = {server, connection, NULL};
+    if(connection->channel->receiveBatch) {
+        connection->channel->receiveBatch(connection->channel, NULL,
+                                          decodeAndProcessNetworkMessage, &ctx, 1000);
+        return;
+    }
+
     UA_ByteString buffer;
     if(UA_ByteString_allocBuffer(&buffer, 512) != UA_STATUSCODE_GOOD) {
         UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER, "Message buffer alloc failed!");
@@ -287,24 +693,41 @@ void UA_ReaderGroup_subscribeCallback(UA_Server *server, UA_ReaderGroup *readerG
     }
 
     connection->channel->receive(connection->channel, &buffer, NULL, 1000);
-    if(buffer.length > 0) {
-        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_USERLAND, "Message received:");
-        UA_NetworkMessage currentNetworkMessage;
-        memset(&currentNetworkMessage, 0, sizeof(UA_NetworkMessage));
-        size_t currentPosition = 0;
-        UA_NetworkMessage_decodeBinary(&buffer, &currentPosition, &currentNetworkMessage);
-        UA_Server_processNetworkMessage(server, &currentNetworkMessage, connection);
-        UA_NetworkMessage_deleteMembers(&currentNetworkMessage);
-    }
+    if(buffer.length > 0)
+        decodeAndProcessNetworkMessage(connection->channel, &ctx, &buffer);
 
     UA_ByteString_deleteMembers(&buffer);
 }
 
 /* Add new subscribeCallback. The first execution is triggered directly after
  * creation. */
+#ifdef UA_ENABLE_PUBSUB_THREADS
+static void
+ReaderGroup_subscribeCallbackThread(UA_Server *server, UA_ReaderGroup *readerGroup);
+#endif
+
 UA_StatusCode
 UA_ReaderGroup_addSubscribeCallback(UA_Server *server, UA_ReaderGroup *readerGroup) {
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    /* Only a frozen RT group can run without the service mutex. Otherwise the
+     * group is run by the server main loop until it is frozen. The thread
+     * runs the first cycle right away. */
+    if(readerGroup->config.dedicatedThread &&
+       readerGroup->config.configurationFrozen &&
+       readerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+        readerGroup->threadConnection =
+            UA_PubSubConnection_findConnectionbyId(server, readerGroup->linkedConnection);
+        if(!readerGroup->threadConnection)
+            return UA_STATUSCODE_BADNOTFOUND;
+        retval = UA_PubSubManager_addThreadCallback(server,
+                                                    (UA_ServerCallback) ReaderGroup_subscribeCallbackThread,
+                                                    readerGroup, 5, &readerGroup->subscribeCallbackId);
+        if(retval == UA_STATUSCODE_GOOD)
+            readerGroup->subscribeCallbackIsRegistered = true;
+        return retval;
+    }
+#endif
     retval |= UA_PubSubManager_addRepeatedCallback(server,
                                                    (UA_ServerCallback) UA_ReaderGroup_subscribeCallback,
                                                    readerGroup, 5, &readerGroup->subscribeCallbackId);
@@ -337,6 +760,25 @@ UA_Server_addDataSetReader(UA_Server *server, UA_NodeId readerGroupIdentifier,
         return UA_STATUSCODE_BADNOTFOUND;
     }
 
+    if(readerGroup->config.configurationFrozen) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Add DataSetReader failed. ReaderGroup is frozen.");
+        return UA_STATUSCODE_BADCONFIGURATIONERROR;
+    }
+
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, readerGroup->linkedConnection);
+    if(!connection) {
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+
+    if(connection->readersCount >= connection->readerBucketsSize) {
+        UA_StatusCode retval = growReaderBuckets(connection);
+        if(retval != UA_STATUSCODE_GOOD) {
+            return retval;
+        }
+    }
+
     /* Allocate memory for new DataSetReader */
     UA_DataSetReader *newDataSetReader = (UA_DataSetReader *)UA_calloc(1, sizeof(UA_DataSetReader));
     /* Copy the config into the new dataSetReader */
@@ -350,6 +792,8 @@ UA_Server_addDataSetReader(UA_Server *server, UA_NodeId readerGroupIdentifier,
     /* Add the new reader to the group */
     LIST_INSERT_HEAD(&readerGroup->readers, newDataSetReader, listEntry);
     readerGroup->readersCount++;
+    indexDataSetReader(connection, newDataSetReader);
+    connection->readersCount++;
 
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
     addDataSetReaderRepresentation(server, newDataSetReader);
@@ -366,6 +810,12 @@ UA_Server_removeDataSetReader(UA_Server *server, UA_NodeId readerIdentifier) {
         return UA_STATUSCODE_BADNOTFOUND;
     }
 
+    if(dataSetReader->config.configurationFrozen) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Remove DataSetReader failed. DataSetReader is frozen.");
+        return UA_STATUSCODE_BADCONFIGURATIONERROR;
+    }
+
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
     removeDataSetReaderRepresentation(server, dataSetReader);
 #endif
@@ -390,11 +840,24 @@ UA_Server_DataSetReader_updateConfig(UA_Server *server, UA_NodeId dataSetReaderI
        return UA_STATUSCODE_BADNOTFOUND;
     }
 
+    if(currentDataSetReader->config.configurationFrozen) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Update DataSetReader config failed. DataSetReader is frozen.");
+        return UA_STATUSCODE_BADCONFIGURATIONERROR;
+    }
+
     /* The update functionality will be extended during the next PubSub batches.
      * Currently is only a change of the publishing interval possible. */
     if(currentDataSetReader->config.writerGroupId != config->writerGroupId) {
        UA_PubSubManager_removeRepeatedPubSubCallback(server, currentReaderGroup->subscribeCallbackId);
        currentDataSetReader->config.writerGroupId = config->writerGroupId;
+       /* Rehash with the new identifier */
+       UA_ReaderGroup *linkedReaderGroup =
+           UA_ReaderGroup_findRGbyId(server, currentDataSetReader->linkedReaderGroup);
+       UA_PubSubConnection *connection =
+           UA_PubSubConnection_findConnectionbyId(server, linkedReaderGroup->linkedConnection);
+       LIST_REMOVE(currentDataSetReader, hashEntry);
+       indexDataSetReader(connection, currentDataSetReader);
        UA_ReaderGroup_subscribeCallback(server, currentReaderGroup);
     }
     else {
@@ -461,6 +924,9 @@ UA_DataSetReaderConfig_copy(const UA_DataSetReaderConfig *src,
     	return retVal;
     }
 
+    /* The static value targets are owned by the user */
+    dst->staticValueTargets = src->staticValueTargets;
+    dst->configurationFrozen = src->configurationFrozen;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -660,12 +1126,19 @@ void UA_DataSetReader_delete(UA_Server *server, UA_DataSetReader *dataSetReader)
     UA_UadpDataSetReaderMessageDataType_deleteMembers(&dataSetReader->config.messageSettings);
     UA_ExtensionObject_clear(&dataSetReader->config.transportSettings);
     UA_TargetVariablesDataType_deleteMembers(&dataSetReader->subscribedDataSetTarget);
+    DataSetReaderLayout_clear(&dataSetReader->layout);
 
     /* Delete DataSetReader */
     UA_ReaderGroup* pGroup = UA_ReaderGroup_findRGbyId(server, dataSetReader->linkedReaderGroup);
     if(pGroup != NULL) {
         pGroup->readersCount--;
+        UA_PubSubConnection *pConn =
+            UA_PubSubConnection_findConnectionbyId(server, pGroup->linkedConnection);
+        if(pConn != NULL) {
+            pConn->readersCount--;
+        }
     }
+    LIST_REMOVE(dataSetReader, hashEntry);
 
     UA_NodeId_deleteMembers(&dataSetReader->identifier);
     UA_NodeId_deleteMembers(&dataSetReader->linkedReaderGroup);
@@ -675,9 +1148,36 @@ void UA_DataSetReader_delete(UA_Server *server, UA_DataSetReader *dataSetReader)
     UA_free(dataSetReader);
 }
 
-UA_StatusCode
-UA_Server_processNetworkMessage(UA_Server *server, UA_NetworkMessage *pMsg,
-                                UA_PubSubConnection *pConnection) {
+/* The encoded message is used as the template for frozen RT DataSetReaders
+ * that have not received a message yet. Can be NULL. */
+static UA_StatusCode
+processReaderMessage(UA_Server *server, UA_DataSetReader *dataSetReader,
+                     UA_NetworkMessage *pMsg, const UA_ByteString *buffer) {
+    /* Take the message as the template for the RT layout. Then the values
+     * are copied into the static value targets from now on. */
+    if(buffer && dataSetReader->layout.fieldTypes &&
+       dataSetReader->layout.messageTemplate.length == 0) {
+        UA_StatusCode retval = DataSetReaderLayout_learn(dataSetReader, pMsg, buffer);
+        if(retval == UA_STATUSCODE_GOOD)
+            return DataSetReaderLayout_process(dataSetReader, buffer);
+        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                     "NetworkMessage has no fixed layout");
+    }
+
+    UA_Byte anzDataSets = 1;
+    if(pMsg->payloadHeaderEnabled)
+        anzDataSets = pMsg->payloadHeader.dataSetPayloadHeader.count;
+    for(UA_Byte iterator = 0; iterator < anzDataSets; iterator++) {
+        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER, "Process Msg with DataSetReader!");
+        UA_Server_DataSetReader_process(server, dataSetReader,
+                                        &pMsg->payload.dataSetPayload.dataSetMessages[iterator]);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+processNetworkMessage(UA_Server *server, UA_NetworkMessage *pMsg,
+                      UA_PubSubConnection *pConnection, const UA_ByteString *buffer) {
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     if(!pMsg || !pConnection)
         return UA_STATUSCODE_BADINVALIDARGUMENT;
@@ -695,18 +1195,110 @@ UA_Server_processNetworkMessage(UA_Server *server, UA_NetworkMessage *pMsg,
     UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
                  "DataSetReader found with PublisherId");
 
-    UA_Byte anzDataSets = 1;
-    if(pMsg->payloadHeaderEnabled)
-        anzDataSets = pMsg->payloadHeader.dataSetPayloadHeader.count;
-    for(UA_Byte iterator = 0; iterator < anzDataSets; iterator++) {
-        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER, "Process Msg with DataSetReader!");
-        UA_Server_DataSetReader_process(server, dataSetReader,
-                                        &pMsg->payload.dataSetPayload.dataSetMessages[iterator]);
-    }
-
     /* To Do Handle when dataSetReader parameters are null for publisherId
      * and zero for WriterGroupId and DataSetWriterId */
-    return UA_STATUSCODE_GOOD;
+    return processReaderMessage(server, dataSetReader, pMsg, buffer);
+}
+
+UA_StatusCode
+UA_Server_processNetworkMessage(UA_Server *server, UA_NetworkMessage *pMsg,
+                                UA_PubSubConnection *pConnection) {
+    return processNetworkMessage(server, pMsg, pConnection, NULL);
+}
+
+UA_StatusCode
+UA_Server_processNetworkMessageBinary(UA_Server *server, const UA_ByteString *buffer,
+                                      UA_PubSubConnection *pConnection) {
+    /* Fast path for messages with the layout of a frozen RT DataSetReader */
+    UA_ReaderGroup *readerGroup;
+    LIST_FOREACH(readerGroup, &pConnection->readerGroups, listEntry) {
+        if(!readerGroup->config.configurationFrozen ||
+           readerGroup->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
+            continue;
+        UA_DataSetReader *dataSetReader;
+        LIST_FOREACH(dataSetReader, &readerGroup->readers, listEntry) {
+            if(DataSetReaderLayout_process(dataSetReader, buffer) == UA_STATUSCODE_GOOD)
+                return UA_STATUSCODE_GOOD;
+        }
+    }
+
+    UA_NetworkMessage currentNetworkMessage;
+    memset(&currentNetworkMessage, 0, sizeof(UA_NetworkMessage));
+    size_t currentPosition = 0;
+    UA_StatusCode retval =
+        UA_NetworkMessage_decodeBinary(buffer, &currentPosition, &currentNetworkMessage);
+    if(retval == UA_STATUSCODE_GOOD)
+        retval = processNetworkMessage(server, &currentNetworkMessage, pConnection, buffer);
+    else
+        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Decoding the NetworkMessage failed with StatusCode %s",
+                     UA_StatusCode_name(retval));
+    UA_NetworkMessage_deleteMembers(&currentNetworkMessage);
+    return retval;
+}
+
+#ifdef UA_ENABLE_PUBSUB_THREADS
+
+/* The dedicated thread of a frozen ReaderGroup only looks at the readers of
+ * its own group. They cannot change while the group is frozen. The other
+ * PubSub entities can be changed by the main thread in the meantime.
+ * Messages for other groups are dropped. */
+static UA_StatusCode
+processReaderGroupMessage(UA_PubSubChannel *channel, void *callbackContext,
+                          const UA_ByteString *buffer) {
+    UA_ReceiveContext *ctx = (UA_ReceiveContext*)callbackContext;
+    UA_DataSetReader *dataSetReader;
+    LIST_FOREACH(dataSetReader, &ctx->readerGroup->readers, listEntry) {
+        if(DataSetReaderLayout_process(dataSetReader, buffer) == UA_STATUSCODE_GOOD)
+            return UA_STATUSCODE_GOOD;
+    }
+
+    UA_NetworkMessage currentNetworkMessage;
+    memset(&currentNetworkMessage, 0, sizeof(UA_NetworkMessage));
+    size_t currentPosition = 0;
+    UA_StatusCode retval =
+        UA_NetworkMessage_decodeBinary(buffer, &currentPosition, &currentNetworkMessage);
+    if(retval == UA_STATUSCODE_GOOD)
+        retval = checkReaderIdentifier(ctx->server, &currentNetworkMessage);
+    if(retval != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
+    retval = UA_STATUSCODE_BADNOTFOUND;
+    LIST_FOREACH(dataSetReader, &ctx->readerGroup->readers, listEntry) {
+        if(matchesReader(&currentNetworkMessage, dataSetReader)) {
+            retval = processReaderMessage(ctx->server, dataSetReader,
+                                          &currentNetworkMessage, buffer);
+            break;
+        }
+    }
+
+ cleanup:
+    UA_NetworkMessage_deleteMembers(&currentNetworkMessage);
+    return retval;
 }
 
+static void
+ReaderGroup_subscribeCallbackThread(UA_Server *server, UA_ReaderGroup *readerGroup) {
+    UA_PubSubChannel *channel = readerGroup->threadConnection->channel;
+    UA_ReceiveContext ctx = {server, readerGroup->threadConnection, readerGroup};
+    if(channel->receiveBatch) {
+        channel->receiveBatch(channel, NULL, processReaderGroupMessage, &ctx, 1000);
+        return;
+    }
+
+    UA_ByteString buffer;
+    if(UA_ByteString_allocBuffer(&buffer, 512) != UA_STATUSCODE_GOOD) {
+        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER, "Message buffer alloc failed!");
+        return;
+    }
+
+    channel->receive(channel, &buffer, NULL, 1000);
+    if(buffer.length > 0)
+        processReaderGroupMessage(channel, &ctx, &buffer);
+
+    UA_ByteString_deleteMembers(&buffer);
+}
+
+#endif /* UA_ENABLE_PUBSUB_THREADS */
+
 #endif /* UA_ENABLE_PUBSUB */
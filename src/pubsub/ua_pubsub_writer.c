@@ -30,6 +30,10 @@ static void
 UA_WriterGroup_clear(UA_Server *server, UA_WriterGroup *writerGroup);
 static void
 UA_DataSetField_clear(UA_DataSetField *field);
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+static void
+untrackDataSetField(UA_Server *server, UA_DataSetField *field);
+#endif
 static UA_StatusCode
 generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
                        UA_DataSetMessage *dsm, UA_UInt16 *writerIds, UA_Byte dsmCount,
@@ -120,6 +124,7 @@ UA_PubSubConnection_clear(UA_Server *server, UA_PubSubConnection *connection) {
     UA_ReaderGroup *readerGroups, *tmpReaderGroup;
     LIST_FOREACH_SAFE(readerGroups, &connection->readerGroups, listEntry, tmpReaderGroup)
         UA_Server_removeReaderGroup(server, readerGroups->identifier);
+    UA_free(connection->readerBuckets);
 
     UA_NodeId_clear(&connection->identifier);
     if(connection->channel)
@@ -248,6 +253,16 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId writ
     if(!wg)
         return UA_STATUSCODE_BADNOTFOUND;
 
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    /* The group moves into its thread when it becomes operational */
+    if(wg->config.dedicatedThread && wg->state == UA_PUBSUBSTATE_OPERATIONAL) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Freeze WriterGroup failed. Disable the WriterGroup "
+                       "with a dedicated thread before freezing it.");
+        return UA_STATUSCODE_BADCONFIGURATIONERROR;
+    }
+#endif
+
     //PubSubConnection freezeCounter++
     UA_PubSubConnection *pubSubConnection =  wg->linkedConnection;
     pubSubConnection->configurationFreezeCounter++;
@@ -259,8 +274,7 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId writ
     LIST_FOREACH(dataSetWriter, &wg->writers, listEntry){
         dataSetWriter->config.configurationFrozen = UA_TRUE;
         //PublishedDataSet freezeCounter++
-        UA_PublishedDataSet *publishedDataSet =
-            UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+        UA_PublishedDataSet *publishedDataSet = dataSetWriter->publishedDataSet;
         publishedDataSet->configurationFreezeCounter++;
         publishedDataSet->config.configurationFrozen = UA_TRUE;
         //DataSetFields freeze
@@ -285,8 +299,7 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId writ
         UA_DataSetWriter *dsw;
         LIST_FOREACH(dsw, &wg->writers, listEntry) {
             /* Find the dataset */
-            UA_PublishedDataSet *pds =
-                    UA_PublishedDataSet_findPDSbyId(server, dsw->connectedDataSet);
+            UA_PublishedDataSet *pds = dsw->publishedDataSet;
             if(!pds) {
                 UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
                                "PubSub Publish: PublishedDataSet not found");
@@ -370,6 +383,14 @@ UA_Server_unfreezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId wr
     //                   "PubSub configuration freeze without RT configuration has no effect.");
     //    return UA_STATUSCODE_BADCONFIGURATIONERROR;
     //}
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    /* The thread uses the frozen configuration without the service mutex */
+    if(wg->config.dedicatedThread && wg->state == UA_PUBSUBSTATE_OPERATIONAL) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Unfreeze WriterGroup failed. WriterGroup runs in a dedicated thread.");
+        return UA_STATUSCODE_BADCONFIGURATIONERROR;
+    }
+#endif
     //PubSubConnection freezeCounter--
     UA_PubSubConnection *pubSubConnection =  wg->linkedConnection;
     pubSubConnection->configurationFreezeCounter--;
@@ -381,8 +402,7 @@ UA_Server_unfreezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId wr
     //DataSetWriter unfreeze
     UA_DataSetWriter *dataSetWriter;
     LIST_FOREACH(dataSetWriter, &wg->writers, listEntry) {
-        UA_PublishedDataSet *publishedDataSet =
-            UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+        UA_PublishedDataSet *publishedDataSet = dataSetWriter->publishedDataSet;
         //PublishedDataSet freezeCounter--
         publishedDataSet->configurationFreezeCounter--;
         if(publishedDataSet->configurationFreezeCounter == 0){
@@ -524,10 +544,21 @@ void
 UA_PublishedDataSet_clear(UA_Server *server, UA_PublishedDataSet *publishedDataSet) {
     UA_PublishedDataSetConfig_clear(&publishedDataSet->config);
     //delete PDS
+    /* The fields are removed without regenerating the DataSetMetaData after
+     * every field. That is quadratic for large PublishedDataSets. The field
+     * metadata points into the DataSetMetaData of the PDS. */
     UA_DataSetField *field, *tmpField;
     TAILQ_FOREACH_SAFE(field, &publishedDataSet->fields, listEntry, tmpField) {
-        UA_Server_removeDataSetField(server, field->identifier);
+        UA_FieldMetaData_init(&field->fieldMetaData);
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+        untrackDataSetField(server, field);
+#endif
+        UA_DataSetField_clear(field);
+        TAILQ_REMOVE(&publishedDataSet->fields, field, listEntry);
+        UA_free(field);
     }
+    publishedDataSet->fieldSize = 0;
+    publishedDataSet->promotedFieldsCount = 0;
     UA_DataSetMetaDataType_clear(&publishedDataSet->dataSetMetaData);
     UA_NodeId_clear(&publishedDataSet->identifier);
 }
@@ -615,6 +646,118 @@ generateFieldMetaData(UA_Server *server, UA_DataSetField *field, UA_FieldMetaDat
     }
 }
 
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+
+/*********************************/
+/* Tracking of published values  */
+/*********************************/
+
+#define UA_FIELDBUCKETS_INITIAL 16
+
+static UA_DataSetFieldBucket *
+getFieldBucket(UA_PubSubManager *psm, UA_UInt32 hash) {
+    return &psm->fieldBuckets[hash & (psm->fieldBucketsSize - 1)];
+}
+
+/* Double the number of buckets and rehash the tracked DataSetFields */
+static UA_StatusCode
+growFieldBuckets(UA_PubSubManager *psm) {
+    size_t newSize = (psm->fieldBucketsSize == 0) ?
+        UA_FIELDBUCKETS_INITIAL : psm->fieldBucketsSize * 2;
+    UA_DataSetFieldBucket *buckets = (UA_DataSetFieldBucket*)
+        UA_calloc(newSize, sizeof(UA_DataSetFieldBucket));
+    if(!buckets)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_free(psm->fieldBuckets);
+    psm->fieldBuckets = buckets;
+    psm->fieldBucketsSize = newSize;
+    UA_PublishedDataSet *pds;
+    TAILQ_FOREACH(pds, &psm->publishedDataSets, listEntry) {
+        UA_DataSetField *dsf;
+        TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
+            if(dsf->valueTracked)
+                LIST_INSERT_HEAD(&getFieldBucket(psm, dsf->nodeIdHash)->fields,
+                                 dsf, hashEntry);
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Only writes change the value of a variable without a data source or an
+ * onRead callback */
+static UA_Boolean
+isTrackableField(UA_Server *server, const UA_DataSetField *field) {
+    if(field->config.dataSetFieldType != UA_PUBSUB_DATASETFIELD_VARIABLE ||
+       field->config.field.variable.staticValueSourceEnabled ||
+       field->config.field.variable.publishParameters.attributeId != UA_ATTRIBUTEID_VALUE)
+        return false;
+    UA_Boolean trackable = false;
+    UA_LOCK(server->serviceMutex);
+    const UA_Node *node = UA_NODESTORE_GET(server,
+        &field->config.field.variable.publishParameters.publishedVariable);
+    if(node) {
+        const UA_VariableNode *vn = (const UA_VariableNode*)node;
+        trackable = (node->nodeClass == UA_NODECLASS_VARIABLE &&
+                     vn->valueSource == UA_VALUESOURCE_DATA &&
+                     !vn->value.data.callback.onRead);
+        UA_NODESTORE_RELEASE(server, node);
+    }
+    UA_UNLOCK(server->serviceMutex);
+    return trackable;
+}
+
+/* The field is sampled in every cycle if it cannot be tracked */
+static void
+trackDataSetField(UA_Server *server, UA_DataSetField *field) {
+    if(!isTrackableField(server, field))
+        return;
+    UA_PubSubManager *psm = &server->pubSubManager;
+    if(psm->trackedFieldsCount >= psm->fieldBucketsSize &&
+       growFieldBuckets(psm) != UA_STATUSCODE_GOOD)
+        return;
+    field->valueTracked = true;
+    field->nodeIdHash =
+        UA_NodeId_hash(&field->config.field.variable.publishParameters.publishedVariable);
+    LIST_INSERT_HEAD(&getFieldBucket(psm, field->nodeIdHash)->fields, field, hashEntry);
+    psm->trackedFieldsCount++;
+}
+
+static void
+untrackDataSetField(UA_Server *server, UA_DataSetField *field) {
+    if(!field->valueTracked)
+        return;
+    LIST_REMOVE(field, hashEntry);
+    field->valueTracked = false;
+    server->pubSubManager.trackedFieldsCount--;
+}
+
+void
+UA_DataSetField_valueWritten(UA_Server *server, const UA_NodeId *nodeId) {
+    UA_PubSubManager *psm = &server->pubSubManager;
+    if(psm->trackedFieldsCount == 0)
+        return;
+    UA_DataSetField *dsf;
+    LIST_FOREACH(dsf, &getFieldBucket(psm, UA_NodeId_hash(nodeId))->fields, hashEntry) {
+        if(UA_NodeId_equal(nodeId, &dsf->config.field.variable.publishParameters.publishedVariable))
+            dsf->valueVersion++;
+    }
+}
+
+void
+UA_DataSetField_valueSourceChanged(UA_Server *server, const UA_NodeId *nodeId) {
+    UA_PubSubManager *psm = &server->pubSubManager;
+    if(psm->trackedFieldsCount == 0)
+        return;
+    UA_DataSetField *dsf, *dsf_tmp;
+    LIST_FOREACH_SAFE(dsf, &getFieldBucket(psm, UA_NodeId_hash(nodeId))->fields,
+                      hashEntry, dsf_tmp) {
+        if(UA_NodeId_equal(nodeId, &dsf->config.field.variable.publishParameters.publishedVariable))
+            untrackDataSetField(server, dsf);
+    }
+}
+
+#endif /* UA_ENABLE_PUBSUB_DELTAFRAMES */
+
 UA_DataSetFieldResult
 UA_Server_addDataSetField(UA_Server *server, const UA_NodeId publishedDataSet,
                           const UA_DataSetFieldConfig *fieldConfig,
@@ -668,6 +811,9 @@ UA_Server_addDataSetField(UA_Server *server, const UA_NodeId publishedDataSet,
     if(newField->config.field.variable.promotedField)
         currentDataSet->promotedFieldsCount++;
     currentDataSet->fieldSize++;
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+    trackDataSetField(server, newField);
+#endif
 
     //generate fieldMetadata within the DataSetMetaData
     currentDataSet->dataSetMetaData.fieldsSize++;
@@ -735,6 +881,9 @@ UA_Server_removeDataSetField(UA_Server *server, const UA_NodeId dsf) {
     currentField->fieldMetaData.name = UA_STRING_NULL;
     currentField->fieldMetaData.description.locale = UA_STRING_NULL;
     currentField->fieldMetaData.description.text = UA_STRING_NULL;
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+    untrackDataSetField(server, currentField);
+#endif
     UA_DataSetField_clear(currentField);
     TAILQ_REMOVE(&parentPublishedDataSet->fields, currentField, listEntry);
     UA_free(currentField);
@@ -1221,6 +1370,7 @@ UA_Server_addDataSetWriter(UA_Server *server,
 
     //connect PublishedDataSet with DataSetWriter
     newDataSetWriter->connectedDataSet = currentDataSetContext->identifier;
+    newDataSetWriter->publishedDataSet = currentDataSetContext;
     newDataSetWriter->linkedWriterGroup = wg->identifier;
     UA_PubSubManager_generateUniqueNodeId(server, &newDataSetWriter->identifier);
     if(writerIdentifier != NULL)
@@ -1257,8 +1407,7 @@ UA_Server_removeDataSetWriter(UA_Server *server, const UA_NodeId dsw){
         return UA_STATUSCODE_BADCONFIGURATIONERROR;
     }
 
-    UA_PublishedDataSet *publishedDataSet =
-        UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+    UA_PublishedDataSet *publishedDataSet = dataSetWriter->publishedDataSet;
     if(!publishedDataSet)
         return UA_STATUSCODE_BADNOTFOUND;
 
@@ -1416,8 +1565,7 @@ static UA_StatusCode
 UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
                                                UA_DataSetMessage *dataSetMessage,
                                                UA_DataSetWriter *dataSetWriter) {
-    UA_PublishedDataSet *currentDataSet =
-        UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+    UA_PublishedDataSet *currentDataSet = dataSetWriter->publishedDataSet;
     if(!currentDataSet)
         return UA_STATUSCODE_BADNOTFOUND;
 
@@ -1450,6 +1598,9 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
 #endif
 
         /* Sample the value */
+#ifdef UA_ENABLE_PUBSUB_DELTAFRAMES
+        UA_UInt32 version = dsf->valueVersion;
+#endif
         UA_DataValue *dfv = &dataSetMessage->data.keyFrameData.dataSetFields[counter];
         UA_PubSubDataSetField_sampleValue(server, dsf, dfv);
 
@@ -1476,6 +1627,7 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
         /* Update lastValue store */
         UA_DataValue_clear(&dataSetWriter->lastSamples[counter].value);
         UA_DataValue_copy(dfv, &dataSetWriter->lastSamples[counter].value);
+        dataSetWriter->lastSamples[counter].valueVersion = version;
 #endif
 
         counter++;
@@ -1488,8 +1640,7 @@ static UA_StatusCode
 UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
                                                  UA_DataSetMessage *dataSetMessage,
                                                  UA_DataSetWriter *dataSetWriter) {
-    UA_PublishedDataSet *currentDataSet =
-        UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+    UA_PublishedDataSet *currentDataSet = dataSetWriter->publishedDataSet;
     if(!currentDataSet)
         return UA_STATUSCODE_BADNOTFOUND;
 
@@ -1503,9 +1654,18 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
     UA_DataSetField *dsf;
     size_t counter = 0;
     TAILQ_FOREACH(dsf, &currentDataSet->fields, listEntry) {
+        /* The tracked value was not written since the last sample */
+        UA_DataSetWriterSample *sample = &dataSetWriter->lastSamples[counter];
+        if(dsf->valueTracked && dsf->valueVersion == sample->valueVersion) {
+            sample->valueChanged = false;
+            counter++;
+            continue;
+        }
+
         /* Sample the value */
         UA_DataValue value;
         UA_DataValue_init(&value);
+        sample->valueVersion = dsf->valueVersion;
         UA_PubSubDataSetField_sampleValue(server, dsf, &value);
 
         /* Check if the value has changed */
@@ -1578,8 +1738,7 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
 static UA_StatusCode
 UA_DataSetWriter_generateDataSetMessage(UA_Server *server, UA_DataSetMessage *dataSetMessage,
                                         UA_DataSetWriter *dataSetWriter) {
-    UA_PublishedDataSet *currentDataSet =
-        UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+    UA_PublishedDataSet *currentDataSet = dataSetWriter->publishedDataSet;
     if(!currentDataSet)
         return UA_STATUSCODE_BADNOTFOUND;
 
@@ -2007,8 +2166,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
     UA_STACKARRAY(UA_DataSetMessage, dsmStore, writerGroup->writersCount);
     LIST_FOREACH(dsw, &writerGroup->writers, listEntry) {
         /* Find the dataset */
-        UA_PublishedDataSet *pds =
-            UA_PublishedDataSet_findPDSbyId(server, dsw->connectedDataSet);
+        UA_PublishedDataSet *pds = dsw->publishedDataSet;
         if(!pds) {
             UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
                            "PubSub Publish: PublishedDataSet not found");
@@ -2093,6 +2251,24 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
  * creation. */
 UA_StatusCode
 UA_WriterGroup_addPublishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
+#ifdef UA_ENABLE_PUBSUB_THREADS
+    /* Only a frozen RT group sends without the service mutex. Otherwise the
+     * group is run by the server main loop. The thread runs the first cycle
+     * right away. */
+    if(writerGroup->config.dedicatedThread &&
+       writerGroup->config.configurationFrozen &&
+       writerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
+        UA_StatusCode res =
+            UA_PubSubManager_addThreadCallback(server,
+                                               (UA_ServerCallback) UA_WriterGroup_publishCallback,
+                                               writerGroup, writerGroup->config.publishingInterval,
+                                               &writerGroup->publishCallbackId);
+        if(res == UA_STATUSCODE_GOOD)
+            writerGroup->publishCallbackIsRegistered = true;
+        return res;
+    }
+#endif
+
     UA_StatusCode retval =
         UA_PubSubManager_addRepeatedCallback(server,
                                              (UA_ServerCallback) UA_WriterGroup_publishCallback,
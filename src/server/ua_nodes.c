@@ -116,8 +116,11 @@ UA_CommonVariableNode_copy(const UA_VariableNode *src, UA_VariableNode *dst) {
         retval |= UA_DataValue_copy(&src->value.data.value,
                                     &dst->value.data.value);
         dst->value.data.callback = src->value.data.callback;
-    } else
+    } else if(src->valueSource == UA_VALUESOURCE_DATASOURCE) {
         dst->value.dataSource = src->value.dataSource;
+    } else {
+        dst->value.valueRing = src->value.valueRing;
+    }
     return retval;
 }
 
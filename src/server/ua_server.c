@@ -178,6 +178,7 @@ void UA_Server_delete(UA_Server *server) {
     LIST_FOREACH_SAFE(current, &server->sessions, pointers, temp) {
         UA_Server_removeSession(server, current, UA_DIAGNOSTICEVENT_CLOSE);
     }
+    UA_free(server->sessionBuckets);
     UA_UNLOCK(server->serviceMutex);
     UA_Array_delete(server->namespaces, server->namespacesSize, &UA_TYPES[UA_TYPES_STRING]);
 
@@ -279,6 +280,9 @@ UA_Server_init(UA_Server *server) {
     
     /* Initialize the handling of repeated callbacks */
     UA_Timer_init(&server->timer);
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    server->timer.lateness = &server->serviceStats.timerLateness;
+#endif
 
     UA_WorkQueue_init(&server->workQueue);
 
@@ -301,12 +305,14 @@ UA_Server_init(UA_Server *server) {
 
     /* Initialize SecureChannel */
     TAILQ_INIT(&server->channels);
+    ZIP_INIT(&server->channelsByExpiry);
     /* TODO: use an ID that is likely to be unique after a restart */
     server->lastChannelId = STARTCHANNELID;
     server->lastTokenId = STARTTOKENID;
 
     /* Initialize Session Management */
     LIST_INIT(&server->sessions);
+    ZIP_INIT(&server->sessionsByExpiry);
     server->sessionCount = 0;
 
 #if UA_MULTITHREADING >= 100
@@ -513,6 +519,22 @@ UA_ServerStatistics UA_Server_getStatistics(UA_Server *server)
    return server->serverStats;
 }
 
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+void
+UA_Server_getServiceStatistics(UA_Server *server, UA_ServiceStatistics *stats) {
+    UA_LOCK(server->serviceMutex);
+    *stats = server->serviceStats;
+    UA_UNLOCK(server->serviceMutex);
+}
+
+void
+UA_Server_resetServiceStatistics(UA_Server *server) {
+    UA_LOCK(server->serviceMutex);
+    memset(&server->serviceStats, 0, sizeof(UA_ServiceStatistics));
+    UA_UNLOCK(server->serviceMutex);
+}
+#endif
+
 /********************/
 /* Main Server Loop */
 /********************/
@@ -66,11 +66,13 @@ sendServiceFaultWithRequest(UA_SecureChannel *channel,
 
  /* This is not an ERR message, the connection is not closed afterwards */
 static UA_StatusCode
-sendServiceFault(UA_SecureChannel *channel, const UA_ByteString *msg,
-                 size_t offset, const UA_DataType *responseType,
+sendServiceFault(UA_SecureChannel *channel, const UA_ByteString *segments,
+                 size_t segmentsSize, size_t offset, const UA_DataType *responseType,
                  UA_UInt32 requestId, UA_StatusCode error) {
     UA_RequestHeader requestHeader;
-    UA_StatusCode retval = UA_RequestHeader_decodeBinary(msg, &offset, &requestHeader);
+    UA_StatusCode retval =
+        UA_decodeBinarySegments(segments, segmentsSize, &offset, &requestHeader,
+                                &UA_TYPES[UA_TYPES_REQUESTHEADER], NULL, NULL, false);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
     retval = sendServiceFaultWithRequest(channel, &requestHeader, responseType,
@@ -363,7 +365,9 @@ processOPN(UA_Server *server, UA_SecureChannel *channel,
     /* Call the service */
     UA_OpenSecureChannelResponse openScResponse;
     UA_OpenSecureChannelResponse_init(&openScResponse);
+    UA_LOCK(server->serviceMutex);
     Service_OpenSecureChannel(server, channel, &openSecureChannelRequest, &openScResponse);
+    UA_UNLOCK(server->serviceMutex);
     UA_OpenSecureChannelRequest_clear(&openSecureChannelRequest);
     if(openScResponse.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_CHANNEL(&server->config.logger, channel, "Could not open a SecureChannel. "
@@ -492,6 +496,17 @@ sendResponse(UA_SecureChannel *channel, UA_UInt32 requestId, UA_UInt32 requestHa
     return UA_MessageContext_finish(&mc);
 }
 
+/* Send a ServiceFault. The error is also noted in the response for the
+ * statistics. */
+static UA_StatusCode
+rejectRequest(UA_SecureChannel *channel, const UA_RequestHeader *requestHeader,
+              UA_UInt32 requestId, UA_Response *response,
+              const UA_DataType *responseType, UA_StatusCode error) {
+    response->responseHeader.serviceResult = error;
+    return sendServiceFaultWithRequest(channel, requestHeader, responseType,
+                                       requestId, error);
+}
+
 /* A Session is bound to at most one SecureChannel. After creation, the Session
  * is already bound to the SecureChannel on which the CreateSession request was
  * received. Even if the Session is not yet activated.
@@ -512,13 +527,13 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     const UA_RequestHeader *requestHeader = &request->requestHeader;
     if(session && !UA_NodeId_equal(&session->header.authenticationToken,
                                    &requestHeader->authenticationToken))
-        return sendServiceFaultWithRequest(channel, requestHeader, responseType,
-                                           requestId, UA_STATUSCODE_BADSESSIONIDINVALID);
+        return rejectRequest(channel, requestHeader, requestId, response,
+                             responseType, UA_STATUSCODE_BADSESSIONIDINVALID);
 
     /* Has the session timed out? */
     if(session && session->validTill < UA_DateTime_nowMonotonic())
-        return sendServiceFaultWithRequest(channel, requestHeader, responseType,
-                                           requestId, UA_STATUSCODE_BADSESSIONIDINVALID);
+        return rejectRequest(channel, requestHeader, requestId, response,
+                             responseType, UA_STATUSCODE_BADSESSIONIDINVALID);
 
     /* Session lifecycle service. The session pointer can still be NULL. */
     if(requestType == &UA_TYPES[UA_TYPES_CREATESESSIONREQUEST] ||
@@ -552,8 +567,8 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
                                    "Service %" PRIi16 " refused without a valid session",
                                    requestType->binaryEncodingId);
 #endif
-            return sendServiceFaultWithRequest(channel, requestHeader, responseType,
-                                               requestId, UA_STATUSCODE_BADSESSIONIDINVALID);
+            return rejectRequest(channel, requestHeader, requestId, response,
+                                 responseType, UA_STATUSCODE_BADSESSIONIDINVALID);
         }
 
         UA_Session_init(&anonymousSession);
@@ -579,8 +594,8 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
         UA_Server_removeSessionByToken(server, &session->header.authenticationToken,
                                        UA_DIAGNOSTICEVENT_ABORT);
         UA_UNLOCK(server->serviceMutex);
-        return sendServiceFaultWithRequest(channel, requestHeader, responseType,
-                                           requestId, UA_STATUSCODE_BADSESSIONNOTACTIVATED);
+        return rejectRequest(channel, requestHeader, requestId, response,
+                             responseType, UA_STATUSCODE_BADSESSIONNOTACTIVATED);
     }
 
     /* Update the session lifetime */
@@ -623,13 +638,48 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
                         response, responseType);
 }
 
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+static void
+recordServiceStatistics(UA_Server *server, const UA_DataType *requestType,
+                        size_t bytesReceived, size_t bytesSent,
+                        UA_DateTime duration, UA_Boolean error) {
+    UA_LOCK(server->serviceMutex);
+    UA_ServiceStatistics *stats = &server->serviceStats;
+    UA_ServiceCounters *sc = NULL;
+    for(size_t i = 0; i < stats->servicesSize; i++) {
+        if(stats->services[i].requestType == requestType) {
+            sc = &stats->services[i];
+            break;
+        }
+    }
+    if(!sc) {
+        if(stats->servicesSize == UA_SERVICESTATISTICS_MAX) {
+            UA_UNLOCK(server->serviceMutex);
+            return;
+        }
+        sc = &stats->services[stats->servicesSize++];
+        sc->requestType = requestType;
+    }
+    sc->requestCount++;
+    if(error)
+        sc->errorCount++;
+    sc->bytesReceived += bytesReceived;
+    sc->bytesSent += bytesSent;
+    UA_LatencyHistogram_record(&sc->latency, duration);
+    UA_UNLOCK(server->serviceMutex);
+}
+#endif
+
+/* The message is given as the segments from the payload of its chunks */
 static UA_StatusCode
-processMSG(UA_Server *server, UA_SecureChannel *channel,
-           UA_UInt32 requestId, const UA_ByteString *msg) {
+processMSG(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
+           const UA_ByteString *segments, size_t segmentsSize) {
     /* Decode the nodeid */
     size_t offset = 0;
     UA_NodeId requestTypeId;
-    UA_StatusCode retval = UA_NodeId_decodeBinary(msg, &offset, &requestTypeId);
+    UA_StatusCode retval =
+        UA_decodeBinarySegments(segments, segmentsSize, &offset, &requestTypeId,
+                                &UA_TYPES[UA_TYPES_NODEID], NULL, NULL, false);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
     if(requestTypeId.namespaceIndex != 0 ||
@@ -658,21 +708,28 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                                     "Unknown request with type identifier %" PRIi32,
                                     requestTypeId.identifier.numeric);
             }
-            return sendServiceFault(channel, msg, requestPos,
+            return sendServiceFault(channel, segments, segmentsSize, requestPos,
                                     &UA_TYPES[UA_TYPES_SERVICEFAULT], requestId,
                                     UA_STATUSCODE_BADSERVICEUNSUPPORTED);
         }
     }
     UA_assert(responseType);
 
-    /* Decode the request */
+    /* Decode the request. The allocations are taken from the arena of the
+     * SecureChannel. Strings and ByteStrings point into the message (unless
+     * they straddle chunks). The request is released at once when the arena is
+     * reset. (Services get the request as const and copy what they retain.) */
     UA_Request request;
-    retval = UA_decodeBinary(msg, &offset, &request, requestType, server->config.customDataTypes);
+    retval = UA_decodeBinarySegments(segments, segmentsSize, &offset, &request,
+                                     requestType, server->config.customDataTypes,
+                                     &channel->decodeArena, true);
     if(retval != UA_STATUSCODE_GOOD) {
+        UA_Arena_reset(&channel->decodeArena);
         UA_LOG_DEBUG_CHANNEL(&server->config.logger, channel,
                              "Could not decode the request with StatusCode %s",
                              UA_StatusCode_name(retval));
-        return sendServiceFault(channel, msg, requestPos, responseType, requestId, retval);
+        return sendServiceFault(channel, segments, segmentsSize, requestPos,
+                                responseType, requestId, retval);
     }
 
     /* Check timestamp in the request header */
@@ -685,7 +742,7 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
             if(server->config.verifyRequestTimestamp <= UA_RULEHANDLING_ABORT) {
                 retval = sendServiceFaultWithRequest(channel, requestHeader, responseType,
                                                      requestId, UA_STATUSCODE_BADINVALIDTIMESTAMP);
-                UA_clear(&request, requestType);
+                UA_Arena_reset(&channel->decodeArena);
                 return retval;
             }
         }
@@ -693,20 +750,32 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
 
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
     /* Set the authenticationToken from the create session request to help
-     * fuzzing cover more lines */
-    UA_NodeId_clear(&requestHeader->authenticationToken);
-    if(!UA_NodeId_isNull(&unsafe_fuzz_authenticationToken))
-        UA_NodeId_copy(&unsafe_fuzz_authenticationToken, &requestHeader->authenticationToken);
+     * fuzzing cover more lines. The request lives in the arena and is not
+     * cleared. So the token is not copied. */
+    requestHeader->authenticationToken = unsafe_fuzz_authenticationToken;
 #endif
 
     /* Prepare the respone and process the request */
     UA_Response response;
     UA_init(&response, responseType);
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    UA_DateTime started = UA_DateTime_nowMonotonic();
+    size_t sentBytes = channel->sentBytes;
+#endif
     retval = processMSGDecoded(server, channel, requestId, service, &request, requestType,
                                &response, responseType, sessionRequired);
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    size_t messageLength = 0;
+    for(size_t i = 0; i < segmentsSize; i++)
+        messageLength += segments[i].length;
+    recordServiceStatistics(server, requestType, messageLength, channel->sentBytes - sentBytes,
+                            UA_DateTime_nowMonotonic() - started,
+                            retval != UA_STATUSCODE_GOOD ||
+                            response.responseHeader.serviceResult != UA_STATUSCODE_GOOD);
+#endif
 
     /* Clean up */
-    UA_clear(&request, requestType);
+    UA_Arena_reset(&channel->decodeArena);
     UA_clear(&response, responseType);
     return retval;
 }
@@ -715,8 +784,9 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
 static void
 processSecureChannelMessage(void *application, UA_SecureChannel *channel,
                             UA_MessageType messagetype, UA_UInt32 requestId,
-                            UA_ByteString *message) {
+                            UA_ByteString *segments, size_t segmentsSize) {
     UA_Server *server = (UA_Server*)application;
+    UA_ByteString *message = &segments[0]; /* Single segment except for MSG */
 
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     switch(messagetype) {
@@ -730,11 +800,13 @@ processSecureChannelMessage(void *application, UA_SecureChannel *channel,
         break;
     case UA_MESSAGETYPE_MSG:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a MSG");
-        retval = processMSG(server, channel, requestId, message);
+        retval = processMSG(server, channel, requestId, segments, segmentsSize);
         break;
     case UA_MESSAGETYPE_CLO:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Process a CLO");
+        UA_LOCK(server->serviceMutex);
         Service_CloseSecureChannel(server, channel); /* Regular close */
+        UA_UNLOCK(server->serviceMutex);
         break;
     default:
         UA_LOG_TRACE_CHANNEL(&server->config.logger, channel, "Invalid message type");
@@ -784,7 +856,9 @@ UA_Server_processBinaryMessage(UA_Server *server, UA_Connection *connection,
 
     /* Add a SecureChannel to a new connection */
     if(!channel) {
+        UA_LOCK(server->serviceMutex);
         retval = UA_Server_createSecureChannel(server, connection);
+        UA_UNLOCK(server->serviceMutex);
         if(retval != UA_STATUSCODE_GOOD)
             goto error;
         channel = connection->channel;
@@ -825,7 +899,12 @@ deleteConnection(UA_Server *server, UA_Connection *connection) {
 
 void
 UA_Server_removeConnection(UA_Server *server, UA_Connection *connection) {
+    /* The cleanup changes the channels concurrently in a worker */
+    UA_LOCK(server->serviceMutex);
+    if(connection->channel)
+        UA_Server_expireSecureChannel(server, connection->channel);
     UA_Connection_detachSecureChannel(connection);
+    UA_UNLOCK(server->serviceMutex);
 #if UA_MULTITHREADING >= 200
     UA_DelayedCallback *dc = (UA_DelayedCallback*)UA_malloc(sizeof(UA_DelayedCallback));
     if(!dc)
@@ -165,15 +165,36 @@ typedef enum {
 typedef struct channel_entry {
     UA_DelayedCallback cleanupCallback;
     TAILQ_ENTRY(channel_entry) pointers;
+    ZIP_ENTRY(channel_entry) expiryZipfields;
+    UA_DateTime expiry; /* Lower bound for the timeout of the channel. The
+                         * cleanup updates the expiry lazily when it is
+                         * reached. */
     UA_SecureChannel channel;
 } channel_entry;
 
+ZIP_HEAD(UA_ChannelExpiryZip, channel_entry);
+ZIP_PROTTYPE(UA_ChannelExpiryZip, channel_entry, UA_DateTime)
+
 typedef struct session_list_entry {
     UA_DelayedCallback cleanupCallback;
     LIST_ENTRY(session_list_entry) pointers;
+    LIST_ENTRY(session_list_entry) tokenPointers; /* Index by authenticationToken */
+    LIST_ENTRY(session_list_entry) idPointers;    /* Index by sessionId */
+    ZIP_ENTRY(session_list_entry) expiryZipfields;
+    UA_DateTime expiry; /* Lower bound for session.validTill. The cleanup
+                         * updates the expiry lazily when it is reached. */
     UA_Session session;
 } session_list_entry;
 
+ZIP_HEAD(UA_SessionExpiryZip, session_list_entry);
+ZIP_PROTTYPE(UA_SessionExpiryZip, session_list_entry, UA_DateTime)
+
+/* Hash bucket for the session lookup */
+typedef struct {
+    LIST_HEAD(, session_list_entry) byToken;
+    LIST_HEAD(, session_list_entry) byId;
+} session_bucket;
+
 typedef enum {
     UA_SERVERLIFECYCLE_FRESH,
     UA_SERVERLIFECYLE_RUNNING
@@ -190,6 +211,7 @@ struct UA_Server {
 
     /* SecureChannels */
     TAILQ_HEAD(, channel_entry) channels;
+    struct UA_ChannelExpiryZip channelsByExpiry;
     UA_UInt32 lastChannelId;
     UA_UInt32 lastTokenId;
 
@@ -200,6 +222,11 @@ struct UA_Server {
     /* Session Management */
     LIST_HEAD(session_list, session_list_entry) sessions;
     UA_UInt32 sessionCount;
+    session_bucket *sessionBuckets; /* Hashed by authenticationToken and
+                                     * sessionId. The size is a power of
+                                     * two. */
+    size_t sessionBucketsSize;
+    struct UA_SessionExpiryZip sessionsByExpiry;
     UA_Session adminSession; /* Local access to the services (for startup and
                               * maintenance) uses this Session with all possible
                               * access rights (Session Id: 1) */
@@ -232,6 +259,8 @@ struct UA_Server {
     /* To be cast to UA_LocalMonitoredItem to get the callback and context */
     LIST_HEAD(LocalMonitoredItems, UA_MonitoredItem) localMonitoredItems;
     UA_UInt32 lastLocalMonitoredItemId;
+    /* MonitoredItems grouped by their sampling interval */
+    LIST_HEAD(, UA_SamplingGroup) samplingGroups;
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
     LIST_HEAD(conditionSourcelisthead, UA_ConditionSource) headConditionSource;
@@ -254,6 +283,10 @@ struct UA_Server {
 
     /* Statistics */
     UA_ServerStatistics serverStats;
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    UA_ServiceStatistics serviceStats; /* Protected by the serviceMutex. Except
+                                        * for the timer lateness. */
+#endif
 };
 
 /**************************/
@@ -269,6 +302,8 @@ UA_Server_deleteSecureChannels(UA_Server *server);
 void
 UA_Server_cleanupTimedOutSecureChannels(UA_Server *server, UA_DateTime nowMonotonic);
 
+/* The serviceMutex must be held. The cleanup changes the channels in a worker
+ * thread. */
 UA_StatusCode
 UA_Server_createSecureChannel(UA_Server *server, UA_Connection *connection);
 
@@ -276,10 +311,16 @@ UA_StatusCode
 UA_Server_configSecureChannel(UA_Server *server, UA_SecureChannel *channel,
                               const UA_AsymmetricAlgorithmSecurityHeader *asymHeader);
 
+/* Takes the serviceMutex */
 void
 UA_Server_closeSecureChannel(UA_Server *server, UA_SecureChannel *channel,
                              UA_DiagnosticEvent event);
 
+/* The connection of the channel was closed. Remove the channel in the next
+ * cleanup. The serviceMutex must be held. */
+void
+UA_Server_expireSecureChannel(UA_Server *server, UA_SecureChannel *channel);
+
 /********************/
 /* Session Handling */
 /********************/
@@ -424,6 +424,258 @@ readAuditing(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext
     }
     return UA_STATUSCODE_GOOD;
 }
+
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+
+static UA_StatusCode
+readDiagnosticsSummary(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                       const UA_NodeId *nodeId, void *nodeContext,
+                       UA_Boolean includeSourceTimeStamp,
+                       const UA_NumericRange *range, UA_DataValue *value) {
+    if(range) {
+        value->hasStatus = true;
+        value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    UA_ServerDiagnosticsSummaryDataType sds;
+    UA_ServerDiagnosticsSummaryDataType_init(&sds);
+    UA_LOCK(server->serviceMutex);
+    UA_SessionStatistics *ss = &server->serverStats.ss;
+    sds.currentSessionCount = (UA_UInt32)ss->currentSessionCount;
+    sds.cumulatedSessionCount = (UA_UInt32)ss->cumulatedSessionCount;
+    sds.securityRejectedSessionCount = (UA_UInt32)ss->securityRejectedSessionCount;
+    sds.rejectedSessionCount = (UA_UInt32)ss->rejectedSessionCount;
+    sds.sessionTimeoutCount = (UA_UInt32)ss->sessionTimeoutCount;
+    sds.sessionAbortCount = (UA_UInt32)ss->sessionAbortCount;
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    sds.currentSubscriptionCount = server->numSubscriptions;
+#endif
+    for(size_t i = 0; i < server->serviceStats.servicesSize; i++)
+        sds.rejectedRequestsCount += (UA_UInt32)server->serviceStats.services[i].errorCount;
+    UA_UNLOCK(server->serviceMutex);
+
+    /* The summary or one of its components */
+    UA_UInt32 *counter = NULL;
+    switch(nodeId->identifier.numeric) {
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY:
+        break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SERVERVIEWCOUNT:
+        counter = &sds.serverViewCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CURRENTSESSIONCOUNT:
+        counter = &sds.currentSessionCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CUMULATEDSESSIONCOUNT:
+        counter = &sds.cumulatedSessionCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SECURITYREJECTEDSESSIONCOUNT:
+        counter = &sds.securityRejectedSessionCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_REJECTEDSESSIONCOUNT:
+        counter = &sds.rejectedSessionCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SESSIONTIMEOUTCOUNT:
+        counter = &sds.sessionTimeoutCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SESSIONABORTCOUNT:
+        counter = &sds.sessionAbortCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CURRENTSUBSCRIPTIONCOUNT:
+        counter = &sds.currentSubscriptionCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CUMULATEDSUBSCRIPTIONCOUNT:
+        counter = &sds.cumulatedSubscriptionCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_PUBLISHINGINTERVALCOUNT:
+        counter = &sds.publishingIntervalCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SECURITYREJECTEDREQUESTSCOUNT:
+        counter = &sds.securityRejectedRequestsCount; break;
+    case UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_REJECTEDREQUESTSCOUNT:
+        counter = &sds.rejectedRequestsCount; break;
+    default:
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_StatusCode retval;
+    if(counter)
+        retval = UA_Variant_setScalarCopy(&value->value, counter, &UA_TYPES[UA_TYPES_UINT32]);
+    else
+        retval = UA_Variant_setScalarCopy(&value->value, &sds,
+                                          &UA_TYPES[UA_TYPES_SERVERDIAGNOSTICSSUMMARYDATATYPE]);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    value->hasValue = true;
+    if(includeSourceTimeStamp) {
+        value->hasSourceTimestamp = true;
+        value->sourceTimestamp = UA_DateTime_now();
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_UInt32 diagnosticsSummaryNodes[] = {
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SERVERVIEWCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CURRENTSESSIONCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CUMULATEDSESSIONCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SECURITYREJECTEDSESSIONCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_REJECTEDSESSIONCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SESSIONTIMEOUTCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SESSIONABORTCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CURRENTSUBSCRIPTIONCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CUMULATEDSUBSCRIPTIONCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_PUBLISHINGINTERVALCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_SECURITYREJECTEDREQUESTSCOUNT,
+    UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_REJECTEDREQUESTSCOUNT
+};
+
+/* The variables of the ServiceStatistics object. The node context selects the
+ * value. */
+typedef enum {
+    UA_SERVICESTATISTICS_NAMES,
+    UA_SERVICESTATISTICS_REQUESTS,
+    UA_SERVICESTATISTICS_ERRORS,
+    UA_SERVICESTATISTICS_BYTESRECEIVED,
+    UA_SERVICESTATISTICS_BYTESSENT,
+    UA_SERVICESTATISTICS_LATENCYMEDIAN,
+    UA_SERVICESTATISTICS_LATENCY99,
+    UA_SERVICESTATISTICS_LATENCYMAX,
+    UA_SERVICESTATISTICS_PUBLISHLATENCY99,
+    UA_SERVICESTATISTICS_SAMPLINGLAG99,
+    UA_SERVICESTATISTICS_TIMERLATENESS99
+} UA_ServiceStatisticsVariable;
+
+static const char *serviceStatisticsVariables[] = {
+    "ServiceNames", "RequestCounts", "ErrorCounts", "BytesReceived", "BytesSent",
+    "LatencyMedian", "Latency99", "LatencyMax", "PublishLatency99",
+    "SamplingLag99", "TimerLateness99"
+};
+
+static UA_StatusCode
+readServiceName(const UA_DataType *requestType, UA_String *name) {
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    *name = UA_STRING_ALLOC(requestType->typeName);
+    return (name->data || !requestType->typeName) ?
+        UA_STATUSCODE_GOOD : UA_STATUSCODE_BADOUTOFMEMORY;
+#else
+    return UA_NodeId_print(&requestType->typeId, name);
+#endif
+}
+
+static UA_StatusCode
+readServiceStatistics(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                      const UA_NodeId *nodeId, void *nodeContext,
+                      UA_Boolean includeSourceTimeStamp,
+                      const UA_NumericRange *range, UA_DataValue *value) {
+    if(range) {
+        value->hasStatus = true;
+        value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    UA_ServiceStatisticsVariable var = (UA_ServiceStatisticsVariable)(uintptr_t)nodeContext;
+    UA_ServiceStatistics *stats = &server->serviceStats;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_LOCK(server->serviceMutex);
+
+    /* Scalar percentiles */
+    const UA_LatencyHistogram *h = NULL;
+    if(var == UA_SERVICESTATISTICS_PUBLISHLATENCY99)
+        h = &stats->publishLatency;
+    else if(var == UA_SERVICESTATISTICS_SAMPLINGLAG99)
+        h = &stats->samplingLag;
+    else if(var == UA_SERVICESTATISTICS_TIMERLATENESS99)
+        h = &stats->timerLateness;
+    if(h) {
+        UA_UInt64 p99 = UA_LatencyHistogram_percentile(h, 0.99);
+        retval = UA_Variant_setScalarCopy(&value->value, &p99, &UA_TYPES[UA_TYPES_UINT64]);
+        goto out;
+    }
+
+    /* One array entry per service */
+    size_t size = stats->servicesSize;
+    const UA_DataType *type = (var == UA_SERVICESTATISTICS_NAMES) ?
+        &UA_TYPES[UA_TYPES_STRING] : &UA_TYPES[UA_TYPES_UINT64];
+    void *array = UA_Array_new(size, type);
+    if(!array && size > 0) {
+        retval = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto out;
+    }
+    UA_String *names = (UA_String*)array;
+    UA_UInt64 *counters = (UA_UInt64*)array;
+    for(size_t i = 0; i < size && retval == UA_STATUSCODE_GOOD; i++) {
+        UA_ServiceCounters *sc = &stats->services[i];
+        switch(var) {
+        case UA_SERVICESTATISTICS_NAMES:
+            retval = readServiceName(sc->requestType, &names[i]); break;
+        case UA_SERVICESTATISTICS_REQUESTS: counters[i] = sc->requestCount; break;
+        case UA_SERVICESTATISTICS_ERRORS: counters[i] = sc->errorCount; break;
+        case UA_SERVICESTATISTICS_BYTESRECEIVED: counters[i] = sc->bytesReceived; break;
+        case UA_SERVICESTATISTICS_BYTESSENT: counters[i] = sc->bytesSent; break;
+        case UA_SERVICESTATISTICS_LATENCYMEDIAN:
+            counters[i] = UA_LatencyHistogram_percentile(&sc->latency, 0.5); break;
+        case UA_SERVICESTATISTICS_LATENCY99:
+            counters[i] = UA_LatencyHistogram_percentile(&sc->latency, 0.99); break;
+        case UA_SERVICESTATISTICS_LATENCYMAX: counters[i] = sc->latency.max; break;
+        default: retval = UA_STATUSCODE_BADINTERNALERROR; break;
+        }
+    }
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_Array_delete(array, size, type);
+        goto out;
+    }
+    UA_Variant_setArray(&value->value, array, size, type);
+
+ out:
+    UA_UNLOCK(server->serviceMutex);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    value->hasValue = true;
+    if(includeSourceTimeStamp) {
+        value->hasSourceTimestamp = true;
+        value->sourceTimestamp = UA_DateTime_now();
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The statistics per service are not defined in the standard. They are added
+ * in the namespace of the application below the ServerDiagnostics. */
+static UA_StatusCode
+addServiceStatisticsNodes(UA_Server *server) {
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    oattr.displayName = UA_LOCALIZEDTEXT("", "ServiceStatistics");
+    UA_NodeId objectId = UA_NODEID_STRING(1, "ServerDiagnostics.ServiceStatistics");
+    UA_StatusCode retval =
+        UA_Server_addObjectNode(server, objectId,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERDIAGNOSTICS),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                UA_QUALIFIEDNAME(1, "ServiceStatistics"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                oattr, NULL, NULL);
+
+    UA_DataSource serviceStatistics = {readServiceStatistics, NULL};
+    UA_UInt32 arrayDims = 0;
+    char id[64];
+    for(size_t i = 0; i <= UA_SERVICESTATISTICS_TIMERLATENESS99; i++) {
+        const char *name = serviceStatisticsVariables[i];
+        UA_VariableAttributes vattr = UA_VariableAttributes_default;
+        vattr.displayName = UA_LOCALIZEDTEXT("", (char*)(uintptr_t)name);
+        vattr.accessLevel = UA_ACCESSLEVELMASK_READ;
+        if(i == UA_SERVICESTATISTICS_NAMES) {
+            vattr.dataType = UA_TYPES[UA_TYPES_STRING].typeId;
+        } else {
+            vattr.dataType = UA_TYPES[UA_TYPES_UINT64].typeId;
+        }
+        if(i < UA_SERVICESTATISTICS_PUBLISHLATENCY99) {
+            vattr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+            vattr.arrayDimensions = &arrayDims;
+            vattr.arrayDimensionsSize = 1;
+        } else {
+            vattr.valueRank = UA_VALUERANK_SCALAR;
+        }
+        UA_snprintf(id, sizeof(id), "ServerDiagnostics.ServiceStatistics.%s", name);
+        retval |= UA_Server_addDataSourceVariableNode(server, UA_NODEID_STRING(1, id), objectId,
+                                                      UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                                      UA_QUALIFIEDNAME(1, (char*)(uintptr_t)name),
+                                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                                      vattr, serviceStatistics,
+                                                      (void*)(uintptr_t)i, NULL);
+    }
+    return retval;
+}
+
+#endif /* UA_ENABLE_SERVICE_STATISTICS */
 #endif
 
 static UA_StatusCode
@@ -857,14 +1109,23 @@ UA_Server_initNS0(UA_Server *server) {
                         UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVICELEVEL), serviceLevel);
 
     /* ServerDiagnostics - ServerDiagnosticsSummary */
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    UA_DataSource diagnosticsSummary = {readDiagnosticsSummary, NULL};
+    for(size_t i = 0; i < sizeof(diagnosticsSummaryNodes) / sizeof(UA_UInt32); i++)
+        retVal |= UA_Server_setVariableNode_dataSource(server,
+                            UA_NODEID_NUMERIC(0, diagnosticsSummaryNodes[i]), diagnosticsSummary);
+    retVal |= addServiceStatisticsNodes(server);
+    UA_Boolean enabledFlag = true;
+#else
     UA_ServerDiagnosticsSummaryDataType serverDiagnosticsSummary;
     UA_ServerDiagnosticsSummaryDataType_init(&serverDiagnosticsSummary);
     retVal |= writeNs0Variable(server, UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY,
                                &serverDiagnosticsSummary,
                                &UA_TYPES[UA_TYPES_SERVERDIAGNOSTICSSUMMARYDATATYPE]);
+    UA_Boolean enabledFlag = false;
+#endif
 
     /* ServerDiagnostics - EnabledFlag */
-    UA_Boolean enabledFlag = false;
     retVal |= writeNs0Variable(server, UA_NS0ID_SERVER_SERVERDIAGNOSTICS_ENABLEDFLAG,
                                &enabledFlag, &UA_TYPES[UA_TYPES_BOOLEAN]);
 
@@ -177,8 +177,12 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
     /* Read the value */
     if(vn->valueSource == UA_VALUESOURCE_DATA)
         retval = readValueAttributeFromNode(server, session, vn, v, rangeptr);
-    else
+    else if(vn->valueSource == UA_VALUESOURCE_DATASOURCE)
         retval = readValueAttributeFromDataSource(server, session, vn, v, timestamps, rangeptr);
+    else if(rangeptr) /* The ring contains only scalars */
+        retval = UA_STATUSCODE_BADINDEXRANGENODATA;
+    else
+        retval = UA_ValueRing_getLatest(vn->value.valueRing, v);
 
     /* Clean up */
     if(rangeptr)
@@ -1214,6 +1218,15 @@ writeValueAttribute(UA_Server *server, UA_Session *session,
             UA_LOCK(server->serviceMutex);
 
         }
+    } else if(node->valueSource == UA_VALUESOURCE_VALUERING) {
+        if(rangeptr)
+            retval = UA_STATUSCODE_BADINDEXRANGEINVALID;
+        else if(!adjustedValue.hasValue)
+            retval = UA_STATUSCODE_BADTYPEMISMATCH;
+        else
+            retval = UA_ValueRing_push(node->value.valueRing, &adjustedValue.value,
+                                       adjustedValue.hasSourceTimestamp ?
+                                       adjustedValue.sourceTimestamp : 0);
     } else {
         if(node->value.dataSource.write) {
             UA_UNLOCK(server->serviceMutex);
@@ -1460,11 +1473,25 @@ copyAttributeIntoNode(UA_Server *server, UA_Session *session,
     return retval;
 }
 
+static UA_StatusCode
+editNodeAttribute(UA_Server *server, UA_Session *session, const UA_WriteValue *wv) {
+    UA_StatusCode retval =
+        UA_Server_editNode(server, session, &wv->nodeId,
+                           (UA_EditNodeCallback)copyAttributeIntoNode,
+                           /* casting away const qualifier because callback uses const anyway */
+                           (UA_WriteValue *)(uintptr_t)wv);
+#if defined(UA_ENABLE_PUBSUB) && defined(UA_ENABLE_PUBSUB_DELTAFRAMES)
+    /* Delta frames sample only the published values that were written */
+    if(retval == UA_STATUSCODE_GOOD && wv->attributeId == UA_ATTRIBUTEID_VALUE)
+        UA_DataSetField_valueWritten(server, &wv->nodeId);
+#endif
+    return retval;
+}
+
 static void
 Operation_Write(UA_Server *server, UA_Session *session, void *context,
                 UA_WriteValue *wv, UA_StatusCode *result) {
-    *result = UA_Server_editNode(server, session, &wv->nodeId,
-                        (UA_EditNodeCallback)copyAttributeIntoNode, wv);
+    *result = editNodeAttribute(server, session, wv);
 }
 
 void
@@ -1492,19 +1519,13 @@ Service_Write(UA_Server *server, UA_Session *session,
 UA_StatusCode
 writeWithSession(UA_Server *server, UA_Session *session,
                            const UA_WriteValue *value) {
-    return UA_Server_editNode(server, session, &value->nodeId,
-                              (UA_EditNodeCallback)copyAttributeIntoNode,
-                              /* casting away const qualifier because callback uses const anyway */
-                              (UA_WriteValue *)(uintptr_t)value);
+    return editNodeAttribute(server, session, value);
 }
 
 UA_StatusCode
 writeAttribute(UA_Server *server, const UA_WriteValue *value) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
-    return UA_Server_editNode(server, &server->adminSession, &value->nodeId,
-                              (UA_EditNodeCallback)copyAttributeIntoNode,
-                               /* casting away const qualifier because callback uses const anyway */
-                              (UA_WriteValue *)(uintptr_t)value);
+    return editNodeAttribute(server, &server->adminSession, value);
 }
 
 UA_StatusCode
@@ -141,8 +141,7 @@ setMonitoredItemSettings(UA_Server *server, UA_Session *session, UA_MonitoredIte
     UA_MonitoredItem_unregisterSampleCallback(server, mon);
 
     /* Remove the old samples */
-    UA_ByteString_clear(&mon->lastSampledValue);
-    UA_Variant_clear(&mon->lastValue);
+    UA_MonitoredItem_clearLastSample(mon);
 
     /* ClientHandle */
     mon->clientHandle = params->clientHandle;
@@ -540,9 +539,8 @@ Operation_SetMonitoringMode(UA_Server *server, UA_Session *session,
             UA_Notification_delete(notification);
         }
 
-        /* Initialize lastSampledValue */
-        UA_ByteString_clear(&mon->lastSampledValue);
-        UA_Variant_clear(&mon->lastValue);
+        /* Forget the last sample */
+        UA_MonitoredItem_clearLastSample(mon);
     }
 }
 
@@ -1575,6 +1575,11 @@ recursiveDeleteNode(UA_Server *server, UA_Session *session,
     if(removeTargetRefs)
         removeIncomingReferences(server, session, node);
 
+#if defined(UA_ENABLE_PUBSUB) && defined(UA_ENABLE_PUBSUB_DELTAFRAMES)
+    /* A new node with the same NodeId might not be trackable */
+    UA_DataSetField_valueSourceChanged(server, &node->nodeId);
+#endif
+
     UA_NODESTORE_REMOVE(server, &node->nodeId);
 }
 
@@ -1920,6 +1925,10 @@ setValueCallback(UA_Server *server, UA_Session *session,
     if(node->nodeClass != UA_NODECLASS_VARIABLE)
         return UA_STATUSCODE_BADNODECLASSINVALID;
     node->value.data.callback = *callback;
+#if defined(UA_ENABLE_PUBSUB) && defined(UA_ENABLE_PUBSUB_DELTAFRAMES)
+    if(callback->onRead)
+        UA_DataSetField_valueSourceChanged(server, &node->nodeId);
+#endif
     return UA_STATUSCODE_GOOD;
 }
 
@@ -2004,6 +2013,9 @@ setDataSource(UA_Server *server, UA_Session *session,
         UA_DataValue_clear(&node->value.data.value);
     node->value.dataSource = *dataSource;
     node->valueSource = UA_VALUESOURCE_DATASOURCE;
+#if defined(UA_ENABLE_PUBSUB) && defined(UA_ENABLE_PUBSUB_DELTAFRAMES)
+    UA_DataSetField_valueSourceChanged(server, &node->nodeId);
+#endif
     return UA_STATUSCODE_GOOD;
 }
 
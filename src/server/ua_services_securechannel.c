@@ -17,6 +17,36 @@
     (type *)((uintptr_t)ptr - offsetof(type,member))
 #endif
 
+/* Entries with the same expiry are ordered by their memory address */
+static enum ZIP_CMP
+cmpChannelExpiry(const UA_DateTime *a, const UA_DateTime *b) {
+    if(*a < *b)
+        return ZIP_CMP_LESS;
+    if(*a > *b)
+        return ZIP_CMP_MORE;
+    if(a == b)
+        return ZIP_CMP_EQ;
+    if(a < b)
+        return ZIP_CMP_LESS;
+    return ZIP_CMP_MORE;
+}
+
+ZIP_IMPL(UA_ChannelExpiryZip, channel_entry, expiryZipfields,
+         UA_DateTime, expiry, cmpChannelExpiry)
+
+static UA_DateTime
+channelTimeout(const UA_ChannelSecurityToken *token) {
+    return token->createdAt + (UA_DateTime)(token->revisedLifetime * UA_DATETIME_MSEC);
+}
+
+static void
+setChannelExpiry(UA_Server *server, channel_entry *entry, UA_DateTime expiry) {
+    ZIP_REMOVE(UA_ChannelExpiryZip, &server->channelsByExpiry, entry);
+    entry->expiry = expiry;
+    ZIP_INSERT(UA_ChannelExpiryZip, &server->channelsByExpiry, entry,
+               ZIP_RANK(entry, expiryZipfields));
+}
+
 static void
 removeSecureChannelCallback(void *_, channel_entry *entry) {
     UA_SecureChannel_deleteMembers(&entry->channel);
@@ -30,6 +60,7 @@ removeSecureChannel(UA_Server *server, channel_entry *entry,
 
     /* Detach the channel */
     TAILQ_REMOVE(&server->channels, entry, pointers);
+    ZIP_REMOVE(UA_ChannelExpiryZip, &server->channelsByExpiry, entry);
 
     /* Update the statistics */
     UA_SecureChannelStatistics *scs = &server->serverStats.scs;
@@ -70,12 +101,14 @@ UA_Server_deleteSecureChannels(UA_Server *server) {
         removeSecureChannel(server, entry, UA_DIAGNOSTICEVENT_CLOSE);
 }
 
-/* remove channels that were not renewed or who have no connection attached */
+/* Remove channels that were not renewed or who have no connection attached.
+ * Only the channels whose expiry has been reached are visited. */
 void
 UA_Server_cleanupTimedOutSecureChannels(UA_Server *server,
                                         UA_DateTime nowMonotonic) {
-    channel_entry *entry, *temp;
-    TAILQ_FOREACH_SAFE(entry, &server->channels, pointers, temp) {
+    channel_entry *entry;
+    while((entry = ZIP_MIN(UA_ChannelExpiryZip, &server->channelsByExpiry)) &&
+          entry->expiry < nowMonotonic) {
         /* The channel was closed internally */
         if(entry->channel.state == UA_SECURECHANNELSTATE_CLOSED ||
            !entry->channel.connection) {
@@ -84,17 +117,26 @@ UA_Server_cleanupTimedOutSecureChannels(UA_Server *server,
         }
 
         /* The channel has timed out */
-        UA_DateTime timeout =
-            entry->channel.securityToken.createdAt +
-            (UA_DateTime)(entry->channel.securityToken.revisedLifetime * UA_DATETIME_MSEC);
+        UA_DateTime timeout = channelTimeout(&entry->channel.securityToken);
         if(timeout < nowMonotonic) {
             UA_LOG_INFO_CHANNEL(&server->config.logger, &entry->channel,
                                 "SecureChannel has timed out");
             removeSecureChannel(server, entry, UA_DIAGNOSTICEVENT_TIMEOUT);
+            continue;
         }
+
+        /* The token was renewed in the meantime */
+        setChannelExpiry(server, entry, timeout);
     }
 }
 
+void
+UA_Server_expireSecureChannel(UA_Server *server, UA_SecureChannel *channel) {
+    UA_LOCK_ASSERT(server->serviceMutex, 1);
+    setChannelExpiry(server, container_of(channel, channel_entry, channel),
+                     UA_INT64_MIN);
+}
+
 /* remove the first channel that has no session attached */
 static UA_Boolean
 purgeFirstChannelWithoutSession(UA_Server *server) {
@@ -113,6 +155,7 @@ purgeFirstChannelWithoutSession(UA_Server *server) {
 
 UA_StatusCode
 UA_Server_createSecureChannel(UA_Server *server, UA_Connection *connection) {
+    UA_LOCK_ASSERT(server->serviceMutex, 1);
     /* connection already has a channel attached. */
     if(connection->channel != NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
@@ -140,6 +183,9 @@ UA_Server_createSecureChannel(UA_Server *server, UA_Connection *connection) {
     entry->channel.securityToken.revisedLifetime = server->config.maxSecurityTokenLifetime;
 
     TAILQ_INSERT_TAIL(&server->channels, entry, pointers);
+    entry->expiry = channelTimeout(&entry->channel.securityToken);
+    ZIP_INSERT(UA_ChannelExpiryZip, &server->channelsByExpiry, entry,
+               ZIP_FFS32(UA_UInt32_random()));
     UA_Connection_attachSecureChannel(connection, &entry->channel);
     UA_atomic_addSize(&server->serverStats.scs.currentChannelCount, 1);
     UA_atomic_addSize(&server->serverStats.scs.cumulatedChannelCount, 1);
@@ -240,6 +286,9 @@ UA_SecureChannelManager_open(UA_Server *server, UA_SecureChannel *channel,
     /* Reset the internal creation date to the monotonic clock */
     channel->securityToken.createdAt = UA_DateTime_nowMonotonic();
 
+    /* The requested lifetime can be shorter than the initial lifetime */
+    setChannelExpiry(server, container_of(channel, channel_entry, channel),
+                     channelTimeout(&channel->securityToken));
     return UA_STATUSCODE_GOOD;
 }
 
@@ -287,13 +336,22 @@ UA_SecureChannelManager_renew(UA_Server *server, UA_SecureChannel *channel,
 
     /* Reset the internal creation date to the monotonic clock */
     channel->nextSecurityToken.createdAt = UA_DateTime_nowMonotonic();
+
+    /* The channel times out with either the current or the next token. Keep
+     * the expiry a lower bound for both. */
+    channel_entry *entry = container_of(channel, channel_entry, channel);
+    UA_DateTime nextTimeout = channelTimeout(&channel->nextSecurityToken);
+    if(nextTimeout < entry->expiry)
+        setChannelExpiry(server, entry, nextTimeout);
     return UA_STATUSCODE_GOOD;
 }
 
 void
 UA_Server_closeSecureChannel(UA_Server *server, UA_SecureChannel *channel,
                              UA_DiagnosticEvent event) {
+    UA_LOCK(server->serviceMutex);
     removeSecureChannel(server, container_of(channel, channel_entry, channel), event);
+    UA_UNLOCK(server->serviceMutex);
 }
 
 void
@@ -16,6 +16,79 @@
 #include "ua_services.h"
 #include "ua_server_internal.h"
 
+#define UA_SESSIONBUCKETS_INITIAL 16
+
+/* Entries with the same expiry are ordered by their memory address */
+static enum ZIP_CMP
+cmpSessionExpiry(const UA_DateTime *a, const UA_DateTime *b) {
+    if(*a < *b)
+        return ZIP_CMP_LESS;
+    if(*a > *b)
+        return ZIP_CMP_MORE;
+    if(a == b)
+        return ZIP_CMP_EQ;
+    if(a < b)
+        return ZIP_CMP_LESS;
+    return ZIP_CMP_MORE;
+}
+
+ZIP_IMPL(UA_SessionExpiryZip, session_list_entry, expiryZipfields,
+         UA_DateTime, expiry, cmpSessionExpiry)
+
+static session_bucket *
+getSessionBucket(UA_Server *server, const UA_NodeId *id) {
+    return &server->sessionBuckets[UA_NodeId_hash(id) & (server->sessionBucketsSize - 1)];
+}
+
+static void
+indexSession(UA_Server *server, session_list_entry *sentry) {
+    session_bucket *b = getSessionBucket(server, &sentry->session.header.authenticationToken);
+    LIST_INSERT_HEAD(&b->byToken, sentry, tokenPointers);
+    b = getSessionBucket(server, &sentry->session.sessionId);
+    LIST_INSERT_HEAD(&b->byId, sentry, idPointers);
+}
+
+/* Double the number of buckets and rehash the sessions */
+static UA_StatusCode
+growSessionBuckets(UA_Server *server) {
+    size_t newSize = (server->sessionBucketsSize == 0) ?
+        UA_SESSIONBUCKETS_INITIAL : server->sessionBucketsSize * 2;
+    session_bucket *buckets = (session_bucket*)UA_calloc(newSize, sizeof(session_bucket));
+    if(!buckets)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_free(server->sessionBuckets);
+    server->sessionBuckets = buckets;
+    server->sessionBucketsSize = newSize;
+    session_list_entry *sentry;
+    LIST_FOREACH(sentry, &server->sessions, pointers)
+        indexSession(server, sentry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static session_list_entry *
+findSessionByToken(UA_Server *server, const UA_NodeId *token) {
+    if(server->sessionBucketsSize == 0)
+        return NULL;
+    session_list_entry *sentry;
+    LIST_FOREACH(sentry, &getSessionBucket(server, token)->byToken, tokenPointers) {
+        if(UA_NodeId_equal(&sentry->session.header.authenticationToken, token))
+            return sentry;
+    }
+    return NULL;
+}
+
+static session_list_entry *
+findSessionById(UA_Server *server, const UA_NodeId *sessionId) {
+    if(server->sessionBucketsSize == 0)
+        return NULL;
+    session_list_entry *sentry;
+    LIST_FOREACH(sentry, &getSessionBucket(server, sessionId)->byId, idPointers) {
+        if(UA_NodeId_equal(&sentry->session.sessionId, sessionId))
+            return sentry;
+    }
+    return NULL;
+}
+
 /* Delayed callback to free the session memory */
 static void
 removeSessionCallback(UA_Server *server, session_list_entry *entry) {
@@ -59,6 +132,9 @@ UA_Server_removeSession(UA_Server *server, session_list_entry *sentry,
     /* Detach the session from the session manager and make the capacity
      * available */
     LIST_REMOVE(sentry, pointers);
+    LIST_REMOVE(sentry, tokenPointers);
+    LIST_REMOVE(sentry, idPointers);
+    ZIP_REMOVE(UA_SessionExpiryZip, &server->sessionsByExpiry, sentry);
     UA_atomic_subUInt32(&server->sessionCount, 1);
     UA_atomic_subSize(&server->serverStats.ss.currentSessionCount, 1);
 
@@ -95,26 +171,33 @@ UA_StatusCode
 UA_Server_removeSessionByToken(UA_Server *server, const UA_NodeId *token,
                                UA_DiagnosticEvent event) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
-    session_list_entry *entry;
-    LIST_FOREACH(entry, &server->sessions, pointers) {
-        if(UA_NodeId_equal(&entry->session.header.authenticationToken, token)) {
-            UA_Server_removeSession(server, entry, event);
-            return UA_STATUSCODE_GOOD;
-        }
-    }
-    return UA_STATUSCODE_BADSESSIONIDINVALID;
+    session_list_entry *entry = findSessionByToken(server, token);
+    if(!entry)
+        return UA_STATUSCODE_BADSESSIONIDINVALID;
+    UA_Server_removeSession(server, entry, event);
+    return UA_STATUSCODE_GOOD;
 }
 
+/* The sessions are sorted by a lower bound of validTill. Only the sessions
+ * where the bound has been reached are visited. Then either the session has
+ * timed out or the bound is moved to the current validTill. */
 void
 UA_Server_cleanupSessions(UA_Server *server, UA_DateTime nowMonotonic) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
-    session_list_entry *sentry, *temp;
-    LIST_FOREACH_SAFE(sentry, &server->sessions, pointers, temp) {
+    session_list_entry *sentry;
+    while((sentry = ZIP_MIN(UA_SessionExpiryZip, &server->sessionsByExpiry)) &&
+          sentry->expiry < nowMonotonic) {
         /* Session has timed out? */
-        if(sentry->session.validTill >= nowMonotonic)
+        if(sentry->session.validTill < nowMonotonic) {
+            UA_LOG_INFO_SESSION(&server->config.logger, &sentry->session,
+                                "Session has timed out");
+            UA_Server_removeSession(server, sentry, UA_DIAGNOSTICEVENT_TIMEOUT);
             continue;
-        UA_LOG_INFO_SESSION(&server->config.logger, &sentry->session, "Session has timed out");
-        UA_Server_removeSession(server, sentry, UA_DIAGNOSTICEVENT_TIMEOUT);
+        }
+        ZIP_REMOVE(UA_SessionExpiryZip, &server->sessionsByExpiry, sentry);
+        sentry->expiry = sentry->session.validTill;
+        ZIP_INSERT(UA_SessionExpiryZip, &server->sessionsByExpiry, sentry,
+                   ZIP_RANK(sentry, expiryZipfields));
     }
 }
 
@@ -126,46 +209,36 @@ static UA_Session *
 getSessionByToken(UA_Server *server, const UA_NodeId *token) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
 
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.header.authenticationToken, token))
-            continue;
+    session_list_entry *current = findSessionByToken(server, token);
+    if(!current)
+        return NULL;
 
-        /* Session has timed out */
-        if(UA_DateTime_nowMonotonic() > current->session.validTill) {
-            UA_LOG_INFO_SESSION(&server->config.logger, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
-
-        return &current->session;
+    /* Session has timed out */
+    if(UA_DateTime_nowMonotonic() > current->session.validTill) {
+        UA_LOG_INFO_SESSION(&server->config.logger, &current->session,
+                            "Client tries to use a session that has timed out");
+        return NULL;
     }
 
-    return NULL;
+    return &current->session;
 }
 
 UA_Session *
 UA_Server_getSessionById(UA_Server *server, const UA_NodeId *sessionId) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
 
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.sessionId, sessionId))
-            continue;
-
-        /* Session has timed out */
-        if(UA_DateTime_nowMonotonic() > current->session.validTill) {
-            UA_LOG_INFO_SESSION(&server->config.logger, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
+    session_list_entry *current = findSessionById(server, sessionId);
+    if(!current)
+        return NULL;
 
-        return &current->session;
+    /* Session has timed out */
+    if(UA_DateTime_nowMonotonic() > current->session.validTill) {
+        UA_LOG_INFO_SESSION(&server->config.logger, &current->session,
+                            "Client tries to use a session that has timed out");
+        return NULL;
     }
 
-    return NULL;
+    return &current->session;
 }
 
 static UA_StatusCode
@@ -216,6 +289,13 @@ UA_Server_createSession(UA_Server *server, UA_SecureChannel *channel,
     if(server->sessionCount >= server->config.maxSessions)
         return UA_STATUSCODE_BADTOOMANYSESSIONS;
 
+    /* Grow the hash index. Continue with a higher load if this fails. */
+    if(server->sessionCount >= server->sessionBucketsSize) {
+        UA_StatusCode res = growSessionBuckets(server);
+        if(res != UA_STATUSCODE_GOOD && server->sessionBucketsSize == 0)
+            return res;
+    }
+
     session_list_entry *newentry = (session_list_entry *)UA_malloc(sizeof(session_list_entry));
     if(!newentry)
         return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -233,6 +313,10 @@ UA_Server_createSession(UA_Server *server, UA_SecureChannel *channel,
 
     UA_Session_updateLifetime(&newentry->session);
     LIST_INSERT_HEAD(&server->sessions, newentry, pointers);
+    indexSession(server, newentry);
+    newentry->expiry = newentry->session.validTill;
+    ZIP_INSERT(UA_SessionExpiryZip, &server->sessionsByExpiry, newentry,
+               ZIP_FFS32(UA_UInt32_random()));
     *session = &newentry->session;
     return UA_STATUSCODE_GOOD;
 }
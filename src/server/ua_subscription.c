@@ -22,6 +22,18 @@
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS /* conditional compilation */
 
+static enum ZIP_CMP
+cmpMonitoredItemId(const UA_UInt32 *a, const UA_UInt32 *b) {
+    if(*a < *b)
+        return ZIP_CMP_LESS;
+    if(*a == *b)
+        return ZIP_CMP_EQ;
+    return ZIP_CMP_MORE;
+}
+
+ZIP_IMPL(UA_MonitoredItemIdTree, UA_MonitoredItem, idTreeFields,
+         UA_UInt32, monitoredItemId, cmpMonitoredItemId)
+
 UA_Subscription *
 UA_Subscription_new(UA_Session *session, UA_UInt32 subscriptionId) {
     /* Allocate the memory */
@@ -39,6 +51,7 @@ UA_Subscription_new(UA_Session *session, UA_UInt32 subscriptionId) {
     newSub->nextSequenceNumber = 1;
     TAILQ_INIT(&newSub->retransmissionQueue);
     TAILQ_INIT(&newSub->notificationQueue);
+    ZIP_INIT(&newSub->monitoredItemsById);
     return newSub;
 }
 
@@ -52,6 +65,7 @@ UA_Subscription_deleteMembers(UA_Server *server, UA_Subscription *sub) {
     UA_MonitoredItem *mon, *tmp_mon;
     LIST_FOREACH_SAFE(mon, &sub->monitoredItems, listEntry, tmp_mon) {
         LIST_REMOVE(mon, listEntry);
+        ZIP_REMOVE(UA_MonitoredItemIdTree, &sub->monitoredItemsById, mon);
         UA_LOG_INFO_SESSION(&server->config.logger, sub->session,
                             "Subscription %" PRIu32 " | MonitoredItem %" PRIi32 " | "
                             "Deleted the MonitoredItem", sub->subscriptionId,
@@ -80,12 +94,7 @@ UA_Subscription_deleteMembers(UA_Server *server, UA_Subscription *sub) {
 
 UA_MonitoredItem *
 UA_Subscription_getMonitoredItem(UA_Subscription *sub, UA_UInt32 monitoredItemId) {
-    UA_MonitoredItem *mon;
-    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-        if(mon->monitoredItemId == monitoredItemId)
-            break;
-    }
-    return mon;
+    return ZIP_FIND(UA_MonitoredItemIdTree, &sub->monitoredItemsById, &monitoredItemId);
 }
 
 UA_StatusCode
@@ -94,11 +103,7 @@ UA_Subscription_deleteMonitoredItem(UA_Server *server, UA_Subscription *sub,
     UA_LOCK_ASSERT(server->serviceMutex, 1);
 
     /* Find the MonitoredItem */
-    UA_MonitoredItem *mon;
-    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-        if(mon->monitoredItemId == monitoredItemId)
-            break;
-    }
+    UA_MonitoredItem *mon = UA_Subscription_getMonitoredItem(sub, monitoredItemId);
     if(!mon)
         return UA_STATUSCODE_BADMONITOREDITEMIDINVALID;
 
@@ -109,6 +114,7 @@ UA_Subscription_deleteMonitoredItem(UA_Server *server, UA_Subscription *sub,
 
     /* Remove the MonitoredItem */
     LIST_REMOVE(mon, listEntry);
+    ZIP_REMOVE(UA_MonitoredItemIdTree, &sub->monitoredItemsById, mon);
     UA_assert(sub->monitoredItemsSize > 0);
     UA_assert(server->numMonitoredItems > 0);
     sub->monitoredItemsSize--;
@@ -125,6 +131,8 @@ UA_Subscription_addMonitoredItem(UA_Server *server, UA_Subscription *sub, UA_Mon
     sub->monitoredItemsSize++;
     server->numMonitoredItems++;
     LIST_INSERT_HEAD(&sub->monitoredItems, newMon, listEntry);
+    ZIP_INSERT(UA_MonitoredItemIdTree, &sub->monitoredItemsById, newMon,
+               ZIP_FFS32(UA_UInt32_random()));
 }
 
 static void
@@ -358,6 +366,9 @@ publishCallback(UA_Server *server, UA_Subscription *sub) {
 void
 UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    UA_DateTime started = UA_DateTime_nowMonotonic();
+#endif
 
     UA_LOG_DEBUG_SESSION(&server->config.logger, sub->session, "Subscription %" PRIu32 " | "
                          "Publish Callback", sub->subscriptionId);
@@ -507,6 +518,10 @@ UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
     UA_SecureChannel_sendSymmetricMessage(sub->session->header.channel, pre->requestId,
                                           UA_MESSAGETYPE_MSG, response,
                                           &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    UA_LatencyHistogram_record(&server->serviceStats.publishLatency,
+                               UA_DateTime_nowMonotonic() - started);
+#endif
 
     /* Reset subscription state to normal */
     sub->state = UA_SUBSCRIPTIONSTATE_NORMAL;
@@ -155,9 +155,27 @@ void UA_Notification_delete(UA_Notification *n);
 
 typedef TAILQ_HEAD(NotificationQueue, UA_Notification) NotificationQueue;
 
+/* MonitoredItems with the same sampling interval share a repeated callback
+ * and are sampled in one batch */
+typedef struct UA_SamplingGroup {
+    UA_DelayedCallback delayedFreePointers;
+    LIST_ENTRY(UA_SamplingGroup) listEntry;
+    UA_Double samplingInterval; /* [ms] */
+    UA_UInt64 callbackId;
+    TAILQ_HEAD(, UA_MonitoredItem) monitoredItems;
+    UA_MonitoredItem *nextSample; /* Next MonitoredItem in the running batch */
+    UA_Boolean sampling;
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    UA_DateTime lastSample; /* Monotonic start of the last batch */
+#endif
+} UA_SamplingGroup;
+
+void UA_SamplingGroup_sampleCallback(UA_Server *server, UA_SamplingGroup *group);
+
 struct UA_MonitoredItem {
     UA_DelayedCallback delayedFreePointers;
     LIST_ENTRY(UA_MonitoredItem) listEntry;
+    ZIP_ENTRY(UA_MonitoredItem) idTreeFields; /* Lookup in the Subscription */
     UA_Subscription *subscription; /* Local MonitoredItem if the subscription is NULL */
     UA_UInt32 monitoredItemId;
     UA_UInt32 clientHandle;
@@ -191,12 +209,24 @@ struct UA_MonitoredItem {
          * changed at runtime of the MonitoredItem */
         UA_DataChangeFilter dataChangeFilter;
     } filter;
-    UA_Variant lastValue; // TODO: dataEncoding is hardcoded to UA binary
 
-    /* Sample Callback */
-    UA_UInt64 sampleCallbackId;
-    UA_ByteString lastSampledValue;
-    UA_Boolean sampleCallbackIsRegistered;
+    /* The last sample with the filter applied. Values of an overlayable type
+     * (and numeric values for the deadband) are kept in lastValue and compared
+     * in place. All other values are compared by their binary encoding. With
+     * UA_ENABLE_SUBSCRIPTIONS_FINGERPRINT, only a 64-bit fingerprint of the
+     * encoding is kept instead. */
+    UA_Boolean hasLastSample;
+    UA_Boolean lastSampleEncoded; /* Compare the encoding, not lastValue */
+    UA_DataValue lastValue;
+#ifdef UA_ENABLE_SUBSCRIPTIONS_FINGERPRINT
+    UA_UInt64 lastFingerprint;
+#else
+    UA_ByteString lastEncoding;
+#endif
+
+    /* Sampling */
+    UA_SamplingGroup *samplingGroup; /* NULL if the sampling is not registered */
+    TAILQ_ENTRY(UA_MonitoredItem) samplingEntry;
 
     /* Notification Queue */
     NotificationQueue queue;
@@ -209,15 +239,16 @@ struct UA_MonitoredItem {
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
     UA_MonitoredItem *next;
 #endif
-
-#ifdef UA_ENABLE_DA
-    UA_StatusCode lastStatus;
-#endif
 };
 
+ZIP_HEAD(UA_MonitoredItemIdTree, UA_MonitoredItem);
+ZIP_PROTTYPE(UA_MonitoredItemIdTree, UA_MonitoredItem, UA_UInt32)
+
 void UA_MonitoredItem_init(UA_MonitoredItem *mon, UA_Subscription *sub);
 void UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *monitoredItem);
 void UA_MonitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem);
+/* Forget the last sample. The next sample is always reported as a change. */
+void UA_MonitoredItem_clearLastSample(UA_MonitoredItem *mon);
 UA_StatusCode UA_MonitoredItem_registerSampleCallback(UA_Server *server, UA_MonitoredItem *mon);
 void UA_MonitoredItem_unregisterSampleCallback(UA_Server *server, UA_MonitoredItem *mon);
 
@@ -278,6 +309,7 @@ struct UA_Subscription {
     /* MonitoredItems */
     UA_UInt32 lastMonitoredItemId; /* increase the identifiers */
     LIST_HEAD(, UA_MonitoredItem) monitoredItems;
+    struct UA_MonitoredItemIdTree monitoredItemsById;
     UA_UInt32 monitoredItemsSize;
 
     /* Global list of notifications from the MonitoredItems */
@@ -75,23 +75,142 @@ updateNeededForFilteredValue(const UA_Variant *value, const UA_Variant *oldValue
     return false;
 }
 
-/* When a change is detected, encoding contains the heap-allocated binary
- * encoded value. The default for changed is false. */
-static UA_StatusCode
-detectValueChangeWithFilter(UA_Server *server, UA_Session *session, UA_MonitoredItem *mon,
-                            UA_DataValue *value, UA_ByteString *encoding, UA_Boolean *changed) {
-    /* Check for absolute deadband */
-    if(UA_DataType_isNumeric(value->value.type) &&
-       mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_ABSOLUTE) {
-        UA_assert(value->value.type);
-        if(mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUE ||
-           mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP) {
-            if(!updateNeededForFilteredValue(&value->value, &mon->lastValue,
-                                             mon->filter.dataChangeFilter.deadbandValue))
-                return UA_STATUSCODE_GOOD;
-        }
+/* The binary encoding of overlayable types is identical to their memory
+ * representation. Such values are compared in place without encoding. */
+static UA_Boolean
+comparedInPlace(const UA_DataValue *value) {
+    return (!value->hasValue || !value->value.type ||
+            value->value.type->overlayable);
+}
+
+/* Numeric values are kept for the deadband, even if they are not overlayable
+ * on the current architecture */
+static UA_Boolean
+keepLastValue(const UA_DataValue *value) {
+    return (value->hasValue && value->value.type &&
+            (value->value.type->overlayable ||
+             UA_DataType_isNumeric(value->value.type)));
+}
+
+/* Compares like the binary encoding of variants with an overlayable type */
+static UA_Boolean
+sameOverlayableVariant(const UA_Variant *v1, const UA_Variant *v2) {
+    if(v1->type != v2->type)
+        return false;
+    if(!v1->type)
+        return true;
+    if(v1->arrayLength != v2->arrayLength ||
+       UA_Variant_isScalar(v1) != UA_Variant_isScalar(v2) ||
+       (v1->data == NULL) != (v2->data == NULL) ||
+       v1->arrayDimensionsSize != v2->arrayDimensionsSize)
+        return false;
+    if(v1->arrayDimensionsSize > 0 &&
+       memcmp(v1->arrayDimensions, v2->arrayDimensions,
+              sizeof(UA_UInt32) * v1->arrayDimensionsSize) != 0)
+        return false;
+    size_t length = 1;
+    if(!UA_Variant_isScalar(v1))
+        length = v1->arrayLength;
+    if(length == 0)
+        return true;
+    return (memcmp(v1->data, v2->data, length * v1->type->memSize) == 0);
+}
+
+static UA_Boolean
+sameSample(const UA_DataValue *v1, const UA_DataValue *v2) {
+    if(v1->hasValue != v2->hasValue || v1->hasStatus != v2->hasStatus ||
+       v1->hasSourceTimestamp != v2->hasSourceTimestamp ||
+       v1->hasSourcePicoseconds != v2->hasSourcePicoseconds ||
+       v1->hasServerTimestamp != v2->hasServerTimestamp ||
+       v1->hasServerPicoseconds != v2->hasServerPicoseconds)
+        return false;
+    if((v1->hasStatus && v1->status != v2->status) ||
+       (v1->hasSourceTimestamp && v1->sourceTimestamp != v2->sourceTimestamp) ||
+       (v1->hasSourcePicoseconds && v1->sourcePicoseconds != v2->sourcePicoseconds) ||
+       (v1->hasServerTimestamp && v1->serverTimestamp != v2->serverTimestamp) ||
+       (v1->hasServerPicoseconds && v1->serverPicoseconds != v2->serverPicoseconds))
+        return false;
+    return (!v1->hasValue || sameOverlayableVariant(&v1->value, &v2->value));
+}
+
+/* Encoding of a changed sample that is not compared in place. It is stored in
+ * the MonitoredItem once the notification was enqueued. */
+typedef struct {
+    UA_Boolean encoded;
+#ifdef UA_ENABLE_SUBSCRIPTIONS_FINGERPRINT
+    UA_UInt64 fingerprint;
+#else
+    UA_ByteString encoding; /* Heap-allocated */
+#endif
+} SampleEncoding;
+
+static void
+SampleEncoding_clear(SampleEncoding *enc) {
+#ifndef UA_ENABLE_SUBSCRIPTIONS_FINGERPRINT
+    UA_ByteString_clear(&enc->encoding);
+#endif
+    enc->encoded = false;
+}
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_FINGERPRINT
+
+/* The value is encoded piecewise into a buffer on the stack. Every time the
+ * buffer is full, the content is folded into the fingerprint and the buffer is
+ * reused. */
+typedef struct {
+    UA_Byte *buf;
+    UA_UInt64 fingerprint;
+} FingerprintContext;
+
+static void
+foldFingerprint(FingerprintContext *ctx, const UA_Byte *end) {
+    UA_UInt64 h = ctx->fingerprint;
+    const UA_Byte *pos = ctx->buf;
+    for(; pos + sizeof(UA_UInt64) <= end; pos += sizeof(UA_UInt64)) {
+        UA_UInt64 word;
+        memcpy(&word, pos, sizeof(UA_UInt64));
+        h = (h ^ word) * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
     }
+    for(; pos < end; pos++)
+        h = (h ^ *pos) * 0x100000001b3ULL;
+    ctx->fingerprint = h;
+}
+
+static UA_StatusCode
+exchangeFingerprintBuffer(void *handle, UA_Byte **bufPos, const UA_Byte **bufEnd) {
+    FingerprintContext *ctx = (FingerprintContext*)handle;
+    foldFingerprint(ctx, *bufPos);
+    *bufPos = ctx->buf;
+    *bufEnd = &ctx->buf[UA_VALUENCODING_MAXSTACK];
+    return UA_STATUSCODE_GOOD;
+}
 
+static UA_StatusCode
+fingerprintValue(const UA_DataValue *value, UA_UInt64 *fingerprint) {
+    UA_STACKARRAY(UA_Byte, buf, UA_VALUENCODING_MAXSTACK);
+    FingerprintContext ctx;
+    ctx.buf = buf;
+    ctx.fingerprint = 0xcbf29ce484222325ULL;
+    UA_Byte *bufPos = buf;
+    const UA_Byte *bufEnd = &buf[UA_VALUENCODING_MAXSTACK];
+    UA_StatusCode retval = UA_encodeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE],
+                                           &bufPos, &bufEnd,
+                                           exchangeFingerprintBuffer, &ctx);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    foldFingerprint(&ctx, bufPos);
+    *fingerprint = ctx.fingerprint;
+    return UA_STATUSCODE_GOOD;
+}
+
+#else
+
+/* When a change is detected, encoding contains the heap-allocated binary
+ * encoded value */
+static UA_StatusCode
+detectEncodingChange(UA_MonitoredItem *mon, const UA_DataValue *value,
+                     UA_ByteString *encoding, UA_Boolean *changed) {
     /* Stack-allocate some memory for the value encoding. We might heap-allocate
      * more memory if needed. This is just enough for scalars and small
      * structures. */
@@ -128,8 +247,8 @@ detectValueChangeWithFilter(UA_Server *server, UA_Session *session, UA_Monitored
 
     /* Has the value changed? */
     valueEncoding.length = (uintptr_t)bufPos - (uintptr_t)valueEncoding.data;
-    *changed = (!mon->lastSampledValue.data ||
-                !UA_String_equal(&valueEncoding, &mon->lastSampledValue));
+    *changed = (!mon->hasLastSample || !mon->lastSampleEncoded ||
+                !UA_String_equal(&valueEncoding, &mon->lastEncoding));
 
     /* No change */
     if(!(*changed)) {
@@ -146,26 +265,116 @@ detectValueChangeWithFilter(UA_Server *server, UA_Session *session, UA_Monitored
     return UA_STATUSCODE_GOOD;
 }
 
-/* Has this sample changed from the last one? The method may allocate additional
- * space for the encoding buffer. Detect the change in encoding->data. */
+#endif
+
+void
+UA_MonitoredItem_clearLastSample(UA_MonitoredItem *mon) {
+    UA_DataValue_clear(&mon->lastValue);
+#ifndef UA_ENABLE_SUBSCRIPTIONS_FINGERPRINT
+    UA_ByteString_clear(&mon->lastEncoding);
+#endif
+    mon->hasLastSample = false;
+    mon->lastSampleEncoded = false;
+}
+
+/* Remember the filtered sample after a change was detected. Overlayable arrays
+ * of unchanged length are copied into the existing memory. If the copy fails,
+ * there is no last sample and the next sample is reported as a change. */
+static void
+storeLastSample(UA_MonitoredItem *mon, const UA_DataValue *value,
+                SampleEncoding *enc) {
+    UA_Variant *last = &mon->lastValue.value;
+    if(mon->hasLastSample && !enc->encoded && keepLastValue(value) &&
+       last->type == value->value.type && last->arrayLength > 0 &&
+       last->arrayLength == value->value.arrayLength &&
+       last->arrayDimensionsSize == 0 && value->value.arrayDimensionsSize == 0) {
+        memcpy(last->data, value->value.data,
+               last->arrayLength * last->type->memSize);
+    } else {
+        UA_Variant_clear(last);
+        if(keepLastValue(value) &&
+           UA_Variant_copy(&value->value, last) != UA_STATUSCODE_GOOD) {
+            UA_MonitoredItem_clearLastSample(mon);
+            SampleEncoding_clear(enc);
+            return;
+        }
+    }
+
+    /* Take the remaining fields from the filtered sample */
+    UA_Variant lastVariant = *last;
+    mon->lastValue = *value;
+    mon->lastValue.value = lastVariant;
+#ifdef UA_ENABLE_SUBSCRIPTIONS_FINGERPRINT
+    mon->lastFingerprint = enc->fingerprint;
+#else
+    UA_ByteString_clear(&mon->lastEncoding);
+    mon->lastEncoding = enc->encoding;
+    UA_ByteString_init(&enc->encoding);
+#endif
+    mon->lastSampleEncoded = enc->encoded;
+    mon->hasLastSample = true;
+}
+
+/* Has the filtered sample changed from the last one? For values that are not
+ * compared in place, enc contains the encoding (or fingerprint) if a change was
+ * detected. The default for changed is false. */
+static UA_StatusCode
+detectValueChangeWithFilter(UA_Server *server, UA_Session *session, UA_MonitoredItem *mon,
+                            const UA_DataValue *value, SampleEncoding *enc,
+                            UA_Boolean *changed) {
+    /* Check for absolute deadband */
+    if(UA_DataType_isNumeric(value->value.type) &&
+       mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_ABSOLUTE) {
+        UA_assert(value->value.type);
+        if(mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUE ||
+           mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP) {
+            if(!updateNeededForFilteredValue(&value->value, &mon->lastValue.value,
+                                             mon->filter.dataChangeFilter.deadbandValue))
+                return UA_STATUSCODE_GOOD;
+        }
+    }
+
+    /* Compare in place */
+    if(comparedInPlace(value)) {
+        *changed = (!mon->hasLastSample || mon->lastSampleEncoded ||
+                    !sameSample(value, &mon->lastValue));
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Compare the encoding */
+    enc->encoded = true;
+#ifdef UA_ENABLE_SUBSCRIPTIONS_FINGERPRINT
+    UA_StatusCode retval = fingerprintValue(value, &enc->fingerprint);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    *changed = (!mon->hasLastSample || !mon->lastSampleEncoded ||
+                enc->fingerprint != mon->lastFingerprint);
+    return UA_STATUSCODE_GOOD;
+#else
+    return detectEncodingChange(mon, value, &enc->encoding, changed);
+#endif
+}
+
+/* Has this sample changed from the last one? The filter is applied to a shallow
+ * copy of the sample. */
 static UA_StatusCode
-    detectValueChange(UA_Server *server, UA_Session *session, UA_MonitoredItem *mon,
-                  UA_DataValue value, UA_ByteString *encoding, UA_Boolean *changed) {
+detectValueChange(UA_Server *server, UA_Session *session, UA_MonitoredItem *mon,
+                  UA_DataValue *value, SampleEncoding *enc, UA_Boolean *changed) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
 
     /* Apply Filter */
     if(mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUS)
-        value.hasValue = false;
+        value->hasValue = false;
 
-    value.hasServerTimestamp = false;
-    value.hasServerPicoseconds = false;
+    value->hasServerTimestamp = false;
+    value->hasServerPicoseconds = false;
     if(mon->filter.dataChangeFilter.trigger < UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP) {
-        value.hasSourceTimestamp = false;
-        value.hasSourcePicoseconds = false;
+        value->hasSourceTimestamp = false;
+        value->hasSourcePicoseconds = false;
     }
 
     /* Detect the value change */
-    return detectValueChangeWithFilter(server, session, mon, &value, encoding, changed);
+    return detectValueChangeWithFilter(server, session, mon, value, enc, changed);
 }
 
 /* movedValue returns whether the sample was moved to the notification. The
@@ -176,13 +385,16 @@ sampleCallbackWithValue(UA_Server *server, UA_Session *session,
                         UA_DataValue *value, UA_Boolean *movedValue) {
     UA_assert(mon->attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER);
 
-    /* Contains heap-allocated binary encoding of the value if a change was detected */
-    UA_ByteString binValueEncoding = UA_BYTESTRING_NULL;
+    /* Contains the encoding of the value if a change was detected and the value
+     * is not compared in place */
+    SampleEncoding enc;
+    memset(&enc, 0, sizeof(SampleEncoding));
 
-    /* Has the value changed? Allocates memory in binValueEncoding if necessary.
-     * value is edited internally so we make a shallow copy. */
+    /* Has the value changed? The filter is applied to a shallow copy that is
+     * stored as the last sample. */
+    UA_DataValue filtered = *value;
     UA_Boolean changed = false;
-    UA_StatusCode retval = detectValueChange(server, session, mon, *value, &binValueEncoding, &changed);
+    UA_StatusCode retval = detectValueChange(server, session, mon, &filtered, &enc, &changed);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_SESSION(&server->config.logger, session, "Subscription %" PRIu32 " | "
                                "MonitoredItem %" PRIi32 " | Value change detection failed with StatusCode %s",
@@ -203,7 +415,7 @@ sampleCallbackWithValue(UA_Server *server, UA_Session *session,
         /* Allocate a new notification */
         UA_Notification *newNotification = (UA_Notification *)UA_malloc(sizeof(UA_Notification));
         if(!newNotification) {
-            UA_ByteString_clear(&binValueEncoding);
+            SampleEncoding_clear(&enc);
             return UA_STATUSCODE_BADOUTOFMEMORY;
         }
 
@@ -213,7 +425,7 @@ sampleCallbackWithValue(UA_Server *server, UA_Session *session,
         } else { /* => (value->value.storageType == UA_VARIANT_DATA_NODELETE) */
             retval = UA_DataValue_copy(value, &newNotification->data.value);
             if(retval != UA_STATUSCODE_GOOD) {
-                UA_ByteString_clear(&binValueEncoding);
+                SampleEncoding_clear(&enc);
                 UA_free(newNotification);
                 return retval;
             }
@@ -229,26 +441,9 @@ sampleCallbackWithValue(UA_Server *server, UA_Session *session,
         UA_Notification_enqueue(server, sub, mon, newNotification);
     }
 
-    /* Store the encoding for comparison */
-    UA_ByteString_clear(&mon->lastSampledValue);
-    mon->lastSampledValue = binValueEncoding;
-
-    /* Store the value for filter comparison (we don't want to decode
-     * lastSampledValue in every iteration). Don't test the return code here. If
-     * this fails, lastValue is empty and a notification will be forced for the
-     * next deadband comparison. */
-    if((mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_NONE ||
-        mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_ABSOLUTE ||
-        mon->filter.dataChangeFilter.deadbandType == UA_DEADBANDTYPE_PERCENT) &&
-       (mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUS ||
-        mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUE ||
-        mon->filter.dataChangeFilter.trigger == UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP)) {
-        UA_Variant_clear(&mon->lastValue);
-        UA_Variant_copy(&value->value, &mon->lastValue);
-#ifdef UA_ENABLE_DA
-        mon->lastStatus = value->status;
-#endif
-    }
+    /* Store the sample for comparison. The value was possibly moved to the
+     * notification but is still alive. */
+    storeLastSample(mon, &filtered, &enc);
 
     /* Call the local callback if the MonitoredItem is not attached to a
      * subscription. Do this at the very end. Because the callback might delete
@@ -277,10 +472,9 @@ UA_MonitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredIt
     UA_UNLOCK(server->serviceMutex)
 }
 
-void
-monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem) {
-    UA_LOCK_ASSERT(server->serviceMutex, 1);
-
+/* The node can be NULL if it does not exist */
+static void
+sampleWithNode(UA_Server *server, UA_MonitoredItem *monitoredItem, const UA_Node *node) {
     UA_Subscription *sub = monitoredItem->subscription;
     UA_Session *session = &server->adminSession;
     if(sub)
@@ -292,9 +486,6 @@ monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem)
 
     UA_assert(monitoredItem->attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER);
 
-    /* Get the node */
-    const UA_Node *node = UA_NODESTORE_GET(server, &monitoredItem->monitoredNodeId);
-
     /* Sample the value. The sample can still point into the node. */
     UA_DataValue value;
     UA_DataValue_init(&value);
@@ -323,8 +514,59 @@ monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem)
     /* Delete the sample if it was not moved to the notification. */
     if(!movedValue)
         UA_DataValue_clear(&value); /* Does nothing for UA_VARIANT_DATA_NODELETE */
+}
+
+void
+monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *monitoredItem) {
+    UA_LOCK_ASSERT(server->serviceMutex, 1);
+    const UA_Node *node = UA_NODESTORE_GET(server, &monitoredItem->monitoredNodeId);
+    sampleWithNode(server, monitoredItem, node);
+    if(node)
+        UA_NODESTORE_RELEASE(server, node);
+}
+
+/* Sample all MonitoredItems of the group under a single lock. Consecutive
+ * MonitoredItems on the same node share the node from the nodestore. */
+void
+UA_SamplingGroup_sampleCallback(UA_Server *server, UA_SamplingGroup *group) {
+    UA_LOCK(server->serviceMutex);
+
+    /* The lock is released during the sampling for callbacks into userland. A
+     * worker thread might start the next batch of the group in the meantime. */
+    if(group->sampling) {
+        UA_UNLOCK(server->serviceMutex);
+        return;
+    }
+    group->sampling = true;
+
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    /* Delay beyond the sampling interval since the last batch */
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    if(group->lastSample != 0)
+        UA_LatencyHistogram_record(&server->serviceStats.samplingLag, now - group->lastSample -
+                                   (UA_DateTime)(group->samplingInterval * UA_DATETIME_MSEC));
+    group->lastSample = now;
+#endif
+
+    const UA_Node *node = NULL;
+    UA_MonitoredItem *mon = TAILQ_FIRST(&group->monitoredItems);
+    while(mon) {
+        /* Sampling can remove MonitoredItems from the group (e.g. in the
+         * callback of a local MonitoredItem). Then nextSample is updated. */
+        group->nextSample = TAILQ_NEXT(mon, samplingEntry);
+        if(!node || !UA_NodeId_equal(&node->nodeId, &mon->monitoredNodeId)) {
+            if(node)
+                UA_NODESTORE_RELEASE(server, node);
+            node = UA_NODESTORE_GET(server, &mon->monitoredNodeId);
+        }
+        sampleWithNode(server, mon, node);
+        mon = group->nextSample;
+    }
+    group->nextSample = NULL;
+    group->sampling = false;
     if(node)
         UA_NODESTORE_RELEASE(server, node);
+    UA_UNLOCK(server->serviceMutex);
 }
 
 #endif /* UA_ENABLE_SUBSCRIPTIONS */
@@ -260,8 +260,7 @@ UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *monitoredItem) {
     if(monitoredItem->listEntry.le_prev != NULL)
         LIST_REMOVE(monitoredItem, listEntry);
     UA_String_clear(&monitoredItem->indexRange);
-    UA_ByteString_clear(&monitoredItem->lastSampledValue);
-    UA_Variant_clear(&monitoredItem->lastValue);
+    UA_MonitoredItem_clearLastSample(monitoredItem);
     UA_NodeId_clear(&monitoredItem->monitoredNodeId);
 
     /* No actual callback, just remove the structure */
@@ -361,28 +360,65 @@ UA_MonitoredItem_ensureQueueSpace(UA_Server *server, UA_MonitoredItem *mon) {
 UA_StatusCode
 UA_MonitoredItem_registerSampleCallback(UA_Server *server, UA_MonitoredItem *mon) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
-    if(mon->sampleCallbackIsRegistered)
+    if(mon->samplingGroup)
         return UA_STATUSCODE_GOOD;
 
     /* Only DataChange MonitoredItems have a callback with a sampling interval */
     if(mon->attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER)
         return UA_STATUSCODE_GOOD;
 
-    UA_StatusCode retval =
-        addRepeatedCallback(server, (UA_ServerCallback)UA_MonitoredItem_sampleCallback,
-                            mon, mon->samplingInterval, &mon->sampleCallbackId);
-    if(retval == UA_STATUSCODE_GOOD)
-        mon->sampleCallbackIsRegistered = true;
-    return retval;
+    /* Find the group with the same sampling interval */
+    UA_SamplingGroup *group;
+    LIST_FOREACH(group, &server->samplingGroups, listEntry) {
+        if(group->samplingInterval == mon->samplingInterval)
+            break;
+    }
+
+    /* Create a new group with its own repeated callback */
+    if(!group) {
+        group = (UA_SamplingGroup*)UA_calloc(1, sizeof(UA_SamplingGroup));
+        if(!group)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        group->samplingInterval = mon->samplingInterval;
+        TAILQ_INIT(&group->monitoredItems);
+        UA_StatusCode retval =
+            addRepeatedCallback(server, (UA_ServerCallback)UA_SamplingGroup_sampleCallback,
+                                group, group->samplingInterval, &group->callbackId);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_free(group);
+            return retval;
+        }
+        LIST_INSERT_HEAD(&server->samplingGroups, group, listEntry);
+    }
+
+    /* Appending keeps MonitoredItems created together next to each other. So
+     * they can share the lookup of the node during sampling. */
+    TAILQ_INSERT_TAIL(&group->monitoredItems, mon, samplingEntry);
+    mon->samplingGroup = group;
+    return UA_STATUSCODE_GOOD;
 }
 
 void
 UA_MonitoredItem_unregisterSampleCallback(UA_Server *server, UA_MonitoredItem *mon) {
     UA_LOCK_ASSERT(server->serviceMutex, 1);
-    if(!mon->sampleCallbackIsRegistered)
+    UA_SamplingGroup *group = mon->samplingGroup;
+    if(!group)
         return;
-    removeCallback(server, mon->sampleCallbackId);
-    mon->sampleCallbackIsRegistered = false;
+
+    /* The MonitoredItem can be removed while its group is sampled */
+    if(group->nextSample == mon)
+        group->nextSample = TAILQ_NEXT(mon, samplingEntry);
+    TAILQ_REMOVE(&group->monitoredItems, mon, samplingEntry);
+    mon->samplingGroup = NULL;
+    if(!TAILQ_EMPTY(&group->monitoredItems))
+        return;
+
+    /* Remove the empty group. Free the memory after a running batch has
+     * finished. */
+    removeCallback(server, group->callbackId);
+    LIST_REMOVE(group, listEntry);
+    group->delayedFreePointers.callback = NULL;
+    UA_WorkQueue_enqueueDelayed(&server->workQueue, &group->delayedFreePointers);
 }
 
 #endif /* UA_ENABLE_SUBSCRIPTIONS */
@@ -0,0 +1,210 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "ua_server_internal.h"
+
+/* The slots are a sequence lock each. The sequence number of the slot for the
+ * n-th pushed value is 2n+1 while the value is written and 2n+2 once it is
+ * complete. A reader copies the slot and then checks that the sequence number
+ * has not changed in between. The producers reserve the slots with an atomic
+ * increment of the head. So the ring is lock-free for both sides. */
+
+typedef struct {
+    volatile size_t sequence;
+    UA_DateTime sourceTimestamp;
+    /* The value follows */
+} UA_ValueRingSlot;
+
+#define UA_VALUERING_ALIGN 8
+
+struct UA_ValueRing {
+    const UA_DataType *type;
+    size_t mask; /* capacity - 1 */
+    size_t slotSize;
+    volatile size_t head; /* Number of pushed values */
+    UA_Byte *slots;
+};
+
+static UA_ValueRingSlot *
+getSlot(UA_ValueRing *ring, size_t index) {
+    return (UA_ValueRingSlot*)(void*)&ring->slots[(index & ring->mask) * ring->slotSize];
+}
+
+static void *
+slotValue(UA_ValueRingSlot *slot) {
+    return (void*)((uintptr_t)slot + sizeof(UA_ValueRingSlot));
+}
+
+UA_StatusCode
+UA_ValueRing_new(const UA_DataType *type, size_t capacity, UA_ValueRing **ring) {
+    if(!type || !type->pointerFree || capacity == 0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    size_t cap = 1;
+    while(cap < capacity)
+        cap <<= 1;
+    size_t slotSize = sizeof(UA_ValueRingSlot) + type->memSize;
+    slotSize = (slotSize + UA_VALUERING_ALIGN - 1) & ~(size_t)(UA_VALUERING_ALIGN - 1);
+
+    UA_ValueRing *r = (UA_ValueRing*)UA_calloc(1, sizeof(UA_ValueRing));
+    if(!r)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    r->slots = (UA_Byte*)UA_calloc(cap, slotSize);
+    if(!r->slots) {
+        UA_free(r);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    r->type = type;
+    r->mask = cap - 1;
+    r->slotSize = slotSize;
+    *ring = r;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_ValueRing_delete(UA_ValueRing *ring) {
+    if(!ring)
+        return;
+    UA_free(ring->slots);
+    UA_free(ring);
+}
+
+UA_StatusCode
+UA_ValueRing_push(UA_ValueRing *ring, const UA_Variant *value,
+                  UA_DateTime sourceTimestamp) {
+    if(value->type != ring->type || !UA_Variant_isScalar(value))
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    if(sourceTimestamp == 0)
+        sourceTimestamp = UA_DateTime_now();
+
+    size_t index = UA_atomic_addSize(&ring->head, 1) - 1;
+    UA_ValueRingSlot *slot = getSlot(ring, index);
+    slot->sequence = (index << 1) + 1;
+    UA_atomic_sync();
+    slot->sourceTimestamp = sourceTimestamp;
+    memcpy(slotValue(slot), value->data, ring->type->memSize);
+    UA_atomic_sync();
+    slot->sequence = (index << 1) + 2;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Copy the value at the index into the (allocated) data. Fails if the value is
+ * not complete or was overwritten in the meantime. If newer is set, then a
+ * complete value that replaced the value at the index is also taken. */
+static UA_Boolean
+readSlot(UA_ValueRing *ring, size_t index, UA_Boolean newer,
+         void *data, UA_DateTime *sourceTimestamp) {
+    UA_ValueRingSlot *slot = getSlot(ring, index);
+    size_t sequence = slot->sequence;
+    UA_atomic_sync();
+    if(sequence != (index << 1) + 2 &&
+       (!newer || (sequence & 1) || sequence < (index << 1) + 2))
+        return false;
+    *sourceTimestamp = slot->sourceTimestamp;
+    memcpy(data, slotValue(slot), ring->type->memSize);
+    UA_atomic_sync();
+    return (slot->sequence == sequence);
+}
+
+UA_StatusCode
+UA_ValueRing_getLatest(UA_ValueRing *ring, UA_DataValue *value) {
+    size_t head = ring->head;
+    UA_atomic_sync();
+    if(head == 0)
+        return UA_STATUSCODE_BADWAITINGFORINITIALDATA;
+
+    void *data = UA_new(ring->type);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* The most recent values may still be in progress. Take the last complete
+     * value. If the producers lapped the ring in the meantime, start over from
+     * the new head. */
+    UA_DateTime sourceTimestamp = 0;
+    size_t steps = (head > ring->mask) ? ring->mask + 1 : head;
+    size_t i = 1;
+    while(!readSlot(ring, head - i, true, data, &sourceTimestamp)) {
+        if(++i <= steps)
+            continue;
+        head = ring->head;
+        UA_atomic_sync();
+        i = 1;
+    }
+
+    UA_Variant_setScalar(&value->value, data, ring->type);
+    value->hasValue = true;
+    value->sourceTimestamp = sourceTimestamp;
+    value->hasSourceTimestamp = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+size_t
+UA_ValueRing_getValues(UA_ValueRing *ring, size_t *position,
+                       UA_DataValue *values, size_t valuesSize) {
+    size_t head = ring->head;
+    UA_atomic_sync();
+
+    /* Skip the values that are already overwritten */
+    size_t pos = *position;
+    if(head - pos > ring->mask + 1)
+        pos = head - (ring->mask + 1);
+
+    size_t count = 0;
+    void *data = NULL;
+    for(; pos != head && count < valuesSize; pos++) {
+        if(!data) {
+            data = UA_new(ring->type);
+            if(!data)
+                break;
+        }
+        UA_DateTime sourceTimestamp;
+        if(!readSlot(ring, pos, false, data, &sourceTimestamp)) {
+            /* Overwritten while reading. Or still in progress, then retry from
+             * here next time. */
+            if(((getSlot(ring, pos)->sequence) >> 1) <= pos)
+                break;
+            continue;
+        }
+        UA_DataValue_init(&values[count]);
+        UA_Variant_setScalar(&values[count].value, data, ring->type);
+        values[count].hasValue = true;
+        values[count].sourceTimestamp = sourceTimestamp;
+        values[count].hasSourceTimestamp = true;
+        data = NULL;
+        count++;
+    }
+    UA_free(data);
+    *position = pos;
+    return count;
+}
+
+static UA_StatusCode
+setValueRing(UA_Server *server, UA_Session *session,
+             UA_VariableNode *node, UA_ValueRing *ring) {
+    if(node->nodeClass != UA_NODECLASS_VARIABLE)
+        return UA_STATUSCODE_BADNODECLASSINVALID;
+    if(!UA_NodeId_equal(&node->dataType, &ring->type->typeId))
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    if(node->valueSource == UA_VALUESOURCE_DATA)
+        UA_DataValue_clear(&node->value.data.value);
+    node->value.valueRing = ring;
+    node->valueSource = UA_VALUESOURCE_VALUERING;
+#if defined(UA_ENABLE_PUBSUB) && defined(UA_ENABLE_PUBSUB_DELTAFRAMES)
+    UA_DataSetField_valueSourceChanged(server, &node->nodeId);
+#endif
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Server_setVariableNode_valueRing(UA_Server *server, const UA_NodeId nodeId,
+                                    UA_ValueRing *ring) {
+    if(!ring)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    UA_LOCK(server->serviceMutex);
+    UA_StatusCode retval =
+        UA_Server_editNode(server, &server->adminSession, &nodeId,
+                           (UA_EditNodeCallback)setValueRing, ring);
+    UA_UNLOCK(server->serviceMutex);
+    return retval;
+}
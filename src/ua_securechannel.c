@@ -38,6 +38,7 @@ void UA_SecureChannel_init(UA_SecureChannel *channel,
     memset(channel, 0, sizeof(UA_SecureChannel));
     channel->state = UA_SECURECHANNELSTATE_FRESH;
     SIMPLEQ_INIT(&channel->completeChunks);
+    UA_Arena_init(&channel->decodeArena);
     channel->config = *config;
 }
 
@@ -78,12 +79,62 @@ UA_SecureChannel_setSecurityPolicy(UA_SecureChannel *channel,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Chunk buffers have a header in front of the content. The chunk buffers
+ * from before a change of the receive buffer size are not reused. */
+typedef struct UA_ChunkBuffer {
+    struct UA_ChunkBuffer *next; /* In the list of free chunk buffers */
+    size_t size;
+} UA_ChunkBuffer;
+
+#define UA_SECURECHANNEL_MAXFREECHUNKBUFFERS 16
+
+static UA_StatusCode
+getChunkBuffer(UA_SecureChannel *channel, UA_ByteString *buf) {
+    size_t size = channel->config.recvBufferSize;
+    UA_ChunkBuffer *cb;
+    while((cb = channel->freeChunkBuffers)) {
+        channel->freeChunkBuffers = cb->next;
+        channel->freeChunkBuffersSize--;
+        if(cb->size == size)
+            goto done;
+        UA_free(cb);
+    }
+    cb = (UA_ChunkBuffer*)UA_malloc(sizeof(UA_ChunkBuffer) + size);
+    if(!cb)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    cb->size = size;
+ done:
+    buf->data = (UA_Byte*)&cb[1];
+    buf->length = size;
+    return UA_STATUSCODE_GOOD;
+}
+
+static size_t
+chunkBufferSize(const UA_ByteString *buf) {
+    return ((const UA_ChunkBuffer*)(uintptr_t)buf->data)[-1].size;
+}
+
 static void
-deleteChunks(UA_ChunkQueue *queue) {
+releaseChunkBuffer(UA_SecureChannel *channel, UA_ByteString *buf) {
+    if(!buf->data)
+        return;
+    UA_ChunkBuffer *cb = &((UA_ChunkBuffer*)(uintptr_t)buf->data)[-1];
+    if(channel->freeChunkBuffersSize < UA_SECURECHANNEL_MAXFREECHUNKBUFFERS) {
+        cb->next = channel->freeChunkBuffers;
+        channel->freeChunkBuffers = cb;
+        channel->freeChunkBuffersSize++;
+    } else {
+        UA_free(cb);
+    }
+    UA_ByteString_init(buf);
+}
+
+static void
+deleteChunks(UA_SecureChannel *channel, UA_ChunkQueue *queue) {
     UA_Chunk *chunk;
     while((chunk = SIMPLEQ_FIRST(queue))) {
         if(chunk->copied)
-            UA_ByteString_deleteMembers(&chunk->bytes);
+            releaseChunkBuffer(channel, &chunk->bytes);
         SIMPLEQ_REMOVE_HEAD(queue, pointers);
         UA_free(chunk);
     }
@@ -91,8 +142,8 @@ deleteChunks(UA_ChunkQueue *queue) {
 
 void
 UA_SecureChannel_deleteBuffered(UA_SecureChannel *channel) {
-    deleteChunks(&channel->completeChunks);
-    UA_ByteString_clear(&channel->incompleteChunk);
+    deleteChunks(channel, &channel->completeChunks);
+    releaseChunkBuffer(channel, &channel->incompleteChunk);
 }
 
 void
@@ -112,6 +163,12 @@ UA_SecureChannel_deleteMembers(UA_SecureChannel *channel) {
 
     /* Remove buffered chunks */
     UA_SecureChannel_deleteBuffered(channel);
+    UA_ChunkBuffer *cb;
+    while((cb = channel->freeChunkBuffers)) {
+        channel->freeChunkBuffers = cb->next;
+        UA_free(cb);
+    }
+    UA_Arena_clear(&channel->decodeArena);
     UA_ConnectionConfig oldConfig = channel->config;
     UA_SecureChannel_init(channel, &oldConfig);
 }
@@ -306,6 +363,14 @@ encodeHeadersSym(UA_MessageContext *const messageContext, size_t totalLength) {
     return res;
 }
 
+static void
+releasePendingChunks(UA_MessageContext *mc) {
+    UA_Connection *connection = mc->channel->connection;
+    for(size_t i = 0; i < mc->pendingChunksSize; i++)
+        connection->releaseSendBuffer(connection, &mc->pendingChunks[i]);
+    mc->pendingChunksSize = 0;
+}
+
 static UA_StatusCode
 sendSymmetricChunk(UA_MessageContext *messageContext) {
     UA_SecureChannel *const channel = messageContext->channel;
@@ -354,10 +419,25 @@ sendSymmetricChunk(UA_MessageContext *messageContext) {
 #endif
 
     /* Send the chunk, the buffer is freed in the network layer */
-    return connection->send(channel->connection, &messageContext->messageBuffer);
+    if(!connection->sendv)
+        return connection->send(connection, &messageContext->messageBuffer);
+
+    /* Collect the chunks and send them in one go. The buffer is kept in the
+     * list of pending chunks until then. */
+    messageContext->pendingChunks[messageContext->pendingChunksSize++] =
+        messageContext->messageBuffer;
+    UA_ByteString_init(&messageContext->messageBuffer);
+    if(!messageContext->final &&
+       messageContext->pendingChunksSize < UA_MESSAGECONTEXT_MAXPENDING)
+        return UA_STATUSCODE_GOOD;
+    res = connection->sendv(connection, messageContext->pendingChunks,
+                            messageContext->pendingChunksSize);
+    messageContext->pendingChunksSize = 0;
+    return res;
 
 error:
     connection->releaseSendBuffer(channel->connection, &messageContext->messageBuffer);
+    releasePendingChunks(messageContext);
     return res;
 }
 
@@ -408,6 +488,7 @@ UA_MessageContext_begin(UA_MessageContext *mc, UA_SecureChannel *channel,
     mc->messageSizeSoFar = 0;
     mc->final = false;
     mc->messageBuffer = UA_BYTESTRING_NULL;
+    mc->pendingChunksSize = 0;
     mc->messageType = messageType;
 
     /* Allocate the message buffer */
@@ -427,7 +508,8 @@ UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
                          const UA_DataType *contentType) {
     UA_StatusCode retval = UA_encodeBinary(content, contentType, &mc->buf_pos, &mc->buf_end,
                                            sendSymmetricEncodingCallback, mc);
-    if(retval != UA_STATUSCODE_GOOD && mc->messageBuffer.length > 0)
+    if(retval != UA_STATUSCODE_GOOD &&
+       (mc->messageBuffer.length > 0 || mc->pendingChunksSize > 0))
         UA_MessageContext_abort(mc);
     return retval;
 }
@@ -435,13 +517,22 @@ UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
 UA_StatusCode
 UA_MessageContext_finish(UA_MessageContext *mc) {
     mc->final = true;
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    UA_SecureChannel *channel = mc->channel;
+    UA_StatusCode retval = sendSymmetricChunk(mc);
+    if(retval == UA_STATUSCODE_GOOD)
+        channel->sentBytes += mc->messageSizeSoFar;
+    return retval;
+#else
     return sendSymmetricChunk(mc);
+#endif
 }
 
 void
 UA_MessageContext_abort(UA_MessageContext *mc) {
     UA_Connection *connection = mc->channel->connection;
     connection->releaseSendBuffer(connection, &mc->messageBuffer);
+    releasePendingChunks(mc);
 }
 
 UA_StatusCode
@@ -545,59 +636,54 @@ decryptVerifySymmetricChunk(UA_SecureChannel *channel, const UA_SecurityPolicy *
     return res;
 }
 
+/* Chunks of a message that are forwarded without allocating an array */
+#define UA_SECURECHANNEL_STACKSEGMENTS 16
+
 static UA_StatusCode
-assembleProcessMessage(UA_SecureChannel *channel, UA_ChunkQueue *chunks, size_t chunksSize,
-                       UA_UInt32 requestId, UA_MessageType messageType,
-                       void *application, UA_ProcessMessageCallback callback) {
+processMessageChunks(UA_SecureChannel *channel, UA_ChunkQueue *chunks, size_t chunksSize,
+                     UA_UInt32 requestId, UA_MessageType messageType,
+                     void *application, UA_ProcessMessageCallback callback) {
     /* Only MSG and CLO messages at this point */
     UA_assert(messageType == UA_MESSAGETYPE_MSG ||
               messageType == UA_MESSAGETYPE_CLO);
 
-    /* Assemble message */
+    UA_ByteString stackSegments[UA_SECURECHANNEL_STACKSEGMENTS];
+    UA_ByteString *segments = stackSegments;
+    if(chunksSize > UA_SECURECHANNEL_STACKSEGMENTS) {
+        segments = (UA_ByteString*)UA_malloc(chunksSize * sizeof(UA_ByteString));
+        if(!segments)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* Hide the MessageHeader and SequenceHeader. Compute the full message
+     * length. */
     UA_Chunk *chunk;
-    UA_ByteString payload;
-    if(chunksSize > 1) {
-        /* Compute the full message length. Omit the MessageHeader and
-         * SequenceHeader. */
-        size_t messageLength = 0;
-        SIMPLEQ_FOREACH(chunk, chunks, pointers)
-            messageLength += chunk->bytes.length - 24;
-        
-        /* Test chunk count against the connection settings */
-        if(channel->config.localMaxMessageSize != 0 &&
-           messageLength > channel->config.localMaxMessageSize)
-            return UA_STATUSCODE_BADRESPONSETOOLARGE;
-        
-        /* Allocate memory for the full message */
-        UA_StatusCode res = UA_ByteString_allocBuffer(&payload, messageLength);
-        if(res != UA_STATUSCODE_GOOD)
-            return res;
-        
-        /* Assemble the full message */
-        size_t curPos = 0;
-        SIMPLEQ_FOREACH(chunk, chunks, pointers) {
-            UA_assert(chunk->bytes.length > 24);
-            memcpy(&payload.data[curPos], chunk->bytes.data + 24,
-                   chunk->bytes.length - 24);
-            curPos += chunk->bytes.length - 24;
-        }
+    size_t messageLength = 0;
+    size_t i = 0;
+    SIMPLEQ_FOREACH(chunk, chunks, pointers) {
+        UA_assert(chunk->bytes.length > 24);
+        segments[i].data = chunk->bytes.data + 24;
+        segments[i].length = chunk->bytes.length - 24;
+        messageLength += segments[i].length;
+        i++;
+    }
+    UA_assert(i == chunksSize);
 
-        /* Process the message */
-        callback(application, channel, messageType, requestId, &payload);
-        UA_ByteString_deleteMembers(&payload);
-        return UA_STATUSCODE_GOOD;
+    /* Test the message length against the connection settings */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(chunksSize > 1 && channel->config.localMaxMessageSize != 0 &&
+       messageLength > channel->config.localMaxMessageSize) {
+        res = UA_STATUSCODE_BADRESPONSETOOLARGE;
+        goto cleanup;
     }
-    
-    /* Hide the MessageHeader and SequenceHeader */
-    chunk = SIMPLEQ_FIRST(chunks);
-    payload = chunk->bytes;
-    UA_assert(chunk->bytes.length > 24);
-    payload.data += 24;
-    payload.length -= 24;
-    
-    /* Process the message */
-    callback(application, channel, messageType, requestId, &payload);
-    return UA_STATUSCODE_GOOD;
+
+    /* Process the message. The segments are decoded where they are. */
+    callback(application, channel, messageType, requestId, segments, chunksSize);
+
+ cleanup:
+    if(segments != stackSegments)
+        UA_free(segments);
+    return res;
 }
 
 static UA_StatusCode
@@ -606,12 +692,21 @@ persistCompleteChunks(UA_SecureChannel *channel) {
     SIMPLEQ_FOREACH(chunk, &channel->completeChunks, pointers) {
         if(chunk->copied)
             continue;
+        /* The chunk was checked against the receive buffer size when it was
+         * extracted. But processing a HEL/ACK in the same buffer can have
+         * lowered the receive buffer size in the meantime. */
+        if(chunk->bytes.length > channel->config.recvBufferSize) {
+            UA_SecureChannel_close(channel);
+            return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
+        }
         UA_ByteString copy;
-        UA_StatusCode retval = UA_ByteString_copy(&chunk->bytes, &copy);
+        UA_StatusCode retval = getChunkBuffer(channel, &copy);
         if(retval != UA_STATUSCODE_GOOD) {
             UA_SecureChannel_close(channel);
             return retval;
         }
+        memcpy(copy.data, chunk->bytes.data, chunk->bytes.length);
+        copy.length = chunk->bytes.length;
         chunk->bytes = copy;
         chunk->copied = true;
     }
@@ -624,10 +719,13 @@ persistIncompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
     UA_assert(channel->incompleteChunk.length == 0);
     UA_assert(offset < buffer->length);
     size_t length = buffer->length - offset;
-    UA_StatusCode retval = UA_ByteString_allocBuffer(&channel->incompleteChunk, length);
+    UA_StatusCode retval = getChunkBuffer(channel, &channel->incompleteChunk);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
+    /* Less than a full chunk remains. Otherwise it would have been extracted. */
+    UA_assert(length < channel->incompleteChunk.length);
     memcpy(channel->incompleteChunk.data, &buffer->data[offset], length);
+    channel->incompleteChunk.length = length;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -708,8 +806,8 @@ processSymmetricChunks(UA_SecureChannel *channel, UA_ChunkQueue *doneChunks,
             break;
     }
 
-    return assembleProcessMessage(channel, doneChunks, chunksSize, messageRequestId,
-                                  messageType, application, callback);
+    return processMessageChunks(channel, doneChunks, chunksSize, messageRequestId,
+                                messageType, application, callback);
 }
 
 static UA_StatusCode
@@ -728,14 +826,14 @@ processCompleteChunks(UA_SecureChannel *channel, void *application,
             /* Chunks that are processed entirely by the application */
             SIMPLEQ_REMOVE_HEAD(&channel->completeChunks, pointers);
             SIMPLEQ_INSERT_TAIL(&doneChunks, chunk, pointers);
-            callback(application, channel, chunk->messageType, 0, &chunk->bytes);
+            callback(application, channel, chunk->messageType, 0, &chunk->bytes, 1);
             break;
         default: /* MSG and CLO */
             res = processSymmetricChunks(channel, &doneChunks, application, callback);
             break;
         }
 
-        deleteChunks(&doneChunks); 
+        deleteChunks(channel, &doneChunks);
         if(res != UA_STATUSCODE_GOOD)
             break;
 
@@ -771,7 +869,7 @@ processCompleteChunks(UA_SecureChannel *channel, void *application,
 
 static UA_StatusCode
 extractCompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
-                     size_t *offset, UA_Boolean *done) {
+                     size_t *offset, UA_Boolean *done, UA_Boolean copied) {
     /* At least 8 byte needed for the header. Wait for the next chunk. */
     size_t initial_offset = *offset;
     size_t remaining = buffer->length - initial_offset;
@@ -835,42 +933,85 @@ extractCompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
     chunk->messageType = msgType;
     chunk->chunkType = chunkType;
     chunk->bytes = chunkPayload;
-    chunk->copied = false;
+    chunk->copied = copied;
     chunk->decrypted = false;
 
     SIMPLEQ_INSERT_TAIL(&channel->completeChunks, chunk, pointers);
     return UA_STATUSCODE_GOOD;
 }
 
+/* Append the beginning of the buffer to the buffered incomplete chunk. Only
+ * the missing bytes are copied. The complete chunk takes over the chunk
+ * buffer. */
+static UA_StatusCode
+appendIncompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
+                      size_t *offset) {
+    UA_ByteString *ic = &channel->incompleteChunk;
+
+    /* Complete the header to get the chunk length */
+    size_t missing = 0;
+    if(ic->length < 8) {
+        missing = 8 - ic->length;
+        if(missing > buffer->length)
+            missing = buffer->length;
+        memcpy(&ic->data[ic->length], buffer->data, missing);
+        ic->length += missing;
+        *offset = missing;
+        if(ic->length < 8)
+            return UA_STATUSCODE_GOOD;
+    }
+
+    /* Check the message size before copying the remaining bytes */
+    UA_UInt32 messageSize = 0;
+    size_t sizeOffset = 4;
+    UA_UInt32_decodeBinary(ic, &sizeOffset, &messageSize);
+    if(messageSize < 16)
+        return UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
+    if(messageSize > channel->config.recvBufferSize ||
+       messageSize > chunkBufferSize(ic))
+        return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
+
+    missing = messageSize - ic->length;
+    if(missing > buffer->length - *offset)
+        missing = buffer->length - *offset;
+    memcpy(&ic->data[ic->length], &buffer->data[*offset], missing);
+    ic->length += missing;
+    *offset += missing;
+    if(ic->length < messageSize)
+        return UA_STATUSCODE_GOOD;
+
+    /* The chunk is complete */
+    size_t chunkOffset = 0;
+    UA_Boolean done = false;
+    UA_StatusCode res = extractCompleteChunk(channel, ic, &chunkOffset, &done, true);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_assert(!done && chunkOffset == ic->length);
+    UA_ByteString_init(ic); /* Moved to the chunk */
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_SecureChannel_processBuffer(UA_SecureChannel *channel, void *application,
                                UA_ProcessMessageCallback callback,
                                const UA_ByteString *buffer) {
-    /* Prepend the incomplete last chunk. This is usually done in the
+    /* Complete the incomplete last chunk. This is usually done in the
      * networklayer. But we test for a buffered incomplete chunk here again to
      * work around "lazy" network layers. */
-    UA_ByteString appended = channel->incompleteChunk;
-    if(appended.length > 0) {
-        channel->incompleteChunk = UA_BYTESTRING_NULL;
-        UA_Byte *t = (UA_Byte*)UA_realloc(appended.data, appended.length + buffer->length);
-        if(!t) {
-            UA_ByteString_deleteMembers(&appended);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        }
-        memcpy(&t[appended.length], buffer->data, buffer->length);
-        appended.data = t;
-        appended.length += buffer->length;
-        buffer = &appended;
+    size_t offset = 0;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(channel->incompleteChunk.length > 0) {
+        res = appendIncompleteChunk(channel, buffer, &offset);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
     }
 
     /* Loop over the received chunks */
-    size_t offset = 0;
-    UA_Boolean done = false;
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_Boolean done = (channel->incompleteChunk.length > 0);
     while(!done) {
-        res = extractCompleteChunk(channel, buffer, &offset, &done);
+        res = extractCompleteChunk(channel, buffer, &offset, &done, false);
         if(res != UA_STATUSCODE_GOOD)
-            goto cleanup;
+            return res;
     }
 
     /* Buffer half-received chunk. Before processing the messages so that
@@ -878,21 +1019,17 @@ UA_SecureChannel_processBuffer(UA_SecureChannel *channel, void *application,
     if(offset < buffer->length) {
         res = persistIncompleteChunk(channel, buffer, offset);
         if(res != UA_STATUSCODE_GOOD)
-            goto cleanup;
+            return res;
     }
 
     /* Process whatever we can. Chunks of completed and processed messages are
      * removed. */
     res = processCompleteChunks(channel, application, callback);
     if(res != UA_STATUSCODE_GOOD)
-        goto cleanup;
+        return res;
 
     /* Persist full chunks that still point to the buffer */
-    res = persistCompleteChunks(channel);
-
- cleanup:
-    UA_ByteString_deleteMembers(&appended);
-    return res;
+    return persistCompleteChunks(channel);
 }
 
 UA_StatusCode
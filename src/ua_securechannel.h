@@ -18,6 +18,7 @@
 
 #include "open62541_queue.h"
 #include "ua_connection_internal.h"
+#include "ua_util_internal.h"
 
 _UA_BEGIN_DECLS
 
@@ -47,13 +48,15 @@ typedef struct UA_Chunk {
     UA_ByteString bytes;
     UA_MessageType messageType;
     UA_ChunkType chunkType;
-    UA_Boolean copied; /* Do the bytes point to a buffer from the network or was
-                        * memory allocated for the chunk separately */
+    UA_Boolean copied; /* Do the bytes point to a buffer from the network or
+                        * into a chunk buffer owned by the SecureChannel */
     UA_Boolean decrypted; /* The chunk has been decrypted */
 } UA_Chunk;
 
 typedef SIMPLEQ_HEAD(UA_ChunkQueue, UA_Chunk) UA_ChunkQueue;
 
+struct UA_ChunkBuffer;
+
 typedef enum {
     UA_SECURECHANNELSTATE_FRESH,
     UA_SECURECHANNELSTATE_HEL_SENT,
@@ -111,6 +114,19 @@ struct UA_SecureChannel {
                                    * processed so far */
     UA_ByteString incompleteChunk; /* A half-received chunk (TCP is a
                                     * streaming protocol) is stored here */
+
+    /* Chunks that outlive the received buffer are copied into chunk buffers of
+     * the receive buffer size. Released chunk buffers are kept for reuse. */
+    struct UA_ChunkBuffer *freeChunkBuffers;
+    size_t freeChunkBuffersSize;
+
+    /* Decoded requests are allocated from the arena. It is reset after the
+     * response was sent. */
+    UA_Arena decodeArena;
+
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    size_t sentBytes; /* Body length of all sent symmetric messages */
+#endif
 };
 
 void UA_SecureChannel_init(UA_SecureChannel *channel,
@@ -161,6 +177,10 @@ UA_SecureChannel_sendSymmetricMessage(UA_SecureChannel *channel, UA_UInt32 reque
                                       UA_MessageType messageType, void *payload,
                                       const UA_DataType *payloadType);
 
+/* Chunks that are collected before they are handed to the network layer at
+ * once. Only used if the connection implements sendv. */
+#define UA_MESSAGECONTEXT_MAXPENDING 8
+
 /* The MessageContext is forwarded into the encoding layer so that we can send
  * chunks before continuing to encode. This lets us reuse a fixed chunk-sized
  * messages buffer. */
@@ -176,6 +196,9 @@ typedef struct {
     UA_Byte *buf_pos;
     const UA_Byte *buf_end;
 
+    UA_ByteString pendingChunks[UA_MESSAGECONTEXT_MAXPENDING];
+    size_t pendingChunksSize;
+
     UA_Boolean final;
 } UA_MessageContext;
 
@@ -206,10 +229,14 @@ UA_MessageContext_abort(UA_MessageContext *mc);
  * Receive Message
  * --------------- */
 
+/* The body of MSG and CLO messages is not assembled into a contiguous buffer.
+ * Instead, the payloads of the chunks are forwarded as segments. They can be
+ * decoded with UA_decodeBinarySegments. All other messages have a single
+ * segment. */
 typedef void
 (UA_ProcessMessageCallback)(void *application, UA_SecureChannel *channel,
                             UA_MessageType messageType, UA_UInt32 requestId,
-                            UA_ByteString *message);
+                            UA_ByteString *segments, size_t segmentsSize);
 
 /* Process a received buffer. The callback function is called with the message
  * body if the message is complete. The message is removed afterwards. Returns
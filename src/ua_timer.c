@@ -156,6 +156,11 @@ UA_Timer_process(UA_Timer *t, UA_DateTime nowMonotonic,
           first->nextTime <= nowMonotonic) {
         ZIP_REMOVE(UA_TimerZip, &t->root, first);
 
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+        if(t->lateness)
+            UA_LatencyHistogram_record(t->lateness, nowMonotonic - first->nextTime);
+#endif
+
         /* Reinsert / remove to their new position first. Because the callback
          * can interact with the zip tree and expects the same entries in the
          * root and idRoot trees. */
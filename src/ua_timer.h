@@ -29,6 +29,10 @@ typedef struct {
     UA_TimerZip root; /* The root of the time-sorted zip tree */
     UA_TimerIdZip idRoot; /* The root of the id-sorted zip tree */
     UA_UInt64 idCounter;
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+    UA_LatencyHistogram *lateness; /* If set, records how late the callbacks
+                                    * are dispatched */
+#endif
 } UA_Timer;
 
 void UA_Timer_init(UA_Timer *t);
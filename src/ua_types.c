@@ -19,6 +19,7 @@
 #include <open62541/types_generated_handling.h>
 
 #include "ua_util_internal.h"
+#include "ua_types_encoding_binary.h"
 #include "libc_time.h"
 #include "pcg_basic.h"
 
@@ -46,8 +47,13 @@ typedef void (*UA_clearSignature)(void *p, const UA_DataType *type);
 extern const UA_copySignature copyJumpTable[UA_DATATYPEKINDS];
 extern const UA_clearSignature clearJumpTable[UA_DATATYPEKINDS];
 
-/* TODO: The standard-defined types are ordered. See if binary search is
- * more efficient. */
+/* The hash tables are generated together with UA_TYPES. Same hash as in the
+ * generator (backend_open62541_typedefinitions.py). */
+static UA_UInt32
+lookupSlot(UA_UInt32 identifier) {
+    return (UA_UInt32)(identifier * 2654435769u) >> UA_TYPES_LOOKUPSHIFT;
+}
+
 const UA_DataType *
 UA_findDataType(const UA_NodeId *typeId) {
     if(typeId->identifierType != UA_NODEIDTYPE_NUMERIC)
@@ -55,10 +61,14 @@ UA_findDataType(const UA_NodeId *typeId) {
 
     /* Always look in built-in types first
      * (may contain data types from all namespaces) */
-    for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
-        if(UA_TYPES[i].typeId.identifier.numeric == typeId->identifier.numeric
-           && UA_TYPES[i].typeId.namespaceIndex == typeId->namespaceIndex)
-            return &UA_TYPES[i];
+    UA_UInt32 mask = (1u << (32 - UA_TYPES_LOOKUPSHIFT)) - 1;
+    for(UA_UInt32 slot = lookupSlot(typeId->identifier.numeric);
+        UA_TYPES_typeIdLookup[slot] != 0; slot = (slot + 1) & mask) {
+        const UA_DataType *type = &UA_TYPES[UA_TYPES_typeIdLookup[slot] - 1];
+        if(type->typeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+           type->typeId.identifier.numeric == typeId->identifier.numeric &&
+           type->typeId.namespaceIndex == typeId->namespaceIndex)
+            return type;
     }
 
     /* TODO When other namespace look in custom types, too, requires access to custom types array here! */
@@ -76,6 +86,23 @@ UA_findDataType(const UA_NodeId *typeId) {
     return NULL;
 }
 
+const UA_DataType *
+UA_findDataTypeByBinaryBuiltin(const UA_NodeId *typeId) {
+    /* We only store a numeric identifier for the encoding nodeid of data types */
+    if(typeId->identifierType != UA_NODEIDTYPE_NUMERIC)
+        return NULL;
+
+    UA_UInt32 mask = (1u << (32 - UA_TYPES_LOOKUPSHIFT)) - 1;
+    for(UA_UInt32 slot = lookupSlot(typeId->identifier.numeric);
+        UA_TYPES_binaryEncodingIdLookup[slot] != 0; slot = (slot + 1) & mask) {
+        const UA_DataType *type = &UA_TYPES[UA_TYPES_binaryEncodingIdLookup[slot] - 1];
+        if(type->binaryEncodingId == typeId->identifier.numeric &&
+           type->typeId.namespaceIndex == typeId->namespaceIndex)
+            return type;
+    }
+    return NULL;
+}
+
 /***************************/
 /* Random Number Generator */
 /***************************/
@@ -50,8 +50,36 @@ typedef struct {
     const UA_DataTypeArray *customTypes;
     UA_exchangeEncodeBuffer exchangeBufferCallback;
     void *exchangeBufferCallbackHandle;
+
+    /* If set, decoded values are allocated from the arena. Then the value is
+     * not cleaned up member-by-member. The memory is released at once with
+     * the arena. */
+    UA_Arena *arena;
+
+    /* Only used together with an arena. Strings and overlayable arrays point
+     * into the decoded buffer instead of copying the content. */
+    UA_Boolean zeroCopy;
+
+    /* Decoding from a sequence of buffers (segments), e.g. the payloads of the
+     * chunks of a message. When the end of the current segment is reached,
+     * decoding continues at the start of the next segment. Values that straddle
+     * the boundary between segments are gathered byte-by-byte. */
+    const UA_ByteString *segment;     /* The current segment */
+    const UA_ByteString *segmentsEnd; /* Behind the last segment */
+    size_t segmentsTail;              /* Bytes in the following segments */
 } Ctx;
 
+/* Allocate zeroed memory for decoding */
+static void *
+ctxCalloc(Ctx *ctx, size_t nmemb, size_t size) {
+    if(ctx->arena) {
+        if(size != 0 && nmemb > SIZE_MAX / size)
+            return NULL;
+        return UA_Arena_alloc(ctx->arena, nmemb * size);
+    }
+    return UA_calloc(nmemb, size);
+}
+
 typedef status
 (*encodeBinarySignature)(const void *UA_RESTRICT src, const UA_DataType *type,
                          Ctx *UA_RESTRICT ctx);
@@ -81,6 +109,66 @@ extern const encodeBinarySignature encodeBinaryJumpTable[UA_DATATYPEKINDS];
 extern const decodeBinarySignature decodeBinaryJumpTable[UA_DATATYPEKINDS];
 extern const calcSizeBinarySignature calcSizeBinaryJumpTable[UA_DATATYPEKINDS];
 
+#ifdef UA_ENABLE_TYPES_ENCODING_SPECIALIZED
+/* Specialized methods for the structures in UA_TYPES. The entries for the other
+ * types are NULL. Generated from the type definitions and included at the end
+ * of this file. */
+extern const encodeBinarySignature types_encodeBinarySpecialized[UA_TYPES_COUNT];
+extern const decodeBinarySignature types_decodeBinarySpecialized[UA_TYPES_COUNT];
+extern const calcSizeBinarySignature types_calcSizeBinarySpecialized[UA_TYPES_COUNT];
+
+static UA_INLINE UA_Boolean
+isStandardType(const UA_DataType *type) {
+    return (type->typeIndex < UA_TYPES_COUNT && type == &UA_TYPES[type->typeIndex]);
+}
+#endif
+
+/* Continue decoding in the next non-empty segment */
+static status
+nextSegment(Ctx *ctx) {
+    if(!ctx->segment)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    while(ctx->segment + 1 < ctx->segmentsEnd) {
+        ctx->segment++;
+        if(ctx->segment->length == 0)
+            continue;
+        ctx->pos = ctx->segment->data;
+        ctx->end = &ctx->segment->data[ctx->segment->length];
+        ctx->segmentsTail -= ctx->segment->length;
+        return UA_STATUSCODE_GOOD;
+    }
+    return UA_STATUSCODE_BADDECODINGERROR;
+}
+
+/* Bytes that remain to be decoded in all segments */
+static UA_INLINE size_t
+remainingBytes(const Ctx *ctx) {
+    return (size_t)(ctx->end - ctx->pos) + ctx->segmentsTail;
+}
+
+/* Copy bytes that straddle the boundary between segments. This is the slow
+ * path when the current segment does not contain enough bytes. */
+static status
+gatherBytes(Ctx *ctx, u8 *dst, size_t length) {
+    if(remainingBytes(ctx) < length)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    while(length > 0) {
+        if(ctx->pos >= ctx->end) {
+            status ret = nextSegment(ctx);
+            if(ret != UA_STATUSCODE_GOOD)
+                return ret;
+        }
+        size_t n = (size_t)(ctx->end - ctx->pos);
+        if(n > length)
+            n = length;
+        memcpy(dst, ctx->pos, n);
+        ctx->pos += n;
+        dst += n;
+        length -= n;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 /* Breaking a message up into chunks is integrated with the encoding. When the
  * end of a buffer is reached, a callback is executed that sends the current
  * buffer as a chunk and exchanges the encoding buffer "underneath" the ongoing
@@ -94,23 +182,31 @@ static status exchangeBuffer(Ctx *ctx) {
                                        &ctx->pos, &ctx->end);
 }
 
-/* If encoding fails, exchange the buffer and try again. */
-static status
-encodeWithExchangeBuffer(const void *ptr, const UA_DataType *type, Ctx *ctx) {
+/* If encoding fails, exchange the buffer and try again. The encoding method is
+ * passed explicitly so that it can be resolved at compile-time. */
+static UA_INLINE status
+encodeWithExchangeBufferDirect(const void *ptr, const UA_DataType *type,
+                               encodeBinarySignature encode, Ctx *ctx) {
     u8 *oldpos = ctx->pos; /* Last known good position */
     ctx->oldpos = &oldpos;
-    status ret = encodeBinaryJumpTable[type->typeKind](ptr, type, ctx);
+    status ret = encode(ptr, type, ctx);
     if(ret == UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED && ctx->oldpos == &oldpos) {
         ctx->pos = oldpos; /* Send the position to the last known good position
                             * and switch */
         ret = exchangeBuffer(ctx);
         if(ret != UA_STATUSCODE_GOOD)
             return ret;
-        ret = encodeBinaryJumpTable[type->typeKind](ptr, type, ctx);
+        ret = encode(ptr, type, ctx);
     }
     return ret;
 }
 
+static status
+encodeWithExchangeBuffer(const void *ptr, const UA_DataType *type, Ctx *ctx) {
+    return encodeWithExchangeBufferDirect(ptr, type,
+                                          encodeBinaryJumpTable[type->typeKind], ctx);
+}
+
 #define ENCODE_WITHEXCHANGE(VAR, TYPE) \
     encodeWithExchangeBuffer((const void*)VAR, &UA_TYPES[TYPE], ctx)
 
@@ -182,7 +278,7 @@ ENCODE_BINARY(Boolean) {
 }
 
 DECODE_BINARY(Boolean) {
-    if(ctx->pos + 1 > ctx->end)
+    if(ctx->pos + 1 > ctx->end && nextSegment(ctx) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADDECODINGERROR;
     *dst = (*ctx->pos > 0) ? true : false;
     ++ctx->pos;
@@ -199,7 +295,7 @@ ENCODE_BINARY(Byte) {
 }
 
 DECODE_BINARY(Byte) {
-    if(ctx->pos + sizeof(u8) > ctx->end)
+    if(ctx->pos + sizeof(u8) > ctx->end && nextSegment(ctx) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADDECODINGERROR;
     *dst = *ctx->pos;
     ++ctx->pos;
@@ -220,14 +316,21 @@ ENCODE_BINARY(UInt16) {
 }
 
 DECODE_BINARY(UInt16) {
-    if(ctx->pos + sizeof(u16) > ctx->end)
-        return UA_STATUSCODE_BADDECODINGERROR;
+    const u8 *p = ctx->pos;
+    u8 gathered[sizeof(u16)];
+    if(ctx->pos + sizeof(u16) > ctx->end) {
+        status ret = gatherBytes(ctx, gathered, sizeof(u16));
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+        p = gathered;
+    } else {
+        ctx->pos += 2;
+    }
 #if UA_BINARY_OVERLAYABLE_INTEGER
-    memcpy(dst, ctx->pos, sizeof(u16));
+    memcpy(dst, p, sizeof(u16));
 #else
-    UA_decode16(ctx->pos, dst);
+    UA_decode16(p, dst);
 #endif
-    ctx->pos += 2;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -245,14 +348,21 @@ ENCODE_BINARY(UInt32) {
 }
 
 DECODE_BINARY(UInt32) {
-    if(ctx->pos + sizeof(u32) > ctx->end)
-        return UA_STATUSCODE_BADDECODINGERROR;
+    const u8 *p = ctx->pos;
+    u8 gathered[sizeof(u32)];
+    if(ctx->pos + sizeof(u32) > ctx->end) {
+        status ret = gatherBytes(ctx, gathered, sizeof(u32));
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+        p = gathered;
+    } else {
+        ctx->pos += 4;
+    }
 #if UA_BINARY_OVERLAYABLE_INTEGER
-    memcpy(dst, ctx->pos, sizeof(u32));
+    memcpy(dst, p, sizeof(u32));
 #else
-    UA_decode32(ctx->pos, dst);
+    UA_decode32(p, dst);
 #endif
-    ctx->pos += 4;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -270,14 +380,21 @@ ENCODE_BINARY(UInt64) {
 }
 
 DECODE_BINARY(UInt64) {
-    if(ctx->pos + sizeof(u64) > ctx->end)
-        return UA_STATUSCODE_BADDECODINGERROR;
+    const u8 *p = ctx->pos;
+    u8 gathered[sizeof(u64)];
+    if(ctx->pos + sizeof(u64) > ctx->end) {
+        status ret = gatherBytes(ctx, gathered, sizeof(u64));
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
+        p = gathered;
+    } else {
+        ctx->pos += 8;
+    }
 #if UA_BINARY_OVERLAYABLE_INTEGER
-    memcpy(dst, ctx->pos, sizeof(u64));
+    memcpy(dst, p, sizeof(u64));
 #else
-    UA_decode64(ctx->pos, dst);
+    UA_decode64(p, dst);
 #endif
-    ctx->pos += 8;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -397,13 +514,102 @@ DECODE_BINARY(Double) {
 
 #endif
 
+/*************************/
+/* Numeric Array Kernels */
+/*************************/
+
+/* On big-endian platforms, the numeric types are not overlayable. But their
+ * encoding is the memory representation with the byte order reversed. So
+ * arrays are converted in bulk with a tight loop (that the compiler can
+ * vectorize) instead of calling the encoding method for every element. */
+#if !UA_BINARY_OVERLAYABLE_INTEGER && defined(__BYTE_ORDER__) && \
+    defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+# define UA_BINARY_SWAPPABLE 1
+#else
+# define UA_BINARY_SWAPPABLE 0
+#endif
+
+#if UA_BINARY_SWAPPABLE
+
+/* Swap in blocks of a fixed size. Loops with a known length are vectorized
+ * by the compiler already at -O2 (SSE2, NEON, AltiVec/VSX). The remainder is
+ * swapped element-by-element. */
+#define UA_SWAP_BLOCKSIZE 8
+
+#define SWAP_KERNEL(NAME, TYPE, BSWAP)                                  \
+    static void                                                         \
+    NAME(u8 *UA_RESTRICT dst, const u8 *UA_RESTRICT src, size_t count) { \
+        size_t i = 0;                                                   \
+        for(; i + UA_SWAP_BLOCKSIZE <= count; i += UA_SWAP_BLOCKSIZE) { \
+            TYPE v[UA_SWAP_BLOCKSIZE];                                  \
+            memcpy(v, &src[i * sizeof(TYPE)], sizeof(v));               \
+            for(size_t j = 0; j < UA_SWAP_BLOCKSIZE; j++)               \
+                v[j] = BSWAP(v[j]);                                     \
+            memcpy(&dst[i * sizeof(TYPE)], v, sizeof(v));               \
+        }                                                               \
+        for(; i < count; i++) {                                         \
+            TYPE v;                                                     \
+            memcpy(&v, &src[i * sizeof(TYPE)], sizeof(TYPE));           \
+            v = BSWAP(v);                                               \
+            memcpy(&dst[i * sizeof(TYPE)], &v, sizeof(TYPE));           \
+        }                                                               \
+    }
+
+SWAP_KERNEL(swap16, u16, __builtin_bswap16)
+SWAP_KERNEL(swap32, u32, __builtin_bswap32)
+SWAP_KERNEL(swap64, u64, __builtin_bswap64)
+
+/* The type is encoded as its byte-reversed memory */
+static UA_Boolean
+isSwappable(const UA_DataType *type) {
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_INT16:
+    case UA_DATATYPEKIND_UINT16:
+    case UA_DATATYPEKIND_INT32:
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_INT64:
+    case UA_DATATYPEKIND_UINT64:
+    case UA_DATATYPEKIND_DATETIME:
+    case UA_DATATYPEKIND_STATUSCODE:
+        return true;
+#if (UA_FLOAT_IEEE754 == 1) && (UA_LITTLE_ENDIAN == UA_FLOAT_LITTLE_ENDIAN)
+    case UA_DATATYPEKIND_FLOAT:
+    case UA_DATATYPEKIND_DOUBLE:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+#endif /* UA_BINARY_SWAPPABLE */
+
+/* Copy array elements from/to the binary encoding. Either as-is for
+ * overlayable types or with the byte order reversed. */
+static UA_INLINE void
+copyElements(u8 *UA_RESTRICT dst, const u8 *UA_RESTRICT src,
+             size_t count, size_t elementMemSize, UA_Boolean swap) {
+#if UA_BINARY_SWAPPABLE
+    if(swap) {
+        switch(elementMemSize) {
+        case 2: swap16(dst, src, count); return;
+        case 4: swap32(dst, src, count); return;
+        default: swap64(dst, src, count); return;
+        }
+    }
+#else
+    (void)swap;
+#endif
+    memcpy(dst, src, count * elementMemSize);
+}
+
 /******************/
 /* Array Handling */
 /******************/
 
 static status
-Array_encodeBinaryOverlayable(uintptr_t ptr, size_t length,
-                              size_t elementMemSize, Ctx *ctx) {
+Array_encodeBinaryOverlayable(uintptr_t ptr, size_t length, size_t elementMemSize,
+                              UA_Boolean swap, Ctx *ctx) {
     /* Store the number of already encoded elements */
     size_t finished = 0;
 
@@ -411,7 +617,7 @@ Array_encodeBinaryOverlayable(uintptr_t ptr, size_t length,
     while(ctx->end < ctx->pos + (elementMemSize * (length-finished))) {
         size_t possible = ((uintptr_t)ctx->end - (uintptr_t)ctx->pos) / (sizeof(u8) * elementMemSize);
         size_t possibleMem = possible * elementMemSize;
-        memcpy(ctx->pos, (void*)ptr, possibleMem);
+        copyElements(ctx->pos, (const u8*)ptr, possible, elementMemSize, swap);
         ctx->pos += possibleMem;
         ptr += possibleMem;
         finished += possible;
@@ -424,17 +630,17 @@ Array_encodeBinaryOverlayable(uintptr_t ptr, size_t length,
     }
 
     /* Encode the remaining elements */
-    memcpy(ctx->pos, (void*)ptr, elementMemSize * (length-finished));
+    copyElements(ctx->pos, (const u8*)ptr, length-finished, elementMemSize, swap);
     ctx->pos += elementMemSize * (length-finished);
     return UA_STATUSCODE_GOOD;
 }
 
-static status
-Array_encodeBinaryComplex(uintptr_t ptr, size_t length,
-                          const UA_DataType *type, Ctx *ctx) {
+static UA_INLINE status
+Array_encodeBinaryComplex(uintptr_t ptr, size_t length, const UA_DataType *type,
+                          encodeBinarySignature encode, Ctx *ctx) {
     /* Encode every element */
     for(size_t i = 0; i < length; ++i) {
-        status ret = encodeWithExchangeBuffer((const void*)ptr, type, ctx);
+        status ret = encodeWithExchangeBufferDirect((const void*)ptr, type, encode, ctx);
         ptr += type->memSize;
 
         if(ret != UA_STATUSCODE_GOOD)
@@ -444,9 +650,9 @@ Array_encodeBinaryComplex(uintptr_t ptr, size_t length,
     return UA_STATUSCODE_GOOD;
 }
 
-static status
-Array_encodeBinary(const void *src, size_t length,
-                   const UA_DataType *type, Ctx *ctx) {
+static UA_INLINE status
+Array_encodeBinaryDirect(const void *src, size_t length, const UA_DataType *type,
+                         encodeBinarySignature encode, Ctx *ctx) {
     /* Check and convert the array length to int32 */
     i32 signed_length = -1;
     if(length > UA_INT32_MAX)
@@ -464,14 +670,28 @@ Array_encodeBinary(const void *src, size_t length,
         return ret;
 
     /* Encode the content */
-    if(!type->overlayable)
-        return Array_encodeBinaryComplex((uintptr_t)src, length, type, ctx);
-    return Array_encodeBinaryOverlayable((uintptr_t)src, length, type->memSize, ctx);
+    if(type->overlayable)
+        return Array_encodeBinaryOverlayable((uintptr_t)src, length,
+                                             type->memSize, false, ctx);
+#if UA_BINARY_SWAPPABLE
+    if(isSwappable(type))
+        return Array_encodeBinaryOverlayable((uintptr_t)src, length,
+                                             type->memSize, true, ctx);
+#endif
+    return Array_encodeBinaryComplex((uintptr_t)src, length, type, encode, ctx);
 }
 
 static status
-Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
+Array_encodeBinary(const void *src, size_t length,
                    const UA_DataType *type, Ctx *ctx) {
+    return Array_encodeBinaryDirect(src, length, type,
+                                    encodeBinaryJumpTable[type->typeKind], ctx);
+}
+
+static UA_INLINE status
+Array_decodeBinaryDirect(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
+                         const UA_DataType *type, decodeBinarySignature decode,
+                         Ctx *ctx) {
     /* Decode the length */
     i32 signed_length;
     status ret = DECODE_DIRECT(&signed_length, UInt32); /* Int32 */
@@ -492,31 +712,56 @@ Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
      * is too small for the array length. This prevents the allocation of very
      * long arrays for bogus messages.*/
     size_t length = (size_t)signed_length;
-    if(ctx->pos + ((type->memSize * length) / 32) > ctx->end)
+    if((type->memSize * length) / 32 > remainingBytes(ctx))
         return UA_STATUSCODE_BADDECODINGERROR;
 
+    /* Point into the buffer if the content is correctly aligned in memory and
+     * does not straddle segments */
+    if(ctx->zeroCopy && type->overlayable &&
+       (ctx->pos + (type->memSize * length) <= ctx->end || !ctx->segmentsTail)) {
+        size_t align = (type->memSize < sizeof(void*)) ? type->memSize : sizeof(void*);
+        if(((uintptr_t)ctx->pos & (align - 1)) == 0) {
+            if(ctx->end < ctx->pos + (type->memSize * length))
+                return UA_STATUSCODE_BADDECODINGERROR;
+            *dst = ctx->pos;
+            ctx->pos += type->memSize * length;
+            *out_length = length;
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+
     /* Allocate memory */
-    *dst = UA_calloc(length, type->memSize);
+    *dst = ctxCalloc(ctx, length, type->memSize);
     if(!*dst)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    if(type->overlayable) {
-        /* memcpy overlayable array */
-        if(ctx->end < ctx->pos + (type->memSize * length)) {
-            UA_free(*dst);
+    UA_Boolean swap = false;
+#if UA_BINARY_SWAPPABLE
+    swap = isSwappable(type);
+#endif
+    if((type->overlayable || swap) &&
+       ctx->pos + (type->memSize * length) <= ctx->end) {
+        /* Copy overlayable array (or with the byte order reversed) */
+        copyElements((u8*)*dst, ctx->pos, length, type->memSize, swap);
+        ctx->pos += type->memSize * length;
+    } else if(type->overlayable) {
+        /* Copy the overlayable array from several segments */
+        ret = gatherBytes(ctx, (u8*)*dst, type->memSize * length);
+        if(ret != UA_STATUSCODE_GOOD) {
+            if(!ctx->arena)
+                UA_free(*dst);
             *dst = NULL;
-            return UA_STATUSCODE_BADDECODINGERROR;
+            return ret;
         }
-        memcpy(*dst, ctx->pos, type->memSize * length);
-        ctx->pos += type->memSize * length;
     } else {
         /* Decode array members */
         uintptr_t ptr = (uintptr_t)*dst;
         for(size_t i = 0; i < length; ++i) {
-            ret = decodeBinaryJumpTable[type->typeKind]((void*)ptr, type, ctx);
+            ret = decode((void*)ptr, type, ctx);
             if(ret != UA_STATUSCODE_GOOD) {
                 /* +1 because last element is also already initialized */
-                UA_Array_delete(*dst, i+1, type);
+                if(!ctx->arena)
+                    UA_Array_delete(*dst, i+1, type);
                 *dst = NULL;
                 return ret;
             }
@@ -527,6 +772,13 @@ Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
     return UA_STATUSCODE_GOOD;
 }
 
+static status
+Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
+                   const UA_DataType *type, Ctx *ctx) {
+    return Array_decodeBinaryDirect(dst, out_length, type,
+                                    decodeBinaryJumpTable[type->typeKind], ctx);
+}
+
 /*****************/
 /* Builtin Types */
 /*****************/
@@ -558,7 +810,7 @@ DECODE_BINARY(Guid) {
     ret |= DECODE_DIRECT(&dst->data2, UInt16);
     ret |= DECODE_DIRECT(&dst->data3, UInt16);
     if(ctx->pos + (8*sizeof(u8)) > ctx->end)
-        return UA_STATUSCODE_BADDECODINGERROR;
+        return ret | gatherBytes(ctx, dst->data4, 8*sizeof(u8));
     memcpy(dst->data4, ctx->pos, 8*sizeof(u8));
     ctx->pos += 8;
     return ret;
@@ -710,7 +962,7 @@ ENCODE_BINARY(ExpandedNodeId) {
 
 DECODE_BINARY(ExpandedNodeId) {
     /* Decode the encoding mask */
-    if(ctx->pos >= ctx->end)
+    if(ctx->pos >= ctx->end && nextSegment(ctx) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADDECODINGERROR;
     u8 encoding = *ctx->pos;
 
@@ -790,11 +1042,9 @@ UA_findDataTypeByBinaryInternal(const UA_NodeId *typeId, Ctx *ctx) {
 
     /* Always look in built-in types first
      * (may contain data types from all namespaces) */
-    for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
-        if(UA_TYPES[i].binaryEncodingId == typeId->identifier.numeric &&
-           UA_TYPES[i].typeId.namespaceIndex == typeId->namespaceIndex)
-            return &UA_TYPES[i];
-    }
+    const UA_DataType *type = UA_findDataTypeByBinaryBuiltin(typeId);
+    if(type)
+        return type;
 
     const UA_DataTypeArray *customTypes = ctx->customTypes;
     while(customTypes) {
@@ -883,17 +1133,20 @@ ExtensionObject_decodeBinaryContent(UA_ExtensionObject *dst, const UA_NodeId *ty
     /* Unknown type, just take the binary content */
     if(!type) {
         dst->encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
-        UA_NodeId_copy(typeId, &dst->content.encoded.typeId);
+        dst->content.encoded.typeId = *typeId; /* move to dst */
         return DECODE_DIRECT(&dst->content.encoded.body, String); /* ByteString */
     }
 
     /* Allocate memory */
-    dst->content.decoded.data = UA_new(type);
+    dst->content.decoded.data = ctxCalloc(ctx, 1, type->memSize);
     if(!dst->content.decoded.data)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     /* Jump over the length field (TODO: check if the decoded length matches) */
-    ctx->pos += 4;
+    u32 length;
+    status ret = DECODE_DIRECT(&length, UInt32);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
 
     /* Decode */
     dst->encoding = UA_EXTENSIONOBJECT_DECODED;
@@ -913,14 +1166,15 @@ DECODE_BINARY(ExtensionObject) {
     ret |= DECODE_DIRECT(&binTypeId, NodeId);
     ret |= DECODE_DIRECT(&encoding, Byte);
     if(ret != UA_STATUSCODE_GOOD) {
-        UA_NodeId_clear(&binTypeId);
+        if(!ctx->arena)
+            UA_NodeId_clear(&binTypeId);
         return ret;
     }
 
     switch(encoding) {
     case UA_EXTENSIONOBJECT_ENCODED_BYTESTRING:
+        /* The NodeId is moved into dst if the type is unknown */
         ret = ExtensionObject_decodeBinaryContent(dst, &binTypeId, ctx);
-        UA_NodeId_deleteMembers(&binTypeId);
         break;
     case UA_EXTENSIONOBJECT_ENCODED_NOBODY:
         dst->encoding = (UA_ExtensionObjectEncoding)encoding;
@@ -931,11 +1185,12 @@ DECODE_BINARY(ExtensionObject) {
         dst->encoding = (UA_ExtensionObjectEncoding)encoding;
         dst->content.encoded.typeId = binTypeId; /* move to dst */
         ret = DECODE_DIRECT(&dst->content.encoded.body, String); /* ByteString */
-        if(ret != UA_STATUSCODE_GOOD)
+        if(ret != UA_STATUSCODE_GOOD && !ctx->arena)
             UA_NodeId_clear(&dst->content.encoded.typeId);
         break;
     default:
-        UA_NodeId_clear(&binTypeId);
+        if(!ctx->arena)
+            UA_NodeId_clear(&binTypeId);
         ret = UA_STATUSCODE_BADDECODINGERROR;
         break;
     }
@@ -1036,6 +1291,9 @@ Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     /* Save the position in the ByteString. If unwrapping is not possible, start
      * from here to decode a normal ExtensionObject. */
     u8 *old_pos = ctx->pos;
+    const u8 *old_end = ctx->end;
+    const UA_ByteString *old_segment = ctx->segment;
+    size_t old_segmentsTail = ctx->segmentsTail;
 
     /* Decode the DataType */
     UA_NodeId typeId;
@@ -1048,7 +1306,8 @@ Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     u8 encoding;
     ret = DECODE_DIRECT(&encoding, Byte);
     if(ret != UA_STATUSCODE_GOOD) {
-        UA_NodeId_clear(&typeId);
+        if(!ctx->arena)
+            UA_NodeId_clear(&typeId);
         return ret;
     }
 
@@ -1056,16 +1315,23 @@ Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     if(encoding == UA_EXTENSIONOBJECT_ENCODED_BYTESTRING &&
        (dst->type = UA_findDataTypeByBinaryInternal(&typeId, ctx)) != NULL) {
         /* Jump over the length field (TODO: check if length matches) */
-        ctx->pos += 4;
+        u32 length;
+        ret = DECODE_DIRECT(&length, UInt32);
+        if(ret != UA_STATUSCODE_GOOD)
+            return ret;
     } else {
         /* Reset and decode as ExtensionObject */
         dst->type = &UA_TYPES[UA_TYPES_EXTENSIONOBJECT];
         ctx->pos = old_pos;
-        UA_NodeId_clear(&typeId);
+        ctx->end = old_end;
+        ctx->segment = old_segment;
+        ctx->segmentsTail = old_segmentsTail;
+        if(!ctx->arena)
+            UA_NodeId_clear(&typeId);
     }
 
     /* Allocate memory */
-    dst->data = UA_new(dst->type);
+    dst->data = ctxCalloc(ctx, 1, dst->type->memSize);
     if(!dst->data)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
@@ -1111,7 +1377,7 @@ DECODE_BINARY(Variant) {
     if(isArray) {
         ret = Array_decodeBinary(&dst->data, &dst->arrayLength, dst->type, ctx);
     } else if(typeKind != UA_DATATYPEKIND_EXTENSIONOBJECT) {
-        dst->data = UA_new(dst->type);
+        dst->data = ctxCalloc(ctx, 1, dst->type->memSize);
         if(!dst->data)
             return UA_STATUSCODE_BADOUTOFMEMORY;
         ret = decodeBinaryJumpTable[typeKind](dst->data, dst->type, ctx);
@@ -1293,7 +1559,7 @@ DECODE_BINARY(DiagnosticInfo) {
     if(encodingMask & 0x40u) {
         /* innerDiagnosticInfo is allocated on the heap */
         dst->innerDiagnosticInfo = (UA_DiagnosticInfo*)
-            UA_calloc(1, sizeof(UA_DiagnosticInfo));
+            ctxCalloc(ctx, 1, sizeof(UA_DiagnosticInfo));
         if(!dst->innerDiagnosticInfo)
             return UA_STATUSCODE_BADOUTOFMEMORY;
         dst->hasInnerDiagnosticInfo = true;
@@ -1311,6 +1577,11 @@ DECODE_BINARY(DiagnosticInfo) {
 
 static status
 encodeBinaryStruct(const void *src, const UA_DataType *type, Ctx *ctx) {
+#ifdef UA_ENABLE_TYPES_ENCODING_SPECIALIZED
+    if(isStandardType(type) && types_encodeBinarySpecialized[type->typeIndex])
+        return types_encodeBinarySpecialized[type->typeIndex](src, type, ctx);
+#endif
+
     /* Check the recursion limit */
     if(ctx->depth > UA_ENCODING_MAX_RECURSION)
         return UA_STATUSCODE_BADENCODINGERROR;
@@ -1322,7 +1593,7 @@ encodeBinaryStruct(const void *src, const UA_DataType *type, Ctx *ctx) {
     const UA_DataType *typelists[2] = { UA_TYPES, &type[-type->typeIndex] };
 
     /* Loop over members */
-    for(size_t i = 0; i < membersSize; ++i) {
+    for(size_t i = 0; i < membersSize && ret == UA_STATUSCODE_GOOD; ++i) {
         const UA_DataTypeMember *m = &type->members[i];
         const UA_DataType *mt = &typelists[!m->namespaceZero][m->memberTypeIndex];
         ptr += m->padding;
@@ -1422,6 +1693,11 @@ decodeBinaryNotImplemented(void *dst, const UA_DataType *type, Ctx *ctx) {
 
 static status
 decodeBinaryStructure(void *dst, const UA_DataType *type, Ctx *ctx) {
+#ifdef UA_ENABLE_TYPES_ENCODING_SPECIALIZED
+    if(isStandardType(type) && types_decodeBinarySpecialized[type->typeIndex])
+        return types_decodeBinarySpecialized[type->typeIndex](dst, type, ctx);
+#endif
+
     /* Check the recursion limit */
     if(ctx->depth > UA_ENCODING_MAX_RECURSION)
         return UA_STATUSCODE_BADENCODINGERROR;
@@ -1491,51 +1767,96 @@ const decodeBinarySignature decodeBinaryJumpTable[UA_DATATYPEKINDS] = {
 };
 
 status
-UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
-                const UA_DataType *type, const UA_DataTypeArray *customTypes) {
+UA_decodeBinarySegments(const UA_ByteString *segments, size_t segmentsSize,
+                        size_t *offset, void *dst, const UA_DataType *type,
+                        const UA_DataTypeArray *customTypes,
+                        UA_Arena *arena, UA_Boolean zeroCopy) {
+    memset(dst, 0, type->memSize); /* Initialize the value */
+
+    /* Find the segment that contains the offset */
+    size_t total = 0;
+    for(size_t i = 0; i < segmentsSize; i++)
+        total += segments[i].length;
+    if(segmentsSize == 0 || *offset > total)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    size_t i = 0;
+    size_t segmentOffset = *offset;
+    while(segmentOffset >= segments[i].length && i + 1 < segmentsSize)
+        segmentOffset -= segments[i++].length;
+
     /* Set up the context */
     Ctx ctx;
-    ctx.pos = &src->data[*offset];
-    ctx.end = &src->data[src->length];
+    ctx.pos = &segments[i].data[segmentOffset];
+    ctx.end = &segments[i].data[segments[i].length];
     ctx.depth = 0;
     ctx.customTypes = customTypes;
+    ctx.arena = arena;
+    ctx.zeroCopy = (arena != NULL) && zeroCopy;
+    ctx.segment = &segments[i];
+    ctx.segmentsEnd = &segments[segmentsSize];
+    ctx.segmentsTail = total - *offset - (segments[i].length - segmentOffset);
 
     /* Decode */
-    memset(dst, 0, type->memSize); /* Initialize the value */
     status ret = decodeBinaryJumpTable[type->typeKind](dst, type, &ctx);
 
     if(ret == UA_STATUSCODE_GOOD) {
         /* Set the new offset */
-        *offset = (size_t)(ctx.pos - src->data) / sizeof(u8);
+        *offset = total - remainingBytes(&ctx);
     } else {
         /* Clean up */
-        UA_clear(dst, type);
+        if(!arena)
+            UA_clear(dst, type);
         memset(dst, 0, type->memSize);
     }
     return ret;
 }
 
+status
+UA_decodeBinaryArena(const UA_ByteString *src, size_t *offset, void *dst,
+                     const UA_DataType *type, const UA_DataTypeArray *customTypes,
+                     UA_Arena *arena, UA_Boolean zeroCopy) {
+    return UA_decodeBinarySegments(src, 1, offset, dst, type, customTypes,
+                                   arena, zeroCopy);
+}
+
+status
+UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
+                const UA_DataType *type, const UA_DataTypeArray *customTypes) {
+    return UA_decodeBinaryArena(src, offset, dst, type, customTypes, NULL, false);
+}
+
 /**
  * Compute the Message Size
  * ------------------------
  * The following methods are used to compute the length of a datum in binary
  * encoding. */
 
-static size_t
-Array_calcSizeBinary(const void *src, size_t length, const UA_DataType *type) {
+static UA_INLINE size_t
+Array_calcSizeBinaryDirect(const void *src, size_t length, const UA_DataType *type,
+                           calcSizeBinarySignature calcSize) {
     size_t s = 4; /* length */
+#if UA_BINARY_SWAPPABLE
+    if(type->overlayable || isSwappable(type)) {
+#else
     if(type->overlayable) {
+#endif
         s += type->memSize * length;
         return s;
     }
     uintptr_t ptr = (uintptr_t)src;
     for(size_t i = 0; i < length; ++i) {
-        s += calcSizeBinaryJumpTable[type->typeKind]((const void*)ptr, type);
+        s += calcSize((const void*)ptr, type);
         ptr += type->memSize;
     }
     return s;
 }
 
+static size_t
+Array_calcSizeBinary(const void *src, size_t length, const UA_DataType *type) {
+    return Array_calcSizeBinaryDirect(src, length, type,
+                                      calcSizeBinaryJumpTable[type->typeKind]);
+}
+
 static size_t calcSizeBinary1(const void *_, const UA_DataType *__) { (void)_, (void)__; return 1; }
 static size_t calcSizeBinary2(const void *_, const UA_DataType *__) { (void)_, (void)__; return 2; }
 static size_t calcSizeBinary4(const void *_, const UA_DataType *__) { (void)_, (void)__; return 4; }
@@ -1690,6 +2011,11 @@ CALCSIZE_BINARY(DiagnosticInfo) {
 
 static size_t
 calcSizeBinaryStructure(const void *p, const UA_DataType *type) {
+#ifdef UA_ENABLE_TYPES_ENCODING_SPECIALIZED
+    if(isStandardType(type) && types_calcSizeBinarySpecialized[type->typeIndex])
+        return types_calcSizeBinarySpecialized[type->typeIndex](p, type);
+#endif
+
     size_t s = 0;
     uintptr_t ptr = (uintptr_t)p;
     u8 membersSize = type->membersSize;
@@ -1762,3 +2088,7 @@ size_t
 UA_calcSizeBinary(const void *p, const UA_DataType *type) {
     return calcSizeBinaryJumpTable[type->typeKind](p, type);
 }
+
+#ifdef UA_ENABLE_TYPES_ENCODING_SPECIALIZED
+#include <open62541/types_generated_encoding_binary_specialized.c>
+#endif
@@ -14,6 +14,8 @@
 
 #include <open62541/types.h>
 
+#include "ua_util_internal.h"
+
 _UA_BEGIN_DECLS
 
 typedef UA_StatusCode (*UA_exchangeEncodeBuffer)(void *handle, UA_Byte **bufPos,
@@ -65,6 +67,28 @@ UA_decodeBinary(const UA_ByteString *src, size_t *offset, void *dst,
                 const UA_DataType *type, const UA_DataTypeArray *customTypes)
     UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Decodes with all allocations taken from the arena. The decoded value must
+ * not be cleared or deleted. It is released with the arena. If decoding fails,
+ * the allocations done so far remain in the arena until it is reset.
+ *
+ * With zeroCopy, Strings, ByteStrings and arrays of overlayable types (if
+ * correctly aligned) are not copied but point into src. Then src must outlive
+ * the decoded value. */
+UA_StatusCode
+UA_decodeBinaryArena(const UA_ByteString *src, size_t *offset, void *dst,
+                     const UA_DataType *type, const UA_DataTypeArray *customTypes,
+                     UA_Arena *arena, UA_Boolean zeroCopy) UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
+/* Decodes from the concatenation of several buffers (segments) without
+ * assembling them first. The offset counts from the start of the first segment.
+ * With zeroCopy, only content that does not straddle segments points into the
+ * segments. */
+UA_StatusCode
+UA_decodeBinarySegments(const UA_ByteString *segments, size_t segmentsSize,
+                        size_t *offset, void *dst, const UA_DataType *type,
+                        const UA_DataTypeArray *customTypes,
+                        UA_Arena *arena, UA_Boolean zeroCopy) UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 /* Returns the number of bytes the value p takes in binary encoding. Returns
  * zero if an error occurs. UA_calcSizeBinary is thread-safe and reentrant since
  * it does not access global (thread-local) variables. */
@@ -74,6 +98,10 @@ UA_calcSizeBinary(const void *p, const UA_DataType *type);
 const UA_DataType *
 UA_findDataTypeByBinary(const UA_NodeId *typeId);
 
+/* Hashed lookup in UA_TYPES only. Defined in ua_types.c. */
+const UA_DataType *
+UA_findDataTypeByBinaryBuiltin(const UA_NodeId *typeId);
+
 _UA_END_DECLS
 
 #endif /* UA_TYPES_ENCODING_BINARY_H_ */
@@ -297,3 +297,154 @@ UA_NodeId_print(const UA_NodeId *id, UA_String *output) {
 
     return UA_STATUSCODE_GOOD;
 }
+
+/*******************/
+/* Arena Allocator */
+/*******************/
+
+#define UA_ARENA_ALIGN (2 * sizeof(void*))
+#define UA_ARENA_MINBLOCKSIZE 4096
+#define UA_ARENA_MAXBLOCKSIZE (1u << 18) /* Larger blocks are not kept */
+#define UA_ARENA_HEADERSIZE \
+    ((sizeof(UA_ArenaBlock) + UA_ARENA_ALIGN - 1) & ~(UA_ARENA_ALIGN - 1))
+
+void
+UA_Arena_init(UA_Arena *arena) {
+    memset(arena, 0, sizeof(UA_Arena));
+    arena->blockSize = UA_ARENA_MINBLOCKSIZE;
+}
+
+static UA_ArenaBlock *
+UA_Arena_addBlock(UA_Arena *arena, size_t minSize) {
+    size_t size = arena->blockSize;
+    if(size < minSize)
+        size = minSize;
+    UA_ArenaBlock *block = (UA_ArenaBlock*)UA_malloc(UA_ARENA_HEADERSIZE + size);
+    if(!block)
+        return NULL;
+    block->size = size;
+    block->used = 0;
+    block->next = arena->blocks;
+    arena->blocks = block;
+    arena->heapAllocations++;
+    return block;
+}
+
+void *
+UA_Arena_alloc(UA_Arena *arena, size_t size) {
+    size = (size + UA_ARENA_ALIGN - 1) & ~(UA_ARENA_ALIGN - 1);
+    UA_ArenaBlock *block = arena->blocks;
+    if(!block || block->size - block->used < size) {
+        block = UA_Arena_addBlock(arena, size);
+        if(!block)
+            return NULL;
+    }
+    void *p = (void*)((uintptr_t)block + UA_ARENA_HEADERSIZE + block->used);
+    block->used += size;
+    arena->allocations++;
+    memset(p, 0, size);
+    return p;
+}
+
+void
+UA_Arena_reset(UA_Arena *arena) {
+    UA_ArenaBlock *block = arena->blocks;
+    if(!block)
+        return;
+
+    /* A single block is reused */
+    if(!block->next && block->size <= UA_ARENA_MAXBLOCKSIZE) {
+        block->used = 0;
+        return;
+    }
+
+    /* Merge into one block that fits the content of all blocks */
+    size_t total = 0;
+    while(block) {
+        UA_ArenaBlock *next = block->next;
+        total += block->size;
+        UA_free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+    if(total > UA_ARENA_MAXBLOCKSIZE)
+        total = UA_ARENA_MAXBLOCKSIZE;
+    if(total > arena->blockSize)
+        arena->blockSize = total;
+    UA_Arena_addBlock(arena, 0); /* Can fail. Then the next alloc retries. */
+}
+
+void
+UA_Arena_clear(UA_Arena *arena) {
+    UA_ArenaBlock *block = arena->blocks;
+    while(block) {
+        UA_ArenaBlock *next = block->next;
+        UA_free(block);
+        block = next;
+    }
+    UA_Arena_init(arena);
+}
+
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+
+/*********************/
+/* Latency Histogram */
+/*********************/
+
+/* Values below 4us have a bucket each. Above, the value is split into the
+ * exponent e (highest set bit) and the two bits below it. */
+static size_t
+latencyBucket(u64 us) {
+    if(us < 4)
+        return (size_t)us;
+    size_t e = 2;
+    while(e < 63 && (us >> (e + 1)) != 0)
+        e++;
+    if(e > 31)
+        return UA_LATENCYHISTOGRAM_BUCKETS - 1;
+    return 4 + ((e - 2) << 2) + (size_t)((us >> (e - 2)) & 3);
+}
+
+static u64
+latencyBucketUpperBound(size_t bucket) {
+    if(bucket < 4)
+        return bucket;
+    size_t e = ((bucket - 4) >> 2) + 2;
+    u64 sub = (bucket - 4) & 3;
+    return ((5 + sub) << (e - 2)) - 1;
+}
+
+void
+UA_LatencyHistogram_record(UA_LatencyHistogram *h, UA_DateTime duration) {
+    u64 us = (duration > 0) ? (u64)duration / UA_DATETIME_USEC : 0;
+    h->buckets[latencyBucket(us)]++;
+    h->count++;
+    h->sum += us;
+    if(us > h->max)
+        h->max = us;
+}
+
+u64
+UA_LatencyHistogram_percentile(const UA_LatencyHistogram *h, UA_Double percentile) {
+    if(h->count == 0)
+        return 0;
+    /* Nearest rank: the smallest value that is larger or equal than the
+     * percentile of all values */
+    UA_Double target = percentile * (UA_Double)h->count;
+    u64 rank = (target > 0.0) ? (u64)target : 0;
+    if((UA_Double)rank < target || rank == 0)
+        rank++;
+    u64 seen = 0;
+    for(size_t i = 0; i < UA_LATENCYHISTOGRAM_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if(seen < rank)
+            continue;
+        if(i == UA_LATENCYHISTOGRAM_BUCKETS - 1)
+            return h->max; /* Open-ended last bucket */
+        u64 bound = latencyBucketUpperBound(i);
+        return (bound < h->max) ? bound : h->max;
+    }
+    return h->max;
+}
+
+#endif
@@ -46,6 +46,46 @@ typedef UA_UInt64 u64;
 typedef UA_Int64 i64;
 typedef UA_StatusCode status;
 
+/* Arena Allocator
+ * ---------------
+ * Memory is taken from large blocks by advancing a position ("bump
+ * allocation"). Individual allocations cannot be freed. Instead, all memory is
+ * released at once with UA_Arena_reset. If several blocks were required, they
+ * are merged into a single larger block during the reset. So the arena
+ * adjusts to the usual size of its content and then requires no more heap
+ * allocations. */
+
+typedef struct UA_ArenaBlock {
+    struct UA_ArenaBlock *next;
+    size_t size; /* Usable bytes after the header */
+    size_t used;
+} UA_ArenaBlock;
+
+typedef struct {
+    UA_ArenaBlock *blocks; /* The current block comes first */
+    size_t blockSize;      /* Size for the next block */
+
+    /* Statistics */
+    size_t allocations;     /* Allocations served from the arena */
+    size_t heapAllocations; /* Blocks allocated on the heap */
+} UA_Arena;
+
+void UA_Arena_init(UA_Arena *arena);
+
+/* Returns zeroed memory or NULL if the heap is exhausted */
+void * UA_Arena_alloc(UA_Arena *arena, size_t size);
+
+/* Release all allocations. The memory is kept for reuse. */
+void UA_Arena_reset(UA_Arena *arena);
+
+/* Return the memory to the heap */
+void UA_Arena_clear(UA_Arena *arena);
+
+#ifdef UA_ENABLE_SERVICE_STATISTICS
+/* Record a duration in the histogram. Negative durations count as zero. */
+void UA_LatencyHistogram_record(UA_LatencyHistogram *h, UA_DateTime duration);
+#endif
+
 /* Utility Functions
  * ----------------- */
 
@@ -22,13 +22,19 @@ void UA_WorkQueue_init(UA_WorkQueue *wq) {
 
 #if UA_MULTITHREADING >= 200
     wq->delayedCallbacks_checkpoint = NULL;
+    wq->delayedCallbacks_drained = false;
+    wq->delayedCallbacks_checkpointShared = 0;
+    wq->delayedCallbacks_sinceDispatch = 0;
     UA_LOCK_INIT(wq->delayedCallbacks_accessMutex)
 
-    /* Initialize the dispatch queue for worker threads */
+    /* Initialize the shared dispatch queue for worker threads */
     SIMPLEQ_INIT(&wq->dispatchQueue);
+    wq->dispatchQueue_pushed = 0;
+    wq->dispatchQueue_taken = 0;
     UA_LOCK_INIT(wq->dispatchQueue_accessMutex)
     pthread_cond_init(&wq->dispatchQueue_condition, NULL);
-    UA_LOCK_INIT(wq->dispatchQueue_conditionMutex)
+    pthread_mutex_init(&wq->dispatchQueue_conditionMutex, NULL);
+    wq->sleepingWorkers = 0;
 #endif
 }
 
@@ -39,7 +45,8 @@ static void UA_WorkQueue_manuallyProcessDelayed(UA_WorkQueue *wq);
 
 void UA_WorkQueue_cleanup(UA_WorkQueue *wq) {
 #if UA_MULTITHREADING >= 200
-    /* Shut down workers */
+    /* Shut down workers. This moves the work remaining in the deques to the
+     * shared dispatch queue. */
     UA_WorkQueue_stop(wq);
 
     /* Execute remaining work in the dispatch queue */
@@ -51,8 +58,10 @@ void UA_WorkQueue_cleanup(UA_WorkQueue *wq) {
             break;
         }
         SIMPLEQ_REMOVE_HEAD(&wq->dispatchQueue, next);
+        wq->dispatchQueue_taken++;
         UA_UNLOCK(wq->dispatchQueue_accessMutex);
-        dc->callback(dc->application, dc->data);
+        if(dc->callback)
+            dc->callback(dc->application, dc->data);
         UA_free(dc);
     }
 #endif
@@ -64,21 +73,121 @@ void UA_WorkQueue_cleanup(UA_WorkQueue *wq) {
     wq->delayedCallbacks_checkpoint = NULL;
     UA_LOCK_DESTROY(wq->dispatchQueue_accessMutex);
     pthread_cond_destroy(&wq->dispatchQueue_condition);
-    UA_LOCK_DESTROY(wq->dispatchQueue_conditionMutex);
+    pthread_mutex_destroy(&wq->dispatchQueue_conditionMutex);
     UA_LOCK_DESTROY(wq->delayedCallbacks_accessMutex);
 #endif
 }
 
+/*****************/
+/* Work Stealing */
+/*****************/
+
+#if UA_MULTITHREADING >= 200
+
+#define UA_WORKQUEUE_DEQUEMASK (UA_WORKQUEUE_DEQUESIZE - 1)
+
+/* Only called from the thread driving the server. Returns false if the deque
+ * is full. */
+static UA_Boolean
+WorkDeque_push(UA_WorkDeque *d, UA_DelayedCallback *dc) {
+    size_t b = d->bottom;
+    size_t t = d->top;
+    if(b - t >= UA_WORKQUEUE_DEQUESIZE)
+        return false;
+    d->buffer[b & UA_WORKQUEUE_DEQUEMASK] = dc;
+    UA_atomic_sync(); /* The slot is written before the bottom is published */
+    d->bottom = b + 1;
+    return true;
+}
+
+/* Called from the owner and from other workers. The slot at the top is
+ * claimed with a CAS. If a concurrent take wins the race, retry. */
+static UA_DelayedCallback *
+WorkDeque_take(UA_WorkDeque *d) {
+    while(true) {
+        size_t t = d->top;
+        UA_atomic_sync();
+        size_t b = d->bottom;
+        if(t >= b)
+            return NULL;
+        UA_DelayedCallback *dc = d->buffer[t & UA_WORKQUEUE_DEQUEMASK];
+        if(UA_atomic_cmpxchgSize(&d->top, t, t + 1) == t)
+            return dc;
+    }
+}
+
+static UA_Boolean
+WorkDeque_isEmpty(const UA_WorkDeque *d) {
+    return d->top >= d->bottom;
+}
+
+static UA_DelayedCallback *
+takeShared(UA_WorkQueue *wq) {
+    if(SIMPLEQ_EMPTY(&wq->dispatchQueue))
+        return NULL; /* Don't take the lock when there is nothing to do */
+    UA_LOCK(wq->dispatchQueue_accessMutex);
+    UA_DelayedCallback *dc = SIMPLEQ_FIRST(&wq->dispatchQueue);
+    if(dc) {
+        SIMPLEQ_REMOVE_HEAD(&wq->dispatchQueue, next);
+        wq->dispatchQueue_taken++;
+    }
+    UA_UNLOCK(wq->dispatchQueue_accessMutex);
+    return dc;
+}
+
+static UA_Boolean
+hasWork(UA_WorkQueue *wq) {
+    if(!SIMPLEQ_EMPTY(&wq->dispatchQueue))
+        return true;
+    for(size_t i = 0; i < wq->workersSize; i++) {
+        if(!WorkDeque_isEmpty(&wq->workers[i].deque))
+            return true;
+    }
+    return false;
+}
+
+/* Wake up one sleeping worker. The sleeping workers are counted so that the
+ * condition mutex is only taken if a worker actually sleeps. */
+static void
+wakeupWorker(UA_WorkQueue *wq) {
+    UA_atomic_sync(); /* The work is published before sleepingWorkers is read */
+    if(wq->sleepingWorkers == 0)
+        return;
+    pthread_mutex_lock(&wq->dispatchQueue_conditionMutex);
+    pthread_cond_signal(&wq->dispatchQueue_condition);
+    pthread_mutex_unlock(&wq->dispatchQueue_conditionMutex);
+}
+
 /***********/
 /* Workers */
 /***********/
 
-#if UA_MULTITHREADING >= 200
+static UA_DelayedCallback *
+takeWork(UA_Worker *worker) {
+    UA_WorkQueue *wq = worker->queue;
+
+    /* Own deque */
+    UA_DelayedCallback *dc = WorkDeque_take(&worker->deque);
+    if(dc)
+        return dc;
+
+    /* Steal from the other workers */
+    for(size_t i = 1; i < wq->workersSize; i++) {
+        UA_Worker *victim = &wq->workers[(worker->index + i) % wq->workersSize];
+        dc = WorkDeque_take(&victim->deque);
+        if(dc) {
+            worker->stolen++;
+            return dc;
+        }
+    }
+
+    /* Shared dispatch queue */
+    return takeShared(wq);
+}
 
 static void *
 workerLoop(UA_Worker *worker) {
     UA_WorkQueue *wq = worker->queue;
-    UA_UInt32 *counter = &worker->counter;
     volatile UA_Boolean *running = &worker->running;
 
     /* Initialize the (thread local) random seed with the ram address
@@ -86,21 +195,22 @@ workerLoop(UA_Worker *worker) {
     UA_random_seed((uintptr_t)worker);
 
     while(*running) {
-        UA_atomic_addUInt32(counter, 1);
-
-        /* Remove a callback from the queue */
-        UA_LOCK(wq->dispatchQueue_accessMutex);
-        UA_DelayedCallback *dc = SIMPLEQ_FIRST(&wq->dispatchQueue);
-        if(dc)
-            SIMPLEQ_REMOVE_HEAD(&wq->dispatchQueue, next);
-        UA_UNLOCK(wq->dispatchQueue_accessMutex);
+        UA_DelayedCallback *dc = takeWork(worker);
 
-        /* Nothing to do. Sleep until a callback is dispatched */
+        /* Nothing to do. Sleep until a callback is dispatched. Check for work
+         * again after announcing the sleep. So a concurrent enqueue either
+         * sees the sleeping worker or the worker sees the new work. */
         if(!dc) {
-            UA_LOCK(wq->dispatchQueue_conditionMutex);
-            pthread_cond_wait(&wq->dispatchQueue_condition,
-                              &wq->dispatchQueue_conditionMutex);
-            UA_UNLOCK(wq->dispatchQueue_conditionMutex);
+            pthread_mutex_lock(&wq->dispatchQueue_conditionMutex);
+            wq->sleepingWorkers++;
+            worker->idle = true;
+            UA_atomic_sync();
+            if(*running && !hasWork(wq))
+                pthread_cond_wait(&wq->dispatchQueue_condition,
+                                  &wq->dispatchQueue_conditionMutex);
+            worker->idle = false;
+            wq->sleepingWorkers--;
+            pthread_mutex_unlock(&wq->dispatchQueue_conditionMutex);
             continue;
         }
 
@@ -108,6 +218,8 @@ workerLoop(UA_Worker *worker) {
         if(dc->callback)
             dc->callback(dc->application, dc->data);
         UA_free(dc);
+        worker->executed++;
+        UA_atomic_addUInt32(&worker->counter, 1);
     }
 
     return NULL;
@@ -124,11 +236,13 @@ UA_WorkQueue_start(UA_WorkQueue *wq, size_t workersCount) {
     if(!wq->workers)
         return UA_STATUSCODE_BADOUTOFMEMORY;
     wq->workersSize = workersCount;
+    wq->nextWorker = 0;
 
     /* Spin up the workers */
     for(size_t i = 0; i < workersCount; ++i) {
         UA_Worker *w = &wq->workers[i];
         w->queue = wq;
+        w->index = i;
         w->counter = 0;
         w->running = true;
         pthread_create(&w->thread, NULL, (void* (*)(void*))workerLoop, w);
@@ -145,36 +259,81 @@ void UA_WorkQueue_stop(UA_WorkQueue *wq) {
         wq->workers[i].running = false;
 
     /* Wake up all workers */
+    pthread_mutex_lock(&wq->dispatchQueue_conditionMutex);
     pthread_cond_broadcast(&wq->dispatchQueue_condition);
+    pthread_mutex_unlock(&wq->dispatchQueue_conditionMutex);
 
     /* Wait for the workers to finish, then clean up */
     for(size_t i = 0; i < wq->workersSize; ++i)
         pthread_join(wq->workers[i].thread, NULL);
 
+    /* Move the remaining work from the deques to the shared queue */
+    UA_LOCK(wq->dispatchQueue_accessMutex);
+    for(size_t i = 0; i < wq->workersSize; ++i) {
+        UA_DelayedCallback *dc;
+        while((dc = WorkDeque_take(&wq->workers[i].deque))) {
+            SIMPLEQ_INSERT_TAIL(&wq->dispatchQueue, dc, next);
+            wq->dispatchQueue_pushed++;
+        }
+    }
+    UA_UNLOCK(wq->dispatchQueue_accessMutex);
+
     UA_free(wq->workers);
     wq->workers = NULL;
     wq->workersSize = 0;
 }
 
+static void
+enqueueShared(UA_WorkQueue *wq, UA_DelayedCallback *dc) {
+    UA_LOCK(wq->dispatchQueue_accessMutex);
+    SIMPLEQ_INSERT_TAIL(&wq->dispatchQueue, dc, next);
+    wq->dispatchQueue_pushed++;
+    UA_UNLOCK(wq->dispatchQueue_accessMutex);
+    wakeupWorker(wq);
+}
+
+static UA_DelayedCallback *
+newWork(UA_ApplicationCallback cb, void *application, void *data) {
+    UA_DelayedCallback *dc = (UA_DelayedCallback*)UA_malloc(sizeof(UA_DelayedCallback));
+    if(!dc)
+        return NULL;
+    dc->callback = cb;
+    dc->application = application;
+    dc->data = data;
+    return dc;
+}
+
 void UA_WorkQueue_enqueue(UA_WorkQueue *wq, UA_ApplicationCallback cb,
                           void *application, void *data) {
-    UA_DelayedCallback *dc = (UA_DelayedCallback*)UA_malloc(sizeof(UA_DelayedCallback));
+    UA_DelayedCallback *dc = newWork(cb, application, data);
     if(!dc) {
         cb(application, data); /* Execute immediately if the memory could not be allocated */
         return;
     }
 
-    dc->callback = cb;
-    dc->application = application;
-    dc->data = data;
+    /* Push to the deque of the next worker. Idle workers steal from the
+     * others, so the round-robin distribution does not need to be exact. */
+    if(wq->workersSize > 0) {
+        UA_Worker *w = &wq->workers[wq->nextWorker];
+        wq->nextWorker = (wq->nextWorker + 1) % wq->workersSize;
+        if(WorkDeque_push(&w->deque, dc)) {
+            wakeupWorker(wq);
+            return;
+        }
+    }
 
-    /* Enqueue for the worker threads */
-    UA_LOCK(wq->dispatchQueue_accessMutex);
-    SIMPLEQ_INSERT_TAIL(&wq->dispatchQueue, dc, next);
-    UA_UNLOCK(wq->dispatchQueue_accessMutex);
+    /* No workers or the deque is full */
+    enqueueShared(wq, dc);
+}
 
-    /* Wake up sleeping workers */
-    pthread_cond_broadcast(&wq->dispatchQueue_condition);
+void UA_WorkQueue_getStatistics(UA_WorkQueue *wq, size_t *executed,
+                                size_t *stolen) {
+    *executed = 0;
+    *stolen = 0;
+    for(size_t i = 0; i < wq->workersSize; i++) {
+        *executed += wq->workers[i].executed;
+        *stolen += wq->workers[i].stolen;
+    }
 }
 
 #endif
@@ -187,42 +346,84 @@ void UA_WorkQueue_enqueue(UA_WorkQueue *wq, UA_ApplicationCallback cb,
 
 /* Delayed Callbacks are called only when all callbacks that were dispatched
  * prior are finished. After every UA_MAX_DELAYED_SAMPLE delayed Callbacks that
- * were added to the queue, we sample the counters from the workers. The
- * counters are compared to the last counters that were sampled. If every worker
- * has proceeded the counter, then we know that all delayed callbacks prior to
- * the last sample-point are safe to execute. */
+ * were added to the queue, we create a checkpoint. As work is taken from the
+ * deques in any order, the checkpoint is reached in two steps:
+ *
+ * 1. All work that was enqueued before the checkpoint was taken from the
+ *    deques and the shared dispatch queue. Then the worker counters are
+ *    sampled.
+ * 2. Every worker has proceeded its counter (or is idle). So the work that was
+ *    taken before step 1 is finished.
+ *
+ * Then all delayed callbacks prior to the checkpoint are safe to execute. */
 
 /* Sample the worker counter for every nth delayed callback. This is used to
  * test that all workers have **finished** their current job before the delayed
  * callback is processed. */
 #define UA_MAX_DELAYED_SAMPLE 100
 
+static void
+setCheckpoint(UA_WorkQueue *wq, UA_DelayedCallback *cb) {
+    UA_atomic_sync();
+    for(size_t i = 0; i < wq->workersSize; ++i)
+        wq->workers[i].checkpointBottom = wq->workers[i].deque.bottom;
+    UA_LOCK(wq->dispatchQueue_accessMutex);
+    wq->delayedCallbacks_checkpointShared = wq->dispatchQueue_pushed;
+    UA_UNLOCK(wq->dispatchQueue_accessMutex);
+    wq->delayedCallbacks_checkpoint = cb;
+    wq->delayedCallbacks_drained = false;
+}
+
 /* Call only with a held mutex for the delayed callbacks */
 static void
 dispatchDelayedCallbacks(UA_WorkQueue *wq, UA_DelayedCallback *cb) {
-    /* Are callbacks before the last checkpoint ready? */
+    if(!wq->delayedCallbacks_checkpoint) {
+        setCheckpoint(wq, cb);
+        return;
+    }
+
+    /* Step 1: Was all work before the checkpoint taken from the queues? */
+    if(!wq->delayedCallbacks_drained) {
+        UA_atomic_sync();
+        for(size_t i = 0; i < wq->workersSize; ++i) {
+            if(wq->workers[i].deque.top < wq->workers[i].checkpointBottom)
+                return;
+        }
+        UA_LOCK(wq->dispatchQueue_accessMutex);
+        size_t taken = wq->dispatchQueue_taken;
+        UA_UNLOCK(wq->dispatchQueue_accessMutex);
+        if(taken < wq->delayedCallbacks_checkpointShared)
+            return;
+
+        for(size_t i = 0; i < wq->workersSize; ++i)
+            wq->workers[i].checkpointCounter = wq->workers[i].counter;
+        wq->delayedCallbacks_drained = true;
+    }
+
+    /* Step 2: Has every worker finished the work it was executing? */
+    UA_atomic_sync();
     for(size_t i = 0; i < wq->workersSize; ++i) {
-        if(wq->workers[i].counter == wq->workers[i].checkpointCounter)
+        if(wq->workers[i].counter == wq->workers[i].checkpointCounter &&
+           !wq->workers[i].idle)
             return;
     }
 
-    /* Dispatch all delayed callbacks up to the checkpoint.
-     * TODO: Move over the entire queue up to the checkpoint in one step. */
-    if(wq->delayedCallbacks_checkpoint != NULL) {
-        UA_DelayedCallback *iter, *tmp_iter;
-        SIMPLEQ_FOREACH_SAFE(iter, &wq->delayedCallbacks, next, tmp_iter) {
-            UA_LOCK(wq->dispatchQueue_accessMutex);
-            SIMPLEQ_INSERT_TAIL(&wq->dispatchQueue, iter, next);
-            UA_UNLOCK(wq->dispatchQueue_accessMutex);
-            if(iter == wq->delayedCallbacks_checkpoint)
-                break;
-        }
+    /* Move all delayed callbacks up to the checkpoint to the shared dispatch
+     * queue in one step */
+    UA_LOCK(wq->dispatchQueue_accessMutex);
+    while(true) {
+        UA_DelayedCallback *dc = SIMPLEQ_FIRST(&wq->delayedCallbacks);
+        SIMPLEQ_REMOVE_HEAD(&wq->delayedCallbacks, next);
+        SIMPLEQ_INSERT_TAIL(&wq->dispatchQueue, dc, next);
+        wq->dispatchQueue_pushed++;
+        if(dc == wq->delayedCallbacks_checkpoint)
+            break;
     }
+    UA_UNLOCK(wq->dispatchQueue_accessMutex);
+    wakeupWorker(wq);
 
-    /* Create the new sample point */
-    for(size_t i = 0; i < wq->workersSize; ++i)
-        wq->workers[i].checkpointCounter = wq->workers[i].counter;
-    wq->delayedCallbacks_checkpoint = cb;
+    /* Create the new checkpoint */
+    setCheckpoint(wq, cb);
 }
 
 #endif
@@ -230,10 +431,10 @@ dispatchDelayedCallbacks(UA_WorkQueue *wq, UA_DelayedCallback *cb) {
 void
 UA_WorkQueue_enqueueDelayed(UA_WorkQueue *wq, UA_DelayedCallback *cb) {
 #if UA_MULTITHREADING >= 200
-    UA_LOCK(wq->dispatchQueue_accessMutex);
+    UA_LOCK(wq->delayedCallbacks_accessMutex);
 #endif
 
-    SIMPLEQ_INSERT_HEAD(&wq->delayedCallbacks, cb, next);
+    SIMPLEQ_INSERT_TAIL(&wq->delayedCallbacks, cb, next);
 
 #if UA_MULTITHREADING >= 200
     wq->delayedCallbacks_sinceDispatch++;
@@ -242,14 +443,15 @@ UA_WorkQueue_enqueueDelayed(UA_WorkQueue *wq, UA_DelayedCallback *cb) {
         wq->delayedCallbacks_sinceDispatch = 0;
     }
 
-    UA_UNLOCK(wq->dispatchQueue_accessMutex);
+    UA_UNLOCK(wq->delayedCallbacks_accessMutex);
 #endif
 }
 
 /* Assumes all workers are shut down */
 void UA_WorkQueue_manuallyProcessDelayed(UA_WorkQueue *wq) {
-    UA_DelayedCallback *dc, *dc_tmp;
-    SIMPLEQ_FOREACH_SAFE(dc, &wq->delayedCallbacks, next, dc_tmp) {
+    /* Delayed callbacks can enqueue further delayed callbacks */
+    UA_DelayedCallback *dc;
+    while((dc = SIMPLEQ_FIRST(&wq->delayedCallbacks))) {
         SIMPLEQ_REMOVE_HEAD(&wq->delayedCallbacks, next);
         if(dc->callback)
             dc->callback(dc->application, dc->data);
@@ -45,22 +45,48 @@ typedef struct UA_WorkQueue UA_WorkQueue;
 
 #if UA_MULTITHREADING >= 200
 
-/* Workers take out callbacks from the work queue and execute them.
- *
- * Future Plans: Use work-stealing to load-balance between cores.
+/* Number of slots in the deque of every worker. Must be a power of two. */
+#define UA_WORKQUEUE_DEQUESIZE 256
+
+/* Every worker has a bounded deque in the style of
  * Le, Nhat Minh, et al. "Correct and efficient work-stealing for weak memory
- * models." ACM SIGPLAN Notices. Vol. 48. No. 8. ACM, 2013. */
+ * models." ACM SIGPLAN Notices. Vol. 48. No. 8. ACM, 2013.
+ *
+ * Work is pushed at the bottom only by the thread that drives the server
+ * (which processes the timer and the network layer). The owning worker and
+ * the other workers (stealing) take work from the top with a single CAS. So
+ * no lock is taken to dispatch and execute work. Work that does not fit into
+ * a deque or that is enqueued from other threads goes to the shared dispatch
+ * queue that is protected by a mutex. */
+typedef struct {
+    volatile size_t top;    /* Next slot to take from */
+    char padding_top[64 - sizeof(size_t)];
+    volatile size_t bottom; /* Next slot to push to */
+    char padding_bottom[64 - sizeof(size_t)];
+    UA_DelayedCallback * volatile buffer[UA_WORKQUEUE_DEQUESIZE];
+} UA_WorkDeque;
+
+/* Workers take out callbacks from their own deque first. Then they try to
+ * steal from the other workers and from the shared dispatch queue. */
 typedef struct {
+    UA_WorkDeque deque;
     pthread_t thread;
     volatile UA_Boolean running;
+    volatile UA_Boolean idle; /* Sleeping and not executing a callback */
     UA_WorkQueue *queue;
-    UA_UInt32 counter;
-    UA_UInt32 checkpointCounter; /* Counter when the last checkpoint was made
-                                  * for the delayed callbacks */
+    size_t index;
+    volatile UA_UInt32 counter; /* Incremented after every executed callback */
+
+    /* Sampled for the delayed callbacks */
+    UA_UInt32 checkpointCounter;
+    size_t checkpointBottom;
+
+    /* Statistics */
+    volatile size_t executed;
+    volatile size_t stolen;
 
     /* separate cache lines */
-    char padding[64 - sizeof(void*) - sizeof(pthread_t) -
-                 sizeof(UA_UInt32) - sizeof(UA_Boolean)];
+    char padding[64];
 } UA_Worker;
 
 #endif
@@ -71,12 +97,19 @@ struct UA_WorkQueue {
 #if UA_MULTITHREADING >= 200
     UA_Worker *workers;
     size_t workersSize;
+    size_t nextWorker; /* Round-robin distribution of new work */
 
-    /* Work queue */
-    SIMPLEQ_HEAD(, UA_DelayedCallback) dispatchQueue; /* Dispatch queue for the worker threads */
+    /* Shared work queue for overflow and for work from other threads */
+    SIMPLEQ_HEAD(, UA_DelayedCallback) dispatchQueue;
     UA_LOCK_TYPE(dispatchQueue_accessMutex) /* mutex for access to queue */
-    pthread_cond_t dispatchQueue_condition; /* so the workers don't spin if the queue is empty */
-    UA_LOCK_TYPE(dispatchQueue_conditionMutex) /* mutex for access to condition variable */
+    size_t dispatchQueue_pushed;
+    size_t dispatchQueue_taken;
+
+    /* So the workers don't spin if the queues are empty. This is not a
+     * UA_LOCK_TYPE as several workers wait on the condition at once. */
+    pthread_cond_t dispatchQueue_condition;
+    pthread_mutex_t dispatchQueue_conditionMutex;
+    volatile size_t sleepingWorkers;
 #endif
 
     /* Delayed callbacks
@@ -85,6 +118,9 @@ struct UA_WorkQueue {
 #if UA_MULTITHREADING >= 200
     UA_LOCK_TYPE(delayedCallbacks_accessMutex)
     UA_DelayedCallback *delayedCallbacks_checkpoint;
+    UA_Boolean delayedCallbacks_drained; /* All work dispatched before the
+                                          * checkpoint was taken by a worker */
+    size_t delayedCallbacks_checkpointShared;
     size_t delayedCallbacks_sinceDispatch; /* How many have been added since we
                                             * tried to dispatch callbacks? */
 #endif
@@ -111,10 +147,17 @@ UA_StatusCode UA_WorkQueue_start(UA_WorkQueue *wq, size_t workersCount);
 
 void UA_WorkQueue_stop(UA_WorkQueue *wq);
 
-/* Enqueue work for the worker threads */
+/* Enqueue work for the worker threads. The work is pushed lock-free to the
+ * deque of a worker. Must only be called from the thread that drives the
+ * server. */
 void UA_WorkQueue_enqueue(UA_WorkQueue *wq, UA_ApplicationCallback cb,
                           void *application, void *data);
 
+/* Sum up the callbacks executed by the workers and the callbacks that were
+ * stolen from the deque of another worker */
+void UA_WorkQueue_getStatistics(UA_WorkQueue *wq, size_t *executed,
+                                size_t *stolen);
+
 #else
 
 /* Process all enqueued delayed work. This is not needed when workers are
@@ -150,12 +150,89 @@ START_TEST(encodeTwoStringsIntoTenChunksShallWork) {
     UA_String_deleteMembers(&string);
 } END_TEST
 
+/* The numeric types are encoded in bulk. The elements that are cut off by the
+ * chunk boundaries continue in the next chunk. */
+static const size_t numericTypes[] = {
+    UA_TYPES_INT16, UA_TYPES_UINT16, UA_TYPES_INT32, UA_TYPES_UINT32,
+    UA_TYPES_INT64, UA_TYPES_UINT64, UA_TYPES_FLOAT, UA_TYPES_DOUBLE,
+    UA_TYPES_DATETIME, UA_TYPES_STATUSCODE};
+
+START_TEST(encodeNumericArrayIntoChunksShallRoundtrip) {
+    const UA_DataType *type = &UA_TYPES[numericTypes[_i]];
+    size_t arraySize = 1001;
+    size_t chunkCount = 1000;
+    size_t chunkSize = 30;
+    bufIndex = 0;
+    counter = 0;
+    dataCount = 0;
+    buffers = (UA_ByteString*)UA_Array_new(chunkCount, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    for(size_t i = 0; i < chunkCount; i++)
+        UA_ByteString_allocBuffer(&buffers[i], chunkSize);
+
+    /* Fill with a pattern that differs in every byte */
+    void *ar = UA_Array_new(arraySize, type);
+    for(size_t i = 0; i < arraySize * type->memSize; i++)
+        ((UA_Byte*)ar)[i] = (UA_Byte)(i * 7 + 1);
+    if(type->typeIndex == UA_TYPES_FLOAT || type->typeIndex == UA_TYPES_DOUBLE) {
+        /* Avoid NaN that does not compare equal */
+        for(size_t i = 0; i < arraySize; i++) {
+            if(type->typeIndex == UA_TYPES_FLOAT)
+                ((UA_Float*)ar)[i] = (UA_Float)i * 0.5f;
+            else
+                ((UA_Double*)ar)[i] = (UA_Double)i * -0.25;
+        }
+    }
+    UA_Variant v;
+    UA_Variant_setArray(&v, ar, arraySize, type);
+
+    UA_Byte *pos = buffers[0].data;
+    const UA_Byte *end = &buffers[0].data[buffers[0].length];
+    UA_StatusCode retval = UA_encodeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT],
+                                           &pos, &end, sendChunkMockUp, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_gt(counter, 0);
+
+    /* Concatenate the chunks. The end of a chunk can remain unused if the
+     * next element does not fit. */
+    size_t lastChunk = bufIndex;
+    UA_ByteString joined;
+    UA_ByteString_allocBuffer(&joined, UA_calcSizeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT]));
+    size_t joinedPos = 0;
+    for(size_t i = 0; i <= lastChunk; i++) {
+        size_t used = chunkSize - (chunkSize - 5) % type->memSize; /* Header in the first */
+        if(i > 0)
+            used = chunkSize - chunkSize % type->memSize;
+        if(i == lastChunk)
+            used = (uintptr_t)(pos - buffers[i].data);
+        ck_assert_uint_le(joinedPos + used, joined.length);
+        memcpy(&joined.data[joinedPos], buffers[i].data, used);
+        joinedPos += used;
+    }
+    ck_assert_uint_eq(joinedPos, joined.length);
+
+    /* Decode and compare */
+    UA_Variant out;
+    size_t offset = 0;
+    retval = UA_decodeBinary(&joined, &offset, &out, &UA_TYPES[UA_TYPES_VARIANT], NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(out.type, type);
+    ck_assert_uint_eq(out.arrayLength, arraySize);
+    ck_assert(memcmp(out.data, ar, arraySize * type->memSize) == 0);
+
+    UA_Variant_clear(&out);
+    UA_Variant_clear(&v);
+    UA_ByteString_clear(&joined);
+    UA_Array_delete(buffers, chunkCount, &UA_TYPES[UA_TYPES_BYTESTRING]);
+} END_TEST
+
 int main(void) {
     Suite *s = suite_create("Chunked encoding");
     TCase *tc_message = tcase_create("encode chunking");
     tcase_add_test(tc_message,encodeArrayIntoFiveChunksShallWork);
     tcase_add_test(tc_message,encodeStringIntoFiveChunksShallWork);
     tcase_add_test(tc_message,encodeTwoStringsIntoTenChunksShallWork);
+    tcase_add_loop_test(tc_message, encodeNumericArrayIntoChunksShallRoundtrip, 0,
+                        sizeof(numericTypes) / sizeof(size_t));
     suite_add_tcase(s, tc_message);
 
     SRunner *sr = srunner_create(s);
@@ -0,0 +1,122 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Throughput of the en-/decoding of large numeric arrays in a Variant (e.g.
+ * waveforms). Encoding is measured into a single buffer and into chunks where
+ * the array is split over the chunk boundaries. */
+
+#include <open62541/types.h>
+#include <open62541/types_generated_handling.h>
+
+#include "ua_types_encoding_binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "check.h"
+
+#define ARRAY_ELEMENTS 100000
+#define ITERATIONS 50
+#define CHUNK_SIZE 65536
+
+static const size_t numericTypes[] = {
+    UA_TYPES_INT16, UA_TYPES_UINT16, UA_TYPES_INT32, UA_TYPES_UINT32,
+    UA_TYPES_INT64, UA_TYPES_UINT64, UA_TYPES_FLOAT, UA_TYPES_DOUBLE};
+
+static const char *numericTypeNames[] = {
+    "Int16", "UInt16", "Int32", "UInt32", "Int64", "UInt64", "Float", "Double"};
+
+/* The chunks are "sent" by starting over in the same buffer */
+static UA_StatusCode
+exchangeChunk(void *handle, UA_Byte **bufPos, const UA_Byte **bufEnd) {
+    UA_ByteString *chunk = (UA_ByteString*)handle;
+    *bufPos = chunk->data;
+    *bufEnd = &chunk->data[chunk->length];
+    return UA_STATUSCODE_GOOD;
+}
+
+static double
+megabytesPerSecond(size_t bytes, clock_t duration) {
+    if(duration == 0)
+        duration = 1;
+    return ((double)bytes * ITERATIONS / (1024.0 * 1024.0)) /
+        ((double)duration / CLOCKS_PER_SEC);
+}
+
+START_TEST(numericArraySpeed) {
+    const UA_DataType *type = &UA_TYPES[numericTypes[_i]];
+    void *ar = UA_Array_new(ARRAY_ELEMENTS, type);
+    ck_assert_ptr_ne(ar, NULL);
+    for(size_t i = 0; i < ARRAY_ELEMENTS * type->memSize; i++)
+        ((UA_Byte*)ar)[i] = (UA_Byte)i;
+    UA_Variant v;
+    UA_Variant_setArray(&v, ar, ARRAY_ELEMENTS, type);
+
+    size_t size = UA_calcSizeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT]);
+    UA_ByteString buf, chunk;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&buf, size);
+    res |= UA_ByteString_allocBuffer(&chunk, CHUNK_SIZE);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Encode into one buffer */
+    clock_t begin = clock();
+    for(size_t n = 0; n < ITERATIONS; n++) {
+        UA_Byte *pos = buf.data;
+        const UA_Byte *end = &buf.data[buf.length];
+        res |= UA_encodeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT], &pos, &end, NULL, NULL);
+    }
+    clock_t encodeTime = clock() - begin;
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Encode into chunks */
+    begin = clock();
+    for(size_t n = 0; n < ITERATIONS; n++) {
+        UA_Byte *pos = chunk.data;
+        const UA_Byte *end = &chunk.data[chunk.length];
+        res |= UA_encodeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT], &pos, &end,
+                               exchangeChunk, &chunk);
+    }
+    clock_t chunkedTime = clock() - begin;
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Decode */
+    begin = clock();
+    for(size_t n = 0; n < ITERATIONS; n++) {
+        UA_Variant out;
+        size_t offset = 0;
+        res |= UA_decodeBinary(&buf, &offset, &out, &UA_TYPES[UA_TYPES_VARIANT], NULL);
+        UA_Variant_clear(&out);
+    }
+    clock_t decodeTime = clock() - begin;
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    printf("%-8s encode %8.1f MB/s, encode chunked %8.1f MB/s, decode %8.1f MB/s\n",
+           numericTypeNames[_i], megabytesPerSecond(size, encodeTime),
+           megabytesPerSecond(size, chunkedTime), megabytesPerSecond(size, decodeTime));
+
+    UA_Variant_clear(&v);
+    UA_ByteString_clear(&buf);
+    UA_ByteString_clear(&chunk);
+}
+END_TEST
+
+static Suite *testSuite_arraySpeed(void) {
+    Suite *s = suite_create("Numeric Array Speed");
+    TCase *tc_speed = tcase_create("Numeric Array Speed");
+    tcase_add_loop_test(tc_speed, numericArraySpeed, 0,
+                        sizeof(numericTypes) / sizeof(size_t));
+    suite_add_tcase(s, tc_speed);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_arraySpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
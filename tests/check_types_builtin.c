@@ -341,6 +341,193 @@ START_TEST(UA_String_decodeWithZeroSizeShallNotAllocateMemoryAndNullPtr) {
 }
 END_TEST
 
+START_TEST(UA_String_decodeZeroCopyShallPointIntoBuffer) {
+    // given
+    size_t pos = 0;
+    UA_Byte data[] =
+    { 0x08, 0x00, 0x00, 0x00, 'A', 'C', 'P', 'L', 'T', ' ', 'U', 'A', 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    UA_ByteString src = { 16, data };
+    UA_String dst;
+    UA_Arena arena;
+    UA_Arena_init(&arena);
+    // when
+    UA_StatusCode retval = UA_decodeBinaryArena(&src, &pos, &dst, &UA_TYPES[UA_TYPES_STRING],
+                                                NULL, &arena, true);
+    // then
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dst.length, 8);
+    ck_assert_ptr_eq(dst.data, &data[4]);
+    ck_assert_uint_eq(pos, 12);
+    ck_assert_uint_eq(arena.allocations, 0);
+    // finally
+    UA_Arena_clear(&arena);
+}
+END_TEST
+
+START_TEST(UA_Int32Array_decodeZeroCopyShallOnlyPointToAlignedMemory) {
+    // given
+    UA_Int32 values[4] = {1, -2, 3, -4};
+    UA_Variant v;
+    UA_Variant_setArray(&v, values, 4, &UA_TYPES[UA_TYPES_INT32]);
+    UA_ByteString src;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&src, 64);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Arena arena;
+    UA_Arena_init(&arena);
+    for(size_t shift = 0; shift < 4; shift++) {
+        /* The array content starts after the encoding byte and the length */
+        UA_Byte *pos = &src.data[shift];
+        const UA_Byte *end = &src.data[src.length];
+        retval = UA_encodeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT], &pos, &end, NULL, NULL);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        // when
+        size_t offset = shift;
+        size_t allocations = arena.allocations;
+        UA_Variant dst;
+        retval = UA_decodeBinaryArena(&src, &offset, &dst, &UA_TYPES[UA_TYPES_VARIANT],
+                                      NULL, &arena, true);
+        // then
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(dst.arrayLength, 4);
+        ck_assert(memcmp(dst.data, values, sizeof(values)) == 0);
+        UA_Boolean aligned = (((uintptr_t)&src.data[shift + 5]) % sizeof(UA_Int32)) == 0;
+        if(aligned) {
+            ck_assert_ptr_eq(dst.data, &src.data[shift + 5]);
+            ck_assert_uint_eq(arena.allocations, allocations);
+        } else {
+            ck_assert_uint_eq(arena.allocations, allocations + 1);
+        }
+        UA_Arena_reset(&arena);
+    }
+    // finally
+    UA_Arena_clear(&arena);
+    UA_ByteString_clear(&src);
+}
+END_TEST
+
+/* Decoding fails after the first string was taken from the buffer. The
+ * borrowed memory must not be freed during the cleanup. */
+START_TEST(UA_ReadRequest_decodeZeroCopyShallNotFreeBorrowedMemoryOnError) {
+    // given
+    UA_ReadValueId rvi[2];
+    UA_ReadValueId_init(&rvi[0]);
+    UA_ReadValueId_init(&rvi[1]);
+    rvi[0].nodeId = UA_NODEID_STRING(1, "first string identifier");
+    rvi[1].nodeId = UA_NODEID_STRING(1, "second string identifier");
+    UA_ReadRequest req;
+    UA_ReadRequest_init(&req);
+    req.nodesToReadSize = 2;
+    req.nodesToRead = rvi;
+    UA_ByteString src;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&src, 256);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Byte *pos = src.data;
+    const UA_Byte *end = &src.data[src.length];
+    retval = UA_encodeBinary(&req, &UA_TYPES[UA_TYPES_READREQUEST], &pos, &end, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    src.length = (size_t)(pos - src.data) - 20; /* Truncate within the second string */
+    UA_Arena arena;
+    UA_Arena_init(&arena);
+    // when
+    size_t offset = 0;
+    UA_ReadRequest dst;
+    retval = UA_decodeBinaryArena(&src, &offset, &dst, &UA_TYPES[UA_TYPES_READREQUEST],
+                                  NULL, &arena, true);
+    // then
+    ck_assert_int_ne(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(dst.nodesToReadSize, 0);
+    ck_assert_ptr_eq(dst.nodesToRead, NULL);
+    ck_assert_uint_eq(offset, 0);
+    // finally
+    UA_Arena_clear(&arena);
+    UA_ByteString_clear(&src);
+}
+END_TEST
+
+/* The encoding is split into three segments at all positions. Decoding from
+ * the segments gives the same value as decoding from a single buffer. */
+START_TEST(UA_WriteRequest_decodeSegmentsShallEqualContiguous) {
+    // given
+    UA_Double doubles[5] = {1.0, -2.5, 3.25, 1e100, -0.0};
+    UA_Range range = {-1.0, 1.0};
+    UA_ExpandedNodeId expanded = UA_EXPANDEDNODEID_STRING(2, "expanded");
+    expanded.serverIndex = 3;
+    UA_WriteValue wv[3];
+    for(size_t i = 0; i < 3; i++)
+        UA_WriteValue_init(&wv[i]);
+    UA_Guid guid = {1, 2, 3, {4, 5, 6, 7, 8, 9, 10, 11}};
+    wv[0].nodeId = UA_NODEID_GUID(1, guid);
+    wv[0].attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_Variant_setArray(&wv[0].value.value, doubles, 5, &UA_TYPES[UA_TYPES_DOUBLE]);
+    wv[0].value.hasValue = true;
+    wv[1].nodeId = UA_NODEID_STRING(1, "range");
+    wv[1].indexRange = UA_STRING("1:2");
+    UA_Variant_setScalar(&wv[1].value.value, &range, &UA_TYPES[UA_TYPES_RANGE]);
+    wv[1].value.hasValue = true;
+    wv[2].nodeId = UA_NODEID_NUMERIC(0, 4711);
+    UA_Variant_setScalar(&wv[2].value.value, &expanded, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+    wv[2].value.hasValue = true;
+    UA_WriteRequest req;
+    UA_WriteRequest_init(&req);
+    req.nodesToWriteSize = 3;
+    req.nodesToWrite = wv;
+
+    UA_ByteString src;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&src, 512);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Byte *pos = src.data;
+    const UA_Byte *end = &src.data[src.length];
+    retval = UA_encodeBinary(&req, &UA_TYPES[UA_TYPES_WRITEREQUEST], &pos, &end, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    src.length = (size_t)(pos - src.data);
+
+    UA_ByteString reencoded;
+    retval = UA_ByteString_allocBuffer(&reencoded, 512);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Arena arena;
+    UA_Arena_init(&arena);
+
+    for(size_t i = 0; i <= src.length; i++) {
+        for(size_t j = i; j <= src.length; j++) {
+            UA_ByteString segments[3] = {{i, src.data}, {j - i, &src.data[i]},
+                                         {src.length - j, &src.data[j]}};
+            // when
+            size_t offset = 0;
+            UA_WriteRequest dst;
+            retval = UA_decodeBinarySegments(segments, 3, &offset, &dst,
+                                             &UA_TYPES[UA_TYPES_WRITEREQUEST],
+                                             NULL, &arena, true);
+            // then
+            ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+            ck_assert_uint_eq(offset, src.length);
+            pos = reencoded.data;
+            end = &reencoded.data[reencoded.length];
+            retval = UA_encodeBinary(&dst, &UA_TYPES[UA_TYPES_WRITEREQUEST],
+                                     &pos, &end, NULL, NULL);
+            ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+            ck_assert_uint_eq((size_t)(pos - reencoded.data), src.length);
+            ck_assert(memcmp(reencoded.data, src.data, src.length) == 0);
+            UA_Arena_reset(&arena);
+
+            // A missing last byte is detected
+            if(j == src.length)
+                continue;
+            segments[2].length--;
+            offset = 0;
+            retval = UA_decodeBinarySegments(segments, 3, &offset, &dst,
+                                             &UA_TYPES[UA_TYPES_WRITEREQUEST],
+                                             NULL, &arena, true);
+            ck_assert_int_ne(retval, UA_STATUSCODE_GOOD);
+            UA_Arena_reset(&arena);
+        }
+    }
+    // finally
+    UA_Arena_clear(&arena);
+    UA_ByteString_clear(&reencoded);
+    UA_ByteString_clear(&src);
+}
+END_TEST
+
 START_TEST(UA_NodeId_decodeTwoByteShallReadTwoBytesAndSetNamespaceToZero) {
     // given
     size_t pos = 0;
@@ -1498,6 +1685,42 @@ START_TEST(UA_ExtensionObject_encodeDecodeShallWorkOnExtensionObject) {
 }
 END_TEST
 
+/* The hashed lookup finds the same type as a linear search */
+START_TEST(UA_findDataType_shallFindFirstMatchingType) {
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        const UA_NodeId *typeId = &UA_TYPES[i].typeId;
+        const UA_DataType *expected = NULL;
+        for(size_t j = 0; j < UA_TYPES_COUNT; j++) {
+            if(UA_NodeId_equal(&UA_TYPES[j].typeId, typeId)) {
+                expected = &UA_TYPES[j];
+                break;
+            }
+        }
+        ck_assert_ptr_eq(UA_findDataType(typeId), expected);
+
+        UA_NodeId encodingId = UA_NODEID_NUMERIC(typeId->namespaceIndex,
+                                                 UA_TYPES[i].binaryEncodingId);
+        for(size_t j = 0; j < UA_TYPES_COUNT; j++) {
+            if(UA_TYPES[j].binaryEncodingId == encodingId.identifier.numeric &&
+               UA_TYPES[j].typeId.namespaceIndex == encodingId.namespaceIndex) {
+                expected = &UA_TYPES[j];
+                break;
+            }
+        }
+        ck_assert_ptr_eq(UA_findDataTypeByBinary(&encodingId), expected);
+    }
+
+    UA_NodeId unknown = UA_NODEID_NUMERIC(0, 4711);
+    ck_assert_ptr_eq(UA_findDataType(&unknown), NULL);
+    ck_assert_ptr_eq(UA_findDataTypeByBinary(&unknown), NULL);
+    unknown = UA_NODEID_NUMERIC(1, UA_TYPES[UA_TYPES_READREQUEST].typeId.identifier.numeric);
+    ck_assert_ptr_eq(UA_findDataType(&unknown), NULL);
+    unknown = UA_NODEID_STRING(0, "ReadRequest");
+    ck_assert_ptr_eq(UA_findDataType(&unknown), NULL);
+    ck_assert_ptr_eq(UA_findDataTypeByBinary(&unknown), NULL);
+}
+END_TEST
+
 static Suite *testSuite_builtin(void) {
     Suite *s = suite_create("Built-in Data Types 62541-6 Table 1");
 
@@ -1521,6 +1744,10 @@ static Suite *testSuite_builtin(void) {
     tcase_add_test(tc_decode, UA_String_decodeShallAllocateMemoryAndCopyString);
     tcase_add_test(tc_decode, UA_String_decodeWithNegativeSizeShallNotAllocateMemoryAndNullPtr);
     tcase_add_test(tc_decode, UA_String_decodeWithZeroSizeShallNotAllocateMemoryAndNullPtr);
+    tcase_add_test(tc_decode, UA_String_decodeZeroCopyShallPointIntoBuffer);
+    tcase_add_test(tc_decode, UA_Int32Array_decodeZeroCopyShallOnlyPointToAlignedMemory);
+    tcase_add_test(tc_decode, UA_ReadRequest_decodeZeroCopyShallNotFreeBorrowedMemoryOnError);
+    tcase_add_test(tc_decode, UA_WriteRequest_decodeSegmentsShallEqualContiguous);
     tcase_add_test(tc_decode, UA_NodeId_decodeTwoByteShallReadTwoBytesAndSetNamespaceToZero);
     tcase_add_test(tc_decode, UA_NodeId_decodeFourByteShallReadFourBytesAndRespectNamespace);
     tcase_add_test(tc_decode, UA_NodeId_decodeStringShallAllocateMemory);
@@ -1550,6 +1777,10 @@ static Suite *testSuite_builtin(void) {
     tcase_add_test(tc_encode, UA_ExtensionObject_encodeDecodeShallWorkOnExtensionObject);
     suite_add_tcase(s, tc_encode);
 
+    TCase *tc_find = tcase_create("find");
+    tcase_add_test(tc_find, UA_findDataType_shallFindFirstMatchingType);
+    suite_add_tcase(s, tc_find);
+
     TCase *tc_convert = tcase_create("convert");
     tcase_add_test(tc_convert, UA_DateTime_toStructShallWorkOnExample);
     tcase_add_test(tc_convert, UA_DateTime_toStructAndBack);
@@ -0,0 +1,367 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* With UA_ENABLE_TYPES_ENCODING_SPECIALIZED, the structures in UA_TYPES are
+ * en-/decoded with generated code. A copy of the type description is not part
+ * of UA_TYPES and takes the generic path. The results of both are compared and
+ * the speed is measured. For the speed, the members of the copied types point
+ * into a copy of the entire UA_TYPES array so that nested structures also take
+ * the generic path. */
+
+#define _XOPEN_SOURCE 500
+#include <open62541/types.h>
+#include <open62541/types_generated_handling.h>
+#include <open62541/nodeids.h>
+
+#include "ua_types_encoding_binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "check.h"
+
+#define RANDOM_ITERATIONS 100 /* Random buffers per type */
+#define RANDOM_BUFSIZE 256
+#define BENCH_ELEMENTS 1000
+#define BENCH_ITERATIONS 200
+#define BENCH_RESPONSES 10
+#define BENCH_RESULTS 100 /* DataValues per response */
+
+/* Mostly zero bytes give short arrays and strings that can be decoded */
+static void
+fillRandom(UA_ByteString *buf) {
+    for(size_t i = 0; i < buf->length; i++)
+        buf->data[i] = (random() % 4 == 0) ? (UA_Byte)random() : 0;
+}
+
+START_TEST(specializedEqualsGeneric) {
+    const UA_DataType *type = &UA_TYPES[_i];
+    if(type->typeKind != UA_DATATYPEKIND_STRUCTURE || type->membersSize == 0)
+        return;
+    UA_DataType generic = *type;
+
+    UA_ByteString buf;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&buf, RANDOM_BUFSIZE);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_ByteString enc1, enc2;
+    res = UA_ByteString_allocBuffer(&enc1, 2 * RANDOM_BUFSIZE);
+    res |= UA_ByteString_allocBuffer(&enc2, 2 * RANDOM_BUFSIZE);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    srandom(42);
+    for(size_t n = 0; n < RANDOM_ITERATIONS; n++) {
+        fillRandom(&buf);
+
+        /* Decode */
+        void *obj1 = UA_new(type);
+        void *obj2 = UA_new(type);
+        size_t offset1 = 0, offset2 = 0;
+        UA_StatusCode res1 = UA_decodeBinary(&buf, &offset1, obj1, type, NULL);
+        UA_StatusCode res2 = UA_decodeBinary(&buf, &offset2, obj2, &generic, NULL);
+        ck_assert_int_eq(res1, res2);
+        if(res1 != UA_STATUSCODE_GOOD) {
+            UA_delete(obj1, type);
+            UA_delete(obj2, type);
+            continue;
+        }
+        ck_assert_uint_eq(offset1, offset2);
+
+        /* Compute the size */
+        size_t size1 = UA_calcSizeBinary(obj1, type);
+        size_t size2 = UA_calcSizeBinary(obj2, &generic);
+        ck_assert_uint_eq(size1, size2);
+
+        /* Encode */
+        UA_Byte *pos1 = enc1.data, *pos2 = enc2.data;
+        const UA_Byte *end1 = &enc1.data[enc1.length];
+        const UA_Byte *end2 = &enc2.data[enc2.length];
+        res1 = UA_encodeBinary(obj1, type, &pos1, &end1, NULL, NULL);
+        res2 = UA_encodeBinary(obj2, &generic, &pos2, &end2, NULL, NULL);
+        ck_assert_int_eq(res1, res2);
+        if(res1 == UA_STATUSCODE_GOOD) {
+            ck_assert_uint_eq((uintptr_t)(pos1 - enc1.data), size1);
+            ck_assert_uint_eq((uintptr_t)(pos2 - enc2.data), size2);
+            ck_assert(memcmp(enc1.data, enc2.data, size1) == 0);
+        }
+
+        UA_delete(obj1, type);
+        UA_delete(obj2, type);
+    }
+
+    UA_ByteString_clear(&buf);
+    UA_ByteString_clear(&enc1);
+    UA_ByteString_clear(&enc2);
+}
+END_TEST
+
+/* The encoding stops at the first member that fails. The remaining members are
+ * not encoded. */
+START_TEST(encodeStopsAtFirstError) {
+    UA_ReadValueId rvid;
+    UA_ReadValueId_init(&rvid);
+    rvid.nodeId = UA_NODEID_STRING(1, "a rather long string identifier");
+    rvid.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_DataType generic = UA_TYPES[UA_TYPES_READVALUEID];
+
+    UA_Byte buf[16];
+    UA_Byte *pos1 = buf, *pos2 = buf;
+    const UA_Byte *end = &buf[sizeof(buf)];
+    UA_StatusCode res1 =
+        UA_encodeBinary(&rvid, &UA_TYPES[UA_TYPES_READVALUEID], &pos1, &end, NULL, NULL);
+    UA_StatusCode res2 = UA_encodeBinary(&rvid, &generic, &pos2, &end, NULL, NULL);
+    ck_assert_int_ne(res1, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(res1, res2);
+    ck_assert_ptr_eq(pos1, pos2);
+}
+END_TEST
+
+/* Copy of UA_TYPES where the members refer to the copy instead of UA_TYPES */
+static UA_DataType *genericTypes;
+
+static void
+setupGenericTypes(void) {
+    genericTypes = (UA_DataType*)malloc(sizeof(UA_DataType) * UA_TYPES_COUNT);
+    ck_assert_ptr_ne(genericTypes, NULL);
+    memcpy(genericTypes, UA_TYPES, sizeof(UA_DataType) * UA_TYPES_COUNT);
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        UA_DataType *type = &genericTypes[i];
+        if(type->membersSize == 0)
+            continue;
+        UA_DataTypeMember *members = (UA_DataTypeMember*)
+            malloc(sizeof(UA_DataTypeMember) * type->membersSize);
+        ck_assert_ptr_ne(members, NULL);
+        memcpy(members, type->members, sizeof(UA_DataTypeMember) * type->membersSize);
+        for(size_t j = 0; j < type->membersSize; j++)
+            members[j].namespaceZero = false;
+        type->members = members;
+    }
+}
+
+static void
+teardownGenericTypes(void) {
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        if(genericTypes[i].membersSize > 0)
+            free((void*)(uintptr_t)genericTypes[i].members);
+    }
+    free(genericTypes);
+    genericTypes = NULL;
+}
+
+/* The elements for the generic path may differ from the elements for the
+ * specialized path in the types of the decoded ExtensionObjects. The decoding
+ * always looks up the types of ExtensionObject contents in UA_TYPES. So they
+ * take the specialized path in both cases. */
+static void
+benchmark(const char *name, size_t typeIndex, size_t count,
+          void *genericElements, void *elements) {
+    const UA_DataType *type = &UA_TYPES[typeIndex];
+    size_t size = 0;
+    for(size_t i = 0; i < count; i++)
+        size += UA_calcSizeBinary((void*)((uintptr_t)elements + i * type->memSize), type);
+    UA_ByteString buf;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&buf, size);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    void *decoded = UA_Array_new(count, type);
+    ck_assert_ptr_ne(decoded, NULL);
+
+    clock_t times[2][2]; /* [generic/specialized][encode/decode] */
+    for(size_t t = 0; t < 2; t++) {
+        const UA_DataType *ty = (t == 0) ? &genericTypes[typeIndex] : type;
+        void *src = (t == 0) ? genericElements : elements;
+
+        clock_t begin = clock();
+        for(size_t n = 0; n < BENCH_ITERATIONS; n++) {
+            UA_Byte *pos = buf.data;
+            const UA_Byte *end = &buf.data[buf.length];
+            for(size_t i = 0; i < count; i++) {
+                res |= UA_encodeBinary((void*)((uintptr_t)src + i * type->memSize),
+                                       ty, &pos, &end, NULL, NULL);
+            }
+        }
+        times[t][0] = clock() - begin;
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+        begin = clock();
+        for(size_t n = 0; n < BENCH_ITERATIONS; n++) {
+            size_t offset = 0;
+            for(size_t i = 0; i < count; i++) {
+                void *dst = (void*)((uintptr_t)decoded + i * type->memSize);
+                UA_clear(dst, type);
+                res |= UA_decodeBinary(&buf, &offset, dst, ty, NULL);
+            }
+            ck_assert_uint_eq(offset, size);
+        }
+        times[t][1] = clock() - begin;
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    printf("%-17s encode: generic %7.2f ms, specialized %7.2f ms (%.2fx); "
+           "decode: generic %7.2f ms, specialized %7.2f ms (%.2fx)\n", name,
+           (double)times[0][0] * 1000 / CLOCKS_PER_SEC,
+           (double)times[1][0] * 1000 / CLOCKS_PER_SEC,
+           (double)times[0][0] / (double)(times[1][0] ? times[1][0] : 1),
+           (double)times[0][1] * 1000 / CLOCKS_PER_SEC,
+           (double)times[1][1] * 1000 / CLOCKS_PER_SEC,
+           (double)times[0][1] / (double)(times[1][1] ? times[1][1] : 1));
+
+    UA_Array_delete(decoded, count, type);
+    UA_ByteString_clear(&buf);
+}
+
+/* A value as it is read from a variable. The scalar types alternate. */
+static void
+fillDataValue(UA_DataValue *dv, UA_UInt32 i) {
+    UA_Double d = (UA_Double)i * 0.5;
+    UA_Int32 n = (UA_Int32)i;
+    UA_Boolean b = (i % 2 == 0);
+    UA_DateTime now = UA_DateTime_now();
+    switch(i % 4) {
+    case 0:
+        UA_Variant_setScalarCopy(&dv->value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+        break;
+    case 1:
+        UA_Variant_setScalarCopy(&dv->value, &n, &UA_TYPES[UA_TYPES_INT32]);
+        break;
+    case 2:
+        UA_Variant_setScalarCopy(&dv->value, &b, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        break;
+    default: {
+        UA_String s = UA_STRING("a string value");
+        UA_Variant_setScalarCopy(&dv->value, &s, &UA_TYPES[UA_TYPES_STRING]);
+        break;
+    }
+    }
+    dv->hasValue = true;
+    dv->sourceTimestamp = now;
+    dv->hasSourceTimestamp = true;
+    dv->serverTimestamp = now;
+    dv->hasServerTimestamp = true;
+}
+
+static void
+fillReadResponse(UA_ReadResponse *rr) {
+    rr->responseHeader.timestamp = UA_DateTime_now();
+    rr->responseHeader.requestHandle = 1;
+    rr->results = (UA_DataValue*)
+        UA_Array_new(BENCH_RESULTS, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    ck_assert_ptr_ne(rr->results, NULL);
+    rr->resultsSize = BENCH_RESULTS;
+    for(UA_UInt32 i = 0; i < BENCH_RESULTS; i++)
+        fillDataValue(&rr->results[i], i);
+}
+
+/* The DataChangeNotification in the ExtensionObject is described by the type
+ * from the given array */
+static void
+fillPublishResponse(UA_PublishResponse *pr, const UA_DataType *types) {
+    pr->responseHeader.timestamp = UA_DateTime_now();
+    pr->responseHeader.requestHandle = 1;
+    pr->subscriptionId = 1;
+    UA_UInt32 seq = 1;
+    UA_StatusCode res = UA_Array_copy(&seq, 1, (void**)&pr->availableSequenceNumbers,
+                                      &UA_TYPES[UA_TYPES_UINT32]);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    pr->availableSequenceNumbersSize = 1;
+    pr->notificationMessage.sequenceNumber = seq;
+    pr->notificationMessage.publishTime = UA_DateTime_now();
+
+    UA_DataChangeNotification *dcn = UA_DataChangeNotification_new();
+    ck_assert_ptr_ne(dcn, NULL);
+    dcn->monitoredItems = (UA_MonitoredItemNotification*)
+        UA_Array_new(BENCH_RESULTS, &UA_TYPES[UA_TYPES_MONITOREDITEMNOTIFICATION]);
+    ck_assert_ptr_ne(dcn->monitoredItems, NULL);
+    dcn->monitoredItemsSize = BENCH_RESULTS;
+    for(UA_UInt32 i = 0; i < BENCH_RESULTS; i++) {
+        dcn->monitoredItems[i].clientHandle = i;
+        fillDataValue(&dcn->monitoredItems[i].value, i);
+    }
+
+    pr->notificationMessage.notificationData = UA_ExtensionObject_new();
+    ck_assert_ptr_ne(pr->notificationMessage.notificationData, NULL);
+    pr->notificationMessage.notificationDataSize = 1;
+    pr->notificationMessage.notificationData->encoding = UA_EXTENSIONOBJECT_DECODED;
+    pr->notificationMessage.notificationData->content.decoded.data = dcn;
+    pr->notificationMessage.notificationData->content.decoded.type =
+        &types[UA_TYPES_DATACHANGENOTIFICATION];
+}
+
+START_TEST(encodingSpeed) {
+    setupGenericTypes();
+
+    UA_ReadValueId *rvids = (UA_ReadValueId*)
+        UA_Array_new(BENCH_ELEMENTS, &UA_TYPES[UA_TYPES_READVALUEID]);
+    UA_WriteValue *wvs = (UA_WriteValue*)
+        UA_Array_new(BENCH_ELEMENTS, &UA_TYPES[UA_TYPES_WRITEVALUE]);
+    UA_BrowseDescription *bds = (UA_BrowseDescription*)
+        UA_Array_new(BENCH_ELEMENTS, &UA_TYPES[UA_TYPES_BROWSEDESCRIPTION]);
+    UA_ReadResponse *rrs = (UA_ReadResponse*)
+        UA_Array_new(BENCH_RESPONSES, &UA_TYPES[UA_TYPES_READRESPONSE]);
+    UA_PublishResponse *prs = (UA_PublishResponse*)
+        UA_Array_new(BENCH_RESPONSES, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
+    UA_PublishResponse *genericPrs = (UA_PublishResponse*)
+        UA_Array_new(BENCH_RESPONSES, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
+    ck_assert(rvids && wvs && bds && rrs && prs && genericPrs);
+
+    for(UA_UInt32 i = 0; i < BENCH_ELEMENTS; i++) {
+        UA_NodeId id = UA_NODEID_NUMERIC(1, 1000 + i);
+        UA_Int32 value = (UA_Int32)i;
+        rvids[i].nodeId = id;
+        rvids[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        wvs[i].nodeId = id;
+        wvs[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        wvs[i].value.hasValue = true;
+        UA_Variant_setScalarCopy(&wvs[i].value.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+        bds[i].nodeId = id;
+        bds[i].browseDirection = UA_BROWSEDIRECTION_FORWARD;
+        bds[i].referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+        bds[i].includeSubtypes = true;
+        bds[i].resultMask = UA_BROWSERESULTMASK_ALL;
+    }
+
+    for(size_t i = 0; i < BENCH_RESPONSES; i++) {
+        fillReadResponse(&rrs[i]);
+        fillPublishResponse(&prs[i], UA_TYPES);
+        fillPublishResponse(&genericPrs[i], genericTypes);
+    }
+
+    benchmark("ReadValueId", UA_TYPES_READVALUEID, BENCH_ELEMENTS, rvids, rvids);
+    benchmark("WriteValue", UA_TYPES_WRITEVALUE, BENCH_ELEMENTS, wvs, wvs);
+    benchmark("BrowseDescription", UA_TYPES_BROWSEDESCRIPTION, BENCH_ELEMENTS, bds, bds);
+    benchmark("ReadResponse", UA_TYPES_READRESPONSE, BENCH_RESPONSES, rrs, rrs);
+    benchmark("PublishResponse", UA_TYPES_PUBLISHRESPONSE, BENCH_RESPONSES,
+              genericPrs, prs);
+
+    UA_Array_delete(rvids, BENCH_ELEMENTS, &UA_TYPES[UA_TYPES_READVALUEID]);
+    UA_Array_delete(wvs, BENCH_ELEMENTS, &UA_TYPES[UA_TYPES_WRITEVALUE]);
+    UA_Array_delete(bds, BENCH_ELEMENTS, &UA_TYPES[UA_TYPES_BROWSEDESCRIPTION]);
+    UA_Array_delete(rrs, BENCH_RESPONSES, &UA_TYPES[UA_TYPES_READRESPONSE]);
+    UA_Array_delete(prs, BENCH_RESPONSES, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
+    UA_Array_delete(genericPrs, BENCH_RESPONSES, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
+
+    teardownGenericTypes();
+}
+END_TEST
+
+static Suite *testSuite_encodingSpecialized(void) {
+    Suite *s = suite_create("Specialized Encoding");
+    TCase *tc_equal = tcase_create("Specialized Equals Generic");
+    tcase_add_loop_test(tc_equal, specializedEqualsGeneric, 0, UA_TYPES_COUNT);
+    tcase_add_test(tc_equal, encodeStopsAtFirstError);
+    suite_add_tcase(s, tc_equal);
+    TCase *tc_speed = tcase_create("Encoding Speed");
+    tcase_add_test(tc_speed, encodingSpeed);
+    suite_add_tcase(s, tc_speed);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_encodingSpecialized();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -195,6 +195,70 @@ START_TEST(Client_read_async_timed) {
         UA_Client_delete(client);
     }END_TEST
 
+#define TIMEOUTCALLS 3
+
+static UA_UInt32 timedOutRequestIds[TIMEOUTCALLS];
+static size_t timedOutRequestIdsSize;
+
+static void
+asyncTimeoutCallback(UA_Client *client, void *userdata,
+                     UA_UInt32 requestId, const UA_ReadResponse *response) {
+    ck_assert_uint_eq(response->responseHeader.serviceResult, UA_STATUSCODE_BADTIMEOUT);
+    ck_assert_uint_lt(timedOutRequestIdsSize, TIMEOUTCALLS);
+    timedOutRequestIds[timedOutRequestIdsSize++] = requestId;
+}
+
+/* The async calls time out in the order of their expiry and not in the order
+ * they were sent */
+START_TEST(Client_read_async_timeoutOrder) {
+        UA_Client *client = UA_Client_new();
+        UA_ClientConfig *clientConfig = UA_Client_getConfig(client);
+        UA_ClientConfig_setDefault(clientConfig);
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+        clientConfig->outStandingPublishRequests = 0;
+#endif
+
+        UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+        UA_Client_recv = client->connection.recv;
+        client->connection.recv = UA_Client_recvTesting;
+
+        UA_ReadRequest rr;
+        UA_ReadRequest_init(&rr);
+        UA_ReadValueId rvid;
+        UA_ReadValueId_init(&rvid);
+        rvid.attributeId = UA_ATTRIBUTEID_VALUE;
+        rvid.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME);
+        rr.nodesToRead = &rvid;
+        rr.nodesToReadSize = 1;
+
+        const UA_UInt32 timeouts[TIMEOUTCALLS] = {300, 100, 200};
+        UA_UInt32 requestIds[TIMEOUTCALLS];
+        for(size_t i = 0; i < TIMEOUTCALLS; i++) {
+            retval = __UA_Client_AsyncServiceEx(client, &rr, &UA_TYPES[UA_TYPES_READREQUEST],
+                    (UA_ClientAsyncServiceCallback) asyncTimeoutCallback,
+                    &UA_TYPES[UA_TYPES_READRESPONSE], NULL, &requestIds[i], timeouts[i]);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        }
+
+        /* Simulate network cable unplugged (no response from server). The
+         * testing result is reset after every receive. */
+        timedOutRequestIdsSize = 0;
+        for(size_t i = 0; i < TIMEOUTCALLS; i++) {
+            UA_Client_recvTesting_result = UA_STATUSCODE_GOODNONCRITICALTIMEOUT;
+            UA_Client_run_iterate(client, (i == 0) ? 150 : 100);
+            ck_assert_uint_eq(timedOutRequestIdsSize, i + 1);
+        }
+        ck_assert_uint_eq(timedOutRequestIds[0], requestIds[1]);
+        ck_assert_uint_eq(timedOutRequestIds[1], requestIds[2]);
+        ck_assert_uint_eq(timedOutRequestIds[2], requestIds[0]);
+        ck_assert_uint_eq(client->asyncServiceCallsSize, 0);
+
+        UA_Client_disconnect(client);
+        UA_Client_delete(client);
+    }END_TEST
+
 static UA_Boolean inactivityCallbackTriggered = false;
 
 static void inactivityCallback(UA_Client *client) {
@@ -250,6 +314,7 @@ static Suite* testSuite_Client(void) {
     tcase_add_checked_fixture(tc_client, setup, teardown);
     tcase_add_test(tc_client, Client_read_async);
     tcase_add_test(tc_client, Client_read_async_timed);
+    tcase_add_test(tc_client, Client_read_async_timeoutOrder);
     tcase_add_test(tc_client, Client_connectivity_check);
     tcase_add_test(tc_client, Client_highlevel_async_readValue);
 
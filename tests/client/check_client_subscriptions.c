@@ -429,6 +429,116 @@ START_TEST(Client_subscription_createDataChanges) {
 }
 END_TEST
 
+#define MANYITEMS 300
+
+static void
+countingDataChangeHandler(UA_Client *client, UA_UInt32 subId, void *subContext,
+                          UA_UInt32 monId, void *monContext, UA_DataValue *value) {
+    (*(UA_UInt32*)monContext)++;
+}
+
+/* Every notification is dispatched to its MonitoredItem by the clientHandle.
+ * The hash index is grown several times while the items are added. */
+START_TEST(Client_subscription_manyMonitoredItems) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Client_recv = client->connection.recv;
+    client->connection.recv = UA_Client_recvTesting;
+
+    UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+    UA_CreateSubscriptionResponse response = UA_Client_Subscriptions_create(client, request,
+                                                                            NULL, NULL, NULL);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_UInt32 subId = response.subscriptionId;
+
+    UA_MonitoredItemCreateRequest items[MANYITEMS];
+    UA_Client_DataChangeNotificationCallback callbacks[MANYITEMS];
+    UA_Client_DeleteMonitoredItemCallback deleteCallbacks[MANYITEMS];
+    void *contexts[MANYITEMS];
+    UA_UInt32 counters[MANYITEMS];
+    UA_UInt32 monIds[MANYITEMS];
+    for(size_t i = 0; i < MANYITEMS; i++) {
+        items[i] = UA_MonitoredItemCreateRequest_default(
+            UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE));
+        callbacks[i] = countingDataChangeHandler;
+        deleteCallbacks[i] = NULL;
+        counters[i] = 0;
+        contexts[i] = &counters[i];
+    }
+
+    UA_CreateMonitoredItemsRequest createRequest;
+    UA_CreateMonitoredItemsRequest_init(&createRequest);
+    createRequest.subscriptionId = subId;
+    createRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    createRequest.itemsToCreate = items;
+    createRequest.itemsToCreateSize = MANYITEMS;
+    UA_CreateMonitoredItemsResponse createResponse =
+       UA_Client_MonitoredItems_createDataChanges(client, createRequest, contexts,
+                                                  callbacks, deleteCallbacks);
+    ck_assert_uint_eq(createResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(createResponse.resultsSize, MANYITEMS);
+    for(size_t i = 0; i < MANYITEMS; i++) {
+        ck_assert_uint_eq(createResponse.results[i].statusCode, UA_STATUSCODE_GOOD);
+        monIds[i] = createResponse.results[i].monitoredItemId;
+    }
+    UA_CreateMonitoredItemsResponse_deleteMembers(&createResponse);
+
+    UA_Client_Subscription *sub = LIST_FIRST(&client->subscriptions);
+    ck_assert_ptr_ne(sub, NULL);
+    ck_assert_uint_eq(sub->monitoredItemsSize, MANYITEMS);
+    ck_assert_uint_ge(sub->monitoredItemBucketsSize, MANYITEMS);
+
+    /* manually control the server thread */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    retval = UA_Client_run_iterate(client, 1);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_fakeSleep((UA_UInt32)publishingInterval + 1);
+    UA_Server_run_iterate(server, true);
+    UA_fakeSleep((UA_UInt32)publishingInterval + 1);
+    retval = UA_Client_run_iterate(client, 1);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < MANYITEMS; i++)
+        ck_assert_uint_eq(counters[i], 1);
+
+    /* run the server in an independent thread again */
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    /* Delete every other MonitoredItem */
+    UA_UInt32 deleteIds[MANYITEMS / 2];
+    for(size_t i = 0; i < MANYITEMS / 2; i++)
+        deleteIds[i] = monIds[2 * i];
+    UA_DeleteMonitoredItemsRequest deleteRequest;
+    UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionId = subId;
+    deleteRequest.monitoredItemIds = deleteIds;
+    deleteRequest.monitoredItemIdsSize = MANYITEMS / 2;
+    UA_DeleteMonitoredItemsResponse deleteResponse =
+        UA_Client_MonitoredItems_delete(client, deleteRequest);
+    ck_assert_uint_eq(deleteResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_DeleteMonitoredItemsResponse_deleteMembers(&deleteResponse);
+    ck_assert_uint_eq(sub->monitoredItemsSize, MANYITEMS / 2);
+
+    UA_Client_MonitoredItem *mon;
+    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
+        size_t index = (size_t)((UA_UInt32*)mon->context - counters);
+        ck_assert_uint_eq(index % 2, 1);
+    }
+
+    retval = UA_Client_Subscriptions_deleteSingle(client, subId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
 START_TEST(Client_subscription_createDataChanges_async) {
     UA_UInt32 reqId = 0;
     UA_Client *client = UA_Client_new();
@@ -939,6 +1049,7 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_client, Client_subscription_connectionClose);
     tcase_add_test(tc_client, Client_subscription_createDataChanges);
     tcase_add_test(tc_client, Client_subscription_createDataChanges_async);
+    tcase_add_test(tc_client, Client_subscription_manyMonitoredItems);
     tcase_add_test(tc_client, Client_subscription_keepAlive);
     tcase_add_test(tc_client, Client_subscription_without_notification);
     tcase_add_test(tc_client, Client_subscription_async_sub);
@@ -118,11 +118,12 @@ UA_debug_dumpSetServiceName(const UA_ByteString *msg, char serviceNameTarget[100
 static void
 UA_debug_dump_setName(void *application, UA_SecureChannel *channel,
                       UA_MessageType messagetype, UA_UInt32 requestId,
-                      UA_ByteString *message) {
+                      UA_ByteString *segments, size_t segmentsSize) {
     struct UA_dump_filename *dump_filename = (struct UA_dump_filename *)application;
     dump_filename->messageType = UA_debug_dumpGetMessageTypePrefix(messagetype);
+    /* The service type is encoded at the start of the first segment */
     if(messagetype == UA_MESSAGETYPE_MSG)
-        UA_debug_dumpSetServiceName(message, dump_filename->serviceName);
+        UA_debug_dumpSetServiceName(&segments[0], dump_filename->serviceName);
 }
 
 /**
@@ -0,0 +1,266 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Concurrent reads and writes on the sharded Nodestore. First through the
+ * server API with worker threads and clients. Then directly on the Nodestore,
+ * where the lock-free readers are compared with the HashMap Nodestore behind a
+ * global mutex (as the server uses it). */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/nodestore_default.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <check.h>
+#include <pthread.h>
+#include <stdio.h>
+#include "thread_wrapper.h"
+#include "mt_testing.h"
+
+#define NUMBER_OF_WORKERS 10
+#define ITERATIONS_PER_WORKER 10
+#define NUMBER_OF_CLIENTS 10
+#define ITERATIONS_PER_CLIENT 10
+
+#define NODES 100000 /* Nodes in the benchmark nodestore */
+#define READS_PER_THREAD 200000
+
+UA_NodeId pumpTypeId = {1, UA_NODEIDTYPE_NUMERIC, {1001}};
+
+/**********************/
+/* Server API Threads */
+/**********************/
+
+static
+void addVariableNode(void) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&attr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    attr.description = UA_LOCALIZEDTEXT("en-US","Temperature");
+    attr.displayName = UA_LOCALIZEDTEXT("en-US","Temperature");
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_QualifiedName myIntegerName = UA_QUALIFIEDNAME(1, "Temperature");
+    UA_NodeId parentNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    UA_NodeId parentReferenceNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+    UA_StatusCode res =
+            UA_Server_addVariableNode(tc.server, pumpTypeId, parentNodeId,
+                                      parentReferenceNodeId, myIntegerName,
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                      attr, NULL, NULL);
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, res);
+}
+
+static void setup(void) {
+    tc.running = true;
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_;
+    UA_Nodestore_Sharded(&config.nodestore);
+    tc.server = UA_Server_newWithConfig(&config);
+    UA_ServerConfig_setDefault(UA_Server_getConfig(tc.server));
+    addVariableNode();
+    UA_Server_run_startup(tc.server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void
+checkServer(void) {
+    UA_Variant var;
+    UA_Variant_init(&var);
+    UA_StatusCode ret = UA_Server_readValue(tc.server, pumpTypeId, &var);
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, ret);
+    ck_assert_int_eq(42, *(UA_Int32 *)var.data);
+    UA_Variant_clear(&var);
+}
+
+static
+void server_readWriteValueAttribute(void *value) {
+    ThreadContext tmp = (*(ThreadContext *) value);
+    if(tmp.index % 2 == 0) {
+        UA_Variant var;
+        UA_Variant_init(&var);
+        UA_StatusCode ret = UA_Server_readValue(tc.server, pumpTypeId, &var);
+        ck_assert_int_eq(UA_STATUSCODE_GOOD, ret);
+        ck_assert_int_eq(42, *(UA_Int32 *)var.data);
+        UA_Variant_clear(&var);
+    } else {
+        UA_Int32 myInteger = 42;
+        UA_Variant var;
+        UA_Variant_setScalar(&var, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+        UA_StatusCode ret = UA_Server_writeValue(tc.server, pumpTypeId, var);
+        ck_assert_int_eq(UA_STATUSCODE_GOOD, ret);
+    }
+}
+
+static
+void client_readValueAttribute(void *value) {
+    ThreadContext tmp = (*(ThreadContext *) value);
+    UA_Variant val;
+    UA_NodeId nodeId = pumpTypeId;
+    UA_StatusCode retval = UA_Client_readValueAttribute(tc.clients[tmp.index], nodeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(42, *(UA_Int32 *)val.data);
+    UA_Variant_deleteMembers(&val);
+}
+
+static
+void initTest(void) {
+    initThreadContext(NUMBER_OF_WORKERS, NUMBER_OF_CLIENTS, checkServer);
+
+    for (size_t i = 0; i < tc.numberOfWorkers; i++) {
+        setThreadContext(&tc.workerContext[i], i, ITERATIONS_PER_WORKER,
+                         server_readWriteValueAttribute);
+    }
+
+    for (size_t i = 0; i < tc.numberofClients; i++) {
+        setThreadContext(&tc.clientContext[i], i, ITERATIONS_PER_CLIENT,
+                         client_readValueAttribute);
+    }
+}
+
+START_TEST(readWriteValueAttribute) {
+        startMultithreading();
+    }
+END_TEST
+
+/************************/
+/* Nodestore Benchmark */
+/************************/
+
+static UA_Nodestore ns;
+static UA_Boolean useMutex;
+static pthread_mutex_t nsMutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile UA_Boolean readersRunning;
+static volatile size_t readErrors;
+
+static void
+fillNodestore(void) {
+    for(UA_UInt32 i = 0; i < NODES; i++) {
+        UA_Node *n = ns.newNode(ns.context, UA_NODECLASS_VARIABLE);
+        ck_assert_ptr_ne(n, NULL);
+        n->nodeId = UA_NODEID_NUMERIC(1, i + 1);
+        ck_assert_int_eq(ns.insertNode(ns.context, n, NULL), UA_STATUSCODE_GOOD);
+    }
+}
+
+static void *
+readerThread(void *arg) {
+    UA_UInt32 rnd = (UA_UInt32)(uintptr_t)arg;
+    UA_NodeId id = UA_NODEID_NUMERIC(1, 0);
+    for(size_t i = 0; i < READS_PER_THREAD; i++) {
+        rnd = rnd * 1103515245 + 12345; /* Linear congruential generator */
+        id.identifier.numeric = ((rnd >> 8) % NODES) + 1;
+        if(useMutex)
+            pthread_mutex_lock(&nsMutex);
+        const UA_Node *node = ns.getNode(ns.context, &id);
+        if(!node || !UA_NodeId_equal(&node->nodeId, &id))
+            UA_atomic_addSize(&readErrors, 1);
+        ns.releaseNode(ns.context, node);
+        if(useMutex)
+            pthread_mutex_unlock(&nsMutex);
+    }
+    return NULL;
+}
+
+/* Replace random nodes with an edited copy until the readers are done */
+static void *
+writerThread(void *arg) {
+    size_t *writes = (size_t*)arg;
+    UA_UInt32 rnd = 4711;
+    UA_NodeId id = UA_NODEID_NUMERIC(1, 0);
+    while(readersRunning) {
+        rnd = rnd * 1103515245 + 12345;
+        id.identifier.numeric = ((rnd >> 8) % NODES) + 1;
+        if(useMutex)
+            pthread_mutex_lock(&nsMutex);
+        UA_Node *copy = NULL;
+        UA_StatusCode res = ns.getNodeCopy(ns.context, &id, &copy);
+        if(res == UA_STATUSCODE_GOOD) {
+            ((UA_VariableNode*)copy)->minimumSamplingInterval += 1.0;
+            res = ns.replaceNode(ns.context, copy);
+        }
+        if(useMutex)
+            pthread_mutex_unlock(&nsMutex);
+        if(res != UA_STATUSCODE_GOOD)
+            UA_atomic_addSize(&readErrors, 1);
+        (*writes)++;
+    }
+    return NULL;
+}
+
+/* Returns the reads per second */
+static double
+measure(size_t readers, size_t *writes) {
+    pthread_t writer;
+    pthread_t *threads = (pthread_t*)UA_malloc(sizeof(pthread_t) * readers);
+    ck_assert_ptr_ne(threads, NULL);
+    readErrors = 0;
+    readersRunning = true;
+    *writes = 0;
+
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    pthread_create(&writer, NULL, writerThread, writes);
+    for(size_t i = 0; i < readers; i++)
+        pthread_create(&threads[i], NULL, readerThread, (void*)(uintptr_t)(i + 1));
+    for(size_t i = 0; i < readers; i++)
+        pthread_join(threads[i], NULL);
+    UA_DateTime finish = UA_DateTime_nowMonotonic();
+    readersRunning = false;
+    pthread_join(writer, NULL);
+    UA_free(threads);
+
+    ck_assert_uint_eq(readErrors, 0);
+    double seconds = (double)(finish - begin) / UA_DATETIME_SEC;
+    *writes = (size_t)((double)*writes / seconds);
+    return (double)(readers * READS_PER_THREAD) / seconds;
+}
+
+static const size_t readerCounts[] = {1, 2, 4, 8};
+
+START_TEST(readWriteScaling) {
+    for(size_t i = 0; i < sizeof(readerCounts) / sizeof(size_t); i++) {
+        size_t n = readerCounts[i];
+        size_t hashMapWrites, shardedWrites;
+
+        UA_Nodestore_HashMap(&ns);
+        useMutex = true;
+        fillNodestore();
+        double hashMapReads = measure(n, &hashMapWrites);
+        ns.clear(ns.context);
+
+        UA_Nodestore_Sharded(&ns);
+        useMutex = false;
+        fillNodestore();
+        double shardedReads = measure(n, &shardedWrites);
+        ns.clear(ns.context);
+
+        printf("%lu readers + 1 writer: hashmap (locked) %10.0f reads/s "
+               "%8lu writes/s, sharded %10.0f reads/s %8lu writes/s\n",
+               (unsigned long)n, hashMapReads, (unsigned long)hashMapWrites,
+               shardedReads, (unsigned long)shardedWrites);
+    }
+}
+END_TEST
+
+static Suite* testSuite_shardedNodestore(void) {
+    Suite *s = suite_create("Multithreading");
+    TCase *tc_server = tcase_create("Read Write attribute");
+    initTest();
+    tcase_add_checked_fixture(tc_server, setup, teardown);
+    tcase_add_test(tc_server, readWriteValueAttribute);
+    suite_add_tcase(s, tc_server);
+    TCase *tc_bench = tcase_create("Sharded Nodestore Scaling");
+    tcase_add_test(tc_bench, readWriteScaling);
+    suite_add_tcase(s, tc_bench);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_shardedNodestore();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
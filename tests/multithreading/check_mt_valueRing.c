@@ -0,0 +1,142 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* A producer thread hands values to the server at a high rate, either pushing
+ * into a value ring or writing the value attribute. The server thread reads
+ * the variable concurrently. The values must arrive complete and in order. */
+
+#include <open62541/server_config_default.h>
+#include <check.h>
+#include <stdio.h>
+#include "thread_wrapper.h"
+
+#define VALUES 200000
+
+UA_Server *server;
+UA_ValueRing *ring;
+UA_NodeId ringNodeId = {1, UA_NODEIDTYPE_NUMERIC, {1001}};
+static volatile UA_Boolean producing;
+static UA_Boolean useRing;
+static UA_DateTime produceTime;
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+    UA_Server_getConfig(server)->logger.log = NULL;
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_UInt64 value = 0;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_UINT64]);
+    attr.dataType = UA_TYPES[UA_TYPES_UINT64].typeId;
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, ringNodeId, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Acquired Value"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    retval = UA_ValueRing_new(&UA_TYPES[UA_TYPES_UINT64], 1024, &ring);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_startup(server);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    UA_ValueRing_delete(ring);
+}
+
+THREAD_CALLBACK(producer) {
+    UA_Variant v;
+    UA_UInt64 value;
+    UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_UINT64]);
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    for(value = 1; value <= VALUES; value++) {
+        UA_StatusCode retval;
+        if(useRing)
+            retval = UA_ValueRing_push(ring, &v, 0);
+        else
+            retval = UA_Server_writeValue(server, ringNodeId, v);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    produceTime = UA_DateTime_nowMonotonic() - begin;
+    producing = false;
+    return 0;
+}
+
+static UA_UInt64
+readValue(void) {
+    UA_Variant v;
+    UA_StatusCode retval = UA_Server_readValue(server, ringNodeId, &v);
+    if(retval == UA_STATUSCODE_BADWAITINGFORINITIALDATA)
+        return 0;
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_UInt64 value = *(UA_UInt64*)v.data;
+    UA_Variant_clear(&v);
+    return value;
+}
+
+static const char *modeNames[] = {"writeValue", "value ring"};
+
+START_TEST(ProduceAndRead) {
+    useRing = (_i == 1);
+    if(useRing) {
+        UA_StatusCode retval = UA_Server_setVariableNode_valueRing(server, ringNodeId, ring);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    producing = true;
+    THREAD_HANDLE producerThread;
+    THREAD_CREATE(producerThread, producer);
+
+    /* Read concurrently. The values only increase. A consumer of the ring
+     * takes every value that was not overwritten. */
+    size_t reads = 0, taken = 0, position = 0;
+    UA_UInt64 last = 0, lastTaken = 0;
+    UA_DataValue values[64];
+    while(producing) {
+        UA_UInt64 value = readValue();
+        ck_assert_uint_ge(value, last);
+        last = value;
+        reads++;
+        if(!useRing)
+            continue;
+        size_t count = UA_ValueRing_getValues(ring, &position, values, 64);
+        for(size_t i = 0; i < count; i++) {
+            UA_UInt64 v = *(UA_UInt64*)values[i].value.data;
+            ck_assert_uint_gt(v, lastTaken);
+            lastTaken = v;
+            UA_DataValue_clear(&values[i]);
+        }
+        taken += count;
+    }
+    THREAD_JOIN(producerThread);
+    ck_assert_uint_eq(readValue(), VALUES);
+
+    printf("%-10s: %.0f values/s produced, %lu concurrent reads",
+           modeNames[_i], (double)VALUES * UA_DATETIME_SEC / (double)produceTime,
+           (unsigned long)reads);
+    if(useRing)
+        printf(", %lu values taken in order", (unsigned long)taken);
+    printf("\n");
+
+    UA_Server_deleteNode(server, ringNodeId, true);
+} END_TEST
+
+int main(void) {
+    TCase *tc = tcase_create("Value ring");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_loop_test(tc, ProduceAndRead, 0, sizeof(modeNames) / sizeof(char*));
+
+    Suite *s = suite_create("Multithreading value ring");
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,151 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Throughput of the worker threads in callbacks/sec depending on the number of
+ * workers */
+
+#include <open62541/types.h>
+
+#include "ua_workqueue.h"
+
+#include <check.h>
+#include <sched.h>
+#include <stdio.h>
+
+#define CALLBACKS 200000 /* Number of callbacks per measurement */
+#define DELAYED 1000 /* Number of delayed callbacks */
+#define WORK_SPIN 100 /* Simulated work in every callback */
+
+static const size_t workerCounts[] = {1, 2, 4, 8, 16};
+
+static volatile size_t executed;
+static volatile size_t delayedExecuted;
+static volatile size_t delayedTooEarly;
+
+static void
+workCallback(void *application, void *data) {
+    volatile size_t x = 0;
+    for(size_t i = 0; i < WORK_SPIN; i++)
+        x += i;
+    UA_atomic_addSize(&executed, 1);
+}
+
+/* The data pointer is the number of callbacks that were enqueued before the
+ * delayed callback. They have to be finished. */
+static void
+delayedCallback(void *application, void *data) {
+    if(executed < (size_t)(uintptr_t)data)
+        UA_atomic_addSize(&delayedTooEarly, 1);
+    UA_atomic_addSize(&delayedExecuted, 1);
+}
+
+static void
+waitExecuted(size_t count) {
+    while(executed < count)
+        sched_yield();
+}
+
+static double
+measure(size_t workers) {
+    UA_WorkQueue wq;
+    memset(&wq, 0, sizeof(UA_WorkQueue));
+    UA_WorkQueue_init(&wq);
+    ck_assert_uint_eq(UA_WorkQueue_start(&wq, workers), UA_STATUSCODE_GOOD);
+    executed = 0;
+
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    for(size_t i = 0; i < CALLBACKS; i++)
+        UA_WorkQueue_enqueue(&wq, workCallback, NULL, NULL);
+    waitExecuted(CALLBACKS);
+    UA_DateTime finish = UA_DateTime_nowMonotonic();
+
+    UA_WorkQueue_cleanup(&wq);
+    ck_assert_uint_eq(executed, CALLBACKS);
+    return (double)CALLBACKS / ((double)(finish - begin) / UA_DATETIME_SEC);
+}
+
+START_TEST(executeAll) {
+    UA_WorkQueue wq;
+    memset(&wq, 0, sizeof(UA_WorkQueue));
+    UA_WorkQueue_init(&wq);
+    ck_assert_uint_eq(UA_WorkQueue_start(&wq, 4), UA_STATUSCODE_GOOD);
+    executed = 0;
+
+    /* More than fits into the deques. The remainder goes to the shared
+     * queue. */
+    size_t count = 4 * UA_WORKQUEUE_DEQUESIZE * 4;
+    for(size_t i = 0; i < count; i++)
+        UA_WorkQueue_enqueue(&wq, workCallback, NULL, NULL);
+    waitExecuted(count);
+
+    /* The statistics are updated after the callback returns */
+    size_t exec = 0, stolen = 0;
+    while(exec < count) {
+        sched_yield();
+        UA_WorkQueue_getStatistics(&wq, &exec, &stolen);
+    }
+    ck_assert_uint_eq(exec, count);
+
+    UA_WorkQueue_cleanup(&wq);
+    ck_assert_uint_eq(executed, count);
+}
+END_TEST
+
+START_TEST(delayedAfterPriorWork) {
+    UA_WorkQueue wq;
+    memset(&wq, 0, sizeof(UA_WorkQueue));
+    UA_WorkQueue_init(&wq);
+    ck_assert_uint_eq(UA_WorkQueue_start(&wq, 4), UA_STATUSCODE_GOOD);
+    executed = 0;
+    delayedExecuted = 0;
+    delayedTooEarly = 0;
+
+    for(size_t i = 0; i < DELAYED; i++) {
+        for(size_t j = 0; j < 10; j++)
+            UA_WorkQueue_enqueue(&wq, workCallback, NULL, NULL);
+        UA_DelayedCallback *dc = (UA_DelayedCallback*)
+            UA_malloc(sizeof(UA_DelayedCallback));
+        ck_assert_ptr_ne(dc, NULL);
+        dc->callback = delayedCallback;
+        dc->application = NULL;
+        dc->data = (void*)(uintptr_t)((i + 1) * 10);
+        UA_WorkQueue_enqueueDelayed(&wq, dc);
+    }
+
+    /* Executes the remaining delayed callbacks */
+    UA_WorkQueue_cleanup(&wq);
+    ck_assert_uint_eq(executed, DELAYED * 10);
+    ck_assert_uint_eq(delayedExecuted, DELAYED);
+    ck_assert_uint_eq(delayedTooEarly, 0);
+}
+END_TEST
+
+START_TEST(callbacksPerSecond) {
+    for(size_t i = 0; i < sizeof(workerCounts) / sizeof(size_t); i++) {
+        size_t n = workerCounts[i];
+        printf("%2lu workers: %10.0f callbacks/s\n",
+               (unsigned long)n, measure(n));
+    }
+}
+END_TEST
+
+static Suite* testSuite_workQueue(void) {
+    Suite *s = suite_create("WorkQueue");
+    TCase *tc_wq = tcase_create("Work Stealing");
+    tcase_add_test(tc_wq, executeAll);
+    tcase_add_test(tc_wq, delayedAfterPriorWork);
+    tcase_add_test(tc_wq, callbacksPerSecond);
+    suite_add_tcase(s,tc_wq);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_workQueue();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
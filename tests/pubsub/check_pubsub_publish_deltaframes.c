@@ -0,0 +1,253 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Cost of the delta frame generation for a large PublishedDataSet depending on
+ * the share of variables written between two publish cycles. The writes to the
+ * published variables are tracked. For comparison, the same DataSetFields are
+ * added before the variables exist. Then they cannot be tracked and all
+ * variables are sampled for every delta frame. */
+
+#include <open62541/plugin/pubsub_udp.h>
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "ua_server_internal.h"
+#include "ua_pubsub_networkmessage.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+
+#define FIELDS 10000
+#define CYCLES 20
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdent, publishedDataSetIdent, writerGroupIdent;
+UA_WriterGroup *writerGroup = NULL;
+UA_ByteString lastMessage = {0, NULL};
+
+static UA_StatusCode
+keepMessage(UA_PubSubChannel *channel, UA_ExtensionObject *transportSettings,
+            const UA_ByteString *buf) {
+    UA_ByteString_clear(&lastMessage);
+    return UA_ByteString_copy(buf, &lastMessage);
+}
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+    config->logger.log = NULL;
+
+    config->pubsubTransportLayers = (UA_PubSubTransportLayer*)
+        UA_malloc(sizeof(UA_PubSubTransportLayer));
+    config->pubsubTransportLayers[0] = UA_PubSubTransportLayerUDPMP();
+    config->pubsubTransportLayersSize++;
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4801/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_StatusCode retval =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The messages are not sent but kept for decoding */
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, connectionIdent);
+    ck_assert_ptr_ne(connection, NULL);
+    connection->channel->send = keepMessage;
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    retval = UA_Server_addWriterGroup(server, connectionIdent,
+                                      &writerGroupConfig, &writerGroupIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    writerGroup = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet");
+    retval = UA_Server_addPublishedDataSet(server, &pdsConfig,
+                                           &publishedDataSetIdent).addResult;
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Server_run_startup(server);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    UA_ByteString_clear(&lastMessage);
+}
+
+static void
+addVariables(void) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_UInt32 value = 0;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    for(UA_UInt32 i = 0; i < FIELDS; i++) {
+        UA_StatusCode retval =
+            UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 50000 + i),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, "Variable"),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                      attr, NULL, NULL);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+}
+
+static void
+addFields(void) {
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    for(UA_UInt32 i = 0; i < FIELDS; i++) {
+        dsfConfig.field.variable.publishParameters.publishedVariable =
+            UA_NODEID_NUMERIC(1, 50000 + i);
+        UA_StatusCode retval =
+            UA_Server_addDataSetField(server, publishedDataSetIdent, &dsfConfig, NULL).result;
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+}
+
+/* The last message is a delta frame with the expected number of fields */
+static void
+checkDeltaFrame(size_t changed) {
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    size_t offset = 0;
+    UA_StatusCode retval = UA_NetworkMessage_decodeBinary(&lastMessage, &offset, &nm);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_DataSetMessage *dsm = nm.payload.dataSetPayload.dataSetMessages;
+    ck_assert_int_eq(dsm->header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    ck_assert_uint_eq(dsm->data.deltaFrameData.fieldCount, changed);
+    UA_NetworkMessage_clear(&nm);
+}
+
+static const UA_UInt32 changeRates[] = {0, 1, 10, 50, 100}; /* percent */
+static const char *modeNames[] = {"tracked", "sample all"};
+
+START_TEST(DeltaFrameSpeed) {
+    UA_Boolean tracked = (_i == 0);
+    if(tracked) {
+        addVariables();
+        addFields();
+    } else {
+        addFields();
+        addVariables();
+    }
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 1;
+    dataSetWriterConfig.keyFrameCount = 60000;
+    UA_StatusCode retval =
+        UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                   &dataSetWriterConfig, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The first message is a key frame */
+    UA_WriterGroup_publishCallback(server, writerGroup);
+
+    UA_UInt32 value = 0;
+    for(size_t r = 0; r < sizeof(changeRates) / sizeof(UA_UInt32); r++) {
+        size_t changed = (FIELDS * changeRates[r]) / 100;
+        clock_t publishTime = 0;
+        for(size_t c = 0; c < CYCLES; c++) {
+            /* Write different variables in every cycle */
+            value++;
+            UA_Variant v;
+            UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_UINT32]);
+            for(size_t i = 0; i < changed; i++) {
+                UA_UInt32 index = (UA_UInt32)((i * FIELDS / changed + c) % FIELDS);
+                retval = UA_Server_writeValue(server, UA_NODEID_NUMERIC(1, 50000 + index), v);
+                ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+            }
+
+            clock_t begin = clock();
+            UA_WriterGroup_publishCallback(server, writerGroup);
+            publishTime += clock() - begin;
+        }
+        checkDeltaFrame(changed);
+        printf("%-10s %3u%% changed: %8.1f us per publish\n", modeNames[_i],
+               (unsigned)changeRates[r],
+               ((double)publishTime * 1000000.0 / CLOCKS_PER_SEC) / CYCLES);
+    }
+}
+END_TEST
+
+static UA_UInt32 dataSourceValue = 0;
+
+static UA_StatusCode
+readDataSource(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+               const UA_NodeId *nodeId, void *nodeContext, UA_Boolean includeSourceTimeStamp,
+               const UA_NumericRange *range, UA_DataValue *value) {
+    dataSourceValue++;
+    UA_Variant_setScalarCopy(&value->value, &dataSourceValue, &UA_TYPES[UA_TYPES_UINT32]);
+    value->hasValue = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+START_TEST(DeltaFrameDataSource) {
+    addVariables();
+    addFields();
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 1;
+    dataSetWriterConfig.keyFrameCount = 60000;
+    UA_StatusCode retval =
+        UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                   &dataSetWriterConfig, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_WriterGroup_publishCallback(server, writerGroup);
+    UA_WriterGroup_publishCallback(server, writerGroup);
+    checkDeltaFrame(0);
+
+    /* The tracked variable gets a data source. It is sampled from then on. */
+    UA_DataSource dataSource;
+    dataSource.read = readDataSource;
+    dataSource.write = NULL;
+    retval = UA_Server_setVariableNode_dataSource(server, UA_NODEID_NUMERIC(1, 50000),
+                                                  dataSource);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t c = 0; c < 3; c++) {
+        UA_WriterGroup_publishCallback(server, writerGroup);
+        checkDeltaFrame(1);
+    }
+}
+END_TEST
+
+int main(void) {
+    TCase *tc_delta = tcase_create("Delta frame speed");
+    tcase_add_checked_fixture(tc_delta, setup, teardown);
+    tcase_add_loop_test(tc_delta, DeltaFrameSpeed, 0,
+                        sizeof(modeNames) / sizeof(char*));
+    tcase_add_test(tc_delta, DeltaFrameDataSource);
+
+    Suite *s = suite_create("PubSub delta frames");
+    suite_add_tcase(s, tc_delta);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,249 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Jitter of the publish cycle of a frozen RT WriterGroup while a client keeps
+ * the server busy with read requests. The WriterGroup is driven either by the
+ * timer of the server main loop or by a dedicated thread. The send time of
+ * every NetworkMessage is recorded and the deviation of the measured cycle
+ * from the publishing interval is put into a histogram. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/plugin/pubsub_udp.h>
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "thread_wrapper.h"
+
+#define CYCLES 2000
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdent, publishedDataSetIdent, writerGroupIdent;
+UA_PubSubChannel *channel = NULL;
+
+static UA_StatusCode
+(*channelSend)(UA_PubSubChannel *channel, UA_ExtensionObject *transportSettings,
+               const UA_ByteString *buf);
+static UA_Int64 sendTimes[CYCLES];
+static volatile size_t sendCount;
+
+static UA_Int64
+monotonicNsec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((UA_Int64)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+static UA_StatusCode
+recordSend(UA_PubSubChannel *ch, UA_ExtensionObject *transportSettings,
+           const UA_ByteString *buf) {
+    if(sendCount < CYCLES) {
+        sendTimes[sendCount] = monotonicNsec();
+        sendCount++;
+    }
+    return channelSend(ch, transportSettings, buf);
+}
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+
+    config->pubsubTransportLayers = (UA_PubSubTransportLayer*)
+        UA_malloc(sizeof(UA_PubSubTransportLayer));
+    config->pubsubTransportLayers[0] = UA_PubSubTransportLayerUDPMP();
+    config->pubsubTransportLayersSize++;
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4801/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_StatusCode retval =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet");
+    retval = UA_Server_addPublishedDataSet(server, &pdsConfig,
+                                           &publishedDataSetIdent).addResult;
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.field.variable.staticValueSourceEnabled = true;
+    UA_UInt32 *fieldValue = UA_UInt32_new(); /* Moved into the field */
+    *fieldValue = 1000;
+    UA_Variant_setScalar(&dsfConfig.field.variable.staticValueSource.value,
+                         fieldValue, &UA_TYPES[UA_TYPES_UINT32]);
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    retval = UA_Server_addDataSetField(server, publishedDataSetIdent,
+                                       &dsfConfig, NULL).result;
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, connectionIdent);
+    ck_assert_ptr_ne(connection, NULL);
+    channel = connection->channel;
+    channelSend = channel->send;
+    channel->send = recordSend;
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+/* Client load */
+
+static UA_Boolean clientRunning;
+static volatile UA_Boolean clientDone;
+static size_t clientReads;
+
+THREAD_CALLBACK(clientLoop) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    UA_NodeId statusId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS);
+    while(retval == UA_STATUSCODE_GOOD && clientRunning) {
+        UA_Variant value;
+        retval = UA_Client_readValueAttribute(client, statusId, &value);
+        UA_Variant_clear(&value);
+        clientReads++;
+    }
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+    clientDone = true;
+    return 0;
+}
+
+/* Histogram of the deviation from the publishing interval */
+
+static const UA_Int64 bucketLimits[] = {10, 50, 100, 250, 500, 1000}; /* usec */
+#define BUCKETS (sizeof(bucketLimits) / sizeof(UA_Int64) + 1)
+
+static void
+printJitter(const char *mode, UA_Int64 interval) {
+    size_t histogram[BUCKETS];
+    memset(histogram, 0, sizeof(histogram));
+    UA_Int64 max = 0, sum = 0;
+    for(size_t i = 1; i < CYCLES; i++) {
+        UA_Int64 jitter = (sendTimes[i] - sendTimes[i-1]) - interval;
+        if(jitter < 0)
+            jitter = -jitter;
+        jitter /= 1000;
+        if(jitter > max)
+            max = jitter;
+        sum += jitter;
+        size_t b = 0;
+        while(b < BUCKETS - 1 && jitter >= bucketLimits[b])
+            b++;
+        histogram[b]++;
+    }
+
+    printf("%4ldus %-12s mean %5.1fus max %6ldus |", (long)(interval / 1000), mode,
+           (double)sum / (CYCLES - 1), (long)max);
+    for(size_t b = 0; b < BUCKETS - 1; b++)
+        printf(" <%ldus: %4lu", (long)bucketLimits[b], (unsigned long)histogram[b]);
+    printf(" more: %4lu (%lu client reads)\n", (unsigned long)histogram[BUCKETS - 1],
+           (unsigned long)clientReads);
+}
+
+static const UA_Double publishingIntervals[] = {1.0, 0.25};
+
+START_TEST(PublishJitter) {
+    UA_Double publishingInterval = publishingIntervals[_i / 2];
+    UA_Boolean dedicatedThread = (_i % 2 == 1);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup");
+    writerGroupConfig.publishingInterval = publishingInterval;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    writerGroupConfig.dedicatedThread = dedicatedThread;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    UA_StatusCode retval =
+        UA_Server_addWriterGroup(server, connectionIdent, &writerGroupConfig, &writerGroupIdent);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 62541;
+    retval = UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                        &dataSetWriterConfig, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Start the client load */
+    clientRunning = true;
+    clientDone = false;
+    clientReads = 0;
+    THREAD_HANDLE clientThread;
+    THREAD_CREATE(clientThread, clientLoop);
+    for(size_t i = 0; i < 100; i++)
+        UA_Server_run_iterate(server, false);
+
+    /* Publish until all cycles are recorded */
+    sendCount = 0;
+    retval = UA_Server_setWriterGroupOperational(server, writerGroupIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    while(sendCount < CYCLES)
+        UA_Server_run_iterate(server, true);
+    retval = UA_Server_setWriterGroupDisabled(server, writerGroupIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop the client load */
+    clientRunning = false;
+    while(!clientDone)
+        UA_Server_run_iterate(server, true);
+    THREAD_JOIN(clientThread);
+
+    printJitter(dedicatedThread ? "thread" : "main loop",
+                (UA_Int64)(publishingInterval * 1000000.0));
+    ck_assert_uint_gt(clientReads, 0);
+    ck_assert_uint_eq(sendCount, CYCLES);
+}
+END_TEST
+
+int main(void) {
+    TCase *tc_jitter = tcase_create("PubSub publish jitter");
+    tcase_add_checked_fixture(tc_jitter, setup, teardown);
+    tcase_add_loop_test(tc_jitter, PublishJitter, 0,
+                        2 * sizeof(publishingIntervals) / sizeof(UA_Double));
+
+    Suite *s = suite_create("PubSub publish jitter");
+    suite_add_tcase(s, tc_jitter);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -344,6 +344,80 @@ START_TEST(AddMultipleDataSetReaderWithValidConfiguration) {
         ck_assert_int_eq(readerGroupIdent2->readersCount, 2);
     } END_TEST
 
+/* Process a NetworkMessage with the given identifiers. The DataSetMessage is
+ * empty. Returns whether a DataSetReader was found. */
+static UA_StatusCode
+processIdentifiers(UA_UInt16 publisherId, UA_UInt16 writerGroupId, UA_UInt16 dataSetWriterId) {
+    UA_NetworkMessage msg;
+    memset(&msg, 0, sizeof(UA_NetworkMessage));
+    msg.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    msg.publisherIdEnabled = true;
+    msg.publisherIdType = UA_PUBLISHERDATATYPE_UINT16;
+    msg.publisherId.publisherIdUInt16 = publisherId;
+    msg.groupHeaderEnabled = true;
+    msg.groupHeader.writerGroupIdEnabled = true;
+    msg.groupHeader.writerGroupId = writerGroupId;
+    msg.payloadHeaderEnabled = true;
+    msg.payloadHeader.dataSetPayloadHeader.count = 1;
+    msg.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = &dataSetWriterId;
+    UA_DataSetMessage dsm;
+    memset(&dsm, 0, sizeof(UA_DataSetMessage));
+    msg.payload.dataSetPayload.dataSetMessages = &dsm;
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, connection_test);
+    return UA_Server_processNetworkMessage(server, &msg, connection);
+}
+
+START_TEST(LookupManyDataSetReaders) {
+        UA_ReaderGroupConfig readerGroupConfig;
+        memset(&readerGroupConfig, 0, sizeof(readerGroupConfig));
+        readerGroupConfig.name  = UA_STRING("ReaderGroup 1");
+        UA_NodeId localReaderGroup[2];
+        UA_StatusCode retVal =
+            UA_Server_addReaderGroup(server, connection_test, &readerGroupConfig, &localReaderGroup[0]);
+        retVal |= UA_Server_addReaderGroup(server, connection_test, &readerGroupConfig, &localReaderGroup[1]);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Enough readers to grow the index */
+        UA_DataSetReaderConfig readerConfig;
+        memset (&readerConfig, 0, sizeof(readerConfig));
+        readerConfig.name       = UA_STRING("DataSet Reader");
+        UA_UInt16 publisherId   = PUBLISHER_ID;
+        UA_Variant_setScalar(&readerConfig.publisherId, &publisherId, &UA_TYPES[UA_TYPES_UINT16]);
+        readerConfig.writerGroupId = WRITER_GROUP_ID;
+        UA_NodeId dataSetReaders[100];
+        for(UA_UInt16 i = 0; i < 100; i++) {
+            readerConfig.dataSetWriterId = i;
+            retVal = UA_Server_addDataSetReader(server, localReaderGroup[i % 2], &readerConfig,
+                                                &dataSetReaders[i]);
+            ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        }
+
+        for(UA_UInt16 i = 0; i < 100; i++)
+            ck_assert_int_eq(processIdentifiers(PUBLISHER_ID, WRITER_GROUP_ID, i), UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(processIdentifiers(PUBLISHER_ID, WRITER_GROUP_ID, 100), UA_STATUSCODE_BADNOTFOUND);
+        ck_assert_int_eq(processIdentifiers(PUBLISHER_ID + 1, WRITER_GROUP_ID, 0), UA_STATUSCODE_BADNOTFOUND);
+        ck_assert_int_eq(processIdentifiers(PUBLISHER_ID, WRITER_GROUP_ID + 1, 0), UA_STATUSCODE_BADNOTFOUND);
+
+        /* The index follows the configuration changes */
+        readerConfig.dataSetWriterId = 7;
+        readerConfig.writerGroupId = WRITER_GROUP_ID + 1;
+        retVal = UA_Server_DataSetReader_updateConfig(server, dataSetReaders[7], localReaderGroup[1],
+                                                      &readerConfig);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(processIdentifiers(PUBLISHER_ID, WRITER_GROUP_ID, 7), UA_STATUSCODE_BADNOTFOUND);
+        ck_assert_int_eq(processIdentifiers(PUBLISHER_ID, WRITER_GROUP_ID + 1, 7), UA_STATUSCODE_GOOD);
+
+        retVal = UA_Server_removeDataSetReader(server, dataSetReaders[8]);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(processIdentifiers(PUBLISHER_ID, WRITER_GROUP_ID, 8), UA_STATUSCODE_BADNOTFOUND);
+
+        retVal = UA_Server_removeReaderGroup(server, localReaderGroup[0]);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(processIdentifiers(PUBLISHER_ID, WRITER_GROUP_ID, 0), UA_STATUSCODE_BADNOTFOUND);
+        ck_assert_int_eq(processIdentifiers(PUBLISHER_ID, WRITER_GROUP_ID, 1), UA_STATUSCODE_GOOD);
+    } END_TEST
+
 START_TEST(UpdateDataSetReaderConfigWithInvalidId) {
         /* Check status of updatting DataSetReader with invalid configuration */
         UA_StatusCode retVal = UA_STATUSCODE_GOOD;
@@ -1331,6 +1405,7 @@ int main(void) {
     tcase_add_test(tc_add_pubsub_readergroup, RemoveDataSetReaderWithValidConfiguration);
     tcase_add_test(tc_add_pubsub_readergroup, RemoveDataSetReaderWithInvalidIdentifier);
     tcase_add_test(tc_add_pubsub_readergroup, AddMultipleDataSetReaderWithValidConfiguration);
+    tcase_add_test(tc_add_pubsub_readergroup, LookupManyDataSetReaders);
     tcase_add_test(tc_add_pubsub_readergroup, UpdateDataSetReaderConfigWithInvalidId);
     tcase_add_test(tc_add_pubsub_readergroup, GetDataSetReaderConfigWithValidConfiguration);
     tcase_add_test(tc_add_pubsub_readergroup, GetDataSetReaderConfigWithInvalidConfiguration);
@@ -0,0 +1,312 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/pubsub_udp.h>
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "ua_pubsub.h"
+#include "ua_pubsub_networkmessage.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+
+#define PUBLISHER_ID 2234
+#define WRITER_GROUP_ID 100
+#define DATASET_WRITER_ID 62541
+#define FIELDS 100
+#define ITERATIONS 10000
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdent, readerGroupIdent, readerIdent;
+UA_DataValue targets[FIELDS];
+UA_UInt32 targetValues[FIELDS];
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+    config->logger.log = NULL;
+
+    config->pubsubTransportLayers = (UA_PubSubTransportLayer*)
+        UA_malloc(sizeof(UA_PubSubTransportLayer));
+    config->pubsubTransportLayers[0] = UA_PubSubTransportLayerUDPMP();
+    config->pubsubTransportLayersSize++;
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4802/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_StatusCode retval =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_startup(server);
+
+    /* The static value targets point to a plain array */
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_DataValue_init(&targets[i]);
+        targetValues[i] = 0;
+        UA_Variant_setScalar(&targets[i].value, &targetValues[i], &UA_TYPES[UA_TYPES_UINT32]);
+    }
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static void
+addReader(UA_PubSubRTLevel rtLevel, UA_Boolean staticTargets) {
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup");
+    readerGroupConfig.rtLevel = rtLevel;
+    UA_StatusCode retval = UA_Server_addReaderGroup(server, connectionIdent, &readerGroupConfig,
+                                                    &readerGroupIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader");
+    UA_UInt16 publisherId = PUBLISHER_ID;
+    UA_Variant_setScalar(&readerConfig.publisherId, &publisherId, &UA_TYPES[UA_TYPES_UINT16]);
+    readerConfig.writerGroupId = WRITER_GROUP_ID;
+    readerConfig.dataSetWriterId = DATASET_WRITER_ID;
+    if(staticTargets)
+        readerConfig.staticValueTargets = targets;
+
+    UA_FieldMetaData fields[FIELDS];
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_FieldMetaData_init(&fields[i]);
+        fields[i].dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+        fields[i].builtInType = UA_NS0ID_UINT32;
+        fields[i].valueRank = -1; /* scalar */
+    }
+    readerConfig.dataSetMetaData.fieldsSize = FIELDS;
+    readerConfig.dataSetMetaData.fields = fields;
+    retval = UA_Server_addDataSetReader(server, readerGroupIdent, &readerConfig, &readerIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+/* A NetworkMessage with one keyframe DataSetMessage. The fields have the value
+ * base + index. */
+static void
+encodeMessage(UA_UInt16 writerGroupId, UA_UInt16 sequenceNumber,
+              const UA_DataType *type, UA_UInt32 base, UA_ByteString *buffer) {
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    nm.version = 1;
+    nm.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    nm.publisherIdEnabled = true;
+    nm.publisherIdType = UA_PUBLISHERDATATYPE_UINT16;
+    nm.publisherId.publisherIdUInt16 = PUBLISHER_ID;
+    nm.groupHeaderEnabled = true;
+    nm.groupHeader.writerGroupIdEnabled = true;
+    nm.groupHeader.writerGroupId = writerGroupId;
+    nm.groupHeader.sequenceNumberEnabled = true;
+    nm.groupHeader.sequenceNumber = sequenceNumber;
+    nm.payloadHeaderEnabled = true;
+    nm.payloadHeader.dataSetPayloadHeader.count = 1;
+    UA_UInt16 dataSetWriterId = DATASET_WRITER_ID;
+    nm.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = &dataSetWriterId;
+
+    UA_DataSetMessage dsm;
+    memset(&dsm, 0, sizeof(UA_DataSetMessage));
+    dsm.header.dataSetMessageValid = true;
+    dsm.header.fieldEncoding = UA_FIELDENCODING_VARIANT;
+    dsm.header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    dsm.header.dataSetMessageSequenceNrEnabled = true;
+    dsm.header.dataSetMessageSequenceNr = sequenceNumber;
+    dsm.data.keyFrameData.fieldCount = FIELDS;
+    UA_DataValue fields[FIELDS];
+    UA_UInt32 uintValues[FIELDS];
+    UA_Double doubleValues[FIELDS];
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_DataValue_init(&fields[i]);
+        fields[i].hasValue = true;
+        uintValues[i] = base + (UA_UInt32)i;
+        doubleValues[i] = (UA_Double)uintValues[i];
+        if(type == &UA_TYPES[UA_TYPES_UINT32])
+            UA_Variant_setScalar(&fields[i].value, &uintValues[i], type);
+        else
+            UA_Variant_setScalar(&fields[i].value, &doubleValues[i], type);
+    }
+    dsm.data.keyFrameData.dataSetFields = fields;
+    nm.payload.dataSetPayload.dataSetMessages = &dsm;
+
+    UA_StatusCode retval =
+        UA_ByteString_allocBuffer(buffer, UA_NetworkMessage_calcSizeBinary(&nm, NULL));
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Byte *pos = buffer->data;
+    retval = UA_NetworkMessage_encodeBinary(&nm, &pos, &buffer->data[buffer->length]);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void
+processMessage(const UA_ByteString *buffer, UA_StatusCode expected) {
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, connectionIdent);
+    ck_assert_ptr_ne(connection, NULL);
+    UA_StatusCode retval = UA_Server_processNetworkMessageBinary(server, buffer, connection);
+    ck_assert_int_eq(retval, expected);
+}
+
+static void
+checkTargets(UA_UInt32 base) {
+    for(size_t i = 0; i < FIELDS; i++) {
+        ck_assert(targets[i].hasValue);
+        ck_assert_uint_eq(targetValues[i], base + (UA_UInt32)i);
+    }
+}
+
+START_TEST(SubscribeFieldsWithFixedOffsets) {
+    addReader(UA_PUBSUB_RT_FIXED_SIZE, true);
+    ck_assert_int_eq(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdent),
+                     UA_STATUSCODE_GOOD);
+    UA_DataSetReader *dsr = UA_ReaderGroup_findDSRbyId(server, readerIdent);
+    ck_assert_ptr_ne(dsr, NULL);
+    ck_assert_uint_eq(dsr->layout.messageTemplate.length, 0);
+
+    /* The first message is decoded and becomes the template */
+    UA_ByteString buffer;
+    encodeMessage(WRITER_GROUP_ID, 1, &UA_TYPES[UA_TYPES_UINT32], 1000, &buffer);
+    processMessage(&buffer, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(dsr->layout.messageTemplate.length, buffer.length);
+    checkTargets(1000);
+    UA_ByteString_clear(&buffer);
+
+    /* The sequence numbers and values change */
+    encodeMessage(WRITER_GROUP_ID, 2, &UA_TYPES[UA_TYPES_UINT32], 5000, &buffer);
+    processMessage(&buffer, UA_STATUSCODE_GOOD);
+    checkTargets(5000);
+    UA_ByteString_clear(&buffer);
+
+    /* Messages with another layout take the normal path */
+    encodeMessage(WRITER_GROUP_ID + 1, 3, &UA_TYPES[UA_TYPES_UINT32], 7000, &buffer);
+    processMessage(&buffer, UA_STATUSCODE_BADNOTFOUND);
+    UA_ByteString_clear(&buffer);
+    encodeMessage(WRITER_GROUP_ID, 4, &UA_TYPES[UA_TYPES_DOUBLE], 7000, &buffer);
+    processMessage(&buffer, UA_STATUSCODE_GOOD);
+    UA_ByteString_clear(&buffer);
+    checkTargets(5000);
+
+    /* Unfreezing forgets the template */
+    ck_assert_int_eq(UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdent),
+                     UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(dsr->layout.messageTemplate.length, 0);
+} END_TEST
+
+START_TEST(FrozenReaderGroupRejectsChanges) {
+    addReader(UA_PUBSUB_RT_FIXED_SIZE, true);
+    ck_assert_int_eq(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdent),
+                     UA_STATUSCODE_GOOD);
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader 2");
+    UA_NodeId readerIdent2;
+    ck_assert_int_eq(UA_Server_addDataSetReader(server, readerGroupIdent, &readerConfig,
+                                                &readerIdent2),
+                     UA_STATUSCODE_BADCONFIGURATIONERROR);
+    ck_assert_int_eq(UA_Server_removeDataSetReader(server, readerIdent),
+                     UA_STATUSCODE_BADCONFIGURATIONERROR);
+    ck_assert_int_eq(UA_Server_removeReaderGroup(server, readerGroupIdent),
+                     UA_STATUSCODE_BADCONFIGURATIONERROR);
+
+    ck_assert_int_eq(UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdent),
+                     UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(UA_Server_removeDataSetReader(server, readerIdent), UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(UA_Server_removeReaderGroup(server, readerGroupIdent), UA_STATUSCODE_GOOD);
+} END_TEST
+
+START_TEST(FreezeWithoutStaticValueTargets) {
+    addReader(UA_PUBSUB_RT_FIXED_SIZE, false);
+    ck_assert_int_eq(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdent),
+                     UA_STATUSCODE_BADNOTSUPPORTED);
+    UA_ReaderGroupConfig config;
+    ck_assert_int_eq(UA_Server_ReaderGroup_getConfig(server, readerGroupIdent, &config),
+                     UA_STATUSCODE_GOOD);
+    ck_assert(!config.configurationFrozen);
+    UA_String_clear(&config.name);
+} END_TEST
+
+START_TEST(FreezeWithMismatchingStaticValueTargets) {
+    UA_Double d = 0.0;
+    UA_Variant_setScalar(&targets[FIELDS - 1].value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    addReader(UA_PUBSUB_RT_FIXED_SIZE, true);
+    ck_assert_int_eq(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdent),
+                     UA_STATUSCODE_BADNOTSUPPORTED);
+    UA_DataSetReader *dsr = UA_ReaderGroup_findDSRbyId(server, readerIdent);
+    ck_assert_ptr_eq(dsr->layout.fieldTypes, NULL);
+} END_TEST
+
+static const char *rtLevelNames[] = {"none", "fixed size"};
+
+/* Compare with writing the values into target variables of the information
+ * model */
+START_TEST(ProcessingSpeed) {
+    UA_Boolean fixed = (_i == 1);
+    addReader(fixed ? UA_PUBSUB_RT_FIXED_SIZE : UA_PUBSUB_RT_NONE, fixed);
+    if(fixed) {
+        ck_assert_int_eq(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdent),
+                         UA_STATUSCODE_GOOD);
+    } else {
+        UA_NodeId folder;
+        UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+        UA_StatusCode retval =
+            UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                    UA_QUALIFIEDNAME(1, "Subscribed Variables"),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                    oAttr, NULL, &folder);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        retval = UA_Server_DataSetReader_addTargetVariables(server, &folder, readerIdent,
+                                                            UA_PUBSUB_SDS_TARGET);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    UA_ByteString buffer;
+    encodeMessage(WRITER_GROUP_ID, 1, &UA_TYPES[UA_TYPES_UINT32], 1000, &buffer);
+    clock_t begin = clock();
+    for(size_t i = 0; i < ITERATIONS; i++)
+        processMessage(&buffer, UA_STATUSCODE_GOOD);
+    clock_t duration = clock() - begin;
+    UA_ByteString_clear(&buffer);
+    if(fixed)
+        checkTargets(1000);
+
+    printf("RT level %-10s: %.2f us per message with %d fields\n", rtLevelNames[_i],
+           (double)duration * 1000000.0 / CLOCKS_PER_SEC / ITERATIONS, FIELDS);
+} END_TEST
+
+int main(void) {
+    TCase *tc_fixed = tcase_create("PubSub RT subscribe with fixed offsets");
+    tcase_add_checked_fixture(tc_fixed, setup, teardown);
+    tcase_add_test(tc_fixed, SubscribeFieldsWithFixedOffsets);
+    tcase_add_test(tc_fixed, FrozenReaderGroupRejectsChanges);
+    tcase_add_test(tc_fixed, FreezeWithoutStaticValueTargets);
+    tcase_add_test(tc_fixed, FreezeWithMismatchingStaticValueTargets);
+
+    TCase *tc_speed = tcase_create("PubSub RT subscribe speed");
+    tcase_add_checked_fixture(tc_speed, setup, teardown);
+    tcase_add_loop_test(tc_speed, ProcessingSpeed, 0, sizeof(rtLevelNames) / sizeof(char*));
+
+    Suite *s = suite_create("PubSub RT levels for DataSetReaders");
+    suite_add_tcase(s, tc_fixed);
+    suite_add_tcase(s, tc_speed);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
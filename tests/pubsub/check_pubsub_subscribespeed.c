@@ -0,0 +1,165 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Receive throughput of the UDP multicast channel over the loopback. Bursts of
+ * datagrams (as from many publishers at once) are sent and then received
+ * either one by one or in batches. The received datagrams are counted to
+ * measure the loss. */
+
+#include <open62541/plugin/pubsub_udp.h>
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BURSTS 400
+#define BURST_SIZE 50 /* Publishers */
+#define DATAGRAM_SIZE 200
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdent;
+UA_PubSubChannel *channel = NULL;
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+
+    config->pubsubTransportLayers = (UA_PubSubTransportLayer*)
+        UA_malloc(sizeof(UA_PubSubTransportLayer));
+    config->pubsubTransportLayers[0] = UA_PubSubTransportLayerUDPMP();
+    config->pubsubTransportLayersSize++;
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4801/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_StatusCode retval =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdent);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnection *connection =
+        UA_PubSubConnection_findConnectionbyId(server, connectionIdent);
+    ck_assert_ptr_ne(connection, NULL);
+    channel = connection->channel;
+    retval = channel->regist(channel, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static size_t received;
+static UA_UInt32 nextSequence;
+static size_t outOfOrder;
+
+static void
+checkDatagram(const UA_ByteString *buffer) {
+    ck_assert_uint_eq(buffer->length, DATAGRAM_SIZE);
+    UA_UInt32 sequence;
+    memcpy(&sequence, buffer->data, sizeof(UA_UInt32));
+    if(sequence != nextSequence)
+        outOfOrder++;
+    nextSequence = sequence + 1;
+    received++;
+}
+
+static UA_StatusCode
+countDatagram(UA_PubSubChannel *ch, void *callbackContext, const UA_ByteString *buffer) {
+    checkDatagram(buffer);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Receive until no more datagrams arrive within 1ms */
+static void
+drainSingle(UA_ByteString *buf) {
+    while(true) {
+        UA_ByteString message = *buf;
+        channel->receive(channel, &message, NULL, 1000);
+        if(message.length == 0)
+            break;
+        checkDatagram(&message);
+    }
+}
+
+static void
+drainBatch(void) {
+    while(channel->receiveBatch(channel, NULL, countDatagram, NULL, 1000) ==
+          UA_STATUSCODE_GOOD) {}
+}
+
+static const char *receiveModeNames[] = {"single", "batch"};
+
+START_TEST(ReceiveSpeedTest) {
+    UA_Boolean batch = (_i == 1);
+    ck_assert(channel->receiveBatch != NULL);
+
+    UA_ByteString datagram, buf;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&datagram, DATAGRAM_SIZE);
+    retval |= UA_ByteString_allocBuffer(&buf, 2048);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    memset(datagram.data, 0, datagram.length);
+
+    received = 0;
+    nextSequence = 0;
+    outOfOrder = 0;
+    UA_UInt32 sequence = 0;
+    clock_t receiveTime = 0;
+    for(size_t i = 0; i < BURSTS; i++) {
+        for(size_t j = 0; j < BURST_SIZE; j++) {
+            memcpy(datagram.data, &sequence, sizeof(UA_UInt32));
+            sequence++;
+            retval = channel->send(channel, NULL, &datagram);
+            ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        }
+        clock_t begin = clock();
+        if(batch)
+            drainBatch();
+        else
+            drainSingle(&buf);
+        receiveTime += clock() - begin;
+    }
+
+    size_t sent = BURSTS * BURST_SIZE;
+    double seconds = (double)receiveTime / CLOCKS_PER_SEC;
+    printf("%-6s receive: %.0f messages/s, %lu of %lu lost, %lu out of order\n",
+           receiveModeNames[_i], (double)received / (seconds > 0 ? seconds : 1e-6),
+           (unsigned long)(sent - received), (unsigned long)sent,
+           (unsigned long)outOfOrder);
+    ck_assert_uint_gt(received, 0);
+    ck_assert_uint_le(received, sent);
+
+    UA_ByteString_clear(&datagram);
+    UA_ByteString_clear(&buf);
+}
+END_TEST
+
+int main(void) {
+    TCase *tc_receive = tcase_create("PubSub UDP receive speed");
+    tcase_add_checked_fixture(tc_receive, setup, teardown);
+    tcase_add_loop_test(tc_receive, ReceiveSpeedTest, 0,
+                        sizeof(receiveModeNames) / sizeof(char*));
+
+    Suite *s = suite_create("PubSub subscriber speed");
+    suite_add_tcase(s, tc_receive);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -25,6 +25,10 @@ static void setupHashMap(void) {
     UA_Nodestore_HashMap(&ns);
 }
 
+static void setupSharded(void) {
+    UA_Nodestore_Sharded(&ns);
+}
+
 static void teardown(void) {
     ns.clear(ns.context);
 }
@@ -184,6 +188,39 @@ START_TEST(failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries) {
 }
 END_TEST
 
+START_TEST(removeNodeWhileInUse) {
+    UA_Node* n1 = createNode(0,2253);
+    ns.insertNode(ns.context, n1, NULL);
+    UA_NodeId in1 = UA_NODEID_NUMERIC(0,2253);
+    const UA_Node* nr = ns.getNode(ns.context, &in1);
+    ck_assert_ptr_eq(nr, n1);
+
+    /* The node is no longer found but can still be used */
+    UA_StatusCode retval = ns.removeNode(ns.context, &in1);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(ns.getNode(ns.context, &in1), NULL);
+    ck_assert(UA_NodeId_equal(&nr->nodeId, &in1));
+    ns.releaseNode(ns.context, nr);
+}
+END_TEST
+
+START_TEST(insertRandomNodeIds) {
+    UA_NodeId ids[200];
+    for(size_t i = 0; i < 200; i++) {
+        UA_Node* n = createNode(1,0);
+        UA_StatusCode retval = ns.insertNode(ns.context, n, &ids[i]);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_ne(ids[i].identifier.numeric, 0);
+    }
+    for(size_t i = 0; i < 200; i++) {
+        const UA_Node* nr = ns.getNode(ns.context, &ids[i]);
+        ck_assert_ptr_ne(nr, NULL);
+        ck_assert(UA_NodeId_equal(&nr->nodeId, &ids[i]));
+        ns.releaseNode(ns.context, nr);
+    }
+}
+END_TEST
+
 /************************************/
 /* Performance Profiling Test Cases */
 /************************************/
@@ -303,6 +340,34 @@ static Suite * namespace_suite (void) {
     tcase_add_test (tc_profile_hm, profileGetDelete);
     suite_add_tcase (s, tc_profile_hm);
 
+    TCase* tc_find_sh = tcase_create ("Find-Sharded");
+    tcase_add_checked_fixture(tc_find_sh, setupSharded, teardown);
+    tcase_add_test (tc_find_sh, findNodeInUA_NodeStoreWithSingleEntry);
+    tcase_add_test (tc_find_sh, findNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_sh, findNodeInExpandedNamespace);
+    tcase_add_test (tc_find_sh, failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_sh, failToFindNodeInOtherUA_NodeStore);
+    tcase_add_test (tc_find_sh, insertRandomNodeIds);
+    suite_add_tcase (s, tc_find_sh);
+
+    TCase *tc_replace_sh = tcase_create("Replace-Sharded");
+    tcase_add_checked_fixture(tc_replace_sh, setupSharded, teardown);
+    tcase_add_test (tc_replace_sh, replaceExistingNode);
+    tcase_add_test (tc_replace_sh, replaceOldNode);
+    tcase_add_test (tc_replace_sh, removeNodeWhileInUse);
+    suite_add_tcase (s, tc_replace_sh);
+
+    TCase* tc_iterate_sh = tcase_create ("Iterate-Sharded");
+    tcase_add_checked_fixture(tc_iterate_sh, setupSharded, teardown);
+    tcase_add_test (tc_iterate_sh, iterateOverUA_NodeStoreShallNotVisitEmptyNodes);
+    tcase_add_test (tc_iterate_sh, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
+    suite_add_tcase (s, tc_iterate_sh);
+
+    TCase* tc_profile_sh = tcase_create ("Profile-Sharded");
+    tcase_add_checked_fixture(tc_profile_sh, setupSharded, teardown);
+    tcase_add_test (tc_profile_sh, profileGetDelete);
+    suite_add_tcase (s, tc_profile_sh);
+
     return s;
 }
 
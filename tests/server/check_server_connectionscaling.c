@@ -0,0 +1,195 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Compare the cost of a server iteration with many idle TCP connections between
+ * the select-based and the epoll-based network layer. The select-based layer
+ * is limited to FD_SETSIZE sockets. As both ends of every connection live in
+ * this process, it is measured only up to FD_SETSIZE / 2 connections. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/network_tcp.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <check.h>
+#include <time.h>
+
+#include "thread_wrapper.h"
+
+#define ITERATIONS 1000 /* Number of server iterations to measure */
+
+static const size_t connectionCounts[] = {16, 128, 384};
+static const size_t epollConnectionCounts[] = {1024, 4096, 10000};
+
+static UA_Server *server;
+static UA_Boolean running;
+static THREAD_HANDLE server_thread;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+static UA_Server *
+newServer(UA_Boolean epoll) {
+    UA_Server *s = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(s);
+    UA_ServerConfig_setDefault(config);
+    if(epoll) {
+        /* Replace the default select-based network layer */
+        config->networkLayers[0].clear(&config->networkLayers[0]);
+        config->networkLayers[0] =
+            UA_ServerNetworkLayerTCPEpoll(UA_ConnectionConfig_default, 4840,
+                                          0, &config->logger);
+    }
+    return s;
+}
+
+static int
+openSocket(void) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    ck_assert_int_ge(fd, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(4840);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ck_assert_int_eq(connect(fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    return fd;
+}
+
+/* Returns the average duration of an iteration in microseconds */
+static double
+measureIterations(UA_Boolean epoll, size_t connections) {
+    server = newServer(epoll);
+    ck_assert_uint_eq(UA_Server_run_startup(server), UA_STATUSCODE_GOOD);
+
+    int *fds = (int*)UA_malloc(sizeof(int) * connections);
+    ck_assert_ptr_ne(fds, NULL);
+    for(size_t i = 0; i < connections; i++) {
+        fds[i] = openSocket();
+        /* Wait until the connection is accepted. The select-based layer
+         * accepts only one connection per iteration. */
+        for(size_t j = 0; j < 1000; j++) {
+            if(UA_Server_getStatistics(server).ns.currentConnectionCount > i)
+                break;
+            UA_Server_run_iterate(server, false);
+        }
+        ck_assert_uint_eq(UA_Server_getStatistics(server).ns.currentConnectionCount,
+                          i + 1);
+    }
+
+    clock_t begin = clock();
+    for(size_t i = 0; i < ITERATIONS; i++)
+        UA_Server_run_iterate(server, false);
+    clock_t finish = clock();
+
+    for(size_t i = 0; i < connections; i++)
+        close(fds[i]);
+    UA_free(fds);
+
+    /* Pick up the closed connections */
+    for(size_t i = 0; i < 1000; i++) {
+        if(UA_Server_getStatistics(server).ns.currentConnectionCount == 0)
+            break;
+        UA_Server_run_iterate(server, false);
+    }
+    ck_assert_uint_eq(UA_Server_getStatistics(server).ns.currentConnectionCount, 0);
+
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    return ((double)(finish - begin) / CLOCKS_PER_SEC) * 1e6 / ITERATIONS;
+}
+
+START_TEST(epollClientConnect) {
+    server = newServer(true);
+    running = true;
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Variant val;
+    UA_Variant_init(&val);
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
+    retval = UA_Client_readValueAttribute(client, nodeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&val);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+END_TEST
+
+START_TEST(connectionScaling) {
+    for(size_t i = 0; i < sizeof(connectionCounts) / sizeof(size_t); i++) {
+        size_t n = connectionCounts[i];
+        double selectTime = measureIterations(false, n);
+        double epollTime = measureIterations(true, n);
+        printf("%5lu connections: select %8.2f us/iteration, "
+               "epoll %8.2f us/iteration\n",
+               (unsigned long)n, selectTime, epollTime);
+    }
+}
+END_TEST
+
+START_TEST(epollConnectionScaling) {
+    /* Every connection requires two file descriptors in this process */
+    struct rlimit rl;
+    ck_assert_int_eq(getrlimit(RLIMIT_NOFILE, &rl), 0);
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+    getrlimit(RLIMIT_NOFILE, &rl);
+
+    for(size_t i = 0; i < sizeof(epollConnectionCounts) / sizeof(size_t); i++) {
+        size_t n = epollConnectionCounts[i];
+        if(rl.rlim_cur != RLIM_INFINITY && (n * 2) + 64 > rl.rlim_cur) {
+            printf("%5lu connections: skipped (file descriptor limit)\n",
+                   (unsigned long)n);
+            continue;
+        }
+        double epollTime = measureIterations(true, n);
+        printf("%5lu connections: epoll %8.2f us/iteration\n",
+               (unsigned long)n, epollTime);
+    }
+}
+END_TEST
+
+static Suite * testSuite_connectionScaling(void) {
+    Suite *s = suite_create("Server Connection Scaling");
+    TCase *tc_epoll = tcase_create("Epoll Network Layer");
+    tcase_add_test(tc_epoll, epollClientConnect);
+    suite_add_tcase(s, tc_epoll);
+    TCase *tc_speed = tcase_create("Connection Scaling");
+    tcase_add_test(tc_speed, connectionScaling);
+    tcase_add_test(tc_speed, epollConnectionScaling);
+    suite_add_tcase(s, tc_speed);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_connectionScaling();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,330 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Tests of the file history backend. The history is stored in a temporary
+ * directory and loaded again after the backend is recreated. */
+
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+#include <open62541/plugin/historydata/history_data_gathering_default.h>
+#include <open62541/plugin/historydata/history_database_default.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "history_backend_test.h"
+
+#define SEGMENT_DURATION (10 * UA_DATETIME_SEC)
+
+static char directory[32];
+
+static int
+removeEntry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    return remove(path);
+}
+
+static void setup(void) {
+    strcpy(directory, "/tmp/ua_history_XXXXXX");
+    ck_assert_ptr_ne(mkdtemp(directory), NULL);
+    setupBackend(UA_HistoryDataBackend_File(directory, SEGMENT_DURATION));
+}
+
+static void teardown(void) {
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+    nftw(directory, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+static void
+restart(void) {
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+    backend = UA_HistoryDataBackend_File(directory, SEGMENT_DURATION);
+    ck_assert_ptr_ne(backend.context, NULL);
+}
+
+static UA_Boolean
+segmentExists(const char *node, UA_DateTime start) {
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s/%016llx.seg", directory, node,
+             (unsigned long long)start);
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+START_TEST(File_appendAndRestart) {
+    /* 1000 samples every 50ms span five segments */
+    for(size_t i = 0; i < 1000; i++)
+        ck_assert_uint_eq(setSample(&nodeA, (UA_DateTime)i * 50 * UA_DATETIME_MSEC,
+                                    (UA_Double)i), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(setSample(&nodeB, 5, 5.0), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(getEnd(&nodeA), 1000);
+    ck_assert(segmentExists("1-s-61", 0));
+    ck_assert(segmentExists("1-s-61", 4 * SEGMENT_DURATION));
+    ck_assert(segmentExists("1-i-2", 0));
+
+    for(size_t round = 0; round < 2; round++) {
+        ck_assert_uint_eq(getEnd(&nodeA), 1000);
+        ck_assert_uint_eq(getEnd(&nodeB), 1);
+        ck_assert(valueAt(&nodeA, 0) == 0.0);
+        ck_assert(valueAt(&nodeA, 200) == 200.0);
+        ck_assert(valueAt(&nodeA, 999) == 999.0);
+        ck_assert_uint_eq(timestampAt(&nodeA, 401), 401 * 50 * UA_DATETIME_MSEC);
+        ck_assert_uint_eq(match(&nodeA, 10 * UA_DATETIME_SEC, MATCH_EQUAL), 200);
+        ck_assert_uint_eq(match(&nodeA, 10 * UA_DATETIME_SEC, MATCH_BEFORE), 199);
+        ck_assert_uint_eq(match(&nodeA, 10 * UA_DATETIME_SEC + 1, MATCH_EQUAL), 1000);
+        ck_assert_uint_eq(match(&nodeA, 10 * UA_DATETIME_SEC + 1, MATCH_EQUAL_OR_AFTER), 201);
+        ck_assert_uint_eq(match(&nodeA, 10 * UA_DATETIME_SEC + 1, MATCH_EQUAL_OR_BEFORE), 200);
+        ck_assert_uint_eq(match(&nodeA, -1, MATCH_BEFORE), 1000);
+        ck_assert_uint_eq(match(&nodeA, 60 * UA_DATETIME_SEC, MATCH_AFTER), 1000);
+        ck_assert(valueAt(&nodeB, 0) == 5.0);
+
+        /* The history is loaded from the files */
+        restart();
+    }
+
+    /* Continue after the restart */
+    ck_assert_uint_eq(setSample(&nodeA, 50 * UA_DATETIME_SEC, 1000.0), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(getEnd(&nodeA), 1001);
+    restart();
+    ck_assert_uint_eq(getEnd(&nodeA), 1001);
+    ck_assert(valueAt(&nodeA, 1000) == 1000.0);
+
+    /* A different segment duration ignores the existing segments */
+    UA_HistoryDataBackend_File_deleteMembers(&backend);
+    backend = UA_HistoryDataBackend_File(directory, 2 * SEGMENT_DURATION);
+    ck_assert_ptr_ne(backend.context, NULL);
+    ck_assert_uint_eq(getEnd(&nodeA), 0);
+} END_TEST
+
+START_TEST(File_rejectedValues) {
+    ck_assert_uint_eq(setSample(&nodeA, 10, 1.0), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(setSample(&nodeA, 20, 2.0), UA_STATUSCODE_GOOD);
+
+    /* Out of order within the segment */
+    ck_assert_uint_eq(setSample(&nodeA, 15, 1.5),
+                      UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED);
+
+    /* Into an earlier segment */
+    ck_assert_uint_eq(setSample(&nodeA, -SEGMENT_DURATION, -1.0), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(getEnd(&nodeA), 3);
+    ck_assert(valueAt(&nodeA, 0) == -1.0);
+    ck_assert(valueAt(&nodeA, 2) == 2.0);
+    ck_assert_uint_eq(setSample(&nodeA, 30, 3.0), UA_STATUSCODE_GOOD);
+    ck_assert(valueAt(&nodeA, 3) == 3.0);
+
+    /* The type of the node is fixed */
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Int32 i = 5;
+    UA_Variant_setScalar(&dv.value, &i, &UA_TYPES[UA_TYPES_INT32]);
+    dv.hasValue = true;
+    dv.sourceTimestamp = 40;
+    dv.hasSourceTimestamp = true;
+    ck_assert_uint_eq(backend.serverSetHistoryData(NULL, backend.context, NULL, NULL,
+                                                   &nodeA, true, &dv),
+                      UA_STATUSCODE_BADTYPEMISMATCH);
+
+    /* Arrays and types with pointers are not supported */
+    UA_Double d[2] = {1.0, 2.0};
+    UA_Variant_setArray(&dv.value, d, 2, &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert_uint_eq(backend.serverSetHistoryData(NULL, backend.context, NULL, NULL,
+                                                   &nodeA, true, &dv),
+                      UA_STATUSCODE_BADNOTSUPPORTED);
+    UA_String s = UA_STRING("test");
+    UA_Variant_setScalar(&dv.value, &s, &UA_TYPES[UA_TYPES_STRING]);
+    ck_assert_uint_eq(backend.serverSetHistoryData(NULL, backend.context, NULL, NULL,
+                                                   &nodeB, true, &dv),
+                      UA_STATUSCODE_BADNOTSUPPORTED);
+    ck_assert_uint_eq(getEnd(&nodeA), 4);
+    ck_assert_uint_eq(getEnd(&nodeB), 0);
+} END_TEST
+
+START_TEST(File_updateAndRemove) {
+    for(size_t i = 0; i < 30; i++)
+        ck_assert_uint_eq(setSample(&nodeA, (UA_DateTime)i * UA_DATETIME_SEC,
+                                    (UA_Double)i), UA_STATUSCODE_GOOD);
+
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Double v = 0.5;
+    UA_Variant_setScalar(&dv.value, &v, &UA_TYPES[UA_TYPES_DOUBLE]);
+    dv.hasValue = true;
+    dv.sourceTimestamp = 5 * UA_DATETIME_SEC;
+    dv.hasSourceTimestamp = true;
+    ck_assert_uint_eq(backend.insertDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_BADENTRYEXISTS);
+    ck_assert_uint_eq(backend.replaceDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_GOOD);
+    ck_assert(valueAt(&nodeA, 5) == 0.5);
+    ck_assert_uint_eq(backend.updateDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_GOODENTRYREPLACED);
+
+    dv.sourceTimestamp = 30 * UA_DATETIME_SEC;
+    ck_assert_uint_eq(backend.replaceDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_BADNOENTRYEXISTS);
+    ck_assert_uint_eq(backend.updateDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_GOODENTRYINSERTED);
+    ck_assert_uint_eq(getEnd(&nodeA), 31);
+    ck_assert_uint_eq(timestampAt(&nodeA, 30), 30 * UA_DATETIME_SEC);
+
+    /* Only entire segments are removed */
+    ck_assert_uint_eq(backend.removeDataValue(NULL, backend.context, NULL, NULL, &nodeA,
+                                              5 * UA_DATETIME_SEC, 15 * UA_DATETIME_SEC),
+                      UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED);
+    ck_assert_uint_eq(backend.removeDataValue(NULL, backend.context, NULL, NULL, &nodeA,
+                                              SEGMENT_DURATION, 2 * SEGMENT_DURATION),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(getEnd(&nodeA), 21);
+    ck_assert(!segmentExists("1-s-61", SEGMENT_DURATION));
+    ck_assert(valueAt(&nodeA, 5) == 0.5);
+    ck_assert_uint_eq(timestampAt(&nodeA, 10), 20 * UA_DATETIME_SEC);
+    ck_assert_uint_eq(backend.removeDataValue(NULL, backend.context, NULL, NULL, &nodeA,
+                                              SEGMENT_DURATION, 2 * SEGMENT_DURATION),
+                      UA_STATUSCODE_BADNODATA);
+
+    /* The changes persist */
+    restart();
+    ck_assert_uint_eq(getEnd(&nodeA), 21);
+    ck_assert(valueAt(&nodeA, 5) == 0.5);
+    ck_assert(valueAt(&nodeA, 20) == 0.5);
+    ck_assert_uint_eq(timestampAt(&nodeA, 10), 20 * UA_DATETIME_SEC);
+} END_TEST
+
+START_TEST(File_manySegments) {
+    /* More segments than can be mapped at the same time */
+    for(size_t i = 0; i < 200; i++)
+        ck_assert_uint_eq(setSample(&nodeA, (UA_DateTime)i * SEGMENT_DURATION,
+                                    (UA_Double)i), UA_STATUSCODE_GOOD);
+    for(size_t round = 0; round < 2; round++) {
+        for(size_t i = 0; i < 200; i++)
+            ck_assert(valueAt(&nodeA, i) == (UA_Double)i);
+        ck_assert_uint_eq(match(&nodeA, 150 * SEGMENT_DURATION, MATCH_EQUAL), 150);
+        ck_assert(valueAt(&nodeA, 3) == 3.0);
+    }
+} END_TEST
+
+START_TEST(File_longIdentifier) {
+    /* The directory name is hashed */
+    char identifier[1024];
+    memset(identifier, 'x', sizeof(identifier) - 1);
+    identifier[sizeof(identifier) - 1] = 0;
+    char identifier2[1024];
+    memcpy(identifier2, identifier, sizeof(identifier));
+    identifier2[0] = 'y';
+    UA_NodeId nodeLong = UA_NODEID_STRING(1, identifier);
+    UA_NodeId nodeLong2 = UA_NODEID_STRING(1, identifier2);
+    ck_assert_uint_eq(setSample(&nodeLong, 10, 1.0), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(setSample(&nodeLong2, 10, 2.0), UA_STATUSCODE_GOOD);
+    restart();
+    ck_assert_uint_eq(getEnd(&nodeLong), 1);
+    ck_assert_uint_eq(getEnd(&nodeLong2), 1);
+    ck_assert(valueAt(&nodeLong2, 0) == 2.0);
+    ck_assert_uint_eq(setSample(&nodeLong, 20, 3.0), UA_STATUSCODE_GOOD);
+    restart();
+    ck_assert_uint_eq(getEnd(&nodeLong), 2);
+    ck_assert(valueAt(&nodeLong, 1) == 3.0);
+} END_TEST
+
+START_TEST(File_readRaw) {
+    UA_Server *server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+    UA_HistoryDataGathering gathering = UA_HistoryDataGathering_Default(1);
+    config->historyDatabase = UA_HistoryDatabase_default(gathering);
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Double value = 0.0;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+    attr.dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE |
+        UA_ACCESSLEVELMASK_HISTORYREAD;
+    attr.historizing = true;
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, nodeA, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "a"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_HistorizingNodeIdSettings setting;
+    memset(&setting, 0, sizeof(UA_HistorizingNodeIdSettings));
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 100;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_VALUESET;
+    retval = gathering.registerNodeId(server, gathering.context, &nodeA, setting);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Writes to the node are stored in the backend */
+    for(size_t i = 0; i < 50; i++) {
+        UA_DataValue dv;
+        UA_DataValue_init(&dv);
+        value = (UA_Double)i;
+        UA_Variant_setScalar(&dv.value, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+        dv.hasValue = true;
+        dv.sourceTimestamp = (UA_DateTime)i * UA_DATETIME_SEC;
+        dv.hasSourceTimestamp = true;
+        retval = UA_Server_writeDataValue(server, nodeA, dv);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(getEnd(&nodeA), 50);
+
+    /* Read [12s, 27s) across the segments */
+    UA_ReadRawModifiedDetails details;
+    UA_ReadRawModifiedDetails_init(&details);
+    details.startTime = 12 * UA_DATETIME_SEC;
+    details.endTime = 27 * UA_DATETIME_SEC;
+    UA_HistoryReadValueId readId;
+    UA_HistoryReadValueId_init(&readId);
+    readId.nodeId = nodeA;
+    UA_RequestHeader requestHeader;
+    UA_RequestHeader_init(&requestHeader);
+
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    response.results = UA_HistoryReadResult_new();
+    response.resultsSize = 1;
+    UA_HistoryData *data = UA_HistoryData_new();
+    response.results[0].historyData.encoding = UA_EXTENSIONOBJECT_DECODED;
+    response.results[0].historyData.content.decoded.type = &UA_TYPES[UA_TYPES_HISTORYDATA];
+    response.results[0].historyData.content.decoded.data = data;
+    config->historyDatabase.readRaw(server, config->historyDatabase.context,
+                                    &UA_NODEID_NULL, NULL, &requestHeader, &details,
+                                    UA_TIMESTAMPSTORETURN_SOURCE, false, 1, &readId,
+                                    &response, &data);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(data->dataValuesSize, 15);
+    for(size_t i = 0; i < 15; i++) {
+        ck_assert_uint_eq(data->dataValues[i].sourceTimestamp,
+                          (UA_DateTime)(i + 12) * UA_DATETIME_SEC);
+        ck_assert(*(UA_Double*)data->dataValues[i].value.data == (UA_Double)(i + 12));
+    }
+    UA_HistoryReadResponse_clear(&response);
+
+    /* Deletes the gathering but not the backend */
+    UA_Server_delete(server);
+} END_TEST
+
+int main(void) {
+    Suite *s = suite_create("History File Backend");
+
+    TCase *tc_file = tcase_create("File backend");
+    tcase_add_checked_fixture(tc_file, setup, teardown);
+    tcase_add_test(tc_file, File_appendAndRestart);
+    tcase_add_test(tc_file, File_rejectedValues);
+    tcase_add_test(tc_file, File_updateAndRemove);
+    tcase_add_test(tc_file, File_manySegments);
+    tcase_add_test(tc_file, File_longIdentifier);
+    tcase_add_test(tc_file, File_readRaw);
+    suite_add_tcase(s, tc_file);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
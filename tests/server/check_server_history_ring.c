@@ -0,0 +1,288 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Tests of the ring-buffer history backend. The benchmark measures the ingest
+ * of samples in time order and the reading of time ranges. */
+
+#include <open62541/plugin/historydata/history_data_backend_ring.h>
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "history_backend_test.h"
+
+#define SAMPLESIZE (2 * sizeof(UA_DateTime) + sizeof(UA_Double) + sizeof(UA_StatusCode) + 1)
+
+#define BENCH_NODES 10
+#define BENCH_CAPACITY 100000 /* Samples per node */
+#define BENCH_SAMPLES 5000000
+#define BENCH_READS 100000
+#define BENCH_RANGE 100
+
+static UA_Int64
+monotonicNsec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((UA_Int64)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+static void setup(void) {
+    /* Two nodes with 100 samples each */
+    setupBackend(UA_HistoryDataBackend_Ring(2, 2 * 100 * SAMPLESIZE));
+}
+
+static void teardown(void) {
+    UA_HistoryDataBackend_Ring_deleteMembers(&backend);
+}
+
+START_TEST(Ring_overwriteOldest) {
+    for(size_t i = 0; i < 150; i++)
+        ck_assert_uint_eq(setSample(&nodeA, (UA_DateTime)i * UA_DATETIME_SEC,
+                                    (UA_Double)i), UA_STATUSCODE_GOOD);
+
+    /* Only the latest 100 samples are kept */
+    ck_assert_uint_eq(getEnd(&nodeA), 100);
+    ck_assert_uint_eq(timestampAt(&nodeA, 0), 50 * UA_DATETIME_SEC);
+    ck_assert(valueAt(&nodeA, 0) == 50.0);
+    ck_assert(valueAt(&nodeA, 99) == 149.0);
+    ck_assert_ptr_eq(backend.getDataValue(NULL, backend.context, NULL, NULL,
+                                          &nodeA, 100), NULL);
+
+    /* Too old for the full ring */
+    ck_assert_uint_eq(setSample(&nodeA, 10 * UA_DATETIME_SEC, 10.0),
+                      UA_STATUSCODE_BADDATALOST);
+
+    /* Out of order into the full ring. The oldest sample is dropped. */
+    ck_assert_uint_eq(setSample(&nodeA, 100 * UA_DATETIME_SEC + 1, 0.5),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(getEnd(&nodeA), 100);
+    ck_assert_uint_eq(timestampAt(&nodeA, 0), 51 * UA_DATETIME_SEC);
+    ck_assert(valueAt(&nodeA, 50) == 0.5);
+    ck_assert(valueAt(&nodeA, 51) == 101.0);
+
+    /* The other node is independent */
+    ck_assert_uint_eq(getEnd(&nodeB), 0);
+    ck_assert_uint_eq(setSample(&nodeB, 1, 1.0), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(getEnd(&nodeB), 1);
+} END_TEST
+
+START_TEST(Ring_rejectedValues) {
+    ck_assert_uint_eq(setSample(&nodeA, 1, 1.0), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(setSample(&nodeB, 1, 1.0), UA_STATUSCODE_GOOD);
+
+    /* Only maxNodes nodes are stored */
+    UA_NodeId nodeC = UA_NODEID_NUMERIC(1, 3);
+    ck_assert_uint_eq(setSample(&nodeC, 1, 1.0), UA_STATUSCODE_BADRESOURCEUNAVAILABLE);
+
+    /* The type of the node is fixed */
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Int32 i = 5;
+    UA_Variant_setScalar(&dv.value, &i, &UA_TYPES[UA_TYPES_INT32]);
+    dv.hasValue = true;
+    dv.sourceTimestamp = 2;
+    dv.hasSourceTimestamp = true;
+    ck_assert_uint_eq(backend.serverSetHistoryData(NULL, backend.context, NULL, NULL,
+                                                   &nodeA, true, &dv),
+                      UA_STATUSCODE_BADTYPEMISMATCH);
+
+    /* Arrays and types with pointers are not supported */
+    UA_Double d[2] = {1.0, 2.0};
+    UA_Variant_setArray(&dv.value, d, 2, &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert_uint_eq(backend.serverSetHistoryData(NULL, backend.context, NULL, NULL,
+                                                   &nodeA, true, &dv),
+                      UA_STATUSCODE_BADNOTSUPPORTED);
+    UA_String s = UA_STRING("test");
+    UA_Variant_setScalar(&dv.value, &s, &UA_TYPES[UA_TYPES_STRING]);
+    ck_assert_uint_eq(backend.serverSetHistoryData(NULL, backend.context, NULL, NULL,
+                                                   &nodeA, true, &dv),
+                      UA_STATUSCODE_BADNOTSUPPORTED);
+    ck_assert_uint_eq(getEnd(&nodeA), 1);
+} END_TEST
+
+START_TEST(Ring_matchAndUpdate) {
+    /* Out of order */
+    UA_DateTime timestamps[5] = {50, 10, 30, 20, 40};
+    for(size_t i = 0; i < 5; i++)
+        ck_assert_uint_eq(setSample(&nodeA, timestamps[i], (UA_Double)timestamps[i]),
+                          UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 5; i++) {
+        ck_assert_uint_eq(timestampAt(&nodeA, i), (i + 1) * 10);
+        ck_assert(valueAt(&nodeA, i) == (UA_Double)((i + 1) * 10));
+    }
+
+    ck_assert_uint_eq(match(&nodeA, 30, MATCH_EQUAL), 2);
+    ck_assert_uint_eq(match(&nodeA, 35, MATCH_EQUAL), 5);
+    ck_assert_uint_eq(match(&nodeA, 30, MATCH_AFTER), 3);
+    ck_assert_uint_eq(match(&nodeA, 35, MATCH_EQUAL_OR_AFTER), 3);
+    ck_assert_uint_eq(match(&nodeA, 30, MATCH_BEFORE), 1);
+    ck_assert_uint_eq(match(&nodeA, 35, MATCH_EQUAL_OR_BEFORE), 2);
+    ck_assert_uint_eq(match(&nodeA, 5, MATCH_BEFORE), 5);
+    ck_assert_uint_eq(match(&nodeA, 55, MATCH_AFTER), 5);
+    ck_assert_uint_eq(match(&nodeB, 30, MATCH_EQUAL), 0);
+
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Double v = 3.0;
+    UA_Variant_setScalar(&dv.value, &v, &UA_TYPES[UA_TYPES_DOUBLE]);
+    dv.hasValue = true;
+    dv.sourceTimestamp = 30;
+    dv.hasSourceTimestamp = true;
+    ck_assert_uint_eq(backend.insertDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_BADENTRYEXISTS);
+    ck_assert_uint_eq(backend.replaceDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_GOOD);
+    ck_assert(valueAt(&nodeA, 2) == 3.0);
+    ck_assert_uint_eq(backend.updateDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_GOODENTRYREPLACED);
+
+    dv.sourceTimestamp = 35;
+    ck_assert_uint_eq(backend.replaceDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_BADNOENTRYEXISTS);
+    ck_assert_uint_eq(backend.updateDataValue(NULL, backend.context, NULL, NULL, &nodeA, &dv),
+                      UA_STATUSCODE_GOODENTRYINSERTED);
+    ck_assert_uint_eq(getEnd(&nodeA), 6);
+    ck_assert_uint_eq(timestampAt(&nodeA, 3), 35);
+
+    /* Remove [20, 35) from the middle and 10 from the front */
+    ck_assert_uint_eq(backend.removeDataValue(NULL, backend.context, NULL, NULL, &nodeA, 20, 35),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(getEnd(&nodeA), 4);
+    ck_assert_uint_eq(timestampAt(&nodeA, 1), 35);
+    ck_assert_uint_eq(backend.removeDataValue(NULL, backend.context, NULL, NULL, &nodeA, 10, 10),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(getEnd(&nodeA), 3);
+    ck_assert_uint_eq(timestampAt(&nodeA, 0), 35);
+    ck_assert_uint_eq(timestampAt(&nodeA, 2), 50);
+    ck_assert_uint_eq(backend.removeDataValue(NULL, backend.context, NULL, NULL, &nodeA, 10, 10),
+                      UA_STATUSCODE_BADNODATA);
+} END_TEST
+
+START_TEST(Ring_copyDataValues) {
+    for(size_t i = 0; i < 10; i++)
+        ck_assert_uint_eq(setSample(&nodeA, (UA_DateTime)i, (UA_Double)i),
+                          UA_STATUSCODE_GOOD);
+
+    /* Read 4 of the values 2..8 and continue */
+    UA_DataValue values[4];
+    size_t provided = 0;
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    UA_ByteString outCp = UA_BYTESTRING_NULL;
+    UA_StatusCode retval =
+        backend.copyDataValues(NULL, backend.context, NULL, NULL, &nodeA, 2, 8, false, 4,
+                               UA_NUMERICRANGE(""), false, &cp, &outCp, &provided, values);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(provided, 4);
+    ck_assert_uint_eq(outCp.length, sizeof(size_t));
+    for(size_t i = 0; i < 4; i++) {
+        ck_assert_uint_eq(values[i].sourceTimestamp, i + 2);
+        ck_assert(*(UA_Double*)values[i].value.data == (UA_Double)(i + 2));
+        UA_DataValue_clear(&values[i]);
+    }
+
+    retval = backend.copyDataValues(NULL, backend.context, NULL, NULL, &nodeA, 2, 8, false, 4,
+                                    UA_NUMERICRANGE(""), false, &outCp, &cp, &provided, values);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(provided, 3);
+    ck_assert_uint_eq(cp.length, 0);
+    ck_assert_uint_eq(values[2].sourceTimestamp, 8);
+    for(size_t i = 0; i < 3; i++)
+        UA_DataValue_clear(&values[i]);
+    UA_ByteString_clear(&outCp);
+
+    /* Reverse */
+    retval = backend.copyDataValues(NULL, backend.context, NULL, NULL, &nodeA, 9, 0, true, 4,
+                                    UA_NUMERICRANGE(""), false, &cp, &outCp, &provided, values);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(provided, 4);
+    ck_assert_uint_eq(values[0].sourceTimestamp, 9);
+    ck_assert_uint_eq(values[3].sourceTimestamp, 6);
+    for(size_t i = 0; i < 4; i++)
+        UA_DataValue_clear(&values[i]);
+    UA_ByteString_clear(&outCp);
+} END_TEST
+
+START_TEST(Ring_benchmark) {
+    UA_HistoryDataBackend_Ring_deleteMembers(&backend);
+    backend = UA_HistoryDataBackend_Ring(BENCH_NODES,
+                                         BENCH_NODES * BENCH_CAPACITY * SAMPLESIZE);
+    ck_assert_ptr_ne(backend.context, NULL);
+
+    /* Ingest in time order. The rings wrap around several times. */
+    UA_NodeId nodes[BENCH_NODES];
+    for(size_t i = 0; i < BENCH_NODES; i++)
+        nodes[i] = UA_NODEID_NUMERIC(1, (UA_UInt32)(1000 + i));
+    UA_Int64 begin = monotonicNsec();
+    for(size_t i = 0; i < BENCH_SAMPLES; i++) {
+        UA_StatusCode retval = setSample(&nodes[i % BENCH_NODES],
+                                         (UA_DateTime)i * UA_DATETIME_MSEC, (UA_Double)i);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    UA_Int64 duration = monotonicNsec() - begin;
+    printf("Ingest of %i samples took %.1f ms (%.2f million samples/s)\n", BENCH_SAMPLES,
+           (double)duration / 1000000, (double)BENCH_SAMPLES / ((double)duration / 1e3));
+
+    for(size_t i = 0; i < BENCH_NODES; i++)
+        ck_assert_uint_eq(getEnd(&nodes[i]), BENCH_CAPACITY);
+
+    /* Read ranges of samples from the retained history */
+    UA_DataValue values[BENCH_RANGE];
+    size_t firstSample = BENCH_SAMPLES - (BENCH_NODES * BENCH_CAPACITY);
+    size_t span = (BENCH_NODES * BENCH_CAPACITY) - (BENCH_NODES * BENCH_RANGE);
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    begin = monotonicNsec();
+    for(size_t i = 0; i < BENCH_READS; i++) {
+        const UA_NodeId *nodeId = &nodes[i % BENCH_NODES];
+        size_t sample = firstSample + (((i * 7919) % span) / BENCH_NODES * BENCH_NODES) +
+            (i % BENCH_NODES);
+        UA_DateTime start = (UA_DateTime)sample * UA_DATETIME_MSEC;
+        UA_DateTime end = start + ((BENCH_RANGE - 1) * BENCH_NODES * UA_DATETIME_MSEC);
+        size_t startIndex = match(nodeId, start, MATCH_EQUAL_OR_AFTER);
+        size_t endIndex = match(nodeId, end, MATCH_EQUAL_OR_BEFORE);
+        ck_assert_uint_eq(backend.resultSize(NULL, backend.context, NULL, NULL, nodeId,
+                                             startIndex, endIndex), BENCH_RANGE);
+        UA_ByteString outCp = UA_BYTESTRING_NULL;
+        size_t provided = 0;
+        UA_StatusCode retval =
+            backend.copyDataValues(NULL, backend.context, NULL, NULL, nodeId, startIndex,
+                                   endIndex, false, BENCH_RANGE, UA_NUMERICRANGE(""), false,
+                                   &cp, &outCp, &provided, values);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(provided, BENCH_RANGE);
+        ck_assert_uint_eq(values[0].sourceTimestamp, start);
+        ck_assert(*(UA_Double*)values[BENCH_RANGE - 1].value.data ==
+                  (UA_Double)(sample + ((BENCH_RANGE - 1) * BENCH_NODES)));
+        for(size_t j = 0; j < BENCH_RANGE; j++)
+            UA_DataValue_clear(&values[j]);
+    }
+    duration = monotonicNsec() - begin;
+    printf("%i range reads of %i samples took %.1f ms (%.1f us per read)\n",
+           BENCH_READS, BENCH_RANGE, (double)duration / 1000000,
+           (double)duration / 1000 / BENCH_READS);
+} END_TEST
+
+int main(void) {
+    Suite *s = suite_create("History Ring Backend");
+
+    TCase *tc_ring = tcase_create("Ring backend");
+    tcase_add_checked_fixture(tc_ring, setup, teardown);
+    tcase_add_test(tc_ring, Ring_overwriteOldest);
+    tcase_add_test(tc_ring, Ring_rejectedValues);
+    tcase_add_test(tc_ring, Ring_matchAndUpdate);
+    tcase_add_test(tc_ring, Ring_copyDataValues);
+    suite_add_tcase(s, tc_ring);
+
+    TCase *tc_bench = tcase_create("Ring backend benchmark");
+    tcase_add_checked_fixture(tc_bench, setup, teardown);
+    tcase_set_timeout(tc_bench, 60);
+    tcase_add_test(tc_bench, Ring_benchmark);
+    suite_add_tcase(s, tc_bench);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -6,6 +6,7 @@
 
 #include <open62541/server_config_default.h>
 
+#include "server/ua_services.h"
 #include "server/ua_subscription.h"
 #include "ua_server_internal.h"
 
@@ -100,12 +101,302 @@ START_TEST(monitorIntegerNoChanges) {
 }
 END_TEST
 
+#define MANY_MONITOREDITEMS 50000
+
+static double
+msSince(clock_t begin) {
+    return (double)(clock() - begin) * 1000 / CLOCKS_PER_SEC;
+}
+
+/* Must be called with the lock held */
+static UA_UInt32
+createSubscription(UA_Session **session) {
+    UA_CreateSessionRequest csr;
+    UA_CreateSessionRequest_init(&csr);
+    UA_StatusCode retval = UA_Server_createSession(server, NULL, &csr, session);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_CreateSubscriptionRequest subRequest;
+    UA_CreateSubscriptionRequest_init(&subRequest);
+    UA_CreateSubscriptionResponse subResponse;
+    UA_CreateSubscriptionResponse_init(&subResponse);
+    Service_CreateSubscription(server, *session, &subRequest, &subResponse);
+    ck_assert_uint_eq(subResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    return subResponse.subscriptionId;
+}
+
+/* Create, modify and delete many MonitoredItems in a single Subscription. The
+ * lookup by MonitoredItemId must not scan all MonitoredItems. */
+START_TEST(createModifyDeleteManyMonitoredItems) {
+    UA_Server_getConfig(server)->logger.log = NULL; /* One log line per item */
+
+    UA_Session *session = NULL;
+    UA_LOCK(server->serviceMutex);
+    UA_UInt32 subscriptionId = createSubscription(&session);
+
+    /* Create */
+    UA_MonitoredItemCreateRequest *items = (UA_MonitoredItemCreateRequest*)
+        UA_Array_new(MANY_MONITOREDITEMS, &UA_TYPES[UA_TYPES_MONITOREDITEMCREATEREQUEST]);
+    ck_assert_ptr_ne(items, NULL);
+    for(size_t i = 0; i < MANY_MONITOREDITEMS; i++) {
+        items[i].itemToMonitor.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
+        items[i].itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+        items[i].monitoringMode = UA_MONITORINGMODE_DISABLED;
+        items[i].requestedParameters.clientHandle = (UA_UInt32)i;
+        items[i].requestedParameters.samplingInterval = 1000.0;
+        items[i].requestedParameters.queueSize = 1;
+    }
+    UA_CreateMonitoredItemsRequest createRequest;
+    UA_CreateMonitoredItemsRequest_init(&createRequest);
+    createRequest.subscriptionId = subscriptionId;
+    createRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    createRequest.itemsToCreate = items;
+    createRequest.itemsToCreateSize = MANY_MONITOREDITEMS;
+    UA_CreateMonitoredItemsResponse createResponse;
+    UA_CreateMonitoredItemsResponse_init(&createResponse);
+    clock_t begin = clock();
+    Service_CreateMonitoredItems(server, session, &createRequest, &createResponse);
+    double createTime = msSince(begin);
+    ck_assert_uint_eq(createResponse.resultsSize, MANY_MONITOREDITEMS);
+
+    /* Modify in reverse order */
+    UA_UInt32 *ids = (UA_UInt32*)
+        UA_Array_new(MANY_MONITOREDITEMS, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_MonitoredItemModifyRequest *mods = (UA_MonitoredItemModifyRequest*)
+        UA_Array_new(MANY_MONITOREDITEMS, &UA_TYPES[UA_TYPES_MONITOREDITEMMODIFYREQUEST]);
+    ck_assert(ids && mods);
+    for(size_t i = 0; i < MANY_MONITOREDITEMS; i++) {
+        ck_assert_uint_eq(createResponse.results[i].statusCode, UA_STATUSCODE_GOOD);
+        ids[i] = createResponse.results[MANY_MONITOREDITEMS - 1 - i].monitoredItemId;
+        mods[i].monitoredItemId = ids[i];
+        mods[i].requestedParameters.clientHandle = (UA_UInt32)i;
+        mods[i].requestedParameters.samplingInterval = 500.0;
+        mods[i].requestedParameters.queueSize = 2;
+    }
+    UA_ModifyMonitoredItemsRequest modifyRequest;
+    UA_ModifyMonitoredItemsRequest_init(&modifyRequest);
+    modifyRequest.subscriptionId = subscriptionId;
+    modifyRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    modifyRequest.itemsToModify = mods;
+    modifyRequest.itemsToModifySize = MANY_MONITOREDITEMS;
+    UA_ModifyMonitoredItemsResponse modifyResponse;
+    UA_ModifyMonitoredItemsResponse_init(&modifyResponse);
+    begin = clock();
+    Service_ModifyMonitoredItems(server, session, &modifyRequest, &modifyResponse);
+    double modifyTime = msSince(begin);
+    ck_assert_uint_eq(modifyResponse.resultsSize, MANY_MONITOREDITEMS);
+    for(size_t i = 0; i < MANY_MONITOREDITEMS; i++)
+        ck_assert_uint_eq(modifyResponse.results[i].statusCode, UA_STATUSCODE_GOOD);
+
+    /* Delete */
+    UA_DeleteMonitoredItemsRequest deleteRequest;
+    UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionId = subscriptionId;
+    deleteRequest.monitoredItemIds = ids;
+    deleteRequest.monitoredItemIdsSize = MANY_MONITOREDITEMS;
+    UA_DeleteMonitoredItemsResponse deleteResponse;
+    UA_DeleteMonitoredItemsResponse_init(&deleteResponse);
+    begin = clock();
+    Service_DeleteMonitoredItems(server, session, &deleteRequest, &deleteResponse);
+    double deleteTime = msSince(begin);
+    ck_assert_uint_eq(deleteResponse.resultsSize, MANY_MONITOREDITEMS);
+    for(size_t i = 0; i < MANY_MONITOREDITEMS; i++)
+        ck_assert_uint_eq(deleteResponse.results[i], UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(server->numMonitoredItems, 0);
+    UA_UNLOCK(server->serviceMutex);
+
+    printf("%d MonitoredItems: create %.1f ms, modify %.1f ms, delete %.1f ms\n",
+           MANY_MONITOREDITEMS, createTime, modifyTime, deleteTime);
+
+    UA_Array_delete(items, MANY_MONITOREDITEMS,
+                    &UA_TYPES[UA_TYPES_MONITOREDITEMCREATEREQUEST]);
+    UA_Array_delete(mods, MANY_MONITOREDITEMS,
+                    &UA_TYPES[UA_TYPES_MONITOREDITEMMODIFYREQUEST]);
+    UA_Array_delete(ids, MANY_MONITOREDITEMS, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_CreateMonitoredItemsResponse_clear(&createResponse);
+    UA_ModifyMonitoredItemsResponse_clear(&modifyResponse);
+    UA_DeleteMonitoredItemsResponse_clear(&deleteResponse);
+}
+END_TEST
+
+#define SAMPLED_VARIABLES 1000
+#define SAMPLING_ITERATIONS 5
+
+static const size_t samplingBatchSizes[] = {10000, 100000, 1000000};
+
+/* Sample all MonitoredItems with the same sampling interval. Once in a batch
+ * and once individually with a lock per MonitoredItem. Groups of ten
+ * consecutive MonitoredItems monitor the same variable. */
+START_TEST(sampleManyMonitoredItems) {
+    UA_Server_getConfig(server)->logger.log = NULL;
+    size_t count = samplingBatchSizes[_i];
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 42;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    for(UA_UInt32 i = 0; i < SAMPLED_VARIABLES; i++) {
+        UA_StatusCode retval =
+            UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 50000 + i),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, "sampled"), UA_NODEID_NULL,
+                                      attr, NULL, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    UA_Session *session = NULL;
+    UA_LOCK(server->serviceMutex);
+    UA_UInt32 subscriptionId = createSubscription(&session);
+
+    UA_MonitoredItemCreateRequest *items = (UA_MonitoredItemCreateRequest*)
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_MONITOREDITEMCREATEREQUEST]);
+    ck_assert_ptr_ne(items, NULL);
+    for(size_t i = 0; i < count; i++) {
+        UA_UInt32 variable = (UA_UInt32)((i / 10) % SAMPLED_VARIABLES);
+        items[i].itemToMonitor.nodeId = UA_NODEID_NUMERIC(1, 50000 + variable);
+        items[i].itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+        items[i].monitoringMode = UA_MONITORINGMODE_SAMPLING;
+        items[i].requestedParameters.samplingInterval = 100.0;
+        items[i].requestedParameters.queueSize = 1;
+    }
+    UA_CreateMonitoredItemsRequest createRequest;
+    UA_CreateMonitoredItemsRequest_init(&createRequest);
+    createRequest.subscriptionId = subscriptionId;
+    createRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    createRequest.itemsToCreate = items;
+    createRequest.itemsToCreateSize = count;
+    UA_CreateMonitoredItemsResponse createResponse;
+    UA_CreateMonitoredItemsResponse_init(&createResponse);
+    Service_CreateMonitoredItems(server, session, &createRequest, &createResponse);
+    ck_assert_uint_eq(createResponse.resultsSize, count);
+    UA_Array_delete(items, count, &UA_TYPES[UA_TYPES_MONITOREDITEMCREATEREQUEST]);
+    UA_CreateMonitoredItemsResponse_clear(&createResponse);
+
+    /* All MonitoredItems are in one group */
+    UA_SamplingGroup *group = LIST_FIRST(&server->samplingGroups);
+    ck_assert_ptr_ne(group, NULL);
+    ck_assert_ptr_eq(LIST_NEXT(group, listEntry), NULL);
+    UA_UNLOCK(server->serviceMutex);
+
+    /* The first sample creates the notifications */
+    UA_SamplingGroup_sampleCallback(server, group);
+
+    clock_t begin = clock();
+    for(size_t n = 0; n < SAMPLING_ITERATIONS; n++)
+        UA_SamplingGroup_sampleCallback(server, group);
+    double batchTime = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    begin = clock();
+    for(size_t n = 0; n < SAMPLING_ITERATIONS; n++) {
+        UA_MonitoredItem *mon;
+        TAILQ_FOREACH(mon, &group->monitoredItems, samplingEntry)
+            UA_MonitoredItem_sampleCallback(server, mon);
+    }
+    double singleTime = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    double samples = (double)(count * SAMPLING_ITERATIONS);
+    printf("%7lu MonitoredItems: batch %.2f Msamples/s, single %.2f Msamples/s\n",
+           (unsigned long)count, samples / (batchTime > 0 ? batchTime : 1e-6) / 1e6,
+           samples / (singleTime > 0 ? singleTime : 1e-6) / 1e6);
+}
+END_TEST
+
+#define DETECTION_ITERATIONS 10000
+#define DETECTION_ARRAYSIZE 10000
+
+static const char *detectionValueNames[] = {
+    "Int32 scalar", "Double[10000] array", "BuildInfo structure"};
+
+/* Set the value variant for a kind of sample. The changed flag modifies a
+ * single element or member. */
+static void
+setDetectionValue(size_t kind, UA_Boolean changed, UA_Variant *v) {
+    if(kind == 0) {
+        UA_Int32 i = changed ? 43 : 42;
+        UA_Variant_setScalarCopy(v, &i, &UA_TYPES[UA_TYPES_INT32]);
+    } else if(kind == 1) {
+        UA_Double *ar = (UA_Double*)
+            UA_Array_new(DETECTION_ARRAYSIZE, &UA_TYPES[UA_TYPES_DOUBLE]);
+        ck_assert_ptr_ne(ar, NULL);
+        for(size_t i = 0; i < DETECTION_ARRAYSIZE; i++)
+            ar[i] = (UA_Double)i;
+        if(changed)
+            ar[DETECTION_ARRAYSIZE / 2] = -1.0;
+        UA_Variant_setArray(v, ar, DETECTION_ARRAYSIZE, &UA_TYPES[UA_TYPES_DOUBLE]);
+    } else {
+        UA_BuildInfo bi;
+        UA_BuildInfo_init(&bi);
+        bi.productUri = UA_STRING("http://open62541.org");
+        bi.manufacturerName = UA_STRING("open62541");
+        bi.productName = UA_STRING("open62541 OPC UA Server");
+        bi.softwareVersion = UA_STRING("1.0");
+        bi.buildNumber = changed ? UA_STRING("2") : UA_STRING("1");
+        UA_Variant_setScalarCopy(v, &bi, &UA_TYPES[UA_TYPES_BUILDINFO]);
+    }
+}
+
+/* Sample an unchanged value of the different kinds. Scalars and arrays of
+ * numeric types are compared in place. Structures (encoded as
+ * ExtensionObjects) are compared by their encoding. Then a single change must
+ * be detected. */
+START_TEST(detectChangesSpeed) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    setDetectionValue((size_t)_i, false, &attr.value);
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "detected");
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, nodeId, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "detected"), UA_NODEID_NULL,
+                                  attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&attr.value);
+
+    UA_MonitoredItemCreateRequest item;
+    UA_MonitoredItemCreateRequest_init(&item);
+    item.itemToMonitor.nodeId = nodeId;
+    item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+    item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    callbackCount = 0;
+    UA_MonitoredItemCreateResult result =
+        UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_NEITHER,
+                                                item, NULL, dataChangeNotificationCallback);
+    ck_assert_uint_eq(result.statusCode, UA_STATUSCODE_GOOD);
+    UA_MonitoredItem *mon = LIST_FIRST(&server->localMonitoredItems);
+
+    /* The first sample when creating the MonitoredItem is always a change */
+    ck_assert_uint_eq(callbackCount, 1);
+
+    clock_t begin = clock();
+    for(size_t n = 0; n < DETECTION_ITERATIONS; n++)
+        UA_MonitoredItem_sampleCallback(server, mon);
+    double time = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    ck_assert_uint_eq(callbackCount, 1);
+
+    UA_Variant v;
+    setDetectionValue((size_t)_i, true, &v);
+    retval = UA_Server_writeValue(server, nodeId, v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&v);
+    UA_MonitoredItem_sampleCallback(server, mon);
+    UA_MonitoredItem_sampleCallback(server, mon);
+    ck_assert_uint_eq(callbackCount, 2);
+
+    printf("%-19s unchanged: %.2f us per sample\n", detectionValueNames[_i],
+           time * 1e6 / DETECTION_ITERATIONS);
+}
+END_TEST
+
 static Suite * monitoring_speed_suite (void) {
     Suite *s = suite_create ("Monitoring Speed");
 
     TCase* tc_datachange = tcase_create ("DataChange");
     tcase_add_checked_fixture(tc_datachange, setup, teardown);
     tcase_add_test (tc_datachange, monitorIntegerNoChanges);
+    tcase_add_test (tc_datachange, createModifyDeleteManyMonitoredItems);
+    tcase_add_loop_test (tc_datachange, sampleManyMonitoredItems, 0,
+                         sizeof(samplingBatchSizes) / sizeof(size_t));
+    tcase_add_loop_test (tc_datachange, detectChangesSpeed, 0,
+                         sizeof(detectionValueNames) / sizeof(char*));
     suite_add_tcase (s, tc_datachange);
 
     return s;
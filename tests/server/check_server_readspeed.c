@@ -189,6 +189,118 @@ START_TEST(readSpeedWithEncoding) {
 }
 END_TEST
 
+/* Decode requests with many string NodeIds on the heap, in an arena and in an
+ * arena without copying the strings. Every allocation served by the arena is
+ * one heap allocation of the normal decoding. */
+#define ARENA_NODES_PER_REQUEST 100
+
+START_TEST(readSpeedWithArena) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+
+    /* Add variable nodes to the address space */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&attr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    UA_NodeId parentNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    UA_NodeId parentReferenceNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+    for(size_t i = 0; i < READNODES; i++) {
+        char varName[20];
+        UA_snprintf(varName, 20, "Variable %u", (UA_UInt32)i);
+        UA_NodeId myNodeId = UA_NODEID_STRING(1, varName);
+        UA_QualifiedName myName = UA_QUALIFIEDNAME(1, varName);
+        retval = UA_Server_addVariableNode(server, myNodeId, parentNodeId,
+                                           parentReferenceNodeId, myName,
+                                           UA_NODEID_NULL, attr, NULL,
+                                           &readNodeIds[i]);
+        UA_assert(retval == UA_STATUSCODE_GOOD);
+    }
+
+    /* Encode the request once */
+    UA_ReadValueId rvi[ARENA_NODES_PER_REQUEST];
+    for(size_t i = 0; i < ARENA_NODES_PER_REQUEST; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = readNodeIds[i];
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToReadSize = ARENA_NODES_PER_REQUEST;
+    request.nodesToRead = rvi;
+
+    UA_ByteString request_msg;
+    retval |= UA_ByteString_allocBuffer(&request_msg, 10000);
+    ck_assert(retval == UA_STATUSCODE_GOOD);
+    UA_Byte *pos = request_msg.data;
+    const UA_Byte *end = &request_msg.data[request_msg.length];
+    retval |= UA_encodeBinary(&request, &UA_TYPES[UA_TYPES_READREQUEST], &pos, &end, NULL, NULL);
+    ck_assert(retval == UA_STATUSCODE_GOOD);
+
+    UA_Arena arena;
+    UA_Arena_init(&arena);
+    UA_ReadRequest req;
+    UA_ReadResponse res;
+    clock_t times[3]; /* heap / arena / arena with zero-copy */
+    size_t served[3] = {0}, heapAllocations[3] = {0};
+    for(size_t t = 0; t < 3; t++) {
+        size_t arenaAllocations = arena.allocations;
+        size_t arenaHeapAllocations = arena.heapAllocations;
+        clock_t begin = clock();
+        for(size_t i = 0; i < READS; i++) {
+            size_t offset = 0;
+            if(t == 0)
+                retval |= UA_decodeBinary(&request_msg, &offset, &req,
+                                          &UA_TYPES[UA_TYPES_READREQUEST], NULL);
+            else
+                retval |= UA_decodeBinaryArena(&request_msg, &offset, &req,
+                                               &UA_TYPES[UA_TYPES_READREQUEST],
+                                               NULL, &arena, t == 2);
+
+            UA_ReadResponse_init(&res);
+            UA_LOCK(server->serviceMutex);
+            Service_Read(server, &server->adminSession, &req, &res);
+            UA_UNLOCK(server->serviceMutex);
+            ck_assert_uint_eq(res.resultsSize, ARENA_NODES_PER_REQUEST);
+            ck_assert_uint_eq(res.results[ARENA_NODES_PER_REQUEST-1].status,
+                              UA_STATUSCODE_GOOD);
+
+            if(t == 0)
+                UA_ReadRequest_clear(&req);
+            else
+                UA_Arena_reset(&arena);
+            UA_ReadResponse_clear(&res);
+        }
+        times[t] = clock() - begin;
+        served[t] = arena.allocations - arenaAllocations;
+        heapAllocations[t] = arena.heapAllocations - arenaHeapAllocations;
+    }
+    ck_assert(retval == UA_STATUSCODE_GOOD);
+    heapAllocations[0] = served[1]; /* The arena served what the heap did */
+
+    printf("decode + read of %u nodes (allocations per request): "
+           "heap %f s (%.3f), arena %f s (%.3f), arena zero-copy %f s (%.3f, "
+           "%.1f from the arena)\n", (unsigned)ARENA_NODES_PER_REQUEST,
+           (double)times[0] / CLOCKS_PER_SEC, (double)heapAllocations[0] / READS,
+           (double)times[1] / CLOCKS_PER_SEC, (double)heapAllocations[1] / READS,
+           (double)times[2] / CLOCKS_PER_SEC, (double)heapAllocations[2] / READS,
+           (double)served[2] / READS);
+
+    /* The first request needs a second block. Both are merged during the
+     * reset. Then the arena requires no further allocations. The strings are
+     * not copied with zero-copy. Only the array is allocated. */
+    ck_assert_ptr_ne(arena.blocks, NULL);
+    ck_assert_ptr_eq(arena.blocks->next, NULL);
+    ck_assert_uint_le(heapAllocations[1], 3);
+    ck_assert_uint_eq(heapAllocations[2], 0);
+    ck_assert_uint_eq(served[2], READS);
+
+    UA_Arena_clear(&arena);
+    UA_ByteString_clear(&request_msg);
+    for(size_t i = 0; i < READNODES; i++)
+        UA_NodeId_clear(&readNodeIds[i]);
+}
+END_TEST
+
 static Suite * service_speed_suite (void) {
     Suite *s = suite_create ("Service Speed");
 
@@ -196,6 +308,7 @@ static Suite * service_speed_suite (void) {
     tcase_add_checked_fixture(tc_read, setup, teardown);
     tcase_add_test (tc_read, readSpeed);
     tcase_add_test (tc_read, readSpeedWithEncoding);
+    tcase_add_test (tc_read, readSpeedWithArena);
     suite_add_tcase (s, tc_read);
 
     return s;
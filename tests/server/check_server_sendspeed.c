@@ -0,0 +1,123 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measure how fast large ReadResponses are sent over TCP on the loopback
+ * interface. The responses are split into many chunks that the network layer
+ * sends in batches from pooled buffers. */
+
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/server_config_default.h>
+
+#include <check.h>
+#include <time.h>
+
+#include "thread_wrapper.h"
+
+#define ARRAYLENGTH (1024 * 1024) /* 8MB of Doubles */
+#define READS 50
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+static UA_NodeId arrayNodeId;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+static UA_Int64
+monotonicNsec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((UA_Int64)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+static void setup(void) {
+    running = true;
+    server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+
+    UA_Double *array = (UA_Double*)UA_Array_new(ARRAYLENGTH, &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert_ptr_ne(array, NULL);
+    for(size_t i = 0; i < ARRAYLENGTH; i++)
+        array[i] = (UA_Double)i;
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Variant_setArray(&attr.value, array, ARRAYLENGTH, &UA_TYPES[UA_TYPES_DOUBLE]);
+    attr.dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, UA_NODEID_STRING(1, "array"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "array"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, &arrayNodeId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&attr.value);
+
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void teardown(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_NodeId_clear(&arrayNodeId);
+    UA_Server_delete(server);
+}
+
+START_TEST(sendSpeed) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Int64 begin = monotonicNsec();
+    for(size_t i = 0; i < READS; i++) {
+        UA_Variant v;
+        retval = UA_Client_readValueAttribute(client, arrayNodeId, &v);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(v.arrayLength, ARRAYLENGTH);
+        ck_assert(((UA_Double*)v.data)[ARRAYLENGTH - 1] == (UA_Double)(ARRAYLENGTH - 1));
+        UA_Variant_clear(&v);
+    }
+    UA_Int64 duration = monotonicNsec() - begin;
+
+    double bytes = (double)READS * ARRAYLENGTH * sizeof(UA_Double);
+    printf("%i reads of %.1f MB took %.1f ms (%.1f MB/s)\n", READS,
+           (double)ARRAYLENGTH * sizeof(UA_Double) / (1024 * 1024),
+           (double)duration / 1000000, bytes / (1024 * 1024) / ((double)duration / 1e9));
+
+    /* The send and receive buffers are reused from the connection pools */
+    UA_NetworkStatistics ns = UA_Server_getStatistics(server).ns;
+    printf("Buffer pool hits: %lu, misses: %lu\n",
+           (unsigned long)ns.bufferPoolHits, (unsigned long)ns.bufferPoolMisses);
+    ck_assert_uint_gt(ns.bufferPoolHits, 100 * ns.bufferPoolMisses);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+static Suite * testSuite_sendSpeed(void) {
+    Suite *s = suite_create("Server Send Speed");
+    TCase *tc = tcase_create("Large ReadResponses over TCP");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, sendSpeed);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_sendSpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
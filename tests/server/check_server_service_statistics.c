@@ -0,0 +1,233 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/server_config_default.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+
+#include "ua_util_internal.h"
+
+#include <check.h>
+#include "testing_clock.h"
+#include "thread_wrapper.h"
+
+#define READS 100
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+static void
+repeatedCallback(UA_Server *s, void *data) {}
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+static void setup(void) {
+    running = true;
+    server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+    UA_Server_run_startup(server);
+    UA_Server_addRepeatedCallback(server, repeatedCallback, NULL, 1.0, NULL);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void teardown(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static UA_Client *
+connectClient(void) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    return client;
+}
+
+/* Read and browse from the client. The browse request without nodes fails. */
+static void
+generateRequests(UA_Client *client) {
+    for(size_t i = 0; i < READS; i++) {
+        UA_Variant v;
+        UA_StatusCode retval =
+            UA_Client_readValueAttribute(client, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE), &v);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        UA_Variant_clear(&v);
+    }
+
+    UA_BrowseRequest bReq;
+    UA_BrowseRequest_init(&bReq);
+    UA_BrowseResponse bResp = UA_Client_Service_browse(client, bReq);
+    ck_assert_uint_eq(bResp.responseHeader.serviceResult, UA_STATUSCODE_BADNOTHINGTODO);
+    UA_BrowseResponse_clear(&bResp);
+}
+
+static const UA_ServiceCounters *
+findService(const UA_ServiceStatistics *stats, const UA_DataType *requestType) {
+    for(size_t i = 0; i < stats->servicesSize; i++) {
+        if(stats->services[i].requestType == requestType)
+            return &stats->services[i];
+    }
+    return NULL;
+}
+
+START_TEST(Server_histogramPercentiles) {
+    UA_LatencyHistogram h;
+    memset(&h, 0, sizeof(UA_LatencyHistogram));
+    ck_assert_uint_eq(UA_LatencyHistogram_percentile(&h, 0.5), 0);
+
+    /* 1..1000us */
+    for(UA_DateTime us = 1; us <= 1000; us++)
+        UA_LatencyHistogram_record(&h, us * UA_DATETIME_USEC);
+    UA_LatencyHistogram_record(&h, -1); /* counts as zero */
+    ck_assert_uint_eq(h.count, 1001);
+    ck_assert_uint_eq(h.max, 1000);
+    ck_assert_uint_eq(h.sum, 500500);
+
+    /* The reported values are upper bounds within 25% of the true values */
+    UA_UInt64 median = UA_LatencyHistogram_percentile(&h, 0.5);
+    ck_assert_uint_ge(median, 500);
+    ck_assert_uint_le(median, 625);
+    UA_UInt64 p99 = UA_LatencyHistogram_percentile(&h, 0.99);
+    ck_assert_uint_ge(p99, 990);
+    ck_assert_uint_le(p99, 1000);
+    ck_assert_uint_eq(UA_LatencyHistogram_percentile(&h, 1.0), 1000);
+    ck_assert_uint_eq(UA_LatencyHistogram_percentile(&h, 0.0), 0);
+
+    /* Beyond the range of the buckets */
+    UA_LatencyHistogram_record(&h, (UA_DateTime)1 << 50);
+    ck_assert_uint_eq(h.buckets[UA_LATENCYHISTOGRAM_BUCKETS - 1], 1);
+    ck_assert_uint_eq(UA_LatencyHistogram_percentile(&h, 1.0), h.max);
+} END_TEST
+
+START_TEST(Server_serviceCounters) {
+    UA_Client *client = connectClient();
+    UA_Server_resetServiceStatistics(server);
+    generateRequests(client);
+    UA_fakeSleep(10); /* Let the repeated callback run */
+    UA_realSleep(50);
+
+    UA_ServiceStatistics *stats = (UA_ServiceStatistics*)UA_malloc(sizeof(UA_ServiceStatistics));
+    ck_assert_ptr_ne(stats, NULL);
+    UA_Server_getServiceStatistics(server, stats);
+
+    const UA_ServiceCounters *read = findService(stats, &UA_TYPES[UA_TYPES_READREQUEST]);
+    ck_assert_ptr_ne(read, NULL);
+    ck_assert_uint_eq(read->requestCount, READS);
+    ck_assert_uint_eq(read->errorCount, 0);
+    ck_assert_uint_eq(read->latency.count, READS);
+    ck_assert_uint_gt(read->bytesReceived, 0);
+    ck_assert_uint_gt(read->bytesSent, 0);
+    ck_assert_uint_le(UA_LatencyHistogram_percentile(&read->latency, 0.5),
+                      UA_LatencyHistogram_percentile(&read->latency, 0.99));
+    ck_assert_uint_le(UA_LatencyHistogram_percentile(&read->latency, 0.99),
+                      read->latency.max);
+
+    const UA_ServiceCounters *browse = findService(stats, &UA_TYPES[UA_TYPES_BROWSEREQUEST]);
+    ck_assert_ptr_ne(browse, NULL);
+    ck_assert_uint_eq(browse->requestCount, 1);
+    ck_assert_uint_eq(browse->errorCount, 1);
+
+    /* The server main loop runs repeated callbacks */
+    ck_assert_uint_gt(stats->timerLateness.count, 0);
+    UA_free(stats);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+START_TEST(Server_serviceStatisticsNodes) {
+    UA_Client *client = connectClient();
+    UA_Server_resetServiceStatistics(server);
+    generateRequests(client);
+
+    UA_Variant v;
+    UA_StatusCode retval =
+        UA_Client_readValueAttribute(client, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERDIAGNOSTICS_ENABLEDFLAG), &v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(*(UA_Boolean*)v.data);
+    UA_Variant_clear(&v);
+
+    retval = UA_Client_readValueAttribute(client,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY), &v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&v, &UA_TYPES[UA_TYPES_SERVERDIAGNOSTICSSUMMARYDATATYPE]));
+    UA_ServerDiagnosticsSummaryDataType *sds = (UA_ServerDiagnosticsSummaryDataType*)v.data;
+    ck_assert_uint_eq(sds->currentSessionCount, 1);
+    ck_assert_uint_eq(sds->rejectedRequestsCount, 1);
+    UA_Variant_clear(&v);
+
+    retval = UA_Client_readValueAttribute(client,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SERVERDIAGNOSTICSSUMMARY_CUMULATEDSESSIONCOUNT), &v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_ge(*(UA_UInt32*)v.data, 1);
+    UA_Variant_clear(&v);
+
+    /* Find the read service in the arrays of the vendor-specific nodes */
+    UA_Variant names, counts;
+    retval = UA_Client_readValueAttribute(client,
+        UA_NODEID_STRING(1, "ServerDiagnostics.ServiceStatistics.ServiceNames"), &names);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Client_readValueAttribute(client,
+        UA_NODEID_STRING(1, "ServerDiagnostics.ServiceStatistics.RequestCounts"), &counts);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(names.type == &UA_TYPES[UA_TYPES_STRING]);
+    ck_assert(counts.type == &UA_TYPES[UA_TYPES_UINT64]);
+    ck_assert_uint_ge(names.arrayLength, 2);
+    ck_assert_uint_eq(names.arrayLength, counts.arrayLength);
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    UA_String readName = UA_STRING("ReadRequest");
+    UA_Boolean found = false;
+    for(size_t i = 0; i < names.arrayLength; i++) {
+        if(!UA_String_equal(&((UA_String*)names.data)[i], &readName))
+            continue;
+        ck_assert_uint_ge(((UA_UInt64*)counts.data)[i], READS);
+        found = true;
+    }
+    ck_assert(found);
+#endif
+    UA_Variant_clear(&names);
+    UA_Variant_clear(&counts);
+
+    retval = UA_Client_readValueAttribute(client,
+        UA_NODEID_STRING(1, "ServerDiagnostics.ServiceStatistics.TimerLateness99"), &v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&v, &UA_TYPES[UA_TYPES_UINT64]));
+    UA_Variant_clear(&v);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+#endif
+
+int main(void) {
+    Suite *s = suite_create("Server Service Statistics");
+
+    TCase *tc_histogram = tcase_create("Latency histogram");
+    tcase_add_test(tc_histogram, Server_histogramPercentiles);
+    suite_add_tcase(s, tc_histogram);
+
+    TCase *tc_services = tcase_create("Service statistics");
+    tcase_add_checked_fixture(tc_services, setup, teardown);
+    tcase_add_test(tc_services, Server_serviceCounters);
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+    tcase_add_test(tc_services, Server_serviceStatisticsNodes);
+#endif
+    suite_add_tcase(s, tc_services);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
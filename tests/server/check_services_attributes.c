@@ -923,6 +923,107 @@ START_TEST(WriteSingleDataSourceAttributeValue) {
     ck_assert_int_eq(retval, UA_STATUSCODE_BADWRITENOTSUPPORTED);
 } END_TEST
 
+static UA_NodeId
+addInt32Variable(void) {
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Int32 value = 0;
+    UA_Variant_setScalar(&vattr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    vattr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    vattr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "ring.value");
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, nodeId, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "ring value"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  vattr, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    return nodeId;
+}
+
+static UA_DataValue
+readRingValue(const UA_NodeId nodeId) {
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = nodeId;
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+    return UA_Server_read(server, &rvi, UA_TIMESTAMPSTORETURN_SOURCE);
+}
+
+START_TEST(ReadWriteValueRing) {
+    UA_NodeId nodeId = addInt32Variable();
+    UA_ValueRing *ring;
+    UA_StatusCode retval = UA_ValueRing_new(&UA_TYPES[UA_TYPES_INT32], 3, &ring);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_setVariableNode_valueRing(server, nodeId, ring);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Nothing pushed yet */
+    UA_DataValue dv = readRingValue(nodeId);
+    ck_assert(dv.hasStatus);
+    ck_assert_int_eq(dv.status, UA_STATUSCODE_BADWAITINGFORINITIALDATA);
+    UA_DataValue_clear(&dv);
+
+    /* Push more values than the ring can hold */
+    UA_Variant v;
+    UA_Int32 value;
+    UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_INT32]);
+    for(value = 1; value <= 6; value++) {
+        retval = UA_ValueRing_push(ring, &v, (UA_DateTime)value);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    dv = readRingValue(nodeId);
+    ck_assert(dv.hasValue);
+    ck_assert_ptr_eq(dv.value.type, &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(*(UA_Int32*)dv.value.data, 6);
+    ck_assert(dv.hasSourceTimestamp);
+    ck_assert_int_eq(dv.sourceTimestamp, 6);
+    UA_DataValue_clear(&dv);
+
+    /* Writing the value attribute pushes into the ring */
+    value = 7;
+    retval = UA_Server_writeValue(server, nodeId, v);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    dv = readRingValue(nodeId);
+    ck_assert_int_eq(*(UA_Int32*)dv.value.data, 7);
+    UA_DataValue_clear(&dv);
+
+    UA_Double d = 1.0;
+    UA_Variant_setScalar(&v, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    retval = UA_Server_writeValue(server, nodeId, v);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADTYPEMISMATCH);
+
+    /* The oldest values are overwritten */
+    UA_DataValue values[8];
+    size_t position = 0;
+    size_t count = UA_ValueRing_getValues(ring, &position, values, 8);
+    ck_assert_uint_eq(count, 4);
+    ck_assert_uint_eq(position, 7);
+    for(size_t i = 0; i < count; i++) {
+        ck_assert_int_eq(*(UA_Int32*)values[i].value.data, (UA_Int32)i + 4);
+        UA_DataValue_clear(&values[i]);
+    }
+    count = UA_ValueRing_getValues(ring, &position, values, 8);
+    ck_assert_uint_eq(count, 0);
+
+    retval = UA_Server_deleteNode(server, nodeId, true);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_ValueRing_delete(ring);
+} END_TEST
+
+START_TEST(ValueRingTypeMismatch) {
+    UA_ValueRing *ring;
+    UA_StatusCode retval = UA_ValueRing_new(&UA_TYPES[UA_TYPES_STRING], 16, &ring);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADINVALIDARGUMENT);
+
+    UA_NodeId nodeId = addInt32Variable();
+    retval = UA_ValueRing_new(&UA_TYPES[UA_TYPES_DOUBLE], 16, &ring);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_setVariableNode_valueRing(server, nodeId, ring);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADTYPEMISMATCH);
+    UA_ValueRing_delete(ring);
+} END_TEST
+
 static Suite * testSuite_services_attributes(void) {
     Suite *s = suite_create("services_attributes_read");
 
@@ -987,6 +1088,12 @@ static Suite * testSuite_services_attributes(void) {
 
     suite_add_tcase(s, tc_writeSingleAttributes);
 
+    TCase *tc_valueRing = tcase_create("valueRing");
+    tcase_add_checked_fixture(tc_valueRing, setup, teardown);
+    tcase_add_test(tc_valueRing, ReadWriteValueRing);
+    tcase_add_test(tc_valueRing, ValueRingTypeMismatch);
+    suite_add_tcase(s, tc_valueRing);
+
     return s;
 }
 
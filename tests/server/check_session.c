@@ -2,12 +2,22 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <open62541/server_config_default.h>
 #include <open62541/types.h>
 
+#include "server/ua_server_internal.h"
 #include "server/ua_services.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
 #include <check.h>
 
+#include "testing_clock.h"
+
+#define MANY_SESSIONS 5000
+
 START_TEST(Session_init_ShallWork) {
     UA_Session session;
     UA_Session_init(&session);
@@ -44,6 +54,99 @@ START_TEST(Session_updateLifetime_ShallWork) {
 }
 END_TEST
 
+static UA_Server *server = NULL;
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+    config->maxSessions = MANY_SESSIONS;
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+static UA_Session *
+createSession(UA_Double timeout) {
+    UA_CreateSessionRequest request;
+    UA_CreateSessionRequest_init(&request);
+    request.requestedSessionTimeout = timeout;
+    UA_Session *session = NULL;
+    UA_LOCK(server->serviceMutex);
+    UA_StatusCode retval = UA_Server_createSession(server, NULL, &request, &session);
+    UA_UNLOCK(server->serviceMutex);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    return session;
+}
+
+START_TEST(Session_lookupManySessions) {
+    UA_Session **sessions = (UA_Session**)UA_malloc(MANY_SESSIONS * sizeof(UA_Session*));
+    ck_assert_ptr_ne(sessions, NULL);
+    for(size_t i = 0; i < MANY_SESSIONS; i++)
+        sessions[i] = createSession(10000.0);
+
+    UA_LOCK(server->serviceMutex);
+    clock_t begin = clock();
+    for(size_t i = 0; i < MANY_SESSIONS; i++) {
+        UA_Session *s = UA_Server_getSessionById(server, &sessions[i]->sessionId);
+        ck_assert_ptr_eq(s, sessions[i]);
+    }
+    clock_t duration = clock() - begin;
+    printf("Lookup of %d sessions by id: %.3f ms\n", MANY_SESSIONS,
+           (double)duration * 1000 / CLOCKS_PER_SEC);
+
+    /* Remove every second session by its token */
+    for(size_t i = 0; i < MANY_SESSIONS; i += 2) {
+        UA_StatusCode retval =
+            UA_Server_removeSessionByToken(server, &sessions[i]->header.authenticationToken,
+                                           UA_DIAGNOSTICEVENT_CLOSE);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(server->sessionCount, MANY_SESSIONS / 2);
+    for(size_t i = 1; i < MANY_SESSIONS; i += 2) {
+        UA_Session *s = UA_Server_getSessionById(server, &sessions[i]->sessionId);
+        ck_assert_ptr_eq(s, sessions[i]);
+    }
+    UA_UNLOCK(server->serviceMutex);
+    UA_free(sessions);
+}
+END_TEST
+
+START_TEST(Session_cleanupTimedOut) {
+    UA_Session *s1 = createSession(1000.0);
+    UA_Session *s2 = createSession(2000.0);
+    UA_Session *s3 = createSession(3000.0);
+    UA_NodeId id1 = s1->sessionId, id2 = s2->sessionId, id3 = s3->sessionId;
+
+    /* Nothing has timed out yet */
+    UA_LOCK(server->serviceMutex);
+    UA_Server_cleanupSessions(server, UA_DateTime_nowMonotonic());
+    ck_assert_uint_eq(server->sessionCount, 3);
+    UA_UNLOCK(server->serviceMutex);
+
+    /* The first session is used and does not time out with its initial
+     * lifetime */
+    UA_fakeSleep(900);
+    UA_Session_updateLifetime(s1);
+    UA_fakeSleep(600);
+
+    UA_LOCK(server->serviceMutex);
+    UA_Server_cleanupSessions(server, UA_DateTime_nowMonotonic());
+    ck_assert_uint_eq(server->sessionCount, 3);
+    UA_UNLOCK(server->serviceMutex);
+
+    UA_fakeSleep(1000);
+    UA_LOCK(server->serviceMutex);
+    UA_Server_cleanupSessions(server, UA_DateTime_nowMonotonic());
+    ck_assert_uint_eq(server->sessionCount, 1);
+    ck_assert_ptr_eq(UA_Server_getSessionById(server, &id1), NULL);
+    ck_assert_ptr_eq(UA_Server_getSessionById(server, &id2), NULL);
+    ck_assert_ptr_eq(UA_Server_getSessionById(server, &id3), s3);
+    UA_UNLOCK(server->serviceMutex);
+}
+END_TEST
+
 static Suite* testSuite_Session(void) {
     Suite *s = suite_create("Session");
     TCase *tc_core = tcase_create("Core");
@@ -51,6 +154,12 @@ static Suite* testSuite_Session(void) {
     tcase_add_test(tc_core, Session_updateLifetime_ShallWork);
 
     suite_add_tcase(s,tc_core);
+
+    TCase *tc_manager = tcase_create("SessionManager");
+    tcase_add_checked_fixture(tc_manager, setup, teardown);
+    tcase_add_test(tc_manager, Session_lookupManySessions);
+    tcase_add_test(tc_manager, Session_cleanupTimedOut);
+    suite_add_tcase(s, tc_manager);
     return s;
 }
 
@@ -0,0 +1,69 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Helpers shared by the tests of the history backends. The test sets the
+ * backend in its setup with setupBackend and deletes it in the teardown. Two
+ * nodes are prepared for the samples. */
+
+#ifndef HISTORY_BACKEND_TEST_H_
+#define HISTORY_BACKEND_TEST_H_
+
+#include <open62541/plugin/historydata/history_data_backend.h>
+
+#include <check.h>
+
+static UA_HistoryDataBackend backend;
+static UA_NodeId nodeA;
+static UA_NodeId nodeB;
+
+static void
+setupBackend(UA_HistoryDataBackend newBackend) {
+    backend = newBackend;
+    ck_assert_ptr_ne(backend.context, NULL);
+    nodeA = UA_NODEID_STRING(1, "a");
+    nodeB = UA_NODEID_NUMERIC(1, 2);
+}
+
+static UA_StatusCode
+setSample(const UA_NodeId *nodeId, UA_DateTime timestamp, UA_Double value) {
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Variant_setScalar(&dv.value, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+    dv.hasValue = true;
+    dv.sourceTimestamp = timestamp;
+    dv.hasSourceTimestamp = true;
+    return backend.serverSetHistoryData(NULL, backend.context, NULL, NULL,
+                                        nodeId, true, &dv);
+}
+
+static size_t
+getEnd(const UA_NodeId *nodeId) {
+    return backend.getEnd(NULL, backend.context, NULL, NULL, nodeId);
+}
+
+static UA_DateTime
+timestampAt(const UA_NodeId *nodeId, size_t index) {
+    const UA_DataValue *dv = backend.getDataValue(NULL, backend.context, NULL, NULL,
+                                                  nodeId, index);
+    ck_assert_ptr_ne(dv, NULL);
+    ck_assert(dv->hasSourceTimestamp);
+    return dv->sourceTimestamp;
+}
+
+static UA_Double
+valueAt(const UA_NodeId *nodeId, size_t index) {
+    const UA_DataValue *dv = backend.getDataValue(NULL, backend.context, NULL, NULL,
+                                                  nodeId, index);
+    ck_assert_ptr_ne(dv, NULL);
+    ck_assert(UA_Variant_hasScalarType(&dv->value, &UA_TYPES[UA_TYPES_DOUBLE]));
+    return *(UA_Double*)dv->value.data;
+}
+
+static size_t
+match(const UA_NodeId *nodeId, UA_DateTime timestamp, MatchStrategy strategy) {
+    return backend.getDateTimeMatch(NULL, backend.context, NULL, NULL,
+                                    nodeId, timestamp, strategy);
+}
+
+#endif /* HISTORY_BACKEND_TEST_H_ */
@@ -82,6 +82,9 @@ endfunction()
 #
 #   [BUILTIN]       Optional argument. If given, then builtin types will be generated.
 #   [INTERNAL]      Optional argument. If given, then the given types file is seen as internal file (e.g. does not require a .csv)
+#   [SPECIALIZED_ENCODING] Optional argument. If given, then binary encoding functions specialized for the structures
+#                   are generated to NAME_generated_encoding_binary_specialized.c. The file is included by the
+#                   binary encoding of the core library and can only be used for the ns0 types.
 #
 #   Arguments taking one value:
 #
@@ -107,7 +110,7 @@ endfunction()
 #
 #
 function(ua_generate_datatypes)
-    set(options BUILTIN INTERNAL)
+    set(options BUILTIN INTERNAL SPECIALIZED_ENCODING)
     set(oneValueArgs NAME TARGET_SUFFIX TARGET_PREFIX NAMESPACE_IDX OUTPUT_DIR FILE_CSV)
     set(multiValueArgs FILES_BSD IMPORT_BSD FILES_SELECTED)
     cmake_parse_arguments(UA_GEN_DT "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
@@ -154,6 +157,16 @@ function(ua_generate_datatypes)
         set(UA_GEN_DT_INTERNAL_ARG "--internal")
     endif()
 
+    # Replace dash with underscore to make valid c literal
+    string(REPLACE "-" "_" UA_GEN_DT_NAME ${UA_GEN_DT_NAME})
+
+    set(UA_GEN_DT_SPECIALIZED_ARG "")
+    set(UA_GEN_DT_SPECIALIZED_OUTPUT "")
+    if (UA_GEN_DT_SPECIALIZED_ENCODING)
+        set(UA_GEN_DT_SPECIALIZED_ARG "--gen-specialized-encoding")
+        set(UA_GEN_DT_SPECIALIZED_OUTPUT ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated_encoding_binary_specialized.c)
+    endif()
+
     set(SELECTED_TYPES_TMP "")
     foreach(f ${UA_GEN_DT_FILES_SELECTED})
         set(SELECTED_TYPES_TMP ${SELECTED_TYPES_TMP} "--selected-types=${f}")
@@ -174,13 +187,11 @@ function(ua_generate_datatypes)
         file(MAKE_DIRECTORY ${UA_GEN_DT_OUTPUT_DIR})
     endif()
 
-    # Replace dash with underscore to make valid c literal
-    string(REPLACE "-" "_" UA_GEN_DT_NAME ${UA_GEN_DT_NAME})
-
     add_custom_command(OUTPUT ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated.c
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated.h
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated_handling.h
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated_encoding_binary.h
+        ${UA_GEN_DT_SPECIALIZED_OUTPUT}
         PRE_BUILD
         COMMAND ${PYTHON_EXECUTABLE} ${open62541_TOOLS_DIR}/generate_datatypes.py
         --namespace=${UA_GEN_DT_NAMESPACE_IDX}
@@ -190,6 +201,7 @@ function(ua_generate_datatypes)
         --type-csv=${UA_GEN_DT_FILE_CSV}
         ${UA_GEN_DT_NO_BUILTIN}
         ${UA_GEN_DT_INTERNAL_ARG}
+        ${UA_GEN_DT_SPECIALIZED_ARG}
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}
         DEPENDS ${open62541_TOOLS_DIR}/generate_datatypes.py
         ${UA_GEN_DT_FILES_BSD}
@@ -200,6 +212,7 @@ function(ua_generate_datatypes)
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated.h
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated_handling.h
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated_encoding_binary.h
+        ${UA_GEN_DT_SPECIALIZED_OUTPUT}
         )
 
     string(TOUPPER "${UA_GEN_DT_NAME}" GEN_NAME_UPPER)
@@ -54,6 +54,11 @@ parser.add_argument('--internal',
                     dest="internal",
                     help='Given bsd are internal types which do not have any .csv file')
 
+parser.add_argument('--gen-specialized-encoding',
+                    action='store_true',
+                    dest="gen_specialized_encoding",
+                    help='Generate binary encoding functions specialized for the structures')
+
 parser.add_argument('-t', '--type-bsd',
                     metavar="<typeBsds>",
                     type=argparse.FileType('r'),
@@ -82,5 +87,5 @@ parser = CSVBSDTypeParser(args.opaque_map, args.selected_types, args.no_builtin,
                           args.type_bsd, args.type_csv)
 parser.create_types()
 
-generator = backend.CGenerator(parser, inname, args.outfile, args.internal)
+generator = backend.CGenerator(parser, inname, args.outfile, args.internal, args.gen_specialized_encoding)
 generator.write_definitions()
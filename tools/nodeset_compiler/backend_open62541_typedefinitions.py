@@ -32,6 +32,18 @@ builtin_overlayable = {"Boolean": "true",
                                "offsetof(UA_Guid, data3) == (sizeof(UA_UInt16) + sizeof(UA_UInt32)) && " +
                                "offsetof(UA_Guid, data4) == (2*sizeof(UA_UInt32)))"}
 
+# Builtin types that share the binary encoding of another builtin type and the
+# encoded size of the builtin types with a fixed size. Used for the specialized
+# encoding.
+builtin_encoding = {"SByte": "Byte", "Int16": "UInt16", "Int32": "UInt32", "Int64": "UInt64",
+                    "DateTime": "UInt64", "StatusCode": "UInt32",
+                    "ByteString": "String", "XmlElement": "String"}
+builtin_encoded_size = {"Boolean": 1, "Byte": 1, "UInt16": 2, "UInt32": 4,
+                        "UInt64": 8, "Float": 4, "Double": 8, "Guid": 16}
+enum_encoding = {"UA_DATATYPEKIND_ENUM": "UInt32", "UA_DATATYPEKIND_BYTE": "Byte",
+                 "UA_DATATYPEKIND_UINT16": "UInt16", "UA_DATATYPEKIND_UINT32": "UInt32",
+                 "UA_DATATYPEKIND_UINT64": "UInt64"}
+
 whitelistFuncAttrWarnUnusedResult = []  # for instances [ "String", "ByteString", "LocalizedText" ]
 
 
@@ -55,17 +67,27 @@ def getNodeidTypeAndId(nodeId):
         return "UA_NODEIDTYPE_STRING, {{ .string = UA_STRING_STATIC(\"{id}\") }}".format(id=strId.replace("\"", "\\\""))
 
 
+def getNumericNodeId(nodeId):
+    if '=' not in nodeId:
+        return int(nodeId)
+    if nodeId.startswith("i="):
+        return int(nodeId[2:])
+    return None
+
+
 class CGenerator(object):
-    def __init__(self, parser, inname, outfile, is_internal_types):
+    def __init__(self, parser, inname, outfile, is_internal_types, gen_specialized_encoding=False):
         self.parser = parser
         self.inname = inname
         self.outfile = outfile
         self.is_internal_types = is_internal_types
+        self.gen_specialized_encoding = gen_specialized_encoding
         self.filtered_types = None
         self.fh = None
         self.ff = None
         self.fc = None
         self.fe = None
+        self.fs = None
 
     @staticmethod
     def get_type_index(datatype):
@@ -283,6 +305,11 @@ class CGenerator(object):
         self.fc.close()
         self.fe.close()
 
+        if self.gen_specialized_encoding:
+            self.fs = open(self.outfile + "_generated_encoding_binary_specialized.c", 'w')
+            self.print_specialized_encoding()
+            self.fs.close()
+
     def printh(self, string):
         print(string, end='\n', file=self.fh)
 
@@ -295,6 +322,9 @@ class CGenerator(object):
     def printc(self, string):
         print(string, end='\n', file=self.fc)
 
+    def prints(self, string):
+        print(string, end='\n', file=self.fs)
+
     def iter_types(self, v):
         l = None
         if sys.version_info[0] < 3:
@@ -338,6 +368,15 @@ _UA_BEGIN_DECLS
             self.printh(
                 "extern UA_EXPORT const UA_DataType UA_" + self.parser.outname.upper() + "[UA_" + self.parser.outname.upper() + "_COUNT];")
 
+            if not self.parser.no_builtin:
+                # Declared here to give the definitions external linkage also
+                # when compiled as C++. Only used internally.
+                out = self.parser.outname.upper()
+                self.printh("\n/* Hash tables for the lookup of the types. Internal. */")
+                self.printh("extern const UA_Byte UA_%s_LOOKUPSHIFT;" % out)
+                self.printh("extern const UA_UInt16 UA_%s_typeIdLookup[];" % out)
+                self.printh("extern const UA_UInt16 UA_%s_binaryEncodingIdLookup[];" % out)
+
             for i, t in enumerate(self.filtered_types):
                 self.printh("\n/**\n * " + t.name)
                 self.printh(" * " + "^" * len(t.name))
@@ -409,6 +448,63 @@ _UA_END_DECLS
                 self.printc(self.print_datatype(t) + ",")
             self.printc("};\n")
 
+            if not self.parser.no_builtin:
+                self.printc(self.print_lookup_tables())
+
+    # Hash tables for the lookup of the builtin types by the numeric typeId and
+    # by the binaryEncodingId. Open addressing with linear probing. The hash
+    # function is repeated in ua_types.c.
+    @staticmethod
+    def lookup_slot(identifier, shift):
+        return ((identifier * 2654435769) & 0xffffffff) >> shift
+
+    def print_lookup_table(self, name, keys, shift):
+        size = 1 << (32 - shift)
+        table = [0] * size
+        seen = set()
+        for index, key in enumerate(keys):
+            # Keep the first type for a key. This is what a linear search finds.
+            if key is None or key in seen:
+                continue
+            seen.add(key)
+            slot = CGenerator.lookup_slot(key[1], shift)
+            while table[slot] != 0:
+                slot = (slot + 1) % size
+            table[slot] = index + 1
+        rows = [", ".join(str(e) for e in table[i:i + 16]) for i in range(0, size, 16)]
+        return "const UA_UInt16 UA_%s_%sLookup[%s] = {\n    " % \
+            (self.parser.outname.upper(), name, size) + ",\n    ".join(rows) + "};\n"
+
+    def print_lookup_tables(self):
+        typeIdKeys = []
+        binaryKeys = []
+        for t in self.filtered_types:
+            if t.name not in self.parser.typedescriptions:
+                typeIdKeys.append(None)
+                binaryKeys.append(None)
+                continue
+            description = self.parser.typedescriptions[t.name]
+            ns = int(description.namespaceid)
+            numericId = getNumericNodeId(description.nodeid)
+            typeIdKeys.append((ns, numericId) if numericId is not None else None)
+            binaryKeys.append((ns, int(description.binaryEncodingId)))
+
+        if len(self.filtered_types) >= 0xffff:
+            raise RuntimeError("Too many types for the lookup tables")
+
+        # At most half of the slots are used
+        bits = 4
+        while (1 << bits) < 2 * len(self.filtered_types):
+            bits += 1
+        shift = 32 - bits
+        return '''/* Hash tables for the lookup of the types by the numeric identifier of the
+ * typeId and of the binaryEncodingId. Open addressing with linear probing. The
+ * entries are the type index + 1. Zero marks an empty slot. */
+const UA_Byte UA_%s_LOOKUPSHIFT = %s;
+''' % (self.parser.outname.upper(), shift) + \
+            self.print_lookup_table("typeId", typeIdKeys, shift) + \
+            self.print_lookup_table("binaryEncodingId", binaryKeys, shift)
+
     def print_encoding(self):
         self.printe('''/* Generated from ''' + self.inname + ''' with script ''' + sys.argv[0] + '''
  * on host ''' + platform.uname()[1] + ''' by user ''' + getpass.getuser() + ''' at ''' + time.strftime(
@@ -431,3 +527,138 @@ _UA_END_DECLS
             self.printe(self.print_datatype_encoding(t))
 
         self.printe("\n#endif /* " + self.parser.outname.upper() + "_GENERATED_ENCODING_BINARY_H_ */")
+
+    def has_specialized_encoding(self, datatype):
+        return isinstance(datatype, StructType) and len(datatype.members) > 0 and \
+            datatype.outname == self.parser.outname and datatype in self.filtered_types
+
+    def get_specialized_name(self, datatype):
+        return self.parser.outname + "_" + makeCIdentifier(datatype.name)
+
+    def get_member_encoding(self, datatype):
+        """Returns the name and C type for the en/decoding functions of a member
+        type and its fixed encoded size (or None). Falls back to the jumptable
+        for types without a specialized encoding."""
+        name = None
+        if isinstance(datatype, StructType):
+            if self.has_specialized_encoding(datatype):
+                return (self.get_specialized_name(datatype), "UA_" + makeCIdentifier(datatype.name), None)
+        elif isinstance(datatype, EnumerationType):
+            name = enum_encoding.get(datatype.strTypeKind)
+        elif isinstance(datatype, OpaqueType):
+            name = builtin_encoding.get(datatype.base_type, datatype.base_type)
+        elif isinstance(datatype, BuiltinType):
+            name = builtin_encoding.get(datatype.name, datatype.name)
+        if name is None:
+            return (None, None, None)
+        return (name, "UA_" + name, builtin_encoded_size.get(name))
+
+    def print_specialized_functions(self, datatype):
+        idName = makeCIdentifier(datatype.name)
+        specName = self.get_specialized_name(datatype)
+        prologue = "    if(ctx->depth > UA_ENCODING_MAX_RECURSION)\n" \
+                   "        return UA_STATUSCODE_BADENCODINGERROR;\n" \
+                   "    ctx->depth++;\n"
+        enc = "static status\n%s_encodeBinary(const UA_%s *UA_RESTRICT src, const UA_DataType *_,\n" \
+              "            Ctx *UA_RESTRICT ctx) {\n" % (specName, idName) + prologue
+        dec = "static status\n%s_decodeBinary(UA_%s *UA_RESTRICT dst, const UA_DataType *_,\n" \
+              "            Ctx *UA_RESTRICT ctx) {\n" % (specName, idName) + prologue
+        calc = "static size_t\n%s_calcSizeBinary(const UA_%s *UA_RESTRICT src, const UA_DataType *_) {\n" % \
+               (specName, idName) + "    size_t s = 0;\n"
+
+        for i, m in enumerate(datatype.members):
+            mName = makeCIdentifier(m.name)
+            mType = "&UA_%s[UA_%s_%s]" % (m.member_type.outname.upper(), m.member_type.outname.upper(),
+                                          makeCIdentifier(m.member_type.name.upper()))
+            (fName, cType, size) = self.get_member_encoding(m.member_type)
+            if fName is None:
+                # Fall back to the jumptable
+                encFunc = "encodeBinaryJumpTable[(%s)->typeKind]" % mType
+                decFunc = "decodeBinaryJumpTable[(%s)->typeKind]" % mType
+                calcFunc = "calcSizeBinaryJumpTable[(%s)->typeKind]" % mType
+                cType = "void"
+            else:
+                encFunc = "(encodeBinarySignature)%s_encodeBinary" % fName
+                decFunc = "%s_decodeBinary" % fName
+                if fName in ["Float", "Double"]:
+                    # The signature depends on the float representation
+                    decFunc = "decodeBinaryJumpTable[UA_DATATYPEKIND_%s]" % fName.upper()
+                    cType = "void"
+                if size is None:
+                    calcFunc = "%s_calcSizeBinary" % fName
+                elif fName == "Guid":
+                    calcFunc = "Guid_calcSizeBinary"
+                else:
+                    calcFunc = "calcSizeBinary%d" % size
+
+            if m.is_array:
+                encCall = "Array_encodeBinaryDirect(src->%s, src->%sSize, %s,\n" \
+                          "            %s, ctx);\n" % (mName, mName, mType, encFunc)
+                decCall = "Array_decodeBinaryDirect((void *UA_RESTRICT *UA_RESTRICT)&dst->%s,\n" \
+                          "            &dst->%sSize, %s, (decodeBinarySignature)%s, ctx);\n" % \
+                          (mName, mName, mType, decFunc)
+                calc += "    s += Array_calcSizeBinaryDirect(src->%s, src->%sSize, %s,\n" \
+                        "            (calcSizeBinarySignature)%s);\n" % (mName, mName, mType, calcFunc)
+            else:
+                encCall = "encodeWithExchangeBufferDirect(&src->%s, %s,\n" \
+                          "            %s, ctx);\n" % (mName, mType, encFunc)
+                decCall = "%s((%s*)&dst->%s, %s, ctx);\n" % (decFunc, cType, mName, mType)
+                if size is not None:
+                    calc += "    s += %d; /* %s */\n" % (size, mName)
+                else:
+                    calc += "    s += %s((const %s*)&src->%s, %s);\n" % (calcFunc, cType, mName, mType)
+
+            # Stop at the first error
+            if i == 0:
+                enc += "    status ret = " + encCall
+                dec += "    status ret = " + decCall
+            else:
+                enc += "    if(ret == UA_STATUSCODE_GOOD)\n        ret = " + encCall
+                dec += "    if(ret == UA_STATUSCODE_GOOD)\n        ret = " + decCall
+
+        enc += "    ctx->depth--;\n    return ret;\n}"
+        dec += "    ctx->depth--;\n    return ret;\n}"
+        calc += "    return s;\n}"
+        return enc + "\n\n" + dec + "\n\n" + calc
+
+    def print_specialized_table(self, signature, suffix):
+        table = "const %s %s_%sSpecialized[UA_%s_COUNT] = {\n" % \
+                (signature, self.parser.outname, suffix, self.parser.outname.upper())
+        entries = []
+        for t in self.filtered_types:
+            if self.has_specialized_encoding(t):
+                entries.append("    (%s)%s_%s /* %s */" % (signature, self.get_specialized_name(t), suffix, t.name))
+            else:
+                entries.append("    NULL /* %s */" % t.name)
+        return table + ",\n".join(entries) + "\n};"
+
+    def print_specialized_encoding(self):
+        self.prints('''/* Generated from ''' + self.inname + ''' with script ''' + sys.argv[0] + '''
+ * on host ''' + platform.uname()[1] + ''' by user ''' + getpass.getuser() + ''' at ''' + time.strftime(
+            "%Y-%m-%d %I:%M:%S") + ''' */
+
+/* Binary encoding specialized for the structures in UA_''' + self.parser.outname.upper() + '''. The member
+ * offsets and types are resolved at compile-time instead of walking the type
+ * description. This file is included at the end of ua_types_encoding_binary.c
+ * and uses its internal definitions. */
+''')
+
+        specialized = list(filter(self.has_specialized_encoding, self.filtered_types))
+        for t in specialized:
+            idName = makeCIdentifier(t.name)
+            specName = self.get_specialized_name(t)
+            self.prints("static status %s_encodeBinary(const UA_%s *UA_RESTRICT src, const UA_DataType *_, "
+                        "Ctx *UA_RESTRICT ctx);" % (specName, idName))
+            self.prints("static status %s_decodeBinary(UA_%s *UA_RESTRICT dst, const UA_DataType *_, "
+                        "Ctx *UA_RESTRICT ctx);" % (specName, idName))
+            self.prints("static size_t %s_calcSizeBinary(const UA_%s *UA_RESTRICT src, const UA_DataType *_);" %
+                        (specName, idName))
+
+        for t in specialized:
+            self.prints("\n/* " + t.name + " */")
+            self.prints(self.print_specialized_functions(t))
+
+        self.prints("")
+        self.prints(self.print_specialized_table("encodeBinarySignature", "encodeBinary") + "\n")
+        self.prints(self.print_specialized_table("decodeBinarySignature", "decodeBinary") + "\n")
+        self.prints(self.print_specialized_table("calcSizeBinarySignature", "calcSizeBinary"))